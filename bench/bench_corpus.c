@@ -0,0 +1,433 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_corpus.h"
+
+// NOTE(HS): vocabulary kept in sync with scripts/lexer_tc_gen.py
+static const char *bench_keywords[] = {
+    "var", "if", "else", "func", "return", "true", "false", "nil", "println",
+};
+
+static const char *bench_operators[] = {
+    "+", "-", "*", "/", "<", ">", "!=", "==", "<=", ">=", "||", "&&",
+};
+
+#define BENCH_ARRAY_LEN(A) (sizeof(A) / sizeof((A)[0]))
+
+typedef struct
+{
+    char *data;
+    size_t len;
+    size_t capacity;
+    uint64_t rng;
+} Corpus_Builder;
+
+/// xorshift64*, plenty for picking tokens
+static uint32_t builder_rand(Corpus_Builder *b)
+{
+    b->rng ^= b->rng >> 12;
+    b->rng ^= b->rng << 25;
+    b->rng ^= b->rng >> 27;
+    return (uint32_t) ((b->rng * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/// Random number in `[lo, hi]`
+static uint32_t builder_range(Corpus_Builder *b, uint32_t lo, uint32_t hi)
+{
+    return lo + (builder_rand(b) % (hi - lo + 1));
+}
+
+static void builder_append(Corpus_Builder *b, const char *str, size_t len)
+{
+    if (b->len + len + 1 > b->capacity)
+    {
+        while (b->len + len + 1 > b->capacity)
+        {
+            b->capacity *= 2;
+        }
+        b->data = realloc(b->data, b->capacity);
+        assert(b->data && "Failed to grow benchmark corpus");
+    }
+    memcpy(&b->data[b->len], str, len);
+    b->len += len;
+}
+
+static void builder_str(Corpus_Builder *b, const char *str)
+{
+    builder_append(b, str, strlen(str));
+}
+
+static void builder_char(Corpus_Builder *b, char c)
+{
+    builder_append(b, &c, 1);
+}
+
+static void builder_ident(Corpus_Builder *b, uint32_t min_len, uint32_t max_len)
+{
+    static const char ident_chars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+    uint32_t len = builder_range(b, min_len, max_len);
+
+    // NOTE(HS): identifiers can't start with `_`
+    builder_char(b, ident_chars[builder_range(b, 0, 51)]);
+    for (uint32_t i = 1; i < len; ++i)
+    {
+        builder_char(b, ident_chars[builder_range(b, 0, sizeof(ident_chars) - 2)]);
+    }
+}
+
+static void builder_number(Corpus_Builder *b)
+{
+    char buffer[32];
+    if (builder_rand(b) & 1)
+    {
+        snprintf(buffer, sizeof(buffer), "%u", builder_range(b, 0, 2000000000));
+    }
+    else
+    {
+        snprintf(buffer, sizeof(buffer), "%u.%u", builder_range(b, 0, 100000), builder_range(b, 0, 99999999));
+    }
+    builder_str(b, buffer);
+}
+
+static void builder_operator(Corpus_Builder *b)
+{
+    builder_char(b, ' ');
+    builder_str(b, bench_operators[builder_range(b, 0, BENCH_ARRAY_LEN(bench_operators) - 1)]);
+    builder_char(b, ' ');
+}
+
+static void builder_string(Corpus_Builder *b)
+{
+    static const char *words[] = {
+        "hello", "world", "the", "quick", "brown", "fox", "tyger", "burning", "bright",
+        "in", "forests", "of", "night", "\\\"quoted\\\"", "12345", "!?", "{ }",
+    };
+
+    builder_char(b, '\"');
+    uint32_t count = builder_range(b, 1, 24);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            builder_char(b, ' ');
+        }
+        builder_str(b, words[builder_range(b, 0, BENCH_ARRAY_LEN(words) - 1)]);
+    }
+    builder_char(b, '\"');
+}
+
+static void gen_code(Corpus_Builder *b)
+{
+    builder_str(b,
+        "var generated_identifier_name_for_value = func(first_argument, second_argument) {\n"
+        "        return if (first_argument < second_argument) {\n"
+        "                first_argument * 1024 + 3.14159265;\n"
+        "        } else {\n"
+        "                second_argument_with_a_long_name - 1000000;\n"
+        "        };\n"
+        "};\n"
+        "\n"
+        "                                                println(generated_identifier_name_for_value);\n");
+}
+
+static void gen_ident(Corpus_Builder *b)
+{
+    builder_str(b, "var ");
+    builder_ident(b, 1, 40);
+    builder_str(b, " = ");
+    uint32_t count = builder_range(b, 1, 8);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            builder_str(b, " + ");
+        }
+        if (builder_range(b, 0, 3) == 0)
+        {
+            builder_str(b, bench_keywords[builder_range(b, 0, BENCH_ARRAY_LEN(bench_keywords) - 1)]);
+        }
+        else
+        {
+            builder_ident(b, 1, 16);
+        }
+    }
+    builder_str(b, ";\n");
+}
+
+static void gen_operator(Corpus_Builder *b)
+{
+    builder_ident(b, 1, 2);
+    uint32_t count = builder_range(b, 4, 32);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        builder_operator(b);
+        if (builder_range(b, 0, 4) == 0)
+        {
+            builder_char(b, builder_rand(b) & 1 ? '!' : '-');
+        }
+        builder_ident(b, 1, 2);
+    }
+    builder_str(b, ";\n");
+}
+
+static void gen_string(Corpus_Builder *b)
+{
+    builder_str(b, "println(");
+    builder_string(b);
+    builder_str(b, ");\n");
+}
+
+static void gen_numeric(Corpus_Builder *b)
+{
+    builder_str(b, "var n = [");
+    uint32_t count = builder_range(b, 2, 16);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            builder_str(b, ", ");
+        }
+        builder_number(b);
+    }
+    builder_str(b, "];\n");
+}
+
+static void gen_nested_expression(Corpus_Builder *b, uint32_t depth)
+{
+    if (depth == 0)
+    {
+        if (builder_rand(b) & 1)
+        {
+            builder_ident(b, 1, 8);
+        }
+        else
+        {
+            builder_number(b);
+        }
+        return;
+    }
+
+    switch (builder_range(b, 0, 2))
+    {
+        case 0:
+        {
+            builder_char(b, '(');
+            gen_nested_expression(b, depth - 1);
+            builder_operator(b);
+            gen_nested_expression(b, 0);
+            builder_char(b, ')');
+        } break;
+
+        case 1:
+        {
+            builder_ident(b, 1, 8);
+            builder_char(b, '(');
+            gen_nested_expression(b, depth - 1);
+            builder_char(b, ')');
+        } break;
+
+        default:
+        {
+            builder_str(b, "if (");
+            gen_nested_expression(b, 0);
+            builder_str(b, ") { ");
+            gen_nested_expression(b, depth - 1);
+            builder_str(b, " } else { ");
+            gen_nested_expression(b, 0);
+            builder_str(b, " }");
+        } break;
+    }
+}
+
+static void gen_nested(Corpus_Builder *b)
+{
+    builder_str(b, "var nested = func(x) {\n    return ");
+    gen_nested_expression(b, builder_range(b, 8, 32));
+    builder_str(b, ";\n};\n");
+}
+
+static void gen_unicode(Corpus_Builder *b)
+{
+    // NOTE(HS): 2, 3 and 4 byte sequences
+    static const char *idents[] = {
+        "na\xc3\xafve", "caf\xc3\xa9", "\xc3\xbc" "ber_gr\xc3\xb6\xc3\x9f" "e", "\xce\xb1\xce\xb2\xce\xb3",
+        "\xe5\x90\x8d\xe5\x89\x8d", "\xe5\x80\xa4", "\xd0\xb7\xd0\xbd\xd0\xb0\xd1\x87\xd0\xb5\xd0\xbd\xd0\xb8\xd0\xb5",
+        "\xf0\x9f\x90\xaf", "plain_ascii",
+    };
+    static const char *words[] = {
+        "gr\xc3\xbc\xc3\x9f", "gott", "\xe3\x81\x93\xe3\x82\x93\xe3\x81\xab\xe3\x81\xa1\xe3\x81\xaf",
+        "\xd0\xbc\xd0\xb8\xd1\x80", "\xf0\x9f\x94\xa5", "hello", "\xc3\xa0 bient\xc3\xb4t",
+    };
+
+    builder_str(b, "var ");
+    builder_str(b, idents[builder_range(b, 0, BENCH_ARRAY_LEN(idents) - 1)]);
+    builder_str(b, " = ");
+    builder_str(b, idents[builder_range(b, 0, BENCH_ARRAY_LEN(idents) - 1)]);
+    builder_str(b, " + \"");
+    uint32_t count = builder_range(b, 1, 12);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+        {
+            builder_char(b, ' ');
+        }
+        builder_str(b, words[builder_range(b, 0, BENCH_ARRAY_LEN(words) - 1)]);
+    }
+    builder_str(b, "\";\n");
+}
+
+// NOTE(HS): the parser mix sticks to the syntax the parser supports, and a fixed
+// set of names so a random identifier can never spell a keyword
+static const char *parser_names[] = {
+    "x", "y", "count", "total", "left", "right", "value", "index",
+};
+
+static const char *parser_operators[] = {
+    "+", "-", "*", "/", "<", ">", "==", "!=", "<=", ">=", "&&", "||",
+};
+
+static void gen_parser_expression(Corpus_Builder *b, uint32_t depth)
+{
+    uint32_t choice = depth == 0 ? builder_range(b, 0, 3) : builder_range(b, 0, 7);
+    switch (choice)
+    {
+        // names twice as likely as other leaves
+        case 0:
+        case 1:
+        {
+            builder_str(b, parser_names[builder_range(b, 0, BENCH_ARRAY_LEN(parser_names) - 1)]);
+        } break;
+
+        case 2:
+        {
+            builder_number(b);
+        } break;
+
+        case 3:
+        {
+            builder_str(b, builder_rand(b) & 1 ? "true" : "false");
+        } break;
+
+        case 4:
+        {
+            builder_char(b, builder_rand(b) & 1 ? '-' : '!');
+            gen_parser_expression(b, depth - 1);
+        } break;
+
+        case 5:
+        {
+            builder_char(b, '(');
+            gen_parser_expression(b, depth - 1);
+            builder_char(b, ')');
+        } break;
+
+        default:
+        {
+            gen_parser_expression(b, depth - 1);
+            builder_char(b, ' ');
+            builder_str(b, parser_operators[builder_range(b, 0, BENCH_ARRAY_LEN(parser_operators) - 1)]);
+            builder_char(b, ' ');
+            gen_parser_expression(b, depth - 1);
+        } break;
+    }
+}
+
+static void gen_parser(Corpus_Builder *b)
+{
+    const char *name = parser_names[builder_range(b, 0, BENCH_ARRAY_LEN(parser_names) - 1)];
+    switch (builder_range(b, 0, 3))
+    {
+        case 0:
+        {
+            builder_str(b, "var ");
+            builder_str(b, name);
+            builder_str(b, " = func(left, right) {\n    var total = ");
+            gen_parser_expression(b, 3);
+            builder_str(b, ";\n    return if (");
+            gen_parser_expression(b, 2);
+            builder_str(b, ") { ");
+            gen_parser_expression(b, 3);
+            builder_str(b, " } else { total };\n};\n");
+        } break;
+
+        case 1:
+        {
+            gen_parser_expression(b, 4);
+            builder_str(b, ";\n");
+        } break;
+
+        default:
+        {
+            builder_str(b, "var ");
+            builder_str(b, name);
+            builder_str(b, " = ");
+            gen_parser_expression(b, 4);
+            builder_str(b, ";\n");
+        } break;
+    }
+}
+
+static void (*const bench_generators[BENCH_MIX_COUNT]) (Corpus_Builder *) = {
+    [BENCH_MIX_CODE]     = gen_code,
+    [BENCH_MIX_IDENT]    = gen_ident,
+    [BENCH_MIX_OPERATOR] = gen_operator,
+    [BENCH_MIX_STRING]   = gen_string,
+    [BENCH_MIX_NUMERIC]  = gen_numeric,
+    [BENCH_MIX_NESTED]   = gen_nested,
+    [BENCH_MIX_UNICODE]  = gen_unicode,
+    [BENCH_MIX_PARSER]   = gen_parser,
+};
+
+static const char *bench_mix_names[BENCH_MIX_COUNT] = {
+    [BENCH_MIX_CODE]     = "code",
+    [BENCH_MIX_IDENT]    = "ident",
+    [BENCH_MIX_OPERATOR] = "operator",
+    [BENCH_MIX_STRING]   = "string",
+    [BENCH_MIX_NUMERIC]  = "numeric",
+    [BENCH_MIX_NESTED]   = "nested",
+    [BENCH_MIX_UNICODE]  = "unicode",
+    [BENCH_MIX_PARSER]   = "parser",
+};
+
+const char *bench_mix_to_string(Bench_Mix mix)
+{
+    assert(mix < BENCH_MIX_COUNT);
+    return bench_mix_names[mix];
+}
+
+bool bench_mix_from_string(const char *name, Bench_Mix *mix)
+{
+    for (int i = 0; i < BENCH_MIX_COUNT; ++i)
+    {
+        if (strcmp(name, bench_mix_names[i]) == 0)
+        {
+            *mix = (Bench_Mix) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+char *bench_corpus_generate(Bench_Mix mix, size_t size, uint64_t seed)
+{
+    assert(mix < BENCH_MIX_COUNT);
+
+    Corpus_Builder b = {
+        .data = malloc(size + 4096),
+        .len = 0,
+        .capacity = size + 4096,
+        // NOTE(HS): xorshift state must be non-zero
+        .rng = seed ? seed : 0x9E3779B97F4A7C15ULL,
+    };
+    assert(b.data && "Failed to allocate benchmark corpus");
+
+    while (b.len < size)
+    {
+        bench_generators[mix](&b);
+    }
+    b.data[b.len] = '\0';
+
+    return b.data;
+}
@@ -0,0 +1,42 @@
+/**
+ * Generators for synthetic benchmark corpora. Each mix stresses a different part
+ * of the lexer (the parser mix, the parser), and uses the same token vocabulary
+ * as scripts/lexer_tc_gen.py. Generation is deterministic for a given seed so runs are comparable.
+*/
+#ifndef TYGER_BENCH_CORPUS_H_
+#define TYGER_BENCH_CORPUS_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum
+{
+    /// realistic looking mix of everything
+    BENCH_MIX_CODE,
+    /// long and short identifiers, keywords and near-keywords
+    BENCH_MIX_IDENT,
+    /// dense single and two character operators
+    BENCH_MIX_OPERATOR,
+    /// string literals, with escaped quotes
+    BENCH_MIX_STRING,
+    /// int and float literals
+    BENCH_MIX_NUMERIC,
+    /// deeply nested blocks, calls and parentheses
+    BENCH_MIX_NESTED,
+    /// UTF-8 identifiers and localised string literals
+    BENCH_MIX_UNICODE,
+    /// statements using only the syntax the parser supports
+    BENCH_MIX_PARSER,
+    BENCH_MIX_COUNT
+} Bench_Mix;
+
+const char *bench_mix_to_string(Bench_Mix mix);
+
+/// Looks up a mix by the name returned from `bench_mix_to_string`.
+bool bench_mix_from_string(const char *name, Bench_Mix *mix);
+
+/// Generates a NUL-terminated corpus of at least `size` bytes (whole statements
+/// only), which the caller must free.
+char *bench_corpus_generate(Bench_Mix mix, size_t size, uint64_t seed);
+
+#endif // TYGER_BENCH_CORPUS_H_
@@ -0,0 +1,599 @@
+/**
+ * Throughput benchmark for the lexer and parser, over generated corpora.
+ *
+ * Usage: tyger_bench [options]
+ *  --size <bytes>[K|M]  size of each generated corpus (default 8M)
+ *  --iterations <n>     runs of each benchmark, the best is reported (default 5)
+ *  --mix <name|all>     corpus mix to run: code, ident, operator, string, numeric,
+ *                       nested, unicode, parser or all (default all)
+ *  --seed <n>           seed for the corpus generator
+ *  --min-mbps <n>       exit with failure if `lexer_next_token` is slower than this
+ *                       on any mix, for catching regressions in CI
+*/
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "lexer_internal.h"
+#include "parallel_lexer.h"
+#include "scan.h"
+#include "stream_lexer.h"
+#include "tthreads.h"
+#include "bench_corpus.h"
+#include "bench_parser.h"
+#include "bench_timer.h"
+
+#define BENCH_DEFAULT_SIZE (8 * 1024 * 1024)
+#define BENCH_DEFAULT_ITERATIONS 5
+#define BENCH_DEFAULT_SEED 0x7967657253454544ULL
+#define BENCH_STREAM_CHUNK (64 * 1024)
+
+/// Lexes the whole corpus once, returning the number of tokens produced.
+static size_t bench_lex_all(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    size_t count = 0;
+    Token t;
+    do
+    {
+        t = lexer_next_token(&l);
+        count += 1;
+    } while (t.kind != TK_EOF);
+
+    return count;
+}
+
+/// Lexes the whole corpus once with the table-driven lexer, returning the number of tokens.
+static size_t bench_lex_all_dfa(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    size_t count = 0;
+    Token t;
+    do
+    {
+        t = lexer_next_token_dfa(&l);
+        count += 1;
+    } while (t.kind != TK_EOF);
+
+    return count;
+}
+
+/// Lexes the whole corpus into a token buffer, returning the number of tokens.
+static size_t bench_tokenize_all(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    Token_Buffer tokens = {0};
+    lexer_tokenize_all(&l, &tokens);
+    size_t count = tokens.len;
+    token_buffer_free(&tokens);
+
+    return count;
+}
+
+/// Lexes the corpus through the streaming lexer, fed in fixed size chunks.
+static size_t bench_stream_lex(const char *corpus)
+{
+    Stream_Lexer sl;
+    stream_lexer_init(&sl);
+
+    size_t len = strlen(corpus);
+    size_t count = 0;
+    Token t;
+    for (size_t i = 0; i < len; i += BENCH_STREAM_CHUNK)
+    {
+        size_t n = len - i < BENCH_STREAM_CHUNK ? len - i : BENCH_STREAM_CHUNK;
+        stream_lexer_feed(&sl, &corpus[i], n);
+        while (stream_lexer_next(&sl, &t))
+        {
+            count += 1;
+        }
+    }
+
+    stream_lexer_finish(&sl);
+    while (stream_lexer_next(&sl, &t) && t.kind != TK_EOF)
+    {
+        count += 1;
+    }
+    stream_lexer_free(&sl);
+
+    return count + 1;
+}
+
+/// Lexes the corpus and decodes every number the way the parser used to, copying
+/// each literal into a scratch buffer for `atoi` / `atof`.
+static size_t bench_numbers_atoi(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    size_t count = 0;
+    volatile double sum = 0.0;
+    for (Token t = lexer_next_token(&l); t.kind != TK_EOF; t = lexer_next_token(&l))
+    {
+        count += 1;
+        if (t.kind != TK_INT_LIT && t.kind != TK_FLOAT_LIT)
+        {
+            continue;
+        }
+
+        char *buffer = malloc(t.literal.length + 1);
+        assert(buffer && "Failed to allocate scratch buffer");
+        strncpy(buffer, t.literal.str, t.literal.length);
+        buffer[t.literal.length] = '\0';
+        sum += t.kind == TK_INT_LIT ? (double) atoi(buffer) : atof(buffer);
+        free(buffer);
+    }
+
+    return count + 1;
+}
+
+/// Lexes the corpus using the values the lexer decoded while scanning.
+static size_t bench_numbers_lexer(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    size_t count = 0;
+    volatile double sum = 0.0;
+    for (Token t = lexer_next_token(&l); t.kind != TK_EOF; t = lexer_next_token(&l))
+    {
+        count += 1;
+        if (t.kind == TK_INT_LIT)
+        {
+            sum += (double) t.value.i;
+        }
+        else if (t.kind == TK_FLOAT_LIT)
+        {
+            sum += (double) t.value.f;
+        }
+    }
+
+    return count + 1;
+}
+
+/// Builds the line index for the whole corpus, returning the number of lines.
+static size_t bench_line_index(const char *corpus)
+{
+    Line_Index lines = {0};
+    line_index_build(&lines, corpus, strlen(corpus));
+    size_t count = lines.len;
+    line_index_free(&lines);
+
+    return count;
+}
+
+/// Thread count used by `bench_tokenize_parallel`
+static size_t bench_thread_count = 1;
+
+/// Lexes the whole corpus into a token buffer on `bench_thread_count` threads.
+static size_t bench_tokenize_parallel(const char *corpus)
+{
+    Lexer l;
+    lexer_init(&l, corpus);
+
+    Parallel_Lexer_Config config = parallel_lexer_default_config();
+    config.thread_count = bench_thread_count;
+    config.min_input_size = 0;
+
+    Token_Buffer tokens = {0};
+    lexer_tokenize_parallel(&l, &tokens, &config);
+    size_t count = tokens.len;
+    token_buffer_free(&tokens);
+
+    return count;
+}
+
+/// The keyword classification used before the perfect hash, kept as a baseline.
+static Token_Kind bench_keyword_chain(String_View sv)
+{
+    #define sveq(S) string_view_eq_cstr(sv, (S))
+
+    Token_Kind kind = TK_IDENT;
+
+    if      (sveq("true"))    { kind = TK_TRUE;    }
+    else if (sveq("false"))   { kind = TK_FALSE;   }
+    else if (sveq("nil"))     { kind = TK_NIL;     }
+    else if (sveq("if"))      { kind = TK_IF;      }
+    else if (sveq("else"))    { kind = TK_ELSE;    }
+    else if (sveq("func"))    { kind = TK_FUNC;    }
+    else if (sveq("var"))     { kind = TK_VAR;     }
+    else if (sveq("return"))  { kind = TK_RETURN;  }
+    else if (sveq("println")) { kind = TK_PRINTLN; }
+
+    #undef sveq
+    return kind;
+}
+
+/// Times classifying every identifier and keyword in the corpus with `classify`.
+static void bench_keywords(const char *corpus, const char *name, Token_Kind (*classify)(String_View))
+{
+    // collect the words up front so only classification is timed
+    size_t capacity = 1024;
+    size_t count = 0;
+    String_View *words = malloc(sizeof(String_View) * capacity);
+    assert(words && "Failed to allocate benchmark words");
+
+    Lexer l;
+    lexer_init(&l, corpus);
+    for (Token t = lexer_next_token(&l); t.kind != TK_EOF; t = lexer_next_token(&l))
+    {
+        if (t.kind != TK_IDENT && string_view_to_ident_or_keyword(t.literal) == TK_IDENT)
+        {
+            continue;
+        }
+        if (count == capacity)
+        {
+            capacity *= 2;
+            words = realloc(words, sizeof(String_View) * capacity);
+            assert(words && "Failed to grow benchmark words");
+        }
+        words[count++] = t.literal;
+    }
+
+    double start = bench_now_seconds();
+    size_t keywords = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        keywords += classify(words[i]) != TK_IDENT;
+    }
+    double elapsed = bench_now_seconds() - start;
+
+    printf("keyword lookup [%-14s] %8.2f ns/word (%zu words, %zu keywords)\n",
+        name, elapsed * 1e9 / (double) count, count, keywords);
+
+    free(words);
+}
+
+/// Times comparing identifiers, both against an earlier occurrence of the same
+/// name and against the previous identifier (almost always a different name).
+static void bench_string_compare(const char *corpus)
+{
+    size_t capacity = 1024;
+    size_t count = 0;
+    Hashed_String_View *words = malloc(sizeof(Hashed_String_View) * capacity);
+    Symbol *symbols = malloc(sizeof(Symbol) * capacity);
+    assert(words && symbols && "Failed to allocate benchmark words");
+
+    Lexer l;
+    lexer_init(&l, corpus);
+    for (Token t = lexer_next_token(&l); t.kind != TK_EOF; t = lexer_next_token(&l))
+    {
+        if (t.kind != TK_IDENT)
+        {
+            continue;
+        }
+        if (count == capacity)
+        {
+            capacity *= 2;
+            words = realloc(words, sizeof(Hashed_String_View) * capacity);
+            symbols = realloc(symbols, sizeof(Symbol) * capacity);
+            assert(words && symbols && "Failed to grow benchmark words");
+        }
+        words[count] = string_view_hashed(t.literal);
+        symbols[count] = t.value.symbol;
+        count += 1;
+    }
+    lexer_free(&l);
+
+    if (count < 2)
+    {
+        free(symbols);
+        free(words);
+        return;
+    }
+
+    // NOTE(HS): symbols are dense, so the first occurrence of each name is found by
+    // indexing with its symbol
+    Hashed_String_View *first_of_symbol = calloc(symbol_count() + 1, sizeof(Hashed_String_View));
+    Hashed_String_View *firsts = malloc(sizeof(Hashed_String_View) * count);
+    assert(first_of_symbol && firsts && "Failed to allocate benchmark words");
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (first_of_symbol[symbols[i]].sv.str == NULL)
+        {
+            first_of_symbol[symbols[i]] = words[i];
+        }
+        firsts[i] = first_of_symbol[symbols[i]];
+    }
+
+    #define BENCH_COMPARE(NAME, EQ)                                                          \
+        for (int same = 1; same >= 0; --same)                                                \
+        {                                                                                    \
+            double start = bench_now_seconds();                                              \
+            size_t matches = 0;                                                              \
+            for (size_t i = 1; i < count; ++i)                                               \
+            {                                                                                \
+                Hashed_String_View a = words[i];                                             \
+                Hashed_String_View b = same ? firsts[i] : words[i - 1];                      \
+                matches += (EQ);                                                             \
+            }                                                                                \
+            double elapsed = bench_now_seconds() - start;                                    \
+            printf("ident compare  [%-14s] %8.2f ns/pair (%-5s names, %zu pairs, %zu equal)\n", \
+                NAME, elapsed * 1e9 / (double) (count - 1), same ? "same" : "other",          \
+                count - 1, matches);                                                         \
+        }
+
+    BENCH_COMPARE("memcmp", a.sv.length == b.sv.length && memcmp(a.sv.str, b.sv.str, a.sv.length) == 0);
+    BENCH_COMPARE("string_view_eq", string_view_eq(a.sv, b.sv));
+    BENCH_COMPARE("hashed", hashed_string_view_eq(a, b));
+
+    #undef BENCH_COMPARE
+
+    free(firsts);
+    free(first_of_symbol);
+    free(symbols);
+    free(words);
+}
+
+/// Times re-lexing after a one character edit in the middle of the corpus, by
+/// inserting a character into an identifier and removing it again.
+static void bench_relex(const char *corpus, size_t corpus_len)
+{
+    size_t at = corpus_len / 2;
+    while (at < corpus_len && !is_alpha(corpus[at]))
+    {
+        at += 1;
+    }
+    if (at == corpus_len)
+    {
+        return;
+    }
+
+    char *edited = malloc(corpus_len + 2);
+    assert(edited && "Failed to allocate edited corpus");
+    memcpy(edited, corpus, at);
+    edited[at] = 'x';
+    memcpy(&edited[at + 1], &corpus[at], corpus_len - at + 1);
+
+    Lexer l;
+    lexer_init_n(&l, corpus, corpus_len);
+    Token_Buffer tokens = {0};
+    double start = bench_now_seconds();
+    lexer_tokenize_all(&l, &tokens);
+    double full = bench_now_seconds() - start;
+
+    const int edits = 1000;
+    size_t lexed = 0;
+    start = bench_now_seconds();
+    for (int i = 0; i < edits; ++i)
+    {
+        Text_Edit insert = { at, 0, 1 };
+        Text_Edit remove = { at, 1, 0 };
+        lexed += token_buffer_relex(&tokens, edited, corpus_len + 1, insert);
+        lexed += token_buffer_relex(&tokens, corpus, corpus_len, remove);
+    }
+    double elapsed = bench_now_seconds() - start;
+
+    printf("token_buffer_relex   %8.2f us/edit (%.1f tokens lexed per edit), full lex %.2f us\n",
+        elapsed * 1e6 / (2.0 * edits), (double) lexed / (2.0 * edits), full * 1e6);
+
+    token_buffer_free(&tokens);
+    lexer_free(&l);
+    free(edited);
+}
+
+/// Times validating the corpus as UTF-8 with each kernel implementation.
+static void bench_utf8(const char *corpus, size_t corpus_len, int iterations)
+{
+    Cpu_Isa detected = scan_get_isa();
+    for (int isa = CPU_ISA_SCALAR; isa <= (int) detected; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+
+        double best = 0.0;
+        size_t valid = 0;
+        for (int i = 0; i < iterations; ++i)
+        {
+            double start = bench_now_seconds();
+            valid = scan_utf8(corpus, corpus_len);
+            double elapsed = bench_now_seconds() - start;
+            if (i == 0 || elapsed < best) { best = elapsed; }
+        }
+
+        printf("%-20s [%-6s] %10.2f MB/s %s\n",
+            "scan_utf8", cpu_isa_to_string((Cpu_Isa) isa), (double) corpus_len / best / 1e6,
+            valid == corpus_len ? "valid" : "INVALID");
+    }
+    scan_set_isa(detected);
+}
+
+/// Runs `fn` over the corpus `iterations` times and reports the best throughput,
+/// returning it in MB/s.
+static double bench_run(
+    const char *name,
+    const char *variant,
+    size_t (*fn)(const char *),
+    const char *corpus,
+    size_t corpus_len,
+    int iterations
+)
+{
+    double best = 0.0;
+    size_t tokens = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        double start = bench_now_seconds();
+        tokens = fn(corpus);
+        double elapsed = bench_now_seconds() - start;
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+
+    double mbps = (double) corpus_len / best / 1e6;
+    printf("%-20s [%-6s] %10.2f MB/s %12.0f tokens/s\n",
+        name,
+        variant,
+        mbps,
+        (double) tokens / best);
+
+    return mbps;
+}
+
+/// Parses a size in bytes with an optional `K` or `M` suffix.
+static size_t bench_parse_size(const char *str)
+{
+    char *end = NULL;
+    size_t size = (size_t) strtoull(str, &end, 10);
+    if (end && (*end == 'K' || *end == 'k'))
+    {
+        size *= 1024;
+    }
+    else if (end && (*end == 'M' || *end == 'm'))
+    {
+        size *= 1024 * 1024;
+    }
+    return size;
+}
+
+static void bench_usage(const char *program)
+{
+    fprintf(stderr,
+        "usage: %s [--size <bytes>[K|M]] [--iterations <n>] [--mix <name|all>] [--seed <n>] [--min-mbps <n>]\n",
+        program);
+}
+
+/// Benchmarks of individual lexer components and alternative APIs, run on the
+/// code mix.
+static void bench_components(const char *corpus, size_t corpus_len, int iterations)
+{
+    Cpu_Isa detected = scan_get_isa();
+
+    size_t hardware_threads = thread_hardware_count();
+    for (size_t threads = 2; threads <= 2 * hardware_threads || threads <= 2; threads *= 2)
+    {
+        char variant[16];
+        snprintf(variant, sizeof(variant), "%zu thr", threads);
+        bench_thread_count = threads;
+        bench_run("tokenize_parallel", variant, bench_tokenize_parallel, corpus, corpus_len, iterations);
+    }
+
+    bench_run("stream_lexer_next", cpu_isa_to_string(detected), bench_stream_lex, corpus, corpus_len, iterations);
+    bench_run("line_index_build", cpu_isa_to_string(detected), bench_line_index, corpus, corpus_len, iterations);
+
+    bench_keywords(corpus, "strcmp chain", bench_keyword_chain);
+    bench_keywords(corpus, "perfect hash", string_view_to_ident_or_keyword);
+
+    bench_string_compare(corpus);
+    bench_relex(corpus, corpus_len);
+}
+
+int main(int argc, const char *argv[])
+{
+    size_t size = BENCH_DEFAULT_SIZE;
+    int iterations = BENCH_DEFAULT_ITERATIONS;
+    uint64_t seed = BENCH_DEFAULT_SEED;
+    double min_mbps = 0.0;
+    bool run_mix[BENCH_MIX_COUNT];
+    for (int mix = 0; mix < BENCH_MIX_COUNT; ++mix) { run_mix[mix] = true; }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (value == NULL)
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+        i += 1;
+
+        if (strcmp(arg, "--size") == 0)
+        {
+            size = bench_parse_size(value);
+        }
+        else if (strcmp(arg, "--iterations") == 0)
+        {
+            iterations = atoi(value);
+        }
+        else if (strcmp(arg, "--seed") == 0)
+        {
+            seed = strtoull(value, NULL, 0);
+        }
+        else if (strcmp(arg, "--min-mbps") == 0)
+        {
+            min_mbps = atof(value);
+        }
+        else if (strcmp(arg, "--mix") == 0)
+        {
+            Bench_Mix mix;
+            if (strcmp(value, "all") == 0)
+            {
+                continue;
+            }
+            if (!bench_mix_from_string(value, &mix))
+            {
+                fprintf(stderr, "unknown mix `%s`\n", value);
+                return 1;
+            }
+            for (int m = 0; m < BENCH_MIX_COUNT; ++m) { run_mix[m] = m == (int) mix; }
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (size == 0) { size = BENCH_DEFAULT_SIZE; }
+    if (iterations <= 0) { iterations = BENCH_DEFAULT_ITERATIONS; }
+
+    Cpu_Isa detected = scan_get_isa();
+    printf("corpus size: %zu bytes, %d iterations, host isa: %s\n",
+        size, iterations, cpu_isa_to_string(detected));
+
+    bool regressed = false;
+    for (int mix = 0; mix < BENCH_MIX_COUNT; ++mix)
+    {
+        if (!run_mix[mix])
+        {
+            continue;
+        }
+
+        char *corpus = bench_corpus_generate((Bench_Mix) mix, size, seed);
+        size_t corpus_len = strlen(corpus);
+        printf("\n== mix: %s (%zu bytes)\n", bench_mix_to_string((Bench_Mix) mix), corpus_len);
+
+        double mbps = 0.0;
+        for (int isa = CPU_ISA_SCALAR; isa <= (int) detected; ++isa)
+        {
+            scan_set_isa((Cpu_Isa) isa);
+            mbps = bench_run("lexer_next_token", cpu_isa_to_string((Cpu_Isa) isa), bench_lex_all, corpus, corpus_len, iterations);
+        }
+        scan_set_isa(detected);
+
+        bench_run("lexer_next_token_dfa", "table", bench_lex_all_dfa, corpus, corpus_len, iterations);
+        bench_utf8(corpus, corpus_len, iterations);
+        bench_run("lexer_tokenize_all", cpu_isa_to_string(detected), bench_tokenize_all, corpus, corpus_len, iterations);
+
+        if (mix == BENCH_MIX_CODE)
+        {
+            bench_components(corpus, corpus_len, iterations);
+        }
+        else if (mix == BENCH_MIX_NUMERIC)
+        {
+            bench_run("numbers (atoi)", cpu_isa_to_string(detected), bench_numbers_atoi, corpus, corpus_len, iterations);
+            bench_run("numbers (lexer)", cpu_isa_to_string(detected), bench_numbers_lexer, corpus, corpus_len, iterations);
+        }
+        else if (mix == BENCH_MIX_PARSER)
+        {
+            bench_parser(corpus, corpus_len, iterations);
+        }
+
+        if (mbps < min_mbps)
+        {
+            printf("REGRESSION: lexer_next_token on `%s` at %.2f MB/s is below %.2f MB/s\n",
+                bench_mix_to_string((Bench_Mix) mix), mbps, min_mbps);
+            regressed = true;
+        }
+
+        free(corpus);
+    }
+
+    return regressed ? 1 : 0;
+}
@@ -0,0 +1,457 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "ast_cache.h"
+#include "flat_ast.h"
+#include "lexer.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "bench_parser.h"
+#include "bench_timer.h"
+#include "tthreads.h"
+
+/// What a traversal computes, so the compiler can't skip it: the number of nodes
+/// and the sum of every int literal.
+typedef struct
+{
+    size_t nodes;
+    int64_t int_sum;
+} Bench_Ast_Stats;
+
+static void bench_walk_block(const Block_Statement *block, Bench_Ast_Stats *stats);
+
+static void bench_walk_expression(const Expression *expr, Bench_Ast_Stats *stats)
+{
+    stats->nodes += 1;
+    switch (expr->kind)
+    {
+        case AST_INT_EXPRESSION:
+        {
+            stats->int_sum += expr->expr.int_expression.value;
+        } break;
+
+        case AST_PREFIX_EXPRESSION:
+        {
+            bench_walk_expression(expr->expr.prefix_expression.rhs, stats);
+        } break;
+
+        case AST_INFIX_EXPRESSION:
+        {
+            bench_walk_expression(expr->expr.infix_expression.lhs, stats);
+            bench_walk_expression(expr->expr.infix_expression.rhs, stats);
+        } break;
+
+        case AST_IF_EXPRESSION:
+        {
+            bench_walk_expression(expr->expr.if_expression.condition, stats);
+            bench_walk_block(expr->expr.if_expression.consequence, stats);
+            if (expr->expr.if_expression.alternative)
+            {
+                bench_walk_block(expr->expr.if_expression.alternative, stats);
+            }
+        } break;
+
+        case AST_FUNCTION_EXPRESSION:
+        {
+            if (expr->expr.function_expression.body)
+            {
+                bench_walk_block(expr->expr.function_expression.body, stats);
+            }
+        } break;
+
+        default:
+        {} break;
+    }
+}
+
+static void bench_walk_statement(const Statement *stmt, Bench_Ast_Stats *stats)
+{
+    stats->nodes += 1;
+    switch (stmt->kind)
+    {
+        case AST_VAR_STATEMENT:
+        {
+            bench_walk_expression(&stmt->stmt.var_statement.expression, stats);
+        } break;
+
+        case AST_RETURN_STATEMENT:
+        {
+            bench_walk_expression(&stmt->stmt.return_statement.expression, stats);
+        } break;
+
+        case AST_EXPRESSION_STATEMENT:
+        {
+            bench_walk_expression(&stmt->stmt.expression_statement.expression, stats);
+        } break;
+
+        default:
+        {} break;
+    }
+}
+
+static void bench_walk_block(const Block_Statement *block, Bench_Ast_Stats *stats)
+{
+    stats->nodes += 1;
+    for (size_t i = 0; i < block->len; ++i)
+    {
+        bench_walk_statement(&block->statements[i], stats);
+    }
+}
+
+/// NOTE(HS): counts the top level as a block, the way the flat AST stores it
+static Bench_Ast_Stats bench_walk_program(const Program *prog)
+{
+    Bench_Ast_Stats stats = { 1, 0 };
+    for (size_t i = 0; i < prog->statements.len; ++i)
+    {
+        bench_walk_statement(&prog->statements.elements[i], &stats);
+    }
+    return stats;
+}
+
+static bool bench_visit_flat(const Flat_Ast *ast, Flat_Node node, size_t depth, void *user)
+{
+    (void) depth;
+    Bench_Ast_Stats *stats = user;
+    stats->nodes += 1;
+    if (ast->kinds[node] == FLAT_INT_EXPRESSION)
+    {
+        stats->int_sum += flat_ast_int(ast, node);
+    }
+    return true;
+}
+
+static Bench_Ast_Stats bench_walk_flat(const Flat_Ast *ast)
+{
+    Bench_Ast_Stats stats = { 0, 0 };
+    flat_ast_walk(ast, ast->root, bench_visit_flat, &stats);
+    return stats;
+}
+
+/// Same traversal as the pointer AST's, recursing through the accessors.
+static void bench_walk_flat_node(const Flat_Ast *ast, Flat_Node node, Bench_Ast_Stats *stats)
+{
+    stats->nodes += 1;
+    switch (flat_ast_kind(ast, node))
+    {
+        case FLAT_BLOCK:
+        {
+            size_t len = 0;
+            const Flat_Node *statements = flat_ast_block_statements(ast, node, &len);
+            for (size_t i = 0; i < len; ++i)
+            {
+                bench_walk_flat_node(ast, statements[i], stats);
+            }
+        } break;
+
+        case FLAT_VAR_STATEMENT:
+        {
+            bench_walk_flat_node(ast, flat_ast_var(ast, node)->value, stats);
+        } break;
+
+        case FLAT_RETURN_STATEMENT:
+        case FLAT_EXPRESSION_STATEMENT:
+        {
+            bench_walk_flat_node(ast, flat_ast_statement_expression(ast, node), stats);
+        } break;
+
+        case FLAT_INT_EXPRESSION:
+        {
+            stats->int_sum += flat_ast_int(ast, node);
+        } break;
+
+        case FLAT_PREFIX_EXPRESSION:
+        {
+            bench_walk_flat_node(ast, flat_ast_prefix(ast, node)->rhs, stats);
+        } break;
+
+        case FLAT_INFIX_EXPRESSION:
+        {
+            const Flat_Infix *infix = flat_ast_infix(ast, node);
+            bench_walk_flat_node(ast, infix->lhs, stats);
+            bench_walk_flat_node(ast, infix->rhs, stats);
+        } break;
+
+        case FLAT_IF_EXPRESSION:
+        {
+            const Flat_If *flat_if = flat_ast_if(ast, node);
+            bench_walk_flat_node(ast, flat_if->condition, stats);
+            bench_walk_flat_node(ast, flat_if->consequence, stats);
+            if (flat_if->alternative != FLAT_NODE_NONE)
+            {
+                bench_walk_flat_node(ast, flat_if->alternative, stats);
+            }
+        } break;
+
+        case FLAT_FUNCTION_EXPRESSION:
+        {
+            Flat_Node body = flat_ast_function(ast, node)->body;
+            if (body != FLAT_NODE_NONE)
+            {
+                bench_walk_flat_node(ast, body, stats);
+            }
+        } break;
+
+        default:
+        {} break;
+    }
+}
+
+static Bench_Ast_Stats bench_recurse_flat(const Flat_Ast *ast)
+{
+    Bench_Ast_Stats stats = { 0, 0 };
+    bench_walk_flat_node(ast, ast->root, &stats);
+    return stats;
+}
+
+/// Passes that don't care about the tree's shape can skip the walk entirely.
+static Bench_Ast_Stats bench_scan_flat(const Flat_Ast *ast)
+{
+    Bench_Ast_Stats stats = { 0, 0 };
+    for (size_t i = 1; i < ast->len; ++i)
+    {
+        stats.nodes += 1;
+        if (ast->kinds[i] == FLAT_INT_EXPRESSION)
+        {
+            stats.int_sum += (int32_t) ast->payloads[i];
+        }
+    }
+    return stats;
+}
+
+static void bench_report_walk(const char *variant, Bench_Ast_Stats stats, double seconds)
+{
+    printf("%-20s [%-6s] %10.2f ns/node %10zu nodes (sum %lld)\n",
+        "ast_walk",
+        variant,
+        seconds * 1e9 / (double) stats.nodes,
+        stats.nodes,
+        (long long) stats.int_sum);
+}
+
+/// Parses `tokens` `iterations` times, on `threads` threads if more than 1,
+/// returning the best time and keeping the program of the last run in `program`.
+static double bench_parse(Token_Buffer *tokens, int iterations, bool lazy, size_t threads, Program *program)
+{
+    Parallel_Parser_Config config = parallel_parser_default_config();
+    config.thread_count = threads;
+    config.min_token_count = 0;
+
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        program_free(program);
+
+        Parser parser;
+        parser_init_tokens(&parser, tokens);
+        parser.lazy_function_bodies = lazy;
+        double start = bench_now_seconds();
+        *program = threads > 1
+            ? parser_parse_program_parallel(&parser, &config)
+            : parser_parse_program(&parser);
+        double elapsed = bench_now_seconds() - start;
+        parser_free(&parser);
+
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    return best;
+}
+
+/// Most memory any one statement of a streamed parse took.
+typedef struct
+{
+    size_t nodes;
+    size_t tokens;
+} Bench_Stream_Peak;
+
+/// The corpus, read by a parser over it a chunk at a time.
+typedef struct
+{
+    const char *corpus;
+    size_t len;
+    size_t pos;
+} Bench_Reader;
+
+static size_t bench_read(void *reader, char *buffer, size_t capacity)
+{
+    Bench_Reader *r = reader;
+    size_t len = r->len - r->pos < capacity ? r->len - r->pos : capacity;
+    memcpy(buffer, &r->corpus[r->pos], len);
+    r->pos += len;
+    return len;
+}
+
+static bool bench_stream_statement(Parser *p, const Statement *stmt, Arena *arena, void *user)
+{
+    (void) stmt;
+    Bench_Stream_Peak *peak = user;
+    if (arena->used > peak->nodes) { peak->nodes = arena->used; }
+    if (p->tokens->len > peak->tokens) { peak->tokens = p->tokens->len; }
+    return true;
+}
+
+/// Lexes and parses the corpus a statement at a time, returning the best time and
+/// the most memory any one statement took.
+static double bench_parse_each(const char *corpus, size_t corpus_len, int iterations, Bench_Stream_Peak *peak)
+{
+    double best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        *peak = (Bench_Stream_Peak) {0};
+        Bench_Reader reader = { corpus, corpus_len, 0 };
+        double start = bench_now_seconds();
+        Parser parser;
+        parser_init_stream(&parser, bench_read, &reader);
+        parser_parse_each(&parser, bench_stream_statement, peak);
+        double elapsed = bench_now_seconds() - start;
+        parser_free(&parser);
+
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    return best;
+}
+
+static void bench_report_parse(const char *variant, const Token_Buffer *tokens, const Program *program, double seconds)
+{
+    printf("%-20s [%-6s] %10.2f MB/s %12.0f tokens/s %10.2f MB of nodes\n",
+        "parser_parse_program",
+        variant,
+        (double) tokens->input_len / seconds / 1e6,
+        (double) tokens->len / seconds,
+        (double) program->arena.used / 1e6);
+}
+
+void bench_parser(const char *corpus, size_t corpus_len, int iterations)
+{
+    Token_Buffer tokens = {0};
+    Lexer lexer;
+    lexer_init_n(&lexer, corpus, corpus_len);
+    lexer_tokenize_all(&lexer, &tokens);
+
+    // NOTE(HS): lazy parsing skips function bodies, see `Parser.lazy_function_bodies`
+    Program program = {0};
+    double best = bench_parse(&tokens, iterations, true, 1, &program);
+    bench_report_parse("lazy", &tokens, &program, best);
+
+    size_t threads = thread_hardware_count();
+    if (threads > 1)
+    {
+        char variant[32];
+        snprintf(variant, sizeof(variant), "par %zu", threads);
+        best = bench_parse(&tokens, iterations, false, threads, &program);
+        bench_report_parse(variant, &tokens, &program, best);
+    }
+
+    // NOTE(HS): the memory of a streamed parse is the largest statement's, it is
+    // timed with lexing as the tokens are lexed as they're reached
+    Bench_Stream_Peak peak = {0};
+    best = bench_parse_each(corpus, corpus_len, iterations, &peak);
+    printf("%-20s [%-6s] %10.2f MB/s %12.0f tokens/s %10.2f KB of nodes, %zu tokens at most\n",
+        "parser_parse_each",
+        "stream",
+        (double) corpus_len / best / 1e6,
+        (double) tokens.len / best,
+        (double) peak.nodes / 1e3,
+        peak.tokens);
+
+    // parse, keeping the program of the last run for the AST benchmarks
+    best = bench_parse(&tokens, iterations, false, 1, &program);
+    bench_report_parse("arena", &tokens, &program, best);
+
+    Flat_Ast flat = {0};
+    flat_ast_from_program(&flat, &program);
+
+    // warm start, from a cache of the program, used in place or inflated
+    const char *cache_path = "tyger_bench" AST_CACHE_EXTENSION;
+    if (ast_cache_write(cache_path, &flat, corpus, corpus_len))
+    {
+        for (int inflate = 0; inflate < 2; ++inflate)
+        {
+            best = 0.0;
+            for (int i = 0; i < iterations; ++i)
+            {
+                double start = bench_now_seconds();
+                Ast_Cache cache;
+                bool hit = ast_cache_open(&cache, cache_path, corpus, corpus_len);
+                if (hit && inflate)
+                {
+                    Program inflated = flat_ast_to_program(&cache.ast);
+                    program_free(&inflated);
+                }
+                if (hit)
+                {
+                    ast_cache_close(&cache);
+                }
+                double elapsed = bench_now_seconds() - start;
+                if (i == 0 || elapsed < best) { best = elapsed; }
+            }
+            printf("%-20s [%-6s] %10.2f MB/s %12.0f tokens/s\n",
+                "ast_cache_open",
+                inflate ? "ptr" : "flat",
+                (double) corpus_len / best / 1e6,
+                (double) tokens.len / best);
+        }
+        remove(cache_path);
+    }
+
+    // memory
+    Bench_Ast_Stats pointer_stats = bench_walk_program(&program);
+    size_t pointer_bytes = program.arena.used + program.statements.len * sizeof(Statement);
+    printf("%-20s [%-6s] %10.2f bytes/node (Statement %zu, Expression %zu bytes)\n",
+        "ast_size", "ptr",
+        (double) pointer_bytes / (double) pointer_stats.nodes,
+        sizeof(Statement),
+        sizeof(Expression));
+    printf("%-20s [%-6s] %10.2f bytes/node\n",
+        "ast_size", "flat",
+        (double) flat_ast_size_bytes(&flat) / (double) (flat.len - 1));
+
+    // traversal
+    Bench_Ast_Stats stats = {0};
+    best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        double start = bench_now_seconds();
+        stats = bench_walk_program(&program);
+        double elapsed = bench_now_seconds() - start;
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    bench_report_walk("ptr", stats, best);
+
+    best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        double start = bench_now_seconds();
+        stats = bench_walk_flat(&flat);
+        double elapsed = bench_now_seconds() - start;
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    bench_report_walk("visit", stats, best);
+
+    best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        double start = bench_now_seconds();
+        stats = bench_recurse_flat(&flat);
+        double elapsed = bench_now_seconds() - start;
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    bench_report_walk("recur", stats, best);
+
+    best = 0.0;
+    for (int i = 0; i < iterations; ++i)
+    {
+        double start = bench_now_seconds();
+        stats = bench_scan_flat(&flat);
+        double elapsed = bench_now_seconds() - start;
+        if (i == 0 || elapsed < best) { best = elapsed; }
+    }
+    bench_report_walk("scan", stats, best);
+
+    flat_ast_free(&flat);
+    program_free(&program);
+    token_buffer_free(&tokens);
+    lexer_free(&lexer);
+}
@@ -0,0 +1,10 @@
+/**
+ * Benchmarks of the parser and the AST representations, run on the parser mix.
+*/
+#ifndef TYGER_BENCH_PARSER_H_
+#define TYGER_BENCH_PARSER_H_
+#include <stddef.h>
+
+void bench_parser(const char *corpus, size_t corpus_len, int iterations);
+
+#endif // TYGER_BENCH_PARSER_H_
@@ -0,0 +1,28 @@
+/**
+ * Monotonic wall-clock timer for the benchmarks.
+*/
+#ifndef TYGER_BENCH_TIMER_H_
+#define TYGER_BENCH_TIMER_H_
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static inline double bench_now_seconds(void)
+{
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double) now.QuadPart / (double) freq.QuadPart;
+}
+#else
+#include <time.h>
+
+static inline double bench_now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec * 1e-9;
+}
+#endif
+
+#endif // TYGER_BENCH_TIMER_H_
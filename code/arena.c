@@ -0,0 +1,140 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+
+/// Stands in for C11's `max_align_t`.
+typedef union
+{
+    long double ld;
+    long long ll;
+    void *ptr;
+    void (*fn)(void);
+} Arena_Max_Align;
+
+struct arena_block_s
+{
+    Arena_Block *next;
+    size_t capacity;
+    size_t used;
+    // NOTE(HS): block data follows the header, which keeps it max aligned
+    Arena_Max_Align data[];
+};
+
+static Arena_Block *arena_block_new(size_t capacity, Arena_Block *next)
+{
+    Arena_Block *block = malloc(sizeof(Arena_Block) + capacity);
+    assert(block && "Failed to allocate arena block");
+    block->next = next;
+    block->capacity = capacity;
+    block->used = 0;
+    return block;
+}
+
+void *arena_alloc(Arena *arena, size_t size, size_t align)
+{
+    assert(arena);
+    assert(align > 0 && (align & (align - 1)) == 0 && "Alignment must be a power of 2");
+
+    Arena_Block *block = arena->head;
+    size_t offset = 0;
+    if (block)
+    {
+        offset = (block->used + (align - 1)) & ~(align - 1);
+    }
+
+    if (!block || offset + size > block->capacity)
+    {
+        // NOTE(HS): oversized allocations get a block of their own, linked behind the
+        // current block so the rest of it can still be used
+        size_t worst_case = size + align;
+        if (block && worst_case > ARENA_DEFAULT_BLOCK_SIZE)
+        {
+            Arena_Block *big = arena_block_new(worst_case, block->next);
+            block->next = big;
+            block = big;
+        }
+        else
+        {
+            size_t capacity = worst_case > ARENA_DEFAULT_BLOCK_SIZE ? worst_case : ARENA_DEFAULT_BLOCK_SIZE;
+            block = arena_block_new(capacity, arena->head);
+            arena->head = block;
+        }
+        offset = 0;
+    }
+
+    char *base = (char*) block->data;
+    uintptr_t addr = ((uintptr_t) (base + offset) + (align - 1)) & ~((uintptr_t) align - 1);
+    offset = (size_t) ((char*) addr - base);
+
+    block->used = offset + size;
+    arena->used += size;
+    return (void*) addr;
+}
+
+char *arena_strndup(Arena *arena, const char *str, size_t len)
+{
+    char *copy = arena_alloc(arena, len + 1, 1);
+    if (len > 0)
+    {
+        memcpy(copy, str, len);
+    }
+    copy[len] = '\0';
+    return copy;
+}
+
+void arena_reset(Arena *arena)
+{
+    assert(arena);
+    if (!arena->head)
+    {
+        return;
+    }
+
+    Arena_Block *block = arena->head->next;
+    while (block)
+    {
+        Arena_Block *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head->next = NULL;
+    arena->head->used = 0;
+    arena->used = 0;
+}
+
+void arena_adopt(Arena *dst, Arena *src)
+{
+    assert(dst && src);
+    if (!src->head)
+    {
+        return;
+    }
+
+    // NOTE(HS): src's current block becomes dst's, so the rest of it gets used
+    Arena_Block *tail = src->head;
+    while (tail->next)
+    {
+        tail = tail->next;
+    }
+    tail->next = dst->head;
+    dst->head = src->head;
+    dst->used += src->used;
+    *src = (Arena) {0};
+}
+
+void arena_free(Arena *arena)
+{
+    assert(arena);
+
+    Arena_Block *block = arena->head;
+    while (block)
+    {
+        Arena_Block *next = block->next;
+        free(block);
+        block = next;
+    }
+    *arena = (Arena) {0};
+}
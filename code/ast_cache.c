@@ -0,0 +1,648 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast_cache.h"
+#include "containers.h"
+#include "parser_internal.h"
+#include "symbol.h"
+
+/// Written natively, so a cache written on a host of the other byte order reads
+/// back as something else and is rejected.
+#define AST_CACHE_BYTE_ORDER 0x01020304u
+
+static const char ast_cache_magic[4] = { 'T', 'Y', 'A', 'C' };
+
+/// Start of every cache file, followed by the sections, unpadded, in this order:
+///   payloads          uint32_t[node_count]
+///   vars              Flat_Var[var_count]
+///   prefixes          Flat_Prefix[prefix_count]
+///   infixes           Flat_Infix[infix_count]
+///   ifs               Flat_If[if_count]
+///   functions         Flat_Function[function_count]
+///   blocks            Flat_Block[block_count]
+///   block_statements  Flat_Node[block_statement_count]
+///   parameters        Symbol[parameter_count]
+///   string offsets    uint32_t[string_count + 1]
+///   kinds             uint8_t[node_count]
+///   string bytes      char[string_bytes]
+/// Everything up to the kinds is made of 32-bit words, so every section is
+/// aligned without padding.
+///
+/// Symbols in the payloads of idents, vars and parameters are indices into the
+/// string table plus one, leaving 0 as `SYMBOL_NONE`. Each string is NUL
+/// terminated, the offsets giving where each one starts and where the last ends.
+typedef struct
+{
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t reserved;
+    uint64_t source_hash;
+    uint64_t source_len;
+
+    uint32_t node_count;
+    uint32_t root;
+    uint32_t var_count;
+    uint32_t prefix_count;
+    uint32_t infix_count;
+    uint32_t if_count;
+    uint32_t function_count;
+    uint32_t block_count;
+    uint32_t block_statement_count;
+    uint32_t parameter_count;
+    uint32_t string_count;
+    uint32_t string_bytes;
+} Ast_Cache_Header;
+
+// NOTE(HS): the layout is written as is, so must not depend on the compiler's padding
+typedef char ast_cache_header_is_packed[sizeof(Ast_Cache_Header) == 80 ? 1 : -1];
+typedef char flat_var_is_two_words[sizeof(Flat_Var) == 8 ? 1 : -1];
+
+uint64_t ast_cache_hash(const char *source, size_t source_len)
+{
+    // NOTE(HS): 8 bytes a step, like `string_view_hash` but keeping all 64 bits,
+    // and finished with a full avalanche so small edits change the whole hash
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    uint64_t h = (uint64_t) source_len * k;
+
+    const char *p = source;
+    size_t len = source_len;
+    while (len >= 8)
+    {
+        uint64_t word;
+        memcpy(&word, p, 8);
+        h = (h ^ word) * k;
+        h ^= h >> 32;
+        p += 8;
+        len -= 8;
+    }
+    if (len > 0)
+    {
+        uint64_t word = 0;
+        memcpy(&word, p, len);
+        h = (h ^ word) * k;
+    }
+
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDull;
+    h ^= h >> 33;
+    h *= 0xC4CEB9FE1A85EC53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+char *ast_cache_path(const char *script_path)
+{
+    assert(script_path);
+    size_t len = strlen(script_path);
+    size_t ext_len = sizeof(AST_CACHE_EXTENSION) - 1;
+
+    char *path = malloc(len + ext_len + 1);
+    assert(path && "Failed to allocate cache path");
+    memcpy(path, script_path, len);
+    memcpy(&path[len], AST_CACHE_EXTENSION, ext_len + 1);
+    return path;
+}
+
+/// Initial number of slots of `Ast_Cache_Strings.slots`, must be a power of 2.
+#define AST_CACHE_STRINGS_INITIAL_SLOTS 64
+
+/// A symbol's local id, empty slots have no symbol.
+typedef struct
+{
+    Symbol symbol;
+    uint32_t local_id;
+} Ast_Cache_Strings_Slot;
+
+/// Symbols of the AST being written, numbered in order of first use.
+///
+/// NOTE(HS): a script uses a few of the symbols of the process, so they're
+/// numbered through a hash map sized by the script rather than a table indexed by
+/// every symbol
+typedef struct
+{
+    /// open addressed (linear probing) local ids, kept at most half full
+    Ast_Cache_Strings_Slot *slots;
+    size_t slot_count;
+    /// the symbol of each local id, less one
+    Flat_Symbol_Pool symbols;
+    uint32_t string_bytes;
+} Ast_Cache_Strings;
+
+static inline size_t cache_strings_slot_of(Symbol symbol, size_t slot_count)
+{
+    // NOTE(HS): symbols are dense, so spread them over the slots (Fibonacci hashing)
+    return (size_t) (symbol * 2654435769u) & (slot_count - 1);
+}
+
+static void cache_strings_grow(Ast_Cache_Strings *strings)
+{
+    size_t slot_count = strings->slot_count * 2;
+    Ast_Cache_Strings_Slot *slots = calloc(slot_count, sizeof(Ast_Cache_Strings_Slot));
+    assert(slots && "Failed to allocate cache symbol ids");
+
+    for (size_t i = 0; i < strings->slot_count; ++i)
+    {
+        Ast_Cache_Strings_Slot old = strings->slots[i];
+        if (old.symbol == SYMBOL_NONE)
+        {
+            continue;
+        }
+
+        size_t slot = cache_strings_slot_of(old.symbol, slot_count);
+        while (slots[slot].symbol != SYMBOL_NONE)
+        {
+            slot = (slot + 1) & (slot_count - 1);
+        }
+        slots[slot] = old;
+    }
+
+    free(strings->slots);
+    strings->slots = slots;
+    strings->slot_count = slot_count;
+}
+
+static uint32_t cache_strings_local_id(Ast_Cache_Strings *strings, Symbol symbol)
+{
+    if (symbol == SYMBOL_NONE)
+    {
+        return 0;
+    }
+
+    size_t mask = strings->slot_count - 1;
+    size_t slot = cache_strings_slot_of(symbol, strings->slot_count);
+    for (; strings->slots[slot].symbol != SYMBOL_NONE; slot = (slot + 1) & mask)
+    {
+        if (strings->slots[slot].symbol == symbol)
+        {
+            return strings->slots[slot].local_id;
+        }
+    }
+
+    da_append(Symbol, &strings->symbols, &symbol);
+    uint32_t local_id = (uint32_t) strings->symbols.len;
+    strings->slots[slot] = (Ast_Cache_Strings_Slot) { symbol, local_id };
+    strings->string_bytes += (uint32_t) symbol_to_string_view(symbol).length + 1;
+
+    if (strings->symbols.len * 2 > strings->slot_count)
+    {
+        cache_strings_grow(strings);
+    }
+    return local_id;
+}
+
+static bool cache_write_section(FILE *file, const void *data, size_t size)
+{
+    return size == 0 || fwrite(data, 1, size, file) == size;
+}
+
+bool ast_cache_write(const char *path, const Flat_Ast *ast, const char *source, size_t source_len)
+{
+    assert(path);
+    assert(ast);
+    assert(ast->len > 0 && "Flat AST has not been built");
+
+    Ast_Cache_Strings strings = {
+        .slots = calloc(AST_CACHE_STRINGS_INITIAL_SLOTS, sizeof(Ast_Cache_Strings_Slot)),
+        .slot_count = AST_CACHE_STRINGS_INITIAL_SLOTS,
+        .string_bytes = 0,
+    };
+    assert(strings.slots && "Failed to allocate cache symbol ids");
+    da_init(Symbol, &strings.symbols);
+
+    // NOTE(HS): symbols are swapped for local ids in copies of the arrays holding them
+    uint32_t *payloads = malloc(sizeof(uint32_t) * ast->len);
+    Flat_Var *vars = malloc(sizeof(Flat_Var) * (ast->vars.len > 0 ? ast->vars.len : 1));
+    Symbol *parameters = malloc(sizeof(Symbol) * (ast->parameters.len > 0 ? ast->parameters.len : 1));
+    assert(payloads && vars && parameters && "Failed to allocate cache symbol arrays");
+
+    for (size_t i = 0; i < ast->len; ++i)
+    {
+        payloads[i] = ast->payloads[i];
+        if (ast->kinds[i] == FLAT_IDENT_EXPRESSION)
+        {
+            payloads[i] = cache_strings_local_id(&strings, ast->payloads[i]);
+        }
+    }
+    for (size_t i = 0; i < ast->vars.len; ++i)
+    {
+        vars[i] = ast->vars.elements[i];
+        vars[i].symbol = cache_strings_local_id(&strings, vars[i].symbol);
+    }
+    for (size_t i = 0; i < ast->parameters.len; ++i)
+    {
+        parameters[i] = cache_strings_local_id(&strings, ast->parameters.elements[i]);
+    }
+
+    uint32_t string_count = (uint32_t) strings.symbols.len;
+    uint32_t *string_offsets = malloc(sizeof(uint32_t) * (string_count + 1));
+    char *string_bytes = malloc(strings.string_bytes > 0 ? strings.string_bytes : 1);
+    assert(string_offsets && string_bytes && "Failed to allocate cache string table");
+
+    uint32_t offset = 0;
+    for (uint32_t i = 0; i < string_count; ++i)
+    {
+        // NOTE(HS): the views point at the table's NUL terminated copies
+        String_View name = symbol_to_string_view(strings.symbols.elements[i]);
+        string_offsets[i] = offset;
+        memcpy(&string_bytes[offset], name.str, name.length + 1);
+        offset += (uint32_t) name.length + 1;
+    }
+    string_offsets[string_count] = offset;
+
+    Ast_Cache_Header header = {
+        .version = AST_CACHE_VERSION,
+        .byte_order = AST_CACHE_BYTE_ORDER,
+        .reserved = 0,
+        .source_hash = ast_cache_hash(source, source_len),
+        .source_len = source_len,
+        .node_count = (uint32_t) ast->len,
+        .root = ast->root,
+        .var_count = (uint32_t) ast->vars.len,
+        .prefix_count = (uint32_t) ast->prefixes.len,
+        .infix_count = (uint32_t) ast->infixes.len,
+        .if_count = (uint32_t) ast->ifs.len,
+        .function_count = (uint32_t) ast->functions.len,
+        .block_count = (uint32_t) ast->blocks.len,
+        .block_statement_count = (uint32_t) ast->block_statements.len,
+        .parameter_count = (uint32_t) ast->parameters.len,
+        .string_count = string_count,
+        .string_bytes = strings.string_bytes,
+    };
+    memcpy(header.magic, ast_cache_magic, sizeof(header.magic));
+
+    // NOTE(HS): written aside and renamed over the old cache, so a reader sees
+    // either the old file or the complete new one
+    size_t path_len = strlen(path);
+    char *tmp_path = malloc(path_len + sizeof(".tmp"));
+    assert(tmp_path && "Failed to allocate cache path");
+    memcpy(tmp_path, path, path_len);
+    memcpy(&tmp_path[path_len], ".tmp", sizeof(".tmp"));
+
+    bool ok = false;
+    FILE *file = fopen(tmp_path, "wb");
+    if (file)
+    {
+        ok = cache_write_section(file, &header, sizeof(header))
+            && cache_write_section(file, payloads, sizeof(uint32_t) * ast->len)
+            && cache_write_section(file, vars, sizeof(Flat_Var) * ast->vars.len)
+            && cache_write_section(file, ast->prefixes.elements, sizeof(Flat_Prefix) * ast->prefixes.len)
+            && cache_write_section(file, ast->infixes.elements, sizeof(Flat_Infix) * ast->infixes.len)
+            && cache_write_section(file, ast->ifs.elements, sizeof(Flat_If) * ast->ifs.len)
+            && cache_write_section(file, ast->functions.elements, sizeof(Flat_Function) * ast->functions.len)
+            && cache_write_section(file, ast->blocks.elements, sizeof(Flat_Block) * ast->blocks.len)
+            && cache_write_section(file, ast->block_statements.elements, sizeof(Flat_Node) * ast->block_statements.len)
+            && cache_write_section(file, parameters, sizeof(Symbol) * ast->parameters.len)
+            && cache_write_section(file, string_offsets, sizeof(uint32_t) * (string_count + 1))
+            && cache_write_section(file, ast->kinds, sizeof(uint8_t) * ast->len)
+            && cache_write_section(file, string_bytes, strings.string_bytes);
+        ok = fclose(file) == 0 && ok;
+
+#if defined(_WIN32)
+        // NOTE(HS): rename won't replace an existing file on windows
+        if (ok)
+        {
+            remove(path);
+        }
+#endif
+        ok = ok && rename(tmp_path, path) == 0;
+        if (!ok)
+        {
+            remove(tmp_path);
+        }
+    }
+
+    free(tmp_path);
+    free(string_bytes);
+    free(string_offsets);
+    free(parameters);
+    free(vars);
+    free(payloads);
+    da_free(&strings.symbols);
+    free(strings.slots);
+    return ok;
+}
+
+/// Cursor over the sections of a cache file.
+typedef struct
+{
+    const char *data;
+    size_t offset;
+} Ast_Cache_Reader;
+
+static const void *cache_read_section(Ast_Cache_Reader *reader, size_t size)
+{
+    const void *section = &reader->data[reader->offset];
+    reader->offset += size;
+    return section;
+}
+
+static bool flat_kind_is_statement(uint8_t kind)
+{
+    return kind == FLAT_ILLEGAL_STATEMENT
+        || kind == FLAT_VAR_STATEMENT
+        || kind == FLAT_RETURN_STATEMENT
+        || kind == FLAT_EXPRESSION_STATEMENT;
+}
+
+static bool flat_kind_is_expression(uint8_t kind)
+{
+    return kind >= FLAT_IDENT_EXPRESSION && kind < FLAT_NODE_KIND_COUNT;
+}
+
+/// Whether `child` of `node` is one of its descendants, which are numbered after
+/// it in pre-order. This is also what rules out cycles in a corrupt file.
+static bool flat_child_is_valid(const Flat_Ast *ast, uint32_t node, uint32_t child, bool (*kind_is_valid)(uint8_t))
+{
+    return child > node && child < ast->len && kind_is_valid(ast->kinds[child]);
+}
+
+static bool flat_kind_is_block(uint8_t kind)
+{
+    return kind == FLAT_BLOCK;
+}
+
+static bool flat_block_is_valid(const Flat_Ast *ast, uint32_t node, uint32_t child, bool optional)
+{
+    return (optional && child == FLAT_NODE_NONE) || flat_child_is_valid(ast, node, child, flat_kind_is_block);
+}
+
+/// Checks every index in the cached AST is in range, and every node has children
+/// of the kinds `flat_ast_to_program` expects, so a corrupt cache is rejected
+/// rather than crashing whatever reads it. Symbols are still local ids here.
+static bool cache_ast_is_valid(const Flat_Ast *ast, uint32_t string_count)
+{
+    if (ast->len == 0 || ast->kinds[0] != FLAT_NONE
+        || ast->root >= ast->len || ast->kinds[ast->root] != FLAT_BLOCK)
+    {
+        return false;
+    }
+
+    for (uint32_t node = 1; node < ast->len; ++node)
+    {
+        uint32_t payload = ast->payloads[node];
+        bool ok = false;
+        switch ((Flat_Node_Kind) ast->kinds[node])
+        {
+            case FLAT_BLOCK:
+            {
+                ok = payload < ast->blocks.len;
+                if (ok)
+                {
+                    const Flat_Block *block = &ast->blocks.elements[payload];
+                    ok = block->first <= ast->block_statements.len
+                        && block->len <= ast->block_statements.len - block->first;
+                    for (uint32_t i = 0; ok && i < block->len; ++i)
+                    {
+                        Flat_Node stmt = ast->block_statements.elements[block->first + i];
+                        ok = flat_child_is_valid(ast, node, stmt, flat_kind_is_statement);
+                    }
+                }
+            } break;
+
+            case FLAT_ILLEGAL_STATEMENT:
+            case FLAT_INT_EXPRESSION:
+            case FLAT_FLOAT_EXPRESSION:
+            case FLAT_BOOLEAN_EXPRESSION:
+            {
+                ok = true;
+            } break;
+
+            case FLAT_VAR_STATEMENT:
+            {
+                ok = payload < ast->vars.len
+                    && ast->vars.elements[payload].symbol <= string_count
+                    && flat_child_is_valid(ast, node, ast->vars.elements[payload].value, flat_kind_is_expression);
+            } break;
+
+            case FLAT_RETURN_STATEMENT:
+            case FLAT_EXPRESSION_STATEMENT:
+            {
+                ok = flat_child_is_valid(ast, node, payload, flat_kind_is_expression);
+            } break;
+
+            case FLAT_IDENT_EXPRESSION:
+            {
+                ok = payload <= string_count;
+            } break;
+
+            case FLAT_PREFIX_EXPRESSION:
+            {
+                ok = payload < ast->prefixes.len
+                    && (ast->prefixes.elements[payload].op == '-' || ast->prefixes.elements[payload].op == '!')
+                    && flat_child_is_valid(ast, node, ast->prefixes.elements[payload].rhs, flat_kind_is_expression);
+            } break;
+
+            case FLAT_INFIX_EXPRESSION:
+            {
+                // NOTE(HS): the operator is printed by token kind, so it has to be one
+                ok = payload < ast->infixes.len
+                    && ast->infixes.elements[payload].op < TOKEN_KIND_COUNT
+                    && precidence_of((Token_Kind) ast->infixes.elements[payload].op) != LOWEST
+                    && flat_child_is_valid(ast, node, ast->infixes.elements[payload].lhs, flat_kind_is_expression)
+                    && flat_child_is_valid(ast, node, ast->infixes.elements[payload].rhs, flat_kind_is_expression);
+            } break;
+
+            case FLAT_IF_EXPRESSION:
+            {
+                ok = payload < ast->ifs.len
+                    && flat_child_is_valid(ast, node, ast->ifs.elements[payload].condition, flat_kind_is_expression)
+                    && flat_block_is_valid(ast, node, ast->ifs.elements[payload].consequence, false)
+                    && flat_block_is_valid(ast, node, ast->ifs.elements[payload].alternative, true);
+            } break;
+
+            case FLAT_FUNCTION_EXPRESSION:
+            {
+                ok = payload < ast->functions.len;
+                if (ok)
+                {
+                    const Flat_Function *func = &ast->functions.elements[payload];
+                    ok = func->first_parameter <= ast->parameters.len
+                        && func->parameter_count <= ast->parameters.len - func->first_parameter
+                        && flat_block_is_valid(ast, node, func->body, true);
+                }
+            } break;
+
+            case FLAT_NONE:
+            case FLAT_NODE_KIND_COUNT:
+            default:
+            {
+                ok = false;
+            } break;
+        }
+
+        if (!ok)
+        {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < ast->parameters.len; ++i)
+    {
+        if (ast->parameters.elements[i] > string_count)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Interns the cache's strings, returning the symbol of each local id (with 0
+/// mapping to `SYMBOL_NONE`), or NULL if the string table is malformed.
+static Symbol *cache_intern_strings(const uint32_t *offsets, const char *bytes, uint32_t count, uint32_t byte_count)
+{
+    if (offsets[0] != 0 || offsets[count] != byte_count)
+    {
+        return NULL;
+    }
+
+    Symbol *symbols = malloc(sizeof(Symbol) * (count + 1));
+    assert(symbols && "Failed to allocate cache symbols");
+    symbols[0] = SYMBOL_NONE;
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t start = offsets[i];
+        uint32_t end = offsets[i + 1];
+        if (end <= start || end > byte_count || bytes[end - 1] != '\0')
+        {
+            free(symbols);
+            return NULL;
+        }
+        symbols[i + 1] = symbol_intern((String_View) { (char *) &bytes[start], end - start - 1 });
+    }
+    return symbols;
+}
+
+bool ast_cache_open(Ast_Cache *cache, const char *path, const char *source, size_t source_len)
+{
+    assert(cache);
+    assert(path);
+
+    *cache = (Ast_Cache) {0};
+    if (!source_load(&cache->file, path))
+    {
+        return false;
+    }
+
+    const char *data = cache->file.data;
+    Ast_Cache_Header header;
+    if (cache->file.len < sizeof(header) || ((uintptr_t) data % sizeof(uint32_t)) != 0)
+    {
+        ast_cache_close(cache);
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    // NOTE(HS): the size is checked before the hash, which reads the whole source
+    if (memcmp(header.magic, ast_cache_magic, sizeof(header.magic)) != 0
+        || header.version != AST_CACHE_VERSION
+        || header.byte_order != AST_CACHE_BYTE_ORDER
+        || header.source_len != source_len
+        || header.source_hash != ast_cache_hash(source, source_len))
+    {
+        ast_cache_close(cache);
+        return false;
+    }
+
+    uint64_t expected_len = sizeof(header)
+        + (uint64_t) header.node_count * (sizeof(uint32_t) + sizeof(uint8_t))
+        + (uint64_t) header.var_count * sizeof(Flat_Var)
+        + (uint64_t) header.prefix_count * sizeof(Flat_Prefix)
+        + (uint64_t) header.infix_count * sizeof(Flat_Infix)
+        + (uint64_t) header.if_count * sizeof(Flat_If)
+        + (uint64_t) header.function_count * sizeof(Flat_Function)
+        + (uint64_t) header.block_count * sizeof(Flat_Block)
+        + (uint64_t) header.block_statement_count * sizeof(Flat_Node)
+        + (uint64_t) header.parameter_count * sizeof(Symbol)
+        + ((uint64_t) header.string_count + 1) * sizeof(uint32_t)
+        + (uint64_t) header.string_bytes;
+    if (expected_len != cache->file.len)
+    {
+        ast_cache_close(cache);
+        return false;
+    }
+
+    Ast_Cache_Reader reader = { data, sizeof(header) };
+    Flat_Ast *ast = &cache->ast;
+    ast->len = header.node_count;
+    ast->capacity = header.node_count;
+    ast->root = header.root;
+
+    // NOTE(HS): the arrays holding symbols are copied to be remapped, the rest
+    // are used where they are in the mapping
+    const uint32_t *payloads = cache_read_section(&reader, sizeof(uint32_t) * header.node_count);
+    const Flat_Var *vars = cache_read_section(&reader, sizeof(Flat_Var) * header.var_count);
+
+    ast->prefixes.len = ast->prefixes.capacity = header.prefix_count;
+    ast->prefixes.elements = (Flat_Prefix *) cache_read_section(&reader, sizeof(Flat_Prefix) * header.prefix_count);
+    ast->infixes.len = ast->infixes.capacity = header.infix_count;
+    ast->infixes.elements = (Flat_Infix *) cache_read_section(&reader, sizeof(Flat_Infix) * header.infix_count);
+    ast->ifs.len = ast->ifs.capacity = header.if_count;
+    ast->ifs.elements = (Flat_If *) cache_read_section(&reader, sizeof(Flat_If) * header.if_count);
+    ast->functions.len = ast->functions.capacity = header.function_count;
+    ast->functions.elements = (Flat_Function *) cache_read_section(&reader, sizeof(Flat_Function) * header.function_count);
+    ast->blocks.len = ast->blocks.capacity = header.block_count;
+    ast->blocks.elements = (Flat_Block *) cache_read_section(&reader, sizeof(Flat_Block) * header.block_count);
+    ast->block_statements.len = ast->block_statements.capacity = header.block_statement_count;
+    ast->block_statements.elements = (Flat_Node *) cache_read_section(&reader, sizeof(Flat_Node) * header.block_statement_count);
+
+    const Symbol *parameters = cache_read_section(&reader, sizeof(Symbol) * header.parameter_count);
+    const uint32_t *string_offsets = cache_read_section(&reader, sizeof(uint32_t) * (header.string_count + 1));
+    ast->kinds = (uint8_t *) cache_read_section(&reader, sizeof(uint8_t) * header.node_count);
+    const char *string_bytes = cache_read_section(&reader, header.string_bytes);
+    assert(reader.offset == cache->file.len);
+
+    ast->payloads = malloc(sizeof(uint32_t) * (header.node_count > 0 ? header.node_count : 1));
+    ast->vars = (Flat_Var_Pool) {
+        header.var_count, header.var_count,
+        malloc(sizeof(Flat_Var) * (header.var_count > 0 ? header.var_count : 1)),
+    };
+    ast->parameters = (Flat_Symbol_Pool) {
+        header.parameter_count, header.parameter_count,
+        malloc(sizeof(Symbol) * (header.parameter_count > 0 ? header.parameter_count : 1)),
+    };
+    assert(ast->payloads && ast->vars.elements && ast->parameters.elements && "Failed to allocate cached AST");
+    memcpy(ast->payloads, payloads, sizeof(uint32_t) * header.node_count);
+    memcpy(ast->vars.elements, vars, sizeof(Flat_Var) * header.var_count);
+    memcpy(ast->parameters.elements, parameters, sizeof(Symbol) * header.parameter_count);
+
+    Symbol *symbols = NULL;
+    if (!cache_ast_is_valid(ast, header.string_count)
+        || !(symbols = cache_intern_strings(string_offsets, string_bytes, header.string_count, header.string_bytes)))
+    {
+        ast_cache_close(cache);
+        return false;
+    }
+
+    for (size_t i = 0; i < ast->len; ++i)
+    {
+        if (ast->kinds[i] == FLAT_IDENT_EXPRESSION)
+        {
+            ast->payloads[i] = symbols[ast->payloads[i]];
+        }
+    }
+    for (size_t i = 0; i < ast->vars.len; ++i)
+    {
+        ast->vars.elements[i].symbol = symbols[ast->vars.elements[i].symbol];
+    }
+    for (size_t i = 0; i < ast->parameters.len; ++i)
+    {
+        ast->parameters.elements[i] = symbols[ast->parameters.elements[i]];
+    }
+    free(symbols);
+
+    return true;
+}
+
+void ast_cache_close(Ast_Cache *cache)
+{
+    assert(cache);
+    free(cache->ast.payloads);
+    free(cache->ast.vars.elements);
+    free(cache->ast.parameters.elements);
+    source_free(&cache->file);
+    *cache = (Ast_Cache) {0};
+}
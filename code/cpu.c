@@ -0,0 +1,88 @@
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "cpu.h"
+
+#if defined(TYGER_CPU_X86_64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+
+static void cpu_cpuid(uint32_t leaf, uint32_t subleaf, uint32_t regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, (int) leaf, (int) subleaf);
+    for (int i = 0; i < 4; ++i) { regs[i] = (uint32_t) r[i]; }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static uint64_t cpu_xgetbv(uint32_t xcr)
+{
+#if defined(_MSC_VER)
+    return _xgetbv(xcr);
+#else
+    // NOTE(HS): inline asm rather than `_xgetbv` so the file doesn't need -mxsave
+    uint32_t eax, edx;
+    __asm__ volatile ("xgetbv" : "=a" (eax), "=d" (edx) : "c" (xcr));
+    return ((uint64_t) edx << 32) | eax;
+#endif
+}
+#endif // TYGER_CPU_X86_64
+
+Cpu_Isa cpu_detect_isa(void)
+{
+#if defined(TYGER_CPU_X86_64)
+    Cpu_Isa isa = CPU_ISA_SSE2;
+    uint32_t regs[4];
+
+    cpu_cpuid(0, 0, regs);
+    uint32_t max_leaf = regs[0];
+    if (max_leaf < 7)
+    {
+        return isa;
+    }
+
+    cpu_cpuid(1, 0, regs);
+    bool has_osxsave = (regs[2] & (1u << 27)) != 0;
+    bool has_avx     = (regs[2] & (1u << 28)) != 0;
+    if (!has_osxsave || !has_avx)
+    {
+        return isa;
+    }
+
+    // XCR0 bits 1 & 2: OS saves XMM and YMM registers
+    if ((cpu_xgetbv(0) & 0x6) != 0x6)
+    {
+        return isa;
+    }
+
+    cpu_cpuid(7, 0, regs);
+    if (regs[1] & (1u << 5))
+    {
+        isa = CPU_ISA_AVX2;
+    }
+
+    return isa;
+#else
+    return CPU_ISA_SCALAR;
+#endif
+}
+
+const char *cpu_isa_to_string(Cpu_Isa isa)
+{
+    const char *res;
+    switch (isa)
+    {
+        case CPU_ISA_SCALAR: { res = "scalar"; } break;
+        case CPU_ISA_SSE2:   { res = "sse2"; } break;
+        case CPU_ISA_AVX2:   { res = "avx2"; } break;
+        default:             { res = "unknown"; } break;
+    }
+    return res;
+}
@@ -0,0 +1,660 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers.h"
+#include "flat_ast.h"
+
+const char *flat_node_kind_to_str(Flat_Node_Kind kind)
+{
+    const char *res = NULL;
+    switch (kind)
+    {
+        #define X(NAME) case FLAT_##NAME: { res = #NAME; } break;
+        FLAT_NODE_KIND_LIST
+        #undef X
+
+        case FLAT_NODE_KIND_COUNT:
+        {
+            assert(0 && "Invalid flat node kind");
+        } break;
+    }
+    return res;
+}
+
+// NOTE(HS): node kinds are stored as bytes
+typedef char flat_node_kind_fits_in_byte[FLAT_NODE_KIND_COUNT <= UINT8_MAX ? 1 : -1];
+
+static void flat_ast_reserve(Flat_Ast *ast, size_t capacity)
+{
+    if (capacity <= ast->capacity)
+    {
+        return;
+    }
+
+    uint8_t *kinds = realloc(ast->kinds, sizeof(uint8_t) * capacity);
+    assert(kinds && "Failed to allocate flat AST kinds");
+    uint32_t *payloads = realloc(ast->payloads, sizeof(uint32_t) * capacity);
+    assert(payloads && "Failed to allocate flat AST payloads");
+
+    ast->kinds = kinds;
+    ast->payloads = payloads;
+    ast->capacity = capacity;
+}
+
+/// Appends a node with an empty payload, to be filled in once its children have
+/// been added.
+static Flat_Node flat_ast_push_node(Flat_Ast *ast, Flat_Node_Kind kind)
+{
+    assert(ast->len < UINT32_MAX && "Too many nodes for a flat AST");
+    if (ast->len == ast->capacity)
+    {
+        flat_ast_reserve(ast, ast->capacity > 0 ? ast->capacity * 2 : 64);
+    }
+
+    Flat_Node node = (Flat_Node) ast->len;
+    ast->kinds[node] = (uint8_t) kind;
+    ast->payloads[node] = 0;
+    ast->len += 1;
+    return node;
+}
+
+static Flat_Node flat_from_expression(Flat_Ast *ast, const Expression *expr);
+
+/// NOTE(HS): a block's statements must be contiguous in `block_statements`, so
+/// their slots are reserved before any nested block can claim the ones after
+static Flat_Node flat_from_block(Flat_Ast *ast, const Block_Statement *block);
+
+static Flat_Node flat_from_statement(Flat_Ast *ast, const Statement *stmt)
+{
+    Flat_Node node = FLAT_NODE_NONE;
+    switch (stmt->kind)
+    {
+        case AST_ILLGEAL_STATEMENT:
+        {
+            node = flat_ast_push_node(ast, FLAT_ILLEGAL_STATEMENT);
+            ast->payloads[node] = (uint32_t) stmt->stmt.illegal_statement.token.location.pos;
+        } break;
+
+        case AST_VAR_STATEMENT:
+        {
+            node = flat_ast_push_node(ast, FLAT_VAR_STATEMENT);
+            Flat_Var var = {
+                .symbol = stmt->stmt.var_statement.symbol,
+                .value = flat_from_expression(ast, &stmt->stmt.var_statement.expression),
+            };
+            ast->payloads[node] = (uint32_t) ast->vars.len;
+            da_append(Flat_Var, &ast->vars, &var);
+        } break;
+
+        case AST_RETURN_STATEMENT:
+        {
+            node = flat_ast_push_node(ast, FLAT_RETURN_STATEMENT);
+            Flat_Node value = flat_from_expression(ast, &stmt->stmt.return_statement.expression);
+            ast->payloads[node] = value;
+        } break;
+
+        case AST_EXPRESSION_STATEMENT:
+        {
+            node = flat_ast_push_node(ast, FLAT_EXPRESSION_STATEMENT);
+            Flat_Node value = flat_from_expression(ast, &stmt->stmt.expression_statement.expression);
+            ast->payloads[node] = value;
+        } break;
+    }
+    return node;
+}
+
+static Flat_Node flat_from_block(Flat_Ast *ast, const Block_Statement *block)
+{
+    Flat_Node node = flat_ast_push_node(ast, FLAT_BLOCK);
+
+    Flat_Block flat_block = {
+        .first = (uint32_t) ast->block_statements.len,
+        .len = (uint32_t) block->len,
+    };
+    Flat_Node none = FLAT_NODE_NONE;
+    for (size_t i = 0; i < block->len; ++i)
+    {
+        da_append(Flat_Node, &ast->block_statements, &none);
+    }
+
+    for (size_t i = 0; i < block->len; ++i)
+    {
+        Flat_Node stmt = flat_from_statement(ast, &block->statements[i]);
+        ast->block_statements.elements[flat_block.first + i] = stmt;
+    }
+
+    ast->payloads[node] = (uint32_t) ast->blocks.len;
+    da_append(Flat_Block, &ast->blocks, &flat_block);
+    return node;
+}
+
+static Flat_Node flat_from_expression(Flat_Ast *ast, const Expression *expr)
+{
+    Flat_Node node = FLAT_NODE_NONE;
+    switch (expr->kind)
+    {
+        case AST_IDENT_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_IDENT_EXPRESSION);
+            ast->payloads[node] = expr->expr.ident_expression.symbol;
+        } break;
+
+        case AST_INT_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_INT_EXPRESSION);
+            ast->payloads[node] = (Token_Value) { .i = expr->expr.int_expression.value }.bits;
+        } break;
+
+        case AST_FLOAT_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_FLOAT_EXPRESSION);
+            ast->payloads[node] = (Token_Value) { .f = expr->expr.float_expression.value }.bits;
+        } break;
+
+        case AST_BOOLEAN_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_BOOLEAN_EXPRESSION);
+            ast->payloads[node] = expr->expr.boolean_expression.value ? 1 : 0;
+        } break;
+
+        case AST_PREFIX_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_PREFIX_EXPRESSION);
+            Flat_Prefix prefix = {
+                .op = (uint32_t) (unsigned char) expr->expr.prefix_expression.op,
+                .rhs = flat_from_expression(ast, expr->expr.prefix_expression.rhs),
+            };
+            ast->payloads[node] = (uint32_t) ast->prefixes.len;
+            da_append(Flat_Prefix, &ast->prefixes, &prefix);
+        } break;
+
+        case AST_INFIX_EXPRESSION:
+        {
+            node = flat_ast_push_node(ast, FLAT_INFIX_EXPRESSION);
+            Flat_Infix infix = { .op = (uint32_t) expr->expr.infix_expression.op };
+            infix.lhs = flat_from_expression(ast, expr->expr.infix_expression.lhs);
+            infix.rhs = flat_from_expression(ast, expr->expr.infix_expression.rhs);
+            ast->payloads[node] = (uint32_t) ast->infixes.len;
+            da_append(Flat_Infix, &ast->infixes, &infix);
+        } break;
+
+        case AST_IF_EXPRESSION:
+        {
+            const If_Expression *if_expr = &expr->expr.if_expression;
+            node = flat_ast_push_node(ast, FLAT_IF_EXPRESSION);
+            Flat_If flat_if = { .alternative = FLAT_NODE_NONE };
+            flat_if.condition = flat_from_expression(ast, if_expr->condition);
+            flat_if.consequence = flat_from_block(ast, if_expr->consequence);
+            if (if_expr->alternative)
+            {
+                flat_if.alternative = flat_from_block(ast, if_expr->alternative);
+            }
+            ast->payloads[node] = (uint32_t) ast->ifs.len;
+            da_append(Flat_If, &ast->ifs, &flat_if);
+        } break;
+
+        case AST_FUNCTION_EXPRESSION:
+        {
+            const Function_Expression *func = &expr->expr.function_expression;
+            node = flat_ast_push_node(ast, FLAT_FUNCTION_EXPRESSION);
+            Flat_Function flat_func = {
+                .first_parameter = (uint32_t) ast->parameters.len,
+                .parameter_count = (uint32_t) func->parameters.len,
+                .body = FLAT_NODE_NONE,
+            };
+            for (size_t i = 0; i < func->parameters.len; ++i)
+            {
+                da_append(Symbol, &ast->parameters, &func->parameters.idents[i].symbol);
+            }
+            if (func->body)
+            {
+                flat_func.body = flat_from_block(ast, func->body);
+            }
+            ast->payloads[node] = (uint32_t) ast->functions.len;
+            da_append(Flat_Function, &ast->functions, &flat_func);
+        } break;
+    }
+    return node;
+}
+
+void flat_ast_from_program(Flat_Ast *ast, const Program *prog)
+{
+    assert(ast);
+    assert(prog);
+
+    flat_ast_free(ast);
+    da_init(Flat_Var, &ast->vars);
+    da_init(Flat_Prefix, &ast->prefixes);
+    da_init(Flat_Infix, &ast->infixes);
+    da_init(Flat_If, &ast->ifs);
+    da_init(Flat_Function, &ast->functions);
+    da_init(Flat_Block, &ast->blocks);
+    da_init(Flat_Node, &ast->block_statements);
+    da_init(Symbol, &ast->parameters);
+
+    flat_ast_push_node(ast, FLAT_NONE);
+
+    // NOTE(HS): the top level is converted as a block of its own
+    Block_Statement top_level = {
+        .len = prog->statements.len,
+        .capacity = prog->statements.len,
+        .statements = prog->statements.elements,
+    };
+    ast->root = flat_from_block(ast, &top_level);
+}
+
+void flat_ast_free(Flat_Ast *ast)
+{
+    free(ast->kinds);
+    free(ast->payloads);
+    da_free(&ast->vars);
+    da_free(&ast->prefixes);
+    da_free(&ast->infixes);
+    da_free(&ast->ifs);
+    da_free(&ast->functions);
+    da_free(&ast->blocks);
+    da_free(&ast->block_statements);
+    da_free(&ast->parameters);
+    *ast = (Flat_Ast) {0};
+}
+
+/// State of `flat_ast_to_program`.
+typedef struct
+{
+    const Flat_Ast *ast;
+    Arena *arena;
+} Flat_To_Program;
+
+static void program_from_flat_expression(Flat_To_Program *conv, Flat_Node node, Expression *expr);
+
+static Block_Statement *program_from_flat_block(Flat_To_Program *conv, Flat_Node node);
+
+static void program_from_flat_statement(Flat_To_Program *conv, Flat_Node node, Statement *stmt)
+{
+    const Flat_Ast *ast = conv->ast;
+    uint32_t payload = ast->payloads[node];
+    switch ((Flat_Node_Kind) ast->kinds[node])
+    {
+        case FLAT_ILLEGAL_STATEMENT:
+        {
+            stmt->kind = AST_ILLGEAL_STATEMENT;
+            Token token = { .kind = TK_ILLEGAL };
+            token.location.pos = payload;
+            stmt->stmt.illegal_statement = (Illegal_statement) { token };
+        } break;
+
+        case FLAT_VAR_STATEMENT:
+        {
+            const Flat_Var *var = &ast->vars.elements[payload];
+            stmt->kind = AST_VAR_STATEMENT;
+            stmt->stmt.var_statement.ident = symbol_to_cstr(var->symbol);
+            stmt->stmt.var_statement.symbol = var->symbol;
+            program_from_flat_expression(conv, var->value, &stmt->stmt.var_statement.expression);
+        } break;
+
+        case FLAT_RETURN_STATEMENT:
+        {
+            stmt->kind = AST_RETURN_STATEMENT;
+            program_from_flat_expression(conv, payload, &stmt->stmt.return_statement.expression);
+        } break;
+
+        case FLAT_EXPRESSION_STATEMENT:
+        {
+            stmt->kind = AST_EXPRESSION_STATEMENT;
+            program_from_flat_expression(conv, payload, &stmt->stmt.expression_statement.expression);
+        } break;
+
+        default:
+        {
+            assert(0 && "Flat node is not a statement");
+        } break;
+    }
+}
+
+static Block_Statement *program_from_flat_block(Flat_To_Program *conv, Flat_Node node)
+{
+    const Flat_Ast *ast = conv->ast;
+    assert(ast->kinds[node] == FLAT_BLOCK);
+    const Flat_Block *flat_block = &ast->blocks.elements[ast->payloads[node]];
+
+    Block_Statement *block = arena_new(conv->arena, Block_Statement);
+    block->len = flat_block->len;
+    block->capacity = flat_block->len;
+    block->statements = NULL;
+    if (flat_block->len > 0)
+    {
+        block->statements = arena_new_array(conv->arena, Statement, flat_block->len);
+    }
+
+    for (size_t i = 0; i < flat_block->len; ++i)
+    {
+        Flat_Node stmt = ast->block_statements.elements[flat_block->first + i];
+        program_from_flat_statement(conv, stmt, &block->statements[i]);
+    }
+    return block;
+}
+
+static Expression *program_new_flat_expression(Flat_To_Program *conv, Flat_Node node)
+{
+    Expression *expr = arena_new(conv->arena, Expression);
+    program_from_flat_expression(conv, node, expr);
+    return expr;
+}
+
+static void program_from_flat_expression(Flat_To_Program *conv, Flat_Node node, Expression *expr)
+{
+    const Flat_Ast *ast = conv->ast;
+    uint32_t payload = ast->payloads[node];
+    switch ((Flat_Node_Kind) ast->kinds[node])
+    {
+        case FLAT_IDENT_EXPRESSION:
+        {
+            expr->kind = AST_IDENT_EXPRESSION;
+            expr->expr.ident_expression = (Ident_Expression) { symbol_to_cstr(payload), payload };
+        } break;
+
+        case FLAT_INT_EXPRESSION:
+        {
+            expr->kind = AST_INT_EXPRESSION;
+            expr->expr.int_expression.value = (Token_Value) { .bits = payload }.i;
+        } break;
+
+        case FLAT_FLOAT_EXPRESSION:
+        {
+            expr->kind = AST_FLOAT_EXPRESSION;
+            expr->expr.float_expression.value = (Token_Value) { .bits = payload }.f;
+        } break;
+
+        case FLAT_BOOLEAN_EXPRESSION:
+        {
+            expr->kind = AST_BOOLEAN_EXPRESSION;
+            expr->expr.boolean_expression.value = payload != 0;
+        } break;
+
+        case FLAT_PREFIX_EXPRESSION:
+        {
+            const Flat_Prefix *prefix = &ast->prefixes.elements[payload];
+            expr->kind = AST_PREFIX_EXPRESSION;
+            expr->expr.prefix_expression.op = (char) prefix->op;
+            expr->expr.prefix_expression.rhs = program_new_flat_expression(conv, prefix->rhs);
+        } break;
+
+        case FLAT_INFIX_EXPRESSION:
+        {
+            const Flat_Infix *infix = &ast->infixes.elements[payload];
+            expr->kind = AST_INFIX_EXPRESSION;
+            expr->expr.infix_expression.op = (Token_Kind) infix->op;
+            expr->expr.infix_expression.lhs = program_new_flat_expression(conv, infix->lhs);
+            expr->expr.infix_expression.rhs = program_new_flat_expression(conv, infix->rhs);
+        } break;
+
+        case FLAT_IF_EXPRESSION:
+        {
+            const Flat_If *flat_if = &ast->ifs.elements[payload];
+            If_Expression *if_expr = &expr->expr.if_expression;
+            expr->kind = AST_IF_EXPRESSION;
+            if_expr->condition = program_new_flat_expression(conv, flat_if->condition);
+            if_expr->consequence = program_from_flat_block(conv, flat_if->consequence);
+            if_expr->alternative = NULL;
+            if (flat_if->alternative != FLAT_NODE_NONE)
+            {
+                if_expr->alternative = program_from_flat_block(conv, flat_if->alternative);
+            }
+        } break;
+
+        case FLAT_FUNCTION_EXPRESSION:
+        {
+            const Flat_Function *flat_func = &ast->functions.elements[payload];
+            Function_Expression *func = &expr->expr.function_expression;
+            expr->kind = AST_FUNCTION_EXPRESSION;
+            *func = (Function_Expression) {
+                .parameters = {
+                    .len = flat_func->parameter_count,
+                    .capacity = flat_func->parameter_count,
+                    .idents = arena_new_array(conv->arena, Ident_Expression, flat_func->parameter_count),
+                },
+                .body = NULL,
+                .body_open = 0,
+                .body_close = 0,
+            };
+            for (uint32_t i = 0; i < flat_func->parameter_count; ++i)
+            {
+                Symbol symbol = ast->parameters.elements[flat_func->first_parameter + i];
+                func->parameters.idents[i] = (Ident_Expression) { symbol_to_cstr(symbol), symbol };
+            }
+            if (flat_func->body != FLAT_NODE_NONE)
+            {
+                func->body = program_from_flat_block(conv, flat_func->body);
+            }
+        } break;
+
+        default:
+        {
+            assert(0 && "Flat node is not an expression");
+        } break;
+    }
+}
+
+Program flat_ast_to_program(const Flat_Ast *ast)
+{
+    assert(ast);
+    assert(ast->kinds[ast->root] == FLAT_BLOCK);
+
+    Program prog = {0};
+    const Flat_Block *top_level = &ast->blocks.elements[ast->payloads[ast->root]];
+    prog.statements = (Statement_Array) {
+        .capacity = top_level->len > 0 ? top_level->len : 1,
+        .len = top_level->len,
+        .elements = malloc(sizeof(Statement) * (top_level->len > 0 ? top_level->len : 1)),
+    };
+    assert(prog.statements.elements && "Failed to allocate program statements");
+
+    Flat_To_Program conv = {
+        .ast = ast,
+        .arena = &prog.arena,
+    };
+
+    for (size_t i = 0; i < top_level->len; ++i)
+    {
+        Flat_Node stmt = ast->block_statements.elements[top_level->first + i];
+        program_from_flat_statement(&conv, stmt, &prog.statements.elements[i]);
+    }
+
+    return prog;
+}
+
+size_t flat_ast_size_bytes(const Flat_Ast *ast)
+{
+    return ast->len * (sizeof(uint8_t) + sizeof(uint32_t))
+        + ast->vars.len * sizeof(Flat_Var)
+        + ast->prefixes.len * sizeof(Flat_Prefix)
+        + ast->infixes.len * sizeof(Flat_Infix)
+        + ast->ifs.len * sizeof(Flat_If)
+        + ast->functions.len * sizeof(Flat_Function)
+        + ast->blocks.len * sizeof(Flat_Block)
+        + ast->block_statements.len * sizeof(Flat_Node)
+        + ast->parameters.len * sizeof(Symbol);
+}
+
+typedef struct
+{
+    Flat_Node node;
+    size_t depth;
+} Flat_Walk_Entry;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Flat_Walk_Entry *elements;
+} Flat_Walk_Stack;
+
+static void flat_walk_push(Flat_Walk_Stack *stack, Flat_Node node, size_t depth)
+{
+    if (node == FLAT_NODE_NONE)
+    {
+        return;
+    }
+    Flat_Walk_Entry entry = { node, depth };
+    da_append(Flat_Walk_Entry, stack, &entry);
+}
+
+void flat_ast_walk(const Flat_Ast *ast, Flat_Node node, Flat_Ast_Visit_Fn visit, void *user)
+{
+    assert(ast);
+    assert(visit);
+
+    // NOTE(HS): children are pushed last to first so they pop in source order
+    Flat_Walk_Stack stack;
+    da_init(Flat_Walk_Entry, &stack);
+    flat_walk_push(&stack, node, 0);
+
+    while (stack.len > 0)
+    {
+        Flat_Walk_Entry entry = stack.elements[--stack.len];
+        if (!visit(ast, entry.node, entry.depth, user))
+        {
+            continue;
+        }
+
+        size_t depth = entry.depth + 1;
+        uint32_t payload = ast->payloads[entry.node];
+        switch ((Flat_Node_Kind) ast->kinds[entry.node])
+        {
+            case FLAT_BLOCK:
+            {
+                const Flat_Block *block = &ast->blocks.elements[payload];
+                for (size_t i = block->len; i > 0; --i)
+                {
+                    flat_walk_push(&stack, ast->block_statements.elements[block->first + i - 1], depth);
+                }
+            } break;
+
+            case FLAT_VAR_STATEMENT:
+            {
+                flat_walk_push(&stack, ast->vars.elements[payload].value, depth);
+            } break;
+
+            case FLAT_RETURN_STATEMENT:
+            case FLAT_EXPRESSION_STATEMENT:
+            {
+                flat_walk_push(&stack, payload, depth);
+            } break;
+
+            case FLAT_PREFIX_EXPRESSION:
+            {
+                flat_walk_push(&stack, ast->prefixes.elements[payload].rhs, depth);
+            } break;
+
+            case FLAT_INFIX_EXPRESSION:
+            {
+                const Flat_Infix *infix = &ast->infixes.elements[payload];
+                flat_walk_push(&stack, infix->rhs, depth);
+                flat_walk_push(&stack, infix->lhs, depth);
+            } break;
+
+            case FLAT_IF_EXPRESSION:
+            {
+                const Flat_If *flat_if = &ast->ifs.elements[payload];
+                flat_walk_push(&stack, flat_if->alternative, depth);
+                flat_walk_push(&stack, flat_if->consequence, depth);
+                flat_walk_push(&stack, flat_if->condition, depth);
+            } break;
+
+            case FLAT_FUNCTION_EXPRESSION:
+            {
+                flat_walk_push(&stack, ast->functions.elements[payload].body, depth);
+            } break;
+
+            default:
+            {} break;
+        }
+    }
+
+    da_free(&stack);
+}
+
+Flat_Node_Kind flat_ast_kind(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(node < ast->len);
+    return (Flat_Node_Kind) ast->kinds[node];
+}
+
+Symbol flat_ast_ident(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_IDENT_EXPRESSION);
+    return ast->payloads[node];
+}
+
+int32_t flat_ast_int(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_INT_EXPRESSION);
+    return (Token_Value) { .bits = ast->payloads[node] }.i;
+}
+
+float flat_ast_float(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_FLOAT_EXPRESSION);
+    return (Token_Value) { .bits = ast->payloads[node] }.f;
+}
+
+bool flat_ast_boolean(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_BOOLEAN_EXPRESSION);
+    return ast->payloads[node] != 0;
+}
+
+Flat_Node flat_ast_statement_expression(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_RETURN_STATEMENT
+        || flat_ast_kind(ast, node) == FLAT_EXPRESSION_STATEMENT);
+    return ast->payloads[node];
+}
+
+const Flat_Var *flat_ast_var(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_VAR_STATEMENT);
+    return &ast->vars.elements[ast->payloads[node]];
+}
+
+const Flat_Prefix *flat_ast_prefix(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_PREFIX_EXPRESSION);
+    return &ast->prefixes.elements[ast->payloads[node]];
+}
+
+const Flat_Infix *flat_ast_infix(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_INFIX_EXPRESSION);
+    return &ast->infixes.elements[ast->payloads[node]];
+}
+
+const Flat_If *flat_ast_if(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_IF_EXPRESSION);
+    return &ast->ifs.elements[ast->payloads[node]];
+}
+
+const Flat_Function *flat_ast_function(const Flat_Ast *ast, Flat_Node node)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_FUNCTION_EXPRESSION);
+    return &ast->functions.elements[ast->payloads[node]];
+}
+
+const Flat_Node *flat_ast_block_statements(const Flat_Ast *ast, Flat_Node node, size_t *len)
+{
+    assert(flat_ast_kind(ast, node) == FLAT_BLOCK);
+    assert(len);
+    const Flat_Block *block = &ast->blocks.elements[ast->payloads[node]];
+    *len = block->len;
+    return &ast->block_statements.elements[block->first];
+}
+
+const Symbol *flat_ast_parameters(const Flat_Ast *ast, Flat_Node node, size_t *len)
+{
+    assert(len);
+    const Flat_Function *func = flat_ast_function(ast, node);
+    *len = func->parameter_count;
+    return &ast->parameters.elements[func->first_parameter];
+}
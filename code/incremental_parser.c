@@ -0,0 +1,376 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "containers.h"
+#include "incremental_parser.h"
+#include "parser.h"
+#include "parser_internal.h"
+
+/// The change being reparsed for: tokens `[first, old_end)` of the old buffer
+/// were replaced by tokens `[first, new_end)` of the new one.
+typedef struct
+{
+    Parser *p;
+    size_t first;
+    size_t old_end;
+    size_t new_end;
+    /// tokens parsed, including by attempts that had to be given up on
+    size_t parsed;
+} Reparse;
+
+/// New statements on the parser's scratch stack from `mark`, to replace the old
+/// statements `[from, to)`.
+typedef struct
+{
+    size_t from;
+    size_t to;
+    size_t mark;
+} Reparse_Splice;
+
+/// A block of a statement, whose statements are parsed at a `nesting_depth` of
+/// `nesting`.
+typedef struct
+{
+    Block_Statement *block;
+    size_t nesting;
+} Block_Ref;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Block_Ref *elements;
+} Block_Ref_Array;
+
+/// A token count spanning the change, adjusted for it.
+static uint32_t reparse_shift(const Reparse *r, uint32_t count)
+{
+    return (uint32_t) (count + r->new_end - r->old_end);
+}
+
+/// The blocks of `expr` that aren't inside another of its blocks, in source order,
+/// `nesting` being the parser's `nesting_depth` inside `expr`.
+static void expression_blocks(Expression *expr, size_t nesting, Block_Ref_Array *blocks)
+{
+    switch (expr->kind)
+    {
+        case AST_PREFIX_EXPRESSION:
+        {
+            expression_blocks(expr->expr.prefix_expression.rhs, nesting, blocks);
+        } break;
+
+        case AST_INFIX_EXPRESSION:
+        {
+            expression_blocks(expr->expr.infix_expression.lhs, nesting, blocks);
+            expression_blocks(expr->expr.infix_expression.rhs, nesting, blocks);
+        } break;
+
+        case AST_IF_EXPRESSION:
+        {
+            If_Expression *if_expr = &expr->expr.if_expression;
+            // NOTE(HS): the condition is an expression of its own, one level deeper
+            expression_blocks(if_expr->condition, nesting + 1, blocks);
+            Block_Ref consequence = { if_expr->consequence, nesting };
+            da_append(Block_Ref, blocks, &consequence);
+            if (if_expr->alternative)
+            {
+                Block_Ref alternative = { if_expr->alternative, nesting };
+                da_append(Block_Ref, blocks, &alternative);
+            }
+        } break;
+
+        case AST_FUNCTION_EXPRESSION:
+        {
+            if (expr->expr.function_expression.body)
+            {
+                Block_Ref body = { expr->expr.function_expression.body, nesting };
+                da_append(Block_Ref, blocks, &body);
+            }
+        } break;
+
+        default:
+        {} break;
+    }
+}
+
+static Expression *statement_expression(Statement *stmt)
+{
+    Expression *expr = NULL;
+    switch (stmt->kind)
+    {
+        case AST_VAR_STATEMENT:        { expr = &stmt->stmt.var_statement.expression; } break;
+        case AST_RETURN_STATEMENT:     { expr = &stmt->stmt.return_statement.expression; } break;
+        case AST_EXPRESSION_STATEMENT: { expr = &stmt->stmt.expression_statement.expression; } break;
+        case AST_ILLGEAL_STATEMENT:    {} break;
+    }
+    return expr;
+}
+
+/// Index of the `}` of `block`, whose `{` is at `open`.
+static size_t block_close(const Block_Statement *block, size_t open)
+{
+    // NOTE(HS): the last statement's tokens run up to the `}`
+    size_t close = open + 1;
+    for (size_t i = 0; i < block->len; ++i)
+    {
+        close += block->statements[i].token_count;
+    }
+    return close;
+}
+
+static bool reparse_block(Reparse *r, Block_Statement *block, size_t open, size_t nesting);
+
+/// Reparses the statements `stmts` of a block, or of the top level, for the
+/// change, `start` being the old index of the first one. Returns false, having
+/// changed nothing, if the statements around the change can't be reparsed without
+/// the block's own statement.
+static bool reparse_statements(Reparse *r, Statement *stmts, size_t len, size_t start, bool in_block, Reparse_Splice *splice)
+{
+    Parser *p = r->p;
+
+    // NOTE(HS): where a statement ends depends on the token after it, so the
+    // first statement affected is the first whose next token is changed or later
+    size_t i = 0;
+    size_t s = start;
+    while (i < len && s + stmts[i].token_count < r->first)
+    {
+        s += stmts[i].token_count;
+        i += 1;
+    }
+
+    splice->mark = p->scratch_statements.len;
+    splice->from = i;
+    splice->to = i;
+
+    if (i < len && s < r->first && r->old_end < s + stmts[i].token_count)
+    {
+        // the change is inside one statement, it may be inside one of its blocks
+        Statement *stmt = &stmts[i];
+        Expression *expr = statement_expression(stmt);
+        Block_Ref_Array blocks;
+        da_init(Block_Ref, &blocks);
+        if (expr)
+        {
+            expression_blocks(expr, p->nesting_depth + 1, &blocks);
+        }
+
+        // NOTE(HS): the blocks don't overlap, so only the last one opening before
+        // the change can hold it
+        size_t k = blocks.len;
+        while (k > 0 && s + blocks.elements[k - 1].block->open >= r->first)
+        {
+            k -= 1;
+        }
+
+        bool done = false;
+        if (k > 0)
+        {
+            Block_Statement *block = blocks.elements[k - 1].block;
+            size_t open = s + block->open;
+            if (r->old_end <= block_close(block, open) && reparse_block(r, block, open, blocks.elements[k - 1].nesting))
+            {
+                for (size_t j = k; j < blocks.len; ++j)
+                {
+                    blocks.elements[j].block->open = reparse_shift(r, blocks.elements[j].block->open);
+                }
+                stmt->token_count = reparse_shift(r, stmt->token_count);
+                done = true;
+            }
+        }
+        da_free(&blocks);
+
+        if (done)
+        {
+            return true;
+        }
+    }
+
+    // NOTE(HS): everything before `s` is unchanged, so it's the same index in
+    // the new tokens
+    size_t error_mark = p->errors.len;
+    p->cur = s;
+
+    size_t j = i;
+    size_t old_s = s;
+    bool synced = false;
+    for (;;)
+    {
+        // an old statement starting here, past the change, parses the same
+        size_t ns = p->cur;
+        if (ns >= r->new_end)
+        {
+            size_t os = ns - r->new_end + r->old_end;
+            while (j < len && old_s < os)
+            {
+                old_s += stmts[j].token_count;
+                j += 1;
+            }
+            if (old_s == os)
+            {
+                synced = true;
+                break;
+            }
+        }
+
+        if (cur_token_is(p, TK_EOF) || (in_block && cur_token_is(p, TK_RBRACE)))
+        {
+            break;
+        }
+
+        Statement stmt;
+        parse_next_statement(p, &stmt);
+        da_append(Statement, &p->scratch_statements, &stmt);
+    }
+    r->parsed += p->cur - s;
+
+    // NOTE(HS): only a block can end somewhere new, the top level always ends
+    // at the old EOF
+    assert((synced || in_block) && "Top level didn't resynchronise at EOF");
+    if (!synced)
+    {
+        p->scratch_statements.len = splice->mark;
+        p->errors.len = error_mark;
+        return false;
+    }
+
+    splice->to = j;
+    return true;
+}
+
+static bool reparse_block(Reparse *r, Block_Statement *block, size_t open, size_t nesting)
+{
+    Parser *p = r->p;
+    Reparse_Splice splice;
+
+    // NOTE(HS): nested as deeply as a full parse would be, so it reaches the same
+    // limit at the same place
+    size_t outer_nesting = p->nesting_depth;
+    p->nesting_depth = nesting;
+    bool reparsed = reparse_statements(r, block->statements, block->len, open + 1, true, &splice);
+    p->nesting_depth = outer_nesting;
+    if (!reparsed)
+    {
+        return false;
+    }
+
+    size_t added = p->scratch_statements.len - splice.mark;
+    if (splice.from == splice.to && added == 0)
+    {
+        return true;
+    }
+
+    // NOTE(HS): the old array is left in the arena, see `Incremental_Parser.reparsed_tokens`
+    size_t len = block->len - (splice.to - splice.from) + added;
+    Statement *statements = NULL;
+    if (len > 0)
+    {
+        // NOTE(HS): an empty block has no statements array, which memcpy must
+        // not be handed even for 0 bytes
+        statements = arena_new_array(p->arena, Statement, len);
+        if (splice.from > 0)
+        {
+            memcpy(statements, block->statements, sizeof(Statement) * splice.from);
+        }
+        if (added > 0)
+        {
+            memcpy(&statements[splice.from], &p->scratch_statements.elements[splice.mark], sizeof(Statement) * added);
+        }
+        if (block->len - splice.to > 0)
+        {
+            memcpy(&statements[splice.from + added], &block->statements[splice.to], sizeof(Statement) * (block->len - splice.to));
+        }
+    }
+
+    block->statements = statements;
+    block->len = len;
+    block->capacity = len;
+    p->scratch_statements.len = splice.mark;
+    return true;
+}
+
+static void incremental_parse_all(Incremental_Parser *ip)
+{
+    program_free(&ip->program);
+    ip->parser.cur = 0;
+    ip->program = parser_parse_program(&ip->parser);
+    ip->reparsed_tokens = 0;
+}
+
+void incremental_parser_init(Incremental_Parser *ip, const char *input, size_t input_len)
+{
+    assert(ip);
+    *ip = (Incremental_Parser) {0};
+
+    Lexer lexer;
+    lexer_init_n(&lexer, input, input_len);
+    lexer_tokenize_all(&lexer, &ip->tokens);
+    lexer_free(&lexer);
+
+    parser_init_tokens(&ip->parser, &ip->tokens);
+    ip->program = parser_parse_program(&ip->parser);
+}
+
+size_t incremental_parser_edit(Incremental_Parser *ip, const char *input, size_t input_len, Text_Edit edit)
+{
+    assert(ip);
+    Token_Edit changed = token_buffer_relex_edit(&ip->tokens, input, input_len, edit);
+
+    Parser *p = &ip->parser;
+    if (p->errors.len > 0 || ip->reparsed_tokens >= ip->tokens.len)
+    {
+        incremental_parse_all(ip);
+        return ip->tokens.len;
+    }
+
+    Reparse r = {
+        .p = p,
+        .first = changed.first,
+        .old_end = changed.first + changed.removed,
+        .new_end = changed.first + changed.inserted,
+        .parsed = 0,
+    };
+
+    Statement_Array *statements = &ip->program.statements;
+    p->arena = &ip->program.arena;
+    p->panicking = false;
+
+    Reparse_Splice splice;
+    reparse_statements(&r, statements->elements, statements->len, 0, false, &splice);
+
+    size_t added = p->scratch_statements.len - splice.mark;
+    size_t len = statements->len - (splice.to - splice.from) + added;
+    if (len > statements->capacity)
+    {
+        size_t capacity = statements->capacity * 2 > len ? statements->capacity * 2 : len;
+        Statement *elements = realloc(statements->elements, sizeof(Statement) * capacity);
+        assert(elements && "Failed to grow program statements");
+        statements->elements = elements;
+        statements->capacity = capacity;
+    }
+
+    memmove(&statements->elements[splice.from + added],
+        &statements->elements[splice.to],
+        sizeof(Statement) * (statements->len - splice.to));
+    memcpy(&statements->elements[splice.from],
+        &p->scratch_statements.elements[splice.mark],
+        sizeof(Statement) * added);
+    statements->len = len;
+    p->scratch_statements.len = splice.mark;
+
+    p->arena = NULL;
+    ip->reparsed_tokens += r.parsed;
+    return r.parsed;
+}
+
+void incremental_parser_free(Incremental_Parser *ip)
+{
+    assert(ip);
+    program_free(&ip->program);
+    parser_free(&ip->parser);
+    token_buffer_free(&ip->tokens);
+    *ip = (Incremental_Parser) {0};
+}
@@ -1,8 +1,14 @@
 #include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "containers.h"
 #include "lexer.h"
 #include "lexer_internal.h"
+#include "scan.h"
 
 const char *token_kind_to_string(Token_Kind kind)
 {
@@ -54,18 +60,19 @@ const char *token_kind_to_string(Token_Kind kind)
 
 void lexer_init(Lexer *lexer, const char *input)
 {
-    assert(lexer);
     assert(input);
+    lexer_init_n(lexer, input, strlen(input));
+}
+
+void lexer_init_n(Lexer *lexer, const char *input, size_t input_len)
+{
+    assert(lexer);
+    assert(input || input_len == 0);
 
-    size_t input_len = strlen(input);
     *lexer = (Lexer) {
         .input = input,
         .input_len = input_len,
-        .location = (Location) {
-            .pos = 0,
-            .line = 1,
-            .col = 0,
-        },
+        .pos = 0,
         .read_pos = 0,
         .ch = '\0',
     };
@@ -75,12 +82,30 @@ void lexer_init(Lexer *lexer, const char *input)
     return;
 }
 
+void lexer_free(Lexer *lexer)
+{
+    assert(lexer);
+    line_index_free(&lexer->lines);
+    da_free(&lexer->strings);
+}
+
+Location lexer_location(Lexer *lexer, size_t pos)
+{
+    assert(lexer);
+
+    if (lexer->lines.len == 0)
+    {
+        line_index_build(&lexer->lines, lexer->input, lexer->input_len);
+    }
+    return line_index_lookup(&lexer->lines, pos);
+}
+
 Token lexer_next_token(Lexer *lexer)
 {
     lexer_skip_whitespace(lexer);
 
     Token token = {0};
-    token.location = lexer->location;
+    token.location.pos = lexer->pos;
 
     // NOTE(HS): this is dumb - but "fallthrough" by default is dump too.
     #define br_case(CASE, ...) \
@@ -92,12 +117,21 @@ Token lexer_next_token(Lexer *lexer)
     // NOTE(HS): default for most characters is to generate something of length 1,
     // this can simply be updated after initial allocation if required, e.g. for
     // `!=`, `==`, and `<=`.
-    token.literal = string_view_from_cstr_offset(lexer->input, lexer->location.pos, 1);
+    token.literal = string_view_from_cstr_offset(lexer->input, lexer->pos, 1);
 
     switch (lexer->ch)
     {
         br_case('\0', {
-            token.kind = TK_EOF;
+            // NOTE(HS): the EOF literal is empty so it never views past the input
+            if (lexer->pos >= lexer->input_len)
+            {
+                token.kind = TK_EOF;
+                token.literal.length = 0;
+            }
+            else
+            {
+                token.kind = TK_ILLEGAL;
+            }
         });
 
         br_case('(', {
@@ -236,30 +270,38 @@ Token lexer_next_token(Lexer *lexer)
 
         br_case('\"', {
             lexer_read_char(lexer);
-            size_t pos = lexer->location.pos;
-            token.location = lexer->location;
-            lexer_read_string(lexer);
-            size_t len = lexer->location.pos - token.location.pos;
+            size_t pos = lexer->pos;
+            token.location.pos = pos;
+            bool escaped = lexer_read_string(lexer);
+            size_t len = lexer->pos - pos;
             token.literal = string_view_from_cstr_offset(lexer->input, pos, len);
             token.kind = TK_STRING_LIT;
+            if (escaped)
+            {
+                token.value.string = token_strings_push(&lexer->strings, token.literal);
+            }
         });
 
         default:
         {
             if (is_numeric(lexer->ch))
             {
-                size_t pos = lexer->location.pos;
+                size_t pos = lexer->pos;
                 lexer_read_number(lexer);
-                token.literal.length = lexer->location.pos - pos;
-                token.kind = string_view_to_number_kind(token.literal);
+                token.literal.length = lexer->pos - pos;
+                token.kind = string_view_to_number(token.literal, &token.value);
                 return token;
             }
-            else if (is_alpha(lexer->ch))
+            else if (is_ident_start(lexer->ch))
             {
-                size_t pos = lexer->location.pos;
+                size_t pos = lexer->pos;
                 lexer_read_ident(lexer);
-                token.literal.length = lexer->location.pos - pos;
+                token.literal.length = lexer->pos - pos;
                 token.kind = string_view_to_ident_or_keyword(token.literal);
+                if (token.kind == TK_IDENT)
+                {
+                    token.value.symbol = symbol_intern(token.literal);
+                }
                 return token;
             }
             else
@@ -273,38 +315,140 @@ Token lexer_next_token(Lexer *lexer)
     return token;
 }
 
+// NOTE(HS): token kinds are stored as bytes in `Token_Buffer`
+typedef char token_kind_fits_in_byte[TOKEN_KIND_COUNT <= UINT8_MAX ? 1 : -1];
+
+void token_buffer_reserve(Token_Buffer *tokens, size_t capacity)
+{
+    if (capacity <= tokens->capacity)
+    {
+        return;
+    }
+
+    uint8_t *kinds = realloc(tokens->kinds, sizeof(uint8_t) * capacity);
+    assert(kinds && "Failed to allocate token kinds");
+    uint32_t *offsets = realloc(tokens->offsets, sizeof(uint32_t) * capacity);
+    assert(offsets && "Failed to allocate token offsets");
+    uint32_t *lengths = realloc(tokens->lengths, sizeof(uint32_t) * capacity);
+    assert(lengths && "Failed to allocate token lengths");
+    uint32_t *values = realloc(tokens->values, sizeof(uint32_t) * capacity);
+    assert(values && "Failed to allocate token values");
+
+    tokens->kinds = kinds;
+    tokens->offsets = offsets;
+    tokens->lengths = lengths;
+    tokens->values = values;
+    tokens->capacity = capacity;
+}
+
+void lexer_tokenize_all(Lexer *lexer, Token_Buffer *tokens)
+{
+    assert(lexer);
+    assert(tokens);
+    assert(lexer->input_len < UINT32_MAX && "Input too large for token buffer offsets");
+
+    tokens->len = 0;
+    line_index_free(&tokens->lines);
+    tokens->input = lexer->input;
+    tokens->input_len = lexer->input_len;
+    tokens->strings.len = 0;
+    tokens->strings_dead = 0;
+
+    // NOTE(HS): rough guess of 1 token per 4 bytes of input to avoid most regrowth
+    token_buffer_reserve(tokens, (lexer->input_len / 4) + 16);
+
+    // NOTE(HS): the lexer decodes strings straight into the buffer's, lent to it
+    // while lexing, rather than its own
+    Token_Strings lexer_strings = lexer->strings;
+    lexer->strings = tokens->strings;
+
+    Token t;
+    do
+    {
+        t = lexer_next_token(lexer);
+        token_buffer_push(tokens, &t);
+    } while (t.kind != TK_EOF);
+
+    tokens->strings = lexer->strings;
+    lexer->strings = lexer_strings;
+}
+
+void token_buffer_push(Token_Buffer *tokens, const Token *t)
+{
+    if (tokens->len == tokens->capacity)
+    {
+        token_buffer_reserve(tokens, tokens->capacity > 0 ? tokens->capacity * 2 : 16);
+    }
+
+    tokens->kinds[tokens->len] = (uint8_t) t->kind;
+    tokens->offsets[tokens->len] = (uint32_t) (t->literal.str - tokens->input);
+    tokens->lengths[tokens->len] = (uint32_t) t->literal.length;
+    tokens->values[tokens->len] = t->value.bits;
+    tokens->len += 1;
+}
+
+Token token_buffer_get(const Token_Buffer *tokens, size_t index)
+{
+    assert(tokens);
+    assert(index < tokens->len);
+
+    size_t offset = tokens->offsets[index];
+    return (Token) {
+        .kind = (Token_Kind) tokens->kinds[index],
+        .location = (Location) { .pos = offset, .line = 0, .col = 0 },
+        .literal = string_view_from_cstr_offset(tokens->input, offset, tokens->lengths[index]),
+        .value = (Token_Value) { .bits = tokens->values[index] },
+    };
+}
+
+Location token_buffer_location(Token_Buffer *tokens, size_t index)
+{
+    assert(tokens);
+    assert(index < tokens->len);
+
+    if (tokens->lines.len == 0)
+    {
+        line_index_build(&tokens->lines, tokens->input, tokens->input_len);
+    }
+    return line_index_lookup(&tokens->lines, tokens->offsets[index]);
+}
+
+void token_buffer_free(Token_Buffer *tokens)
+{
+    line_index_free(&tokens->lines);
+    free(tokens->kinds);
+    free(tokens->offsets);
+    free(tokens->lengths);
+    free(tokens->values);
+    da_free(&tokens->strings);
+    *tokens = (Token_Buffer) {0};
+}
+
 void lexer_read_char(Lexer *lexer)
 {
     assert(lexer);
 
     if (lexer->read_pos >= lexer->input_len)
     {
+        // NOTE(HS): stay at the end of input however many times it is read past
         lexer->ch = '\0';
-    }
-    else
-    {
-        if (lexer->ch == '\n')
-        {
-            lexer->location.line += 1;
-            lexer->location.col = 1;
-        }
-        else if (lexer->ch == '\r')
-        {
-            if (lexer_peek_char(lexer) == '\n')
-            {
-                lexer->read_pos += 1;
-            }
-            lexer->location.line += 1;
-            lexer->location.col = 1;
-        }
-        else
-        {
-            lexer->location.col += 1;
-        }
-        lexer->ch = lexer->input[lexer->read_pos];
+        lexer->pos = lexer->input_len;
+        lexer->read_pos = lexer->input_len + 1;
+        return;
     }
 
-    lexer->location.pos = lexer->read_pos++;
+    lexer->ch = lexer->input[lexer->read_pos];
+    lexer->pos = lexer->read_pos++;
+}
+
+void lexer_seek(Lexer *lexer, size_t pos)
+{
+    assert(lexer);
+    assert(pos <= lexer->input_len);
+
+    lexer->pos = pos;
+    lexer->read_pos = pos + 1;
+    lexer->ch = pos < lexer->input_len ? lexer->input[pos] : '\0';
 }
 
 inline char lexer_peek_char(const Lexer *lexer)
@@ -319,89 +463,295 @@ inline char lexer_peek_char(const Lexer *lexer)
     }
 }
 
+void lexer_advance_to(Lexer *lexer, size_t end)
+{
+    assert(lexer);
+    assert(end > lexer->pos);
+
+    if (end < lexer->input_len)
+    {
+        lexer->ch = lexer->input[end];
+        lexer->pos = end;
+        lexer->read_pos = end + 1;
+    }
+    else
+    {
+        lexer->ch = '\0';
+        lexer->pos = lexer->input_len;
+        lexer->read_pos = lexer->input_len + 1;
+    }
+}
+
 void lexer_skip_whitespace(Lexer *lexer)
 {
-    while (is_whitespace(lexer->ch))
+    if (!is_whitespace(lexer->ch))
     {
-        lexer_read_char(lexer);
+        return;
     }
+
+    size_t pos = lexer->pos;
+    size_t len = scan_whitespace(&lexer->input[pos], lexer->input_len - pos);
+    lexer_advance_to(lexer, pos + len);
 }
 
 void lexer_read_number(Lexer *lexer)
 {
-    while ((is_numeric(lexer->ch) || lexer->ch == '.') && !is_end_of_input(lexer->ch))
+    if (!(is_numeric(lexer->ch) || lexer->ch == '.'))
     {
-        lexer_read_char(lexer);
+        return;
     }
+
+    size_t pos = lexer->pos;
+    size_t len = scan_number(&lexer->input[pos], lexer->input_len - pos);
+    lexer_advance_to(lexer, pos + len);
 }
 
-void lexer_read_string(Lexer *lexer)
+bool lexer_read_string(Lexer *lexer)
 {
-    while (lexer->ch != '\"' && !is_end_of_input(lexer->ch))
+    const char *input = lexer->input;
+    size_t input_len = lexer->input_len;
+    size_t i = lexer->pos;
+    bool escaped = false;
+    for (;;)
     {
-        if (lexer->ch == '\\')
+        i += scan_string(&input[i], input_len - i);
+        if (i >= input_len || input[i] == '\"')
         {
-            if (lexer_peek_char(lexer) == '\"')
+            break;
+        }
+
+        // NOTE(HS): a backslash escapes whatever byte follows it, including a quote
+        // or another backslash
+        escaped = true;
+        i = i + 2 < input_len ? i + 2 : input_len;
+    }
+
+    lexer_seek(lexer, i);
+    return escaped;
+}
+
+/// Decodes the escape sequences in `literal` into `out`, which must hold at least
+/// `literal.length` bytes. Unknown escapes are kept as they are, backslash and all.
+/// Returns the decoded length.
+static size_t string_literal_decode(String_View literal, char *out)
+{
+    const char *str = literal.str;
+    const char *end = literal.str + literal.length;
+    size_t len = 0;
+    while (str < end)
+    {
+        const char *slash = memchr(str, '\\', (size_t) (end - str));
+        size_t run = slash ? (size_t) (slash - str) : (size_t) (end - str);
+        memcpy(&out[len], str, run);
+        len += run;
+        str += run;
+        if (!slash)
+        {
+            break;
+        }
+
+        if (slash + 1 == end)
+        {
+            // unterminated string ending in a backslash
+            out[len++] = '\\';
+            break;
+        }
+
+        char c = slash[1];
+        switch (c)
+        {
+            case 'n':  out[len++] = '\n'; break;
+            case 't':  out[len++] = '\t'; break;
+            case 'r':  out[len++] = '\r'; break;
+            case '0':  out[len++] = '\0'; break;
+            case '\\': out[len++] = '\\'; break;
+            case '\"': out[len++] = '\"'; break;
+            default:
             {
-                lexer_read_char(lexer);
-                lexer_read_char(lexer);
-            }
+                out[len++] = '\\';
+                out[len++] = c;
+            } break;
         }
-        else
+        str = slash + 2;
+    }
+    return len;
+}
+
+uint32_t token_strings_push(Token_Strings *strings, String_View literal)
+{
+    // NOTE(HS): decoding never makes a literal longer, so reserve for all of it
+    size_t needed = strings->len + sizeof(uint32_t) + literal.length;
+    assert(needed <= UINT32_MAX && "Too many decoded strings for 32-bit offsets");
+    if (needed > strings->capacity)
+    {
+        size_t capacity = strings->capacity > 0 ? strings->capacity : DA_DEFAULT_CAPACITY;
+        while (capacity < needed)
         {
-            lexer_read_char(lexer);
+            capacity *= 2;
         }
+        char *elements = realloc(strings->elements, capacity);
+        assert(elements && "Failed to allocate decoded strings");
+        strings->elements = elements;
+        strings->capacity = capacity;
     }
+
+    // NOTE(HS): the bytes come after their length, so are never at offset 0
+    size_t offset = strings->len + sizeof(uint32_t);
+    uint32_t len = (uint32_t) string_literal_decode(literal, &strings->elements[offset]);
+    memcpy(&strings->elements[strings->len], &len, sizeof(uint32_t));
+    strings->len = offset + len;
+    return (uint32_t) offset;
+}
+
+String_View token_string_contents(const Token_Strings *strings, Token token)
+{
+    assert(strings);
+    assert(token.kind == TK_STRING_LIT);
+    if (token.value.string == 0)
+    {
+        return token.literal;
+    }
+
+    assert(token.value.string <= strings->len && "String not decoded into these strings");
+    uint32_t len;
+    memcpy(&len, &strings->elements[token.value.string - sizeof(uint32_t)], sizeof(uint32_t));
+    return (String_View) { &strings->elements[token.value.string], len };
 }
 
 void lexer_read_ident(Lexer *lexer)
 {
-    while ((is_alpha(lexer->ch) || lexer->ch == '_') && !is_end_of_input(lexer->ch))
+    if (!is_ident_char(lexer->ch))
+    {
+        return;
+    }
+
+    size_t pos = lexer->pos;
+    size_t len = scan_ident(&lexer->input[pos], lexer->input_len - pos);
+    lexer_advance_to(lexer, pos + len);
+}
+
+// NOTE(HS): every power of 10 up to 10^10 is exactly representable as a float
+static const float float_pow10[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f,
+};
+
+/// Largest mantissa for which `(float) mantissa` is exact
+#define FLOAT_EXACT_MANTISSA_MAX (1u << 24)
+
+/// Literals longer than this are copied to the heap for `strtof`
+#define NUMBER_BUFFER_SIZE 64
+
+/// Decodes a float literal too long or precise for the fast path with `strtof`,
+/// which rounds correctly. Returns false if the value is out of range.
+static bool decode_float_slow(String_View sv, float *value)
+{
+    char stack_buffer[NUMBER_BUFFER_SIZE];
+    char *buffer = stack_buffer;
+    if (sv.length >= NUMBER_BUFFER_SIZE)
+    {
+        buffer = malloc(sv.length + 1);
+        assert(buffer && "Failed to allocate number buffer");
+    }
+    memcpy(buffer, sv.str, sv.length);
+    buffer[sv.length] = '\0';
+
+    *value = strtof(buffer, NULL);
+
+    if (buffer != stack_buffer)
     {
-        lexer_read_char(lexer);
+        free(buffer);
     }
+    return !isinf(*value);
 }
 
-Token_Kind string_view_to_number_kind(String_View sv)
+Token_Kind string_view_to_number(String_View sv, Token_Value *value)
 {
+    assert(value);
+    *value = (Token_Value) { .bits = 0 };
+
+    // NOTE(HS): the digits are accumulated into a single integer mantissa, with the
+    // number of digits after the decimal point counted to scale it afterwards
+    uint64_t mantissa = 0;
+    bool mantissa_overflow = false;
+    size_t fraction_digits = 0;
     int decimal_point_count = 0;
-    Token_Kind kind = TK_ILLEGAL;
 
     for (size_t i = 0; i < sv.length; ++i)
     {
-        if (sv.str[i] == '.')
+        char c = sv.str[i];
+        if (c == '.')
         {
             decimal_point_count += 1;
+            continue;
         }
+
+        if (mantissa > (UINT64_MAX - 9) / 10)
+        {
+            mantissa_overflow = true;
+            continue;
+        }
+        mantissa = (mantissa * 10) + (uint64_t) (c - '0');
+        fraction_digits += decimal_point_count > 0;
     }
 
     if (decimal_point_count == 0)
     {
-        kind = TK_INT_LIT;
+        if (mantissa_overflow || mantissa > INT32_MAX)
+        {
+            return TK_ILLEGAL;
+        }
+        value->i = (int32_t) mantissa;
+        return TK_INT_LIT;
     }
     else if (decimal_point_count == 1)
     {
-        kind = TK_FLOAT_LIT;
+        // NOTE(HS): both operands are exact, so the single division is correctly
+        // rounded. Anything else takes the slow path rather than being off by an ulp.
+        if (!mantissa_overflow
+            && mantissa <= FLOAT_EXACT_MANTISSA_MAX
+            && fraction_digits < sizeof(float_pow10) / sizeof(float_pow10[0]))
+        {
+            value->f = (float) mantissa / float_pow10[fraction_digits];
+            return TK_FLOAT_LIT;
+        }
+
+        if (decode_float_slow(sv, &value->f))
+        {
+            return TK_FLOAT_LIT;
+        }
+        value->bits = 0;
     }
 
-    return kind;
+    return TK_ILLEGAL;
 }
 
-Token_Kind string_view_to_ident_or_keyword(String_View sv)
+typedef struct
 {
-    #define sveq(S) string_view_eq_cstr(sv, (S))
+    const char *str;
+    size_t length;
+    Token_Kind kind;
+} Keyword;
+
+static const Keyword keyword_table[LEXER_KEYWORD_SLOTS] = {
+    #define X(KIND, STR, FIRST, LAST) \
+        [LEXER_KEYWORD_HASH(sizeof(STR) - 1, FIRST, LAST)] = { STR, sizeof(STR) - 1, KIND },
+    LEXER_KEYWORD_LIST
+    #undef X
+};
 
-    Token_Kind kind = TK_IDENT;
+Token_Kind string_view_to_ident_or_keyword(String_View sv)
+{
+    if (sv.length == 0)
+    {
+        return TK_IDENT;
+    }
 
-    if      (sveq("true"))    { kind = TK_TRUE;    }
-    else if (sveq("false"))   { kind = TK_FALSE;   }
-    else if (sveq("nil"))     { kind = TK_NIL;     }
-    else if (sveq("if"))      { kind = TK_IF;      }
-    else if (sveq("else"))    { kind = TK_ELSE;    }
-    else if (sveq("func"))    { kind = TK_FUNC;    }
-    else if (sveq("var"))     { kind = TK_VAR;     }
-    else if (sveq("return"))  { kind = TK_RETURN;  }
-    else if (sveq("println")) { kind = TK_PRINTLN; }
+    // NOTE(HS): empty slots have a length of 0 so can never match
+    const Keyword *kw = &keyword_table[LEXER_KEYWORD_HASH(sv.length, sv.str[0], sv.str[sv.length - 1])];
+    if (kw->length == sv.length && memcmp(kw->str, sv.str, sv.length) == 0)
+    {
+        return kw->kind;
+    }
 
-    return kind;
+    return TK_IDENT;
 }
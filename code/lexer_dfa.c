@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "lexer_internal.h"
+#include "lexer_dfa_tables.h"
+
+Token lexer_next_token_dfa(Lexer *lexer)
+{
+    assert(lexer);
+
+    lexer_skip_whitespace(lexer);
+
+    const char *input = lexer->input;
+    size_t input_len = lexer->input_len;
+    size_t start = lexer->pos;
+
+    Token token = {0};
+    token.location.pos = start;
+
+    if (start >= input_len)
+    {
+        token.kind = TK_EOF;
+        token.literal = string_view_from_cstr_offset(input, input_len, 0);
+        return token;
+    }
+
+    // NOTE(HS): the whole token in one loop, the only branches being the exit and
+    // the end of input check
+    uint8_t state = LEXER_DFA_START;
+    size_t pos = start;
+    while (pos < input_len)
+    {
+        uint8_t next = lexer_dfa_transitions[state][lexer_dfa_class[(unsigned char) input[pos]]];
+        if (next == LEXER_DFA_STOP)
+        {
+            break;
+        }
+        state = next;
+        pos += 1;
+    }
+
+    token.kind = (Token_Kind) lexer_dfa_accept[state];
+    token.literal = string_view_from_cstr_offset(input, start, pos - start);
+
+    switch (token.kind)
+    {
+        case TK_IDENT:
+        {
+            token.kind = string_view_to_ident_or_keyword(token.literal);
+            if (token.kind == TK_IDENT)
+            {
+                token.value.symbol = symbol_intern(token.literal);
+            }
+        } break;
+
+        case TK_INT_LIT:
+        {
+            token.kind = string_view_to_number(token.literal, &token.value);
+        } break;
+
+        case TK_STRING_LIT:
+        {
+            // NOTE(HS): the literal excludes the quotes, an unterminated string runs
+            // to the end of the input
+            size_t closing = state == LEXER_DFA_STRING_END ? 1 : 0;
+            token.location.pos = start + 1;
+            token.literal = string_view_from_cstr_offset(input, start + 1, pos - start - 1 - closing);
+            if (memchr(token.literal.str, '\\', token.literal.length))
+            {
+                token.value.string = token_strings_push(&lexer->strings, token.literal);
+            }
+        } break;
+
+        default:
+        {
+        } break;
+    }
+
+    lexer_seek(lexer, pos);
+    return token;
+}
@@ -0,0 +1,303 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers.h"
+#include "lexer.h"
+#include "lexer_internal.h"
+
+// NOTE(HS): a string literal's offset and length exclude its quotes, the extent
+// below is every byte the lexer looked at to produce the token. An unterminated
+// string has no closing quote and runs to the end of the input.
+static size_t token_start(const Token_Buffer *tokens, size_t index)
+{
+    size_t offset = tokens->offsets[index];
+    return tokens->kinds[index] == TK_STRING_LIT ? offset - 1 : offset;
+}
+
+static size_t token_end(const Token_Buffer *tokens, size_t index)
+{
+    size_t end = (size_t) tokens->offsets[index] + tokens->lengths[index];
+    if (tokens->kinds[index] == TK_STRING_LIT && end < tokens->input_len)
+    {
+        end += 1;
+    }
+    return end;
+}
+
+/// Index of the first token the edit at `offset` could have changed, i.e. the
+/// first token ending at or after it. Token ends never decrease.
+static size_t first_affected_token(const Token_Buffer *tokens, size_t offset)
+{
+    size_t lo = 0;
+    size_t hi = tokens->len - 1;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (token_end(tokens, mid) < offset)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/// Index of the first token at or after `from` starting at or after `pos`.
+static size_t first_token_from(const Token_Buffer *tokens, size_t from, size_t pos)
+{
+    size_t lo = from;
+    size_t hi = tokens->len - 1;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (token_start(tokens, mid) < pos)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// NOTE(HS): below this the strings left by relexing aren't worth a pass over
+// every token to drop
+#define TOKEN_STRINGS_COMPACT_MIN 4096
+
+/// Bytes taken in `strings` by a string literal's decoded contents, `value` being
+/// its `Token_Value.string`, length included. 0 for one without escapes.
+static size_t token_string_size(const Token_Strings *strings, uint32_t value)
+{
+    if (value == 0)
+    {
+        return 0;
+    }
+    uint32_t len;
+    memcpy(&len, &strings->elements[value - sizeof(uint32_t)], sizeof(uint32_t));
+    return sizeof(uint32_t) + len;
+}
+
+/// Copies the decoded strings the tokens still refer to into a new store, which
+/// drops the dead ones. Relexed strings are appended out of token order, so this
+/// can't be done in place.
+static void token_buffer_compact_strings(Token_Buffer *tokens)
+{
+    size_t live_len = tokens->strings.len - tokens->strings_dead;
+    Token_Strings live = {
+        .capacity = live_len,
+        .len = 0,
+        .elements = malloc(live_len > 0 ? live_len : 1),
+    };
+    assert(live.elements && "Failed to allocate decoded strings");
+
+    for (size_t i = 0; i < tokens->len; ++i)
+    {
+        if (tokens->kinds[i] != TK_STRING_LIT)
+        {
+            continue;
+        }
+        uint32_t value = tokens->values[i];
+        size_t size = token_string_size(&tokens->strings, value);
+        if (size > 0)
+        {
+            memcpy(&live.elements[live.len], &tokens->strings.elements[value - sizeof(uint32_t)], size);
+            tokens->values[i] = (uint32_t) (live.len + sizeof(uint32_t));
+            live.len += size;
+        }
+    }
+    assert(live.len == live_len && "Dead strings miscounted");
+
+    da_free(&tokens->strings);
+    tokens->strings = live;
+    tokens->strings_dead = 0;
+}
+
+/// Whether token `i` of `a` and token `j` of `b` are the same token, with `b`'s
+/// offset `shift` bytes after `a`'s, for an edit of `a`'s bytes `[edit_start, edit_end)`.
+static bool token_buffer_same(const Token_Buffer *a, size_t i, const Token_Buffer *b, size_t j, uint32_t shift,
+    size_t edit_start, size_t edit_end)
+{
+    // NOTE(HS): a string decoded again is stored again, so its value differs, but
+    // its contents are those of the literal checked below
+    if (a->kinds[i] != b->kinds[j]
+        || a->lengths[i] != b->lengths[j]
+        || (a->kinds[i] != TK_STRING_LIT && a->values[i] != b->values[j])
+        || a->offsets[i] + shift != b->offsets[j])
+    {
+        return false;
+    }
+
+    // NOTE(HS): the text of these is read back from the input rather than kept
+    // in the value, so it mustn't be part of the edit. Quotes included.
+    if (a->kinds[i] == TK_STRING_LIT || a->kinds[i] == TK_ILLEGAL)
+    {
+        size_t start = a->offsets[i] > 0 ? a->offsets[i] - 1 : 0;
+        size_t end = a->offsets[i] + a->lengths[i] + 1;
+        return end <= edit_start || start >= edit_end;
+    }
+    return true;
+}
+
+/// Relexes `tokens` for `edit`, setting `changed` to the tokens that differ.
+/// Returns the number of tokens lexed.
+static size_t relex(Token_Buffer *tokens, const char *input, size_t input_len, Text_Edit edit, Token_Edit *changed)
+{
+    assert(tokens && tokens->len > 0);
+    assert(input || input_len == 0);
+    assert(input_len < UINT32_MAX && "Input too large for token buffer offsets");
+    assert(edit.offset + edit.removed_len <= tokens->input_len);
+    assert(tokens->input_len - edit.removed_len + edit.inserted_len == input_len
+        && "Edit doesn't match the change in input length");
+
+    size_t edit_end = edit.offset + edit.removed_len;
+    size_t first = first_affected_token(tokens, edit.offset);
+    size_t resume = first_token_from(tokens, first, edit_end);
+
+    // NOTE(HS): the lexer carries no state from one token to the next, so the old
+    // and new token streams agree from the first token both have starting at the
+    // same (shifted) position past the edit. The old EOF always qualifies.
+    Token_Buffer fresh = {0};
+    fresh.input = input;
+    fresh.input_len = input_len;
+
+    size_t restart = token_start(tokens, first);
+    if (restart > edit.offset)
+    {
+        restart = edit.offset;
+    }
+
+    // NOTE(HS): strings are decoded straight into the buffer's, lent to the lexer
+    Lexer lexer;
+    lexer_init_n(&lexer, input, input_len);
+    lexer_seek(&lexer, restart);
+    lexer.strings = tokens->strings;
+
+    for (;;)
+    {
+        Token t = lexer_next_token(&lexer);
+
+        size_t start = t.kind == TK_STRING_LIT ? t.location.pos - 1 : t.location.pos;
+        while (resume < tokens->len
+            && token_start(tokens, resume) - edit.removed_len + edit.inserted_len < start)
+        {
+            resume += 1;
+        }
+
+        if (resume < tokens->len
+            && token_start(tokens, resume) - edit.removed_len + edit.inserted_len == start)
+        {
+            // NOTE(HS): the old token is kept, so this one's string is never used
+            if (t.kind == TK_STRING_LIT)
+            {
+                tokens->strings_dead += token_string_size(&lexer.strings, t.value.string);
+            }
+            break;
+        }
+
+        assert(t.kind != TK_EOF && "Relexing ran past the old EOF without resynchronising");
+        token_buffer_push(&fresh, &t);
+    }
+    tokens->strings = lexer.strings;
+    lexer.strings = (Token_Strings) {0};
+    lexer_free(&lexer);
+
+    for (size_t i = first; i < resume; ++i)
+    {
+        if (tokens->kinds[i] == TK_STRING_LIT)
+        {
+            tokens->strings_dead += token_string_size(&tokens->strings, tokens->values[i]);
+        }
+    }
+
+    // NOTE(HS): the relexed range starts at or before the edit, and can end with
+    // tokens re-lexed the same, which aren't reported as changed
+    uint32_t shift = (uint32_t) edit.inserted_len - (uint32_t) edit.removed_len;
+    size_t same_before = 0;
+    while (same_before < fresh.len && first + same_before < resume
+        && token_buffer_same(tokens, first + same_before, &fresh, same_before, 0, edit.offset, edit_end))
+    {
+        same_before += 1;
+    }
+    size_t same_after = 0;
+    while (same_before + same_after < fresh.len && first + same_before + same_after < resume
+        && token_buffer_same(tokens, resume - 1 - same_after, &fresh, fresh.len - 1 - same_after, shift, edit.offset, edit_end))
+    {
+        same_after += 1;
+    }
+
+    // splice: tokens[0, first) + fresh + tokens[resume, len) shifted by the edit
+    size_t tail = tokens->len - resume;
+    size_t new_len = first + fresh.len + tail;
+    token_buffer_reserve(tokens, new_len);
+
+    size_t to = first + fresh.len;
+    if (to != resume)
+    {
+        memmove(&tokens->kinds[to], &tokens->kinds[resume], sizeof(uint8_t) * tail);
+        memmove(&tokens->offsets[to], &tokens->offsets[resume], sizeof(uint32_t) * tail);
+        memmove(&tokens->lengths[to], &tokens->lengths[resume], sizeof(uint32_t) * tail);
+        memmove(&tokens->values[to], &tokens->values[resume], sizeof(uint32_t) * tail);
+    }
+
+    if (fresh.len > 0)
+    {
+        memcpy(&tokens->kinds[first], fresh.kinds, sizeof(uint8_t) * fresh.len);
+        memcpy(&tokens->offsets[first], fresh.offsets, sizeof(uint32_t) * fresh.len);
+        memcpy(&tokens->lengths[first], fresh.lengths, sizeof(uint32_t) * fresh.len);
+        memcpy(&tokens->values[first], fresh.values, sizeof(uint32_t) * fresh.len);
+    }
+
+    if (edit.inserted_len != edit.removed_len)
+    {
+        // NOTE(HS): unsigned wrap around makes `shift` a subtraction when the edit
+        // shrank the input
+        for (size_t i = to; i < new_len; ++i)
+        {
+            tokens->offsets[i] += shift;
+        }
+    }
+
+    tokens->len = new_len;
+    tokens->input = input;
+    tokens->input_len = input_len;
+
+    // NOTE(HS): rebuilt from the new input on the next location lookup
+    line_index_free(&tokens->lines);
+
+    if (tokens->strings_dead >= TOKEN_STRINGS_COMPACT_MIN && tokens->strings_dead * 2 > tokens->strings.len)
+    {
+        token_buffer_compact_strings(tokens);
+    }
+
+    *changed = (Token_Edit) {
+        .first = first + same_before,
+        .removed = resume - first - same_before - same_after,
+        .inserted = fresh.len - same_before - same_after,
+    };
+
+    // NOTE(HS): the token the streams agreed on was lexed too
+    size_t lexed = fresh.len + 1;
+    token_buffer_free(&fresh);
+    return lexed;
+}
+
+size_t token_buffer_relex(Token_Buffer *tokens, const char *input, size_t input_len, Text_Edit edit)
+{
+    Token_Edit changed;
+    return relex(tokens, input, input_len, edit, &changed);
+}
+
+Token_Edit token_buffer_relex_edit(Token_Buffer *tokens, const char *input, size_t input_len, Text_Edit edit)
+{
+    Token_Edit changed;
+    relex(tokens, input, input_len, edit, &changed);
+    return changed;
+}
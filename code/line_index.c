@@ -0,0 +1,86 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "containers.h"
+#include "lexer.h"
+#include "scan.h"
+
+void line_index_build(Line_Index *index, const char *input, size_t input_len)
+{
+    assert(index);
+    assert(input || input_len == 0);
+
+    da_free(index);
+    da_init(size_t, index);
+    index->input_len = input_len;
+
+    // NOTE(HS): a line starts after a `\n`, or after a `\r` that isn't the first
+    // half of a `\r\n`, matching how the lexer has always counted lines.
+    size_t line_start = 0;
+    da_append(size_t, index, &line_start);
+
+    size_t pos = 0;
+    while (pos < input_len)
+    {
+        pos += scan_line(&input[pos], input_len - pos);
+        if (pos >= input_len)
+        {
+            break;
+        }
+
+        if (input[pos] == '\r' && pos + 1 < input_len && input[pos + 1] == '\n')
+        {
+            pos += 2;
+        }
+        else
+        {
+            pos += 1;
+        }
+
+        line_start = pos;
+        da_append(size_t, index, &line_start);
+    }
+}
+
+Location line_index_lookup(const Line_Index *index, size_t pos)
+{
+    assert(index);
+    assert(index->len > 0 && "Line index has not been built");
+
+    Location location = { .pos = pos, .line = 1, .col = 0 };
+    if (index->input_len == 0)
+    {
+        return location;
+    }
+
+    // NOTE(HS): the end of input is reported at the location of the final byte
+    size_t target = pos < index->input_len ? pos : index->input_len - 1;
+
+    // last line starting at or before `target`
+    size_t lo = 0;
+    size_t hi = index->len;
+    while (hi - lo > 1)
+    {
+        size_t mid = lo + ((hi - lo) / 2);
+        if (index->elements[mid] <= target)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    location.line = lo + 1;
+    location.col = target - index->elements[lo] + 1;
+    return location;
+}
+
+void line_index_free(Line_Index *index)
+{
+    assert(index);
+    da_free(index);
+    index->input_len = 0;
+}
@@ -1,11 +1,215 @@
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ast_cache.h"
+#include "flat_ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "scan.h"
+#include "source.h"
+#include "trace.h"
+
+static void usage(const char *program)
+{
+    fprintf(stderr, "usage: %s [--yaml] [--cache] <script | ->\n", program);
+    fprintf(stderr, "       %s --check <script>...\n", program);
+}
+
+static bool skip_statement(Parser *p, const Statement *stmt, Arena *arena, void *user)
+{
+    (void) p;
+    (void) stmt;
+    (void) arena;
+    (void) user;
+    return true;
+}
+
+/// A loaded script, read by a parser over it a chunk at a time.
+typedef struct
+{
+    const Source *source;
+    size_t pos;
+} Source_Reader;
+
+static size_t read_source(void *reader, char *buffer, size_t capacity)
+{
+    Source_Reader *r = reader;
+    size_t len = r->source->len - r->pos;
+    if (len > capacity)
+    {
+        len = capacity;
+    }
+    if (len > 0)
+    {
+        memcpy(buffer, &r->source->data[r->pos], len);
+    }
+    r->pos += len;
+    return len;
+}
+
+static void print_program(const Program *program, AST_Print_Format format)
+{
+    const char *ast = program_print_ast(program, format);
+    printf("%s\n", ast);
+    free((void *) ast);
+}
+
+/// Prints the program cached for `source` at `cache_path`, if there is a usable
+/// cache. Returns false if the script has to be parsed.
+static bool print_cached_program(const char *cache_path, const Source *source, AST_Print_Format format)
+{
+    Ast_Cache cache;
+    if (!ast_cache_open(&cache, cache_path, source->data, source->len))
+    {
+        return false;
+    }
+
+    Program program = flat_ast_to_program(&cache.ast);
+    print_program(&program, format);
+    program_free(&program);
+    ast_cache_close(&cache);
+    return true;
+}
+
+/// Loads, validates and parses the script at `path`, printing its AST when
+/// `print` is set. Returns false if the script couldn't be read or has errors,
+/// which are reported on stderr.
+///
+/// With `use_cache`, a printed script's AST is read from the cache next to it
+/// when the script hasn't changed, and the cache is written after parsing it
+/// otherwise.
+static bool run_script(const char *path, AST_Print_Format format, bool print, bool use_cache)
+{
+    Source source;
+    if (!source_load(&source, path))
+    {
+        fprintf(stderr, "error: failed to read `%s`\n", path);
+        return false;
+    }
+
+    // NOTE(HS): only scripts that parsed without errors are cached, so there is
+    // nothing to report on a cache hit
+    char *cache_path = NULL;
+    if (print && use_cache && strcmp(path, "-") != 0)
+    {
+        cache_path = ast_cache_path(path);
+        if (print_cached_program(cache_path, &source, format))
+        {
+            free(cache_path);
+            source_free(&source);
+            return true;
+        }
+    }
+
+    // NOTE(HS): the lexer treats every non-ASCII byte as part of an identifier, so
+    // the whole script is checked to be UTF-8 up front
+    size_t valid = scan_utf8(source.data, source.len);
+    if (valid != source.len)
+    {
+        Line_Index lines = {0};
+        line_index_build(&lines, source.data, source.len);
+        Location loc = line_index_lookup(&lines, valid);
+        fprintf(stderr, "error: `%s` is not valid UTF-8 (line %zu, column %zu)\n", path, loc.line, loc.col);
+        line_index_free(&lines);
+        free(cache_path);
+        source_free(&source);
+        return false;
+    }
+
+    Parser parser;
+    if (print)
+    {
+        // NOTE(HS): the source is lexed in place, it is not NUL terminated
+        Lexer lexer;
+        lexer_init_n(&lexer, source.data, source.len);
+        parser_init(&parser, &lexer);
+        lexer_free(&lexer);
+
+        Program program = parser_parse_program(&parser);
+        print_program(&program, format);
+
+        if (cache_path && parser.errors.len == 0)
+        {
+            Flat_Ast ast = {0};
+            flat_ast_from_program(&ast, &program);
+            if (!ast_cache_write(cache_path, &ast, source.data, source.len))
+            {
+                fprintf(stderr, "warning: failed to write cache `%s`\n", cache_path);
+            }
+            flat_ast_free(&ast);
+        }
+        program_free(&program);
+    }
+    else
+    {
+        // NOTE(HS): only checking, so no statement needs to outlive its parse, and
+        // its tokens are lexed as they are reached rather than all up front
+        Source_Reader reader = { &source, 0 };
+        parser_init_stream(&parser, read_source, &reader);
+        parser_parse_each(&parser, skip_statement, NULL);
+    }
+
+    bool ok = parser.errors.len == 0;
+    parser_print_errors(&parser, stderr, path);
+
+    free(cache_path);
+    parser_free(&parser);
+    source_free(&source);
+
+    return ok;
+}
 
 int main(int argc, const char *argv[])
 {
-    for (int i = 0; i < argc; ++i)
+    AST_Print_Format format = PRINT_FORMAT_PLAIN;
+    bool check = false;
+    bool use_cache = false;
+    int first_path = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--yaml") == 0)
+        {
+            format = PRINT_FORMAT_YAML;
+        }
+        else if (strcmp(argv[i], "--check") == 0)
+        {
+            check = true;
+        }
+        else if (strcmp(argv[i], "--cache") == 0)
+        {
+            use_cache = true;
+        }
+        else
+        {
+            first_path = i;
+            break;
+        }
+    }
+
+    int path_count = first_path > 0 ? argc - first_path : 0;
+    if (path_count == 0 || (!check && path_count > 1))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // NOTE(HS): a script with errors doesn't stop the others from being checked
+    int failed = 0;
+    for (int i = first_path; i < argc; ++i)
+    {
+        if (!run_script(argv[i], format, !check, use_cache))
+        {
+            failed += 1;
+        }
+    }
+
+    if (check && path_count > 1)
     {
-        printf("argv[%i] = %s\n", i, argv[i]);
+        fprintf(stderr, "%d of %d scripts failed\n", failed, path_count);
     }
 
-    return 0;
+    return failed == 0 ? 0 : 1;
 }
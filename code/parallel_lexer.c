@@ -0,0 +1,303 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "lexer_internal.h"
+#include "parallel_lexer.h"
+#include "scan.h"
+#include "tthreads.h"
+
+typedef struct
+{
+    const char *input;
+    size_t input_len;
+    /// the chunk is `[start, end)`, `start` is always just after a `\n`
+    size_t start;
+    size_t end;
+    bool is_last;
+
+    /// pass 1: whether the chunk ends inside a string, for each starting state
+    bool exit_inside[2];
+
+    /// pass 2: the state to lex the chunk in, and the results
+    bool entry_inside;
+    size_t resume;
+    size_t lexed_end;
+    Token_Buffer tokens;
+} Lex_Chunk;
+
+/// Tracks only whether each byte is inside a string literal, following the same
+/// rules as `lexer_read_string`: a `"` outside a string opens one, and inside a
+/// string a backslash escapes the next byte and `"` closes it. No other token can
+/// contain a `"`.
+///
+/// NOTE(HS): chunks end just after a newline, so an escape never straddles two.
+static bool chunk_string_state(const char *input, size_t start, size_t end, bool inside)
+{
+    size_t i = start;
+    for (;;)
+    {
+        i += scan_string(&input[i], end - i);
+        if (i >= end)
+        {
+            return inside;
+        }
+
+        if (input[i] == '\"')
+        {
+            inside = !inside;
+        }
+        else if (inside && i + 1 < end)
+        {
+            i += 1;
+        }
+        i += 1;
+    }
+}
+
+/// Position just past the quote closing a string that is open at `start`.
+static size_t chunk_string_close(const char *input, size_t input_len, size_t start)
+{
+    size_t i = start;
+    for (;;)
+    {
+        i += scan_string(&input[i], input_len - i);
+        if (i >= input_len)
+        {
+            return input_len;
+        }
+
+        if (input[i] == '\"')
+        {
+            return i + 1;
+        }
+        i = i + 2 < input_len ? i + 2 : input_len;
+    }
+}
+
+static void chunk_scan_states(void *arg)
+{
+    Lex_Chunk *chunk = arg;
+    chunk->exit_inside[false] = chunk_string_state(chunk->input, chunk->start, chunk->end, false);
+    chunk->exit_inside[true] = chunk_string_state(chunk->input, chunk->start, chunk->end, true);
+}
+
+/// Lexes every token starting in the chunk, and for the last chunk the EOF token.
+static void chunk_lex(void *arg)
+{
+    Lex_Chunk *chunk = arg;
+
+    chunk->resume = chunk->entry_inside
+        ? chunk_string_close(chunk->input, chunk->input_len, chunk->start)
+        : chunk->start;
+
+    // NOTE(HS): the lexer sees the whole input, so the final token of the chunk may
+    // run on past its end (i.e. a string spanning lines)
+    Lexer lexer;
+    lexer_init_n(&lexer, chunk->input, chunk->input_len);
+    lexer_seek(&lexer, chunk->resume);
+
+    chunk->tokens = (Token_Buffer) {0};
+    chunk->tokens.input = chunk->input;
+    chunk->tokens.input_len = chunk->input_len;
+    token_buffer_reserve(&chunk->tokens, ((chunk->end - chunk->start) / 4) + 16);
+
+    for (;;)
+    {
+        size_t before = lexer.pos;
+        Token t = lexer_next_token(&lexer);
+        if (!chunk->is_last && (t.kind == TK_EOF || t.location.pos >= chunk->end))
+        {
+            chunk->lexed_end = before;
+            break;
+        }
+
+        token_buffer_push(&chunk->tokens, &t);
+        if (t.kind == TK_EOF)
+        {
+            chunk->lexed_end = lexer.pos;
+            break;
+        }
+    }
+
+    // NOTE(HS): the strings decoded are those of the chunk's tokens
+    chunk->tokens.strings = lexer.strings;
+    lexer.strings = (Token_Strings) {0};
+    lexer_free(&lexer);
+}
+
+static void token_buffer_append(Token_Buffer *dst, const Token_Buffer *src)
+{
+    token_buffer_reserve(dst, dst->len + src->len);
+    memcpy(&dst->kinds[dst->len], src->kinds, sizeof(uint8_t) * src->len);
+    memcpy(&dst->offsets[dst->len], src->offsets, sizeof(uint32_t) * src->len);
+    memcpy(&dst->lengths[dst->len], src->lengths, sizeof(uint32_t) * src->len);
+    memcpy(&dst->values[dst->len], src->values, sizeof(uint32_t) * src->len);
+
+    // NOTE(HS): decoded strings are moved over after `dst`'s own, so their
+    // offsets move up by as much
+    if (src->strings.len > 0)
+    {
+        Token_Strings *strings = &dst->strings;
+        size_t base = strings->len;
+        assert(base + src->strings.len <= UINT32_MAX && "Too many decoded strings for 32-bit offsets");
+        if (base + src->strings.len > strings->capacity)
+        {
+            char *elements = realloc(strings->elements, base + src->strings.len);
+            assert(elements && "Failed to allocate decoded strings");
+            strings->elements = elements;
+            strings->capacity = base + src->strings.len;
+        }
+        memcpy(&strings->elements[base], src->strings.elements, src->strings.len);
+        strings->len += src->strings.len;
+
+        for (size_t i = dst->len; i < dst->len + src->len; ++i)
+        {
+            if (dst->kinds[i] == TK_STRING_LIT && dst->values[i] != 0)
+            {
+                dst->values[i] += (uint32_t) base;
+            }
+        }
+    }
+    dst->len += src->len;
+}
+
+Parallel_Lexer_Config parallel_lexer_default_config(void)
+{
+    return (Parallel_Lexer_Config) {
+        .thread_count = 0,
+        .min_input_size = PARALLEL_LEXER_DEFAULT_MIN_SIZE,
+    };
+}
+
+void lexer_tokenize_parallel(Lexer *lexer, Token_Buffer *tokens, const Parallel_Lexer_Config *config)
+{
+    assert(lexer);
+    assert(tokens);
+    assert(lexer->input_len < UINT32_MAX && "Input too large for token buffer offsets");
+
+    Parallel_Lexer_Config cfg = config ? *config : parallel_lexer_default_config();
+    size_t thread_count = cfg.thread_count > 0 ? cfg.thread_count : thread_hardware_count();
+
+    const char *input = lexer->input;
+    size_t input_len = lexer->input_len;
+    size_t start = lexer->pos < input_len ? lexer->pos : input_len;
+    size_t remaining = input_len - start;
+
+    if (thread_count < 2 || remaining < cfg.min_input_size || remaining < thread_count)
+    {
+        lexer_tokenize_all(lexer, tokens);
+        return;
+    }
+
+    Lex_Chunk *chunks = calloc(thread_count, sizeof(Lex_Chunk));
+    assert(chunks && "Failed to allocate lexer chunks");
+
+    // NOTE(HS): split into roughly equal chunks, each moved forward to start on a
+    // new line. Chunks may end up empty if lines are very long.
+    size_t chunk_start = start;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        size_t chunk_end = input_len;
+        if (i + 1 < thread_count)
+        {
+            size_t target = start + ((remaining / thread_count) * (i + 1));
+            if (target < chunk_start)
+            {
+                target = chunk_start;
+            }
+            const char *nl = memchr(&input[target], '\n', input_len - target);
+            chunk_end = nl ? (size_t) (nl - input) + 1 : input_len;
+        }
+
+        chunks[i] = (Lex_Chunk) {
+            .input = input,
+            .input_len = input_len,
+            .start = chunk_start,
+            .end = chunk_end,
+            .is_last = i + 1 == thread_count,
+        };
+        chunk_start = chunk_end;
+    }
+
+    // pass 1: which state does each chunk end in, given either starting state
+    thread_run_each(chunk_scan_states, chunks, sizeof(Lex_Chunk), thread_count);
+
+    // stitch the states together to find each chunk's real starting state
+    bool inside = false;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        chunks[i].entry_inside = inside;
+        inside = chunks[i].exit_inside[inside];
+    }
+
+    // pass 2: lex each chunk from its real starting state
+    thread_run_each(chunk_lex, chunks, sizeof(Lex_Chunk), thread_count);
+
+    tokens->len = 0;
+    line_index_free(&tokens->lines);
+    tokens->input = input;
+    tokens->input_len = input_len;
+    tokens->strings.len = 0;
+    tokens->strings_dead = 0;
+
+    size_t total = 0;
+    for (size_t i = 0; i < thread_count; ++i)
+    {
+        total += chunks[i].tokens.len;
+    }
+    token_buffer_reserve(tokens, total);
+
+    // NOTE(HS): each chunk must pick up exactly where the previous one finished,
+    // i.e. after the string spanning into it, or anywhere in the whitespace
+    // before its start. If not, lex the rest sequentially to be safe.
+    size_t lexed_end = start;
+    size_t i = 0;
+    for (; i < thread_count; ++i)
+    {
+        Lex_Chunk *chunk = &chunks[i];
+        bool aligned = chunk->entry_inside
+            ? lexed_end == chunk->resume
+            : lexed_end <= chunk->start;
+        if (!aligned)
+        {
+            break;
+        }
+
+        token_buffer_append(tokens, &chunk->tokens);
+        if (chunk->tokens.len > 0)
+        {
+            lexed_end = chunk->lexed_end;
+        }
+    }
+
+    if (i < thread_count)
+    {
+        Lexer rest;
+        lexer_init_n(&rest, input, input_len);
+        lexer_seek(&rest, lexed_end);
+        rest.strings = tokens->strings;
+
+        Token t;
+        do
+        {
+            t = lexer_next_token(&rest);
+            token_buffer_push(tokens, &t);
+        } while (t.kind != TK_EOF);
+
+        tokens->strings = rest.strings;
+        rest.strings = (Token_Strings) {0};
+        lexer_free(&rest);
+    }
+
+    for (size_t j = 0; j < thread_count; ++j)
+    {
+        token_buffer_free(&chunks[j].tokens);
+    }
+    free(chunks);
+
+    lexer_seek(lexer, input_len);
+}
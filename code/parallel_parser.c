@@ -0,0 +1,211 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "containers.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "parser_internal.h"
+#include "tthreads.h"
+
+typedef struct
+{
+    Token_Buffer *tokens;
+    bool lazy_function_bodies;
+    size_t max_expression_depth;
+    size_t max_nesting_depth;
+    /// the segment is the statements starting in tokens `[start, end)`
+    size_t start;
+    size_t end;
+
+    /// results, `parsed_end` being the token after the last statement parsed
+    Statement_Array statements;
+    Parse_Error_Array errors;
+    Arena arena;
+    size_t parsed_end;
+} Parse_Segment;
+
+static void segment_parse(void *arg)
+{
+    Parse_Segment *segment = arg;
+
+    Parser p;
+    parser_init_tokens(&p, segment->tokens);
+    p.lazy_function_bodies = segment->lazy_function_bodies;
+    p.max_expression_depth = segment->max_expression_depth;
+    p.max_nesting_depth = segment->max_nesting_depth;
+    p.arena = &segment->arena;
+    p.cur = segment->start;
+
+    da_init(Statement, &segment->statements);
+    parse_statements(&p, &segment->statements, segment->end);
+    segment->parsed_end = p.cur;
+
+    // NOTE(HS): moved out of the parser before it is freed
+    segment->errors = p.errors;
+    p.errors = (Parse_Error_Array) {0};
+    p.arena = NULL;
+    parser_free(&p);
+}
+
+/// Splits the tokens from `start` into up to `count` segments, each starting just
+/// after a `;` ending a top level statement, writing their starts to `starts`.
+/// Returns the number of segments.
+///
+/// NOTE(HS): `return;` is the one statement the parser doesn't end at its `;`
+static size_t split_segments(const Token_Buffer *tokens, size_t start, size_t count, size_t *starts)
+{
+    const uint8_t *kinds = tokens->kinds;
+    size_t len = tokens->len;
+    size_t per_segment = (len - start) / count;
+
+    size_t segments = 1;
+    starts[0] = start;
+    size_t target = start + per_segment;
+
+    size_t depth = 0;
+    for (size_t i = start; i < len && segments < count; ++i)
+    {
+        switch ((Token_Kind) kinds[i])
+        {
+            case TK_LBRACE:
+            case TK_LPAREN:
+            {
+                depth += 1;
+            } break;
+
+            case TK_RBRACE:
+            case TK_RPAREN:
+            {
+                if (depth > 0)
+                {
+                    depth -= 1;
+                }
+            } break;
+
+            case TK_SEMICOLON:
+            {
+                if (depth == 0 && i + 1 >= target && (i == 0 || kinds[i - 1] != TK_RETURN))
+                {
+                    starts[segments] = i + 1;
+                    segments += 1;
+                    target = i + 1 + per_segment;
+                }
+            } break;
+
+            default:
+            {} break;
+        }
+    }
+    return segments;
+}
+
+Parallel_Parser_Config parallel_parser_default_config(void)
+{
+    return (Parallel_Parser_Config) {
+        .thread_count = 0,
+        .min_token_count = PARALLEL_PARSER_DEFAULT_MIN_TOKENS,
+    };
+}
+
+Program parser_parse_program_parallel(Parser *p, const Parallel_Parser_Config *config)
+{
+    assert(p);
+
+    Parallel_Parser_Config cfg = config ? *config : parallel_parser_default_config();
+    size_t thread_count = cfg.thread_count > 0 ? cfg.thread_count : thread_hardware_count();
+
+    size_t start = p->cur;
+    size_t remaining = p->tokens->len - start;
+    if (thread_count < 2 || remaining < cfg.min_token_count || remaining < thread_count)
+    {
+        return parser_parse_program(p);
+    }
+
+    size_t *starts = malloc(sizeof(size_t) * thread_count);
+    assert(starts && "Failed to allocate parser segment starts");
+    size_t segment_count = split_segments(p->tokens, start, thread_count, starts);
+
+    Parse_Segment *segments = calloc(segment_count, sizeof(Parse_Segment));
+    assert(segments && "Failed to allocate parser segments");
+    for (size_t i = 0; i < segment_count; ++i)
+    {
+        segments[i] = (Parse_Segment) {
+            .tokens = p->tokens,
+            .lazy_function_bodies = p->lazy_function_bodies,
+            .max_expression_depth = p->max_expression_depth,
+            .max_nesting_depth = p->max_nesting_depth,
+            .start = starts[i],
+            .end = i + 1 < segment_count ? starts[i + 1] : p->tokens->len,
+        };
+    }
+    free(starts);
+
+    thread_run_each(segment_parse, segments, sizeof(Parse_Segment), segment_count);
+
+    Program prog = {0};
+    size_t total = 0;
+    for (size_t i = 0; i < segment_count; ++i)
+    {
+        total += segments[i].statements.len;
+    }
+    prog.statements = (Statement_Array) {
+        .capacity = total > 0 ? total : 1,
+        .len = 0,
+        .elements = malloc(sizeof(Statement) * (total > 0 ? total : 1)),
+    };
+    assert(prog.statements.elements && "Failed to allocate program statements");
+
+    p->errors.len = 0;
+    p->panicking = false;
+
+    // NOTE(HS): the first segment starts where the sequential parse would, and
+    // every statement of a segment starting at a statement boundary is the same
+    // as the sequential parse's. The next segment starts at a boundary too if
+    // the previous one ended exactly on its start.
+    size_t i = 0;
+    for (; i < segment_count; ++i)
+    {
+        Parse_Segment *segment = &segments[i];
+        memcpy(&prog.statements.elements[prog.statements.len],
+            segment->statements.elements,
+            sizeof(Statement) * segment->statements.len);
+        prog.statements.len += segment->statements.len;
+
+        for (size_t j = 0; j < segment->errors.len; ++j)
+        {
+            da_append(Parse_Error, &p->errors, &segment->errors.elements[j]);
+        }
+        arena_adopt(&prog.arena, &segment->arena);
+
+        if (i + 1 < segment_count && segment->parsed_end != segments[i + 1].start)
+        {
+            break;
+        }
+    }
+
+    if (i < segment_count)
+    {
+        p->cur = segments[i].parsed_end;
+        p->arena = &prog.arena;
+        parse_statements(p, &prog.statements, p->tokens->len);
+        p->arena = NULL;
+    }
+    else
+    {
+        p->cur = segments[segment_count - 1].parsed_end;
+    }
+
+    for (size_t j = 0; j < segment_count; ++j)
+    {
+        da_free(&segments[j].statements);
+        da_free(&segments[j].errors);
+        arena_free(&segments[j].arena);
+    }
+    free(segments);
+
+    return prog;
+}
@@ -1,57 +1,390 @@
 #include <assert.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "containers.h"
 #include "ast.h"
+#include "lexer_internal.h"
 #include "parser.h"
 #include "parser_internal.h"
+#include "stream_lexer.h"
+
+// NOTE(HS): indexed by token kind, adding an operator is adding its row here
+static const Parse_Rule parse_rules[TOKEN_KIND_COUNT] = {
+    [TK_IDENT]     = { parse_ident,         EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_INT_LIT]   = { parse_int,           EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_FLOAT_LIT] = { parse_float,         EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_TRUE]      = { parse_boolean,       EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_FALSE]     = { parse_boolean,       EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_BANG]      = { NULL,                EXPRESSION_FRAME_PREFIX, LOWEST },
+    [TK_MINUS]     = { NULL,                EXPRESSION_FRAME_PREFIX, SUM },
+    [TK_LPAREN]    = { NULL,                EXPRESSION_FRAME_GROUP,  LOWEST },
+    [TK_IF]        = { parse_if_expression, EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_FUNC]      = { parse_function,      EXPRESSION_FRAME_NONE,   LOWEST },
+    [TK_PLUS]      = { NULL,                EXPRESSION_FRAME_NONE,   SUM },
+    [TK_ASTERISK]  = { NULL,                EXPRESSION_FRAME_NONE,   PRODUCT },
+    [TK_SLASH]     = { NULL,                EXPRESSION_FRAME_NONE,   PRODUCT },
+    [TK_LT]        = { NULL,                EXPRESSION_FRAME_NONE,   LESSGREATER },
+    [TK_GT]        = { NULL,                EXPRESSION_FRAME_NONE,   LESSGREATER },
+    [TK_LTE]       = { NULL,                EXPRESSION_FRAME_NONE,   LESSGREATER },
+    [TK_GTE]       = { NULL,                EXPRESSION_FRAME_NONE,   LESSGREATER },
+    [TK_EQ]        = { NULL,                EXPRESSION_FRAME_NONE,   EQUALS },
+    [TK_NEQ]       = { NULL,                EXPRESSION_FRAME_NONE,   EQUALS },
+    [TK_LAND]      = { NULL,                EXPRESSION_FRAME_NONE,   LOGICAL_AND },
+    [TK_LOR]       = { NULL,                EXPRESSION_FRAME_NONE,   LOGICAL_OR },
+};
 
 inline Operator_Precidence precidence_of(Token_Kind k)
 {
-    Operator_Precidence p;
-    switch (k)
+    return parse_rules[k].precidence;
+}
+
+inline Operator_Precidence cur_precidence(const Parser *p)
+{
+    return precidence_of(cur_token_kind(p));
+}
+
+inline Operator_Precidence peek_precidence(const Parser *p)
+{
+    return precidence_of(peek_token_kind(p));
+}
+
+void parser_init(Parser *p, Lexer *l)
+{
+    assert(p);
+    assert(l);
+
+    Token_Buffer *tokens = malloc(sizeof(Token_Buffer));
+    assert(tokens && "Failed to allocate parser token buffer");
+    *tokens = (Token_Buffer) {0};
+
+    Lexer lexer = *l;
+    lexer_tokenize_all(&lexer, tokens);
+
+    parser_init_tokens(p, tokens);
+    p->owns_tokens = true;
+}
+
+void parser_init_tokens(Parser *p, Token_Buffer *tokens)
+{
+    assert(p);
+    assert(tokens && tokens->len > 0);
+
+    *p = (Parser) {
+        .tokens = tokens,
+        .owns_tokens = false,
+        .stream = NULL,
+        .cur = 0,
+        .statement_start = 0,
+        .arena = NULL,
+        .panicking = false,
+        .max_expression_depth = PARSER_MAX_EXPRESSION_DEPTH,
+        .expression_depth = 0,
+        .max_nesting_depth = PARSER_MAX_NESTING_DEPTH,
+        .nesting_depth = 0,
+    };
+    da_init(Statement, &p->scratch_statements);
+    da_init(Ident_Expression, &p->scratch_idents);
+    da_init(Expression_Frame, &p->scratch_frames);
+    da_init(Parse_Error, &p->errors);
+}
+
+/// Appends the next token of the stream to `tokens`, the stream's window, reading
+/// more of the stream as needed.
+static void parser_stream_pull(Parser_Stream *stream, Token_Buffer *tokens)
+{
+    Token t;
+    while (!stream_lexer_next(&stream->lexer, &t))
     {
-        case TK_PLUS:     { p = SUM; } break;
-        case TK_MINUS:    { p = SUM; } break;
-        case TK_ASTERISK: { p = PRODUCT; } break;
-        case TK_SLASH:    { p = PRODUCT; } break;
-        case TK_LT:       { p = LESSGREATER; } break;
-        case TK_GT:       { p = LESSGREATER; } break;
-        case TK_EQ:       { p = EQUALS; } break;
-        case TK_NEQ:      { p = EQUALS; } break;
+        size_t len = stream->read(stream->reader, stream->chunk, PARSER_STREAM_CHUNK_SIZE);
+        if (len > 0)
+        {
+            stream_lexer_feed(&stream->lexer, stream->chunk, len);
+        }
+        else
+        {
+            stream_lexer_finish(&stream->lexer);
+        }
+    }
 
-        default:
+    // NOTE(HS): the literal views the stream lexer's buffer, which is reused by
+    // its next feed, so it is copied into the window
+    if (stream->text_len + t.literal.length > stream->text_capacity)
+    {
+        size_t new_capacity = stream->text_capacity * 2;
+        while (stream->text_len + t.literal.length > new_capacity)
         {
-            p = LOWEST;
-        } break;
+            new_capacity *= 2;
+        }
+
+        char *text = realloc(stream->text, new_capacity);
+        assert(text && "Failed to grow parser stream text");
+        stream->text = text;
+        stream->text_capacity = new_capacity;
+        tokens->input = text;
     }
-    return p;
+    assert(stream->text_len + t.literal.length < UINT32_MAX && "Statement too large for token buffer offsets");
+
+    if (t.literal.length > 0)
+    {
+        memcpy(&stream->text[stream->text_len], t.literal.str, t.literal.length);
+    }
+    if (t.kind == TK_STRING_LIT && t.value.string != 0)
+    {
+        t.value.string = token_strings_push(&tokens->strings, t.literal);
+    }
+    t.literal.str = &stream->text[stream->text_len];
+    stream->text_len += t.literal.length;
+    tokens->input_len = stream->text_len;
+
+    token_buffer_push(tokens, &t);
+    da_append(Location, &stream->locations, &t.location);
 }
 
-inline Operator_Precidence cur_precidence(const Parser *p)
+/// Drops the tokens of the window before the current one, those of the top level
+/// statements already parsed.
+static void parser_stream_slide(Parser *p)
 {
-    return precidence_of(p->cur_token.kind);
+    Parser_Stream *stream = p->stream;
+    Token_Buffer *tokens = p->tokens;
+    size_t dropped = p->cur;
+    if (dropped == 0)
+    {
+        return;
+    }
+
+    size_t kept = tokens->len - dropped;
+    memmove(tokens->kinds, &tokens->kinds[dropped], sizeof(uint8_t) * kept);
+    memmove(tokens->offsets, &tokens->offsets[dropped], sizeof(uint32_t) * kept);
+    memmove(tokens->lengths, &tokens->lengths[dropped], sizeof(uint32_t) * kept);
+    memmove(tokens->values, &tokens->values[dropped], sizeof(uint32_t) * kept);
+    memmove(stream->locations.elements, &stream->locations.elements[dropped], sizeof(Location) * kept);
+    tokens->len = kept;
+    stream->locations.len = kept;
+
+    uint32_t text_start = tokens->offsets[0];
+    memmove(stream->text, &stream->text[text_start], stream->text_len - text_start);
+    stream->text_len -= text_start;
+    tokens->input_len = stream->text_len;
+
+    // NOTE(HS): strings are decoded in token order, so those of the tokens kept
+    // start at the first one's, just after its length
+    size_t strings_start = tokens->strings.len;
+    for (size_t i = 0; i < kept; ++i)
+    {
+        if (tokens->kinds[i] == TK_STRING_LIT && tokens->values[i] != 0)
+        {
+            strings_start = tokens->values[i] - sizeof(uint32_t);
+            break;
+        }
+    }
+    if (strings_start > 0)
+    {
+        memmove(tokens->strings.elements, &tokens->strings.elements[strings_start], tokens->strings.len - strings_start);
+        tokens->strings.len -= strings_start;
+    }
+
+    for (size_t i = 0; i < kept; ++i)
+    {
+        tokens->offsets[i] -= text_start;
+        if (tokens->kinds[i] == TK_STRING_LIT && tokens->values[i] != 0)
+        {
+            tokens->values[i] -= (uint32_t) strings_start;
+        }
+    }
+
+    stream->dropped += dropped;
+    p->cur = 0;
+    p->statement_start = 0;
 }
 
-inline Operator_Precidence peek_precidence(const Parser *p)
+void parser_init_stream(Parser *p, Parse_Read_Fn read, void *reader)
 {
-    return precidence_of(p->peek_token.kind);
+    assert(p);
+    assert(read);
+
+    Parser_Stream *stream = malloc(sizeof(Parser_Stream));
+    assert(stream && "Failed to allocate parser stream");
+    stream->read = read;
+    stream->reader = reader;
+    stream->text_len = 0;
+    stream->text_capacity = DA_DEFAULT_CAPACITY;
+    stream->text = malloc(stream->text_capacity);
+    assert(stream->text && "Failed to allocate parser stream text");
+    stream->dropped = 0;
+    stream_lexer_init(&stream->lexer);
+    da_init(Location, &stream->locations);
+    da_init(Parse_Error_Site, &stream->error_sites);
+
+    Token_Buffer *tokens = malloc(sizeof(Token_Buffer));
+    assert(tokens && "Failed to allocate parser token buffer");
+    *tokens = (Token_Buffer) {0};
+    tokens->input = stream->text;
+
+    // NOTE(HS): the token after the current one is always in the window, until EOF
+    parser_stream_pull(stream, tokens);
+    if (tokens->kinds[0] != TK_EOF)
+    {
+        parser_stream_pull(stream, tokens);
+    }
+
+    parser_init_tokens(p, tokens);
+    p->owns_tokens = true;
+    p->stream = stream;
 }
 
-void parser_init(Parser *p, Lexer *l)
+void parser_free(Parser *p)
 {
+    if (p->owns_tokens && p->tokens)
+    {
+        token_buffer_free(p->tokens);
+        free(p->tokens);
+    }
+    if (p->stream)
+    {
+        stream_lexer_free(&p->stream->lexer);
+        free(p->stream->text);
+        da_free(&p->stream->locations);
+        da_free(&p->stream->error_sites);
+        free(p->stream);
+    }
+    da_free(&p->scratch_statements);
+    da_free(&p->scratch_idents);
+    da_free(&p->scratch_frames);
+    da_free(&p->errors);
     *p = (Parser) {0};
-    p->lexer = *l;
-    parser_next_token(p);
-    parser_next_token(p);
+}
+
+const char *parse_error_kind_to_str(Parse_Error_Kind kind)
+{
+    const char *res = NULL;
+    switch (kind)
+    {
+        #define X(NAME) case PARSE_ERROR_##NAME: { res = #NAME; } break;
+        PARSE_ERROR_KIND_LIST
+        #undef X
+    }
+    return res;
+}
+
+void parser_error(Parser *p, Parse_Error_Kind kind, size_t token, Token_Kind expected)
+{
+    if (p->panicking)
+    {
+        return;
+    }
+    p->panicking = true;
+
+    Parse_Error error = {
+        .kind = kind,
+        .token = token,
+        .expected = expected,
+    };
+
+    // NOTE(HS): over a stream, the token is likely to be dropped before the error
+    // is reported, so where it was is kept
+    if (p->stream)
+    {
+        Parse_Error_Site site = {
+            .location = p->stream->locations.elements[token],
+            .found = (Token_Kind) p->tokens->kinds[token],
+        };
+        da_append(Parse_Error_Site, &p->stream->error_sites, &site);
+        error.token += p->stream->dropped;
+    }
+    da_append(Parse_Error, &p->errors, &error);
+}
+
+void parser_synchronize(Parser *p, size_t start)
+{
+    // NOTE(HS): the caller steps past the token we stop on. A `}` we failed on is
+    // the end of the enclosing block, unless it is all the statement has, so step
+    // back to leave it for the block.
+    if (cur_token_is(p, TK_RBRACE))
+    {
+        if (p->cur > start)
+        {
+            p->cur -= 1;
+        }
+        return;
+    }
+
+    // NOTE(HS): blocks of the statement we skip over are skipped whole
+    size_t depth = 0;
+    while (!cur_token_is(p, TK_EOF))
+    {
+        if (cur_token_is(p, TK_LBRACE))
+        {
+            depth += 1;
+        }
+        else if (cur_token_is(p, TK_RBRACE) && depth > 0)
+        {
+            depth -= 1;
+        }
+
+        if (depth == 0 && (cur_token_is(p, TK_SEMICOLON) || peek_token_is(p, TK_RBRACE)))
+        {
+            break;
+        }
+        parser_next_token(p);
+    }
+}
+
+/// Clears the errors of the last parse.
+static void parser_clear_errors(Parser *p)
+{
+    p->errors.len = 0;
+    if (p->stream)
+    {
+        p->stream->error_sites.len = 0;
+    }
+}
+
+void parser_print_errors(Parser *p, FILE *out, const char *name)
+{
+    for (size_t i = 0; i < p->errors.len; ++i)
+    {
+        const Parse_Error *error = &p->errors.elements[i];
+        Location loc;
+        const char *found;
+        if (p->stream)
+        {
+            loc = p->stream->error_sites.elements[i].location;
+            found = token_kind_to_string(p->stream->error_sites.elements[i].found);
+        }
+        else
+        {
+            loc = token_buffer_location(p->tokens, error->token);
+            found = token_kind_to_string((Token_Kind) p->tokens->kinds[error->token]);
+        }
+
+        fprintf(out, "%s:%zu:%zu: error: ", name, loc.line, loc.col);
+        switch (error->kind)
+        {
+            case PARSE_ERROR_EXPECTED_TOKEN:
+            {
+                fprintf(out, "expected %s, found %s\n", token_kind_to_string(error->expected), found);
+            } break;
+
+            case PARSE_ERROR_EXPECTED_EXPRESSION:
+            {
+                fprintf(out, "expected an expression, found %s\n", found);
+            } break;
+
+            case PARSE_ERROR_EXPRESSION_TOO_DEEP:
+            {
+                fprintf(out, "expression nested too deeply at %s\n", found);
+            } break;
+        }
+    }
 }
 
 const char *ast_statement_kind_to_str(Statement_Kind k)
 {
-    const char *res;
+    const char *res = NULL;
     switch (k)
     {
         #define X(NAME) case AST_##NAME: { res = #NAME; } break;
@@ -63,7 +396,7 @@ const char *ast_statement_kind_to_str(Statement_Kind k)
 
 const char *ast_expression_kind_to_str(Expression_Kind k)
 {
-    const char *res;
+    const char *res = NULL;
     switch (k)
     {
         #define X(NAME) case AST_##NAME: { res = #NAME; } break;
@@ -75,18 +408,58 @@ const char *ast_expression_kind_to_str(Expression_Kind k)
 
 void parser_next_token(Parser *p)
 {
-    p->cur_token = p->peek_token;
-    p->peek_token = lexer_next_token(&p->lexer);
+    // NOTE(HS): the buffer always ends in EOF, which the parser never moves past
+    if (p->cur + 1 < p->tokens->len)
+    {
+        p->cur += 1;
+    }
+
+    // NOTE(HS): a window onto a stream only ends in EOF once it reaches the end,
+    // until then the token after the current one is lexed as it is reached
+    if (p->cur + 1 == p->tokens->len && p->stream && p->tokens->kinds[p->cur] != TK_EOF)
+    {
+        parser_stream_pull(p->stream, p->tokens);
+    }
+}
+
+inline Token_Kind cur_token_kind(const Parser *p)
+{
+    return (Token_Kind) p->tokens->kinds[p->cur];
+}
+
+inline Token_Kind peek_token_kind(const Parser *p)
+{
+    size_t peek = p->cur + 1;
+    return peek < p->tokens->len ? (Token_Kind) p->tokens->kinds[peek] : TK_EOF;
+}
+
+inline String_View cur_token_literal(const Parser *p)
+{
+    return string_view_from_cstr_offset(
+        p->tokens->input,
+        p->tokens->offsets[p->cur],
+        p->tokens->lengths[p->cur]
+    );
+}
+
+inline Token_Value cur_token_value(const Parser *p)
+{
+    return (Token_Value) { .bits = p->tokens->values[p->cur] };
+}
+
+Token cur_token(const Parser *p)
+{
+    return token_buffer_get(p->tokens, p->cur);
 }
 
 inline bool cur_token_is(Parser *p, Token_Kind kind)
 {
-    return p->cur_token.kind == kind;
+    return cur_token_kind(p) == kind;
 }
 
 inline bool peek_token_is(Parser *p, Token_Kind kind)
 {
-    return p->peek_token.kind == kind;
+    return peek_token_kind(p) == kind;
 }
 
 inline bool expect_peek(Parser *p, Token_Kind kind)
@@ -98,90 +471,142 @@ inline bool expect_peek(Parser *p, Token_Kind kind)
     }
     else
     {
+        size_t peek = p->cur + 1 < p->tokens->len ? p->cur + 1 : p->cur;
+        parser_error(p, PARSE_ERROR_EXPECTED_TOKEN, peek, kind);
         return false;
     }
 }
 
+void parse_statements(Parser *p, Statement_Array *statements, size_t end)
+{
+    while (p->cur < end && !cur_token_is(p, TK_EOF))
+    {
+        Statement stmt;
+        parse_next_statement(p, &stmt);
+        da_append(Statement, statements, &stmt);
+    }
+}
+
 Program parser_parse_program(Parser *p)
 {
     Program prog = {0};
     da_init(Statement, &prog.statements);
+    p->arena = &prog.arena;
+    parser_clear_errors(p);
+    p->panicking = false;
 
-    while (p->cur_token.kind != TK_EOF)
-    {
-        Statement stmt;
-        parse_statement(p, &stmt);
-        da_append(Statement, &prog.statements, &stmt);
-        parser_next_token(p);
-    }
+    // NOTE(HS): over a stream, the buffer only ends at EOF once it has been reached
+    parse_statements(p, &prog.statements, SIZE_MAX);
 
+    // NOTE(HS): the arena is moved out with the program
+    p->arena = NULL;
     return prog;
 }
 
 void program_free(Program *prog)
 {
-    // TODO(HS): iterate over all statements and free linked memory, **then** free
-    // the program
     da_free(&prog->statements);
+    arena_free(&prog->arena);
 }
 
-// TODO(HS): stress test this & make sure it doesn't actually leak
-void expression_free(Expression *expr)
+bool parser_parse_next_statement(Parser *p, Arena *arena, Statement *stmt)
 {
-    if (!expr) { return; }
+    assert(p && arena && stmt);
+    if (p->stream)
+    {
+        parser_stream_slide(p);
+    }
+    if (cur_token_is(p, TK_EOF))
+    {
+        return false;
+    }
+
+    Arena *prev_arena = p->arena;
+    p->arena = arena;
+    p->panicking = false;
+
+    parse_next_statement(p, stmt);
 
-    switch (expr->kind)
+    p->arena = prev_arena;
+    return true;
+}
+
+size_t parser_parse_each(Parser *p, Parse_Statement_Fn fn, void *user)
+{
+    assert(p && fn);
+    parser_clear_errors(p);
+
+    // NOTE(HS): one arena for every statement, reset rather than freed between
+    // them so its block is reused
+    Arena arena = {0};
+    size_t count = 0;
+    Statement stmt;
+    while (parser_parse_next_statement(p, &arena, &stmt))
     {
-        case AST_PREFIX_EXPRESSION:
+        count += 1;
+        bool more = fn(p, &stmt, &arena, user);
+        arena_reset(&arena);
+        if (!more)
         {
-            expression_free(expr->expr.prefix_expression.rhs);
-            free(expr->expr.prefix_expression.rhs);
-        } break;
+            break;
+        }
+    }
 
-        case AST_INFIX_EXPRESSION:
-        {
-            expression_free(expr->expr.infix_expression.lhs);
-            free(expr->expr.infix_expression.lhs);
-            expression_free(expr->expr.infix_expression.rhs);
-            free(expr->expr.infix_expression.rhs);
-        } break;
+    arena_free(&arena);
+    return count;
+}
 
-        default:
-        {} break;
-    }
+/// Copies `expr` into the program's arena.
+static Expression *parser_new_expression(Parser *p, const Expression *expr)
+{
+    assert(p->arena && "Parser has no program to allocate from");
+    Expression *node = arena_new(p->arena, Expression);
+    memcpy(node, expr, sizeof(Expression));
+    return node;
 }
 
-// TODO(HS): improve this for errors
-Statement make_illegal(Parser *p)
+/// Copies `block` into the program's arena.
+static Block_Statement *parser_new_block(Parser *p, const Block_Statement *block)
+{
+    assert(p->arena && "Parser has no program to allocate from");
+    Block_Statement *node = arena_new(p->arena, Block_Statement);
+    memcpy(node, block, sizeof(Block_Statement));
+    return node;
+}
+
+Statement make_illegal(Parser *p, size_t token)
 {
     Statement stmt;
     stmt.kind = AST_ILLGEAL_STATEMENT;
-    stmt.stmt.illegal_statement = (Illegal_statement){ p->cur_token };
+    stmt.stmt.illegal_statement = (Illegal_statement){ token_buffer_get(p->tokens, token) };
+
+    // NOTE(HS): a stream's window moves as it grows, so the literal is copied
+    if (p->stream)
+    {
+        Token *illegal = &stmt.stmt.illegal_statement.token;
+        illegal->location = p->stream->locations.elements[token];
+        illegal->literal.str = arena_strndup(p->arena, illegal->literal.str, illegal->literal.length);
+    }
     return stmt;
 }
 
-void ast_free_node(Statement *stmt)
+void parse_next_statement(Parser *p, Statement *stmt)
 {
-    switch (stmt->kind)
-    {
-        case AST_VAR_STATEMENT:
-        {
-            free((void*) stmt->stmt.var_statement.ident);
-        } break;
-
-        case AST_RETURN_STATEMENT:
-        {} break;
+    size_t start = p->cur;
+    parse_statement(p, stmt);
+    parser_next_token(p);
 
-        default:
-        {
-            assert(0 && "Invalid statement kind to free");
-        }
-    }
+    assert(p->cur - start <= UINT32_MAX && "Statement too long");
+    stmt->token_count = (uint32_t) (p->cur - start);
 }
 
 void parse_statement(Parser *p, Statement *stmt)
 {
-    switch (p->cur_token.kind)
+    size_t start = p->cur;
+    size_t enclosing_start = p->statement_start;
+    p->statement_start = start;
+
+    switch (cur_token_kind(p))
     {
         case TK_VAR:
         {
@@ -198,35 +623,43 @@ void parse_statement(Parser *p, Statement *stmt)
             parse_expression_statement(p, stmt);
         } break;
     }
+
+    if (p->panicking)
+    {
+        *stmt = make_illegal(p, start);
+        parser_synchronize(p, start);
+        p->panicking = false;
+    }
+    p->statement_start = enclosing_start;
 }
 
-// TODO(HS): better allocation strategy for idents
 void parse_var_statement(Parser *p, Statement *stmt)
 {
-    // TODO(HS): return error
     if (!expect_peek(p, TK_IDENT))
-    {}
+    {
+        return;
+    }
 
     stmt->kind = AST_VAR_STATEMENT;
 
-    size_t slen = p->cur_token.literal.length;
-    char *buffer = malloc(sizeof(char) * (slen + 1));
-    strncpy(buffer, p->cur_token.literal.str, slen);
-    buffer[p->cur_token.literal.length] = '\0';
-
+    Symbol symbol = cur_token_value(p).symbol;
     stmt->stmt.var_statement = (Var_Statement) {
-        .ident = buffer,
+        .ident = symbol_to_cstr(symbol),
+        .symbol = symbol,
     };
 
-    // TODO(HS): return error
     if (!expect_peek(p, TK_ASSIGN))
     {
-        free(buffer);
+        return;
     }
 
     parser_next_token(p);
 
     parse_expression(p, &stmt->stmt.var_statement.expression, LOWEST);
+    if (p->panicking)
+    {
+        return;
+    }
 
     if (peek_token_is(p, TK_SEMICOLON))
     {
@@ -247,8 +680,11 @@ void parse_return_statement(Parser *p, Statement *stmt)
     }
 
     parse_expression(p, &stmt->stmt.return_statement.expression, LOWEST);
+    if (p->panicking)
+    {
+        return;
+    }
 
-    // TODO(HS): errors
     if (peek_token_is(p, TK_SEMICOLON))
     {
         parser_next_token(p);
@@ -259,6 +695,10 @@ void parse_expression_statement(Parser *p, Statement *stmt)
 {
     Expression expr;
     parse_expression(p, &expr, LOWEST);
+    if (p->panicking)
+    {
+        return;
+    }
 
     *stmt = (Statement) {
         .kind = AST_EXPRESSION_STATEMENT,
@@ -273,202 +713,198 @@ void parse_expression_statement(Parser *p, Statement *stmt)
     }
 }
 
-void parse_expression(Parser *p, Expression *expr, Operator_Precidence precidence)
+/// Opens one more level of expression nesting, reporting an error at the current
+/// token if that is more than the parser allows.
+static bool parser_enter_expression(Parser *p)
 {
-    switch (p->cur_token.kind)
+    if (p->expression_depth >= p->max_expression_depth)
     {
-        case TK_IDENT:
-        {
-            expr->kind = AST_IDENT_EXPRESSION;
-            parse_ident(p, expr);
-        } break;
+        parser_error(p, PARSE_ERROR_EXPRESSION_TOO_DEEP, p->cur, TK_ILLEGAL);
+        return false;
+    }
+    p->expression_depth += 1;
+    return true;
+}
 
-        case TK_INT_LIT:
+/// Completes the operator of `frame` with the operand just parsed, `expr`.
+static void parser_complete_frame(Parser *p, const Expression_Frame *frame, Expression *expr)
+{
+    switch (frame->kind)
+    {
+        case EXPRESSION_FRAME_PREFIX:
         {
-            expr->kind = AST_INT_EXPRESSION;
-            parse_int(p, expr);
+            assert((frame->op == TK_MINUS || frame->op == TK_BANG) && "Invalid prefix operator");
+            Expression *rhs = parser_new_expression(p, expr);
+            *expr = (Expression) {
+                .kind = AST_PREFIX_EXPRESSION,
+                .expr.prefix_expression = {
+                    .op = frame->op == TK_MINUS ? '-' : '!',
+                    .rhs = rhs,
+                }
+            };
         } break;
 
-        case TK_FLOAT_LIT:
+        case EXPRESSION_FRAME_INFIX:
         {
-            expr->kind = AST_FLOAT_EXPRESSION;
-            parse_float(p, expr);
+            Expression *lhs = parser_new_expression(p, &frame->lhs);
+            Expression *rhs = parser_new_expression(p, expr);
+            *expr = (Expression) {
+                .kind = AST_INFIX_EXPRESSION,
+                .expr.infix_expression = {
+                    .op = frame->op,
+                    .lhs = lhs,
+                    .rhs = rhs,
+                }
+            };
         } break;
 
-        case TK_FALSE:
-        case TK_TRUE:
+        case EXPRESSION_FRAME_GROUP:
         {
-            expr->kind = AST_BOOLEAN_EXPRESSION;
-            parse_boolean(p, expr);
+            // NOTE(HS): a group is just its expression, once its `)` is there
+            expect_peek(p, TK_RPAREN);
         } break;
 
-        case TK_MINUS:
-        case TK_BANG:
+        case EXPRESSION_FRAME_NONE:
         {
-            expr->kind = AST_PREFIX_EXPRESSION;
-            parse_prefix_expression(p, expr);
+            assert(0 && "Expression frame without an operator");
         } break;
+    }
+}
 
-        case TK_LPAREN:
-        {
-            parse_grouped_expression(p, expr);
-        } break;
+// NOTE(HS): a Pratt parser with the operators waiting on their operands kept on
+// `p->scratch_frames`, rather than each having its own call. An operand is parsed
+// after the prefix operators and `(`s before it, then completes the operators on
+// the stack that bind tighter than the binary operator after it, which in turn
+// waits on its rhs. Expressions inside blocks start their own frames above ours.
+void parse_expression(Parser *p, Expression *expr, Operator_Precidence precidence)
+{
+    size_t mark = p->scratch_frames.len;
+    size_t depth = p->expression_depth;
 
-        case TK_IF:
+    // NOTE(HS): the statement is discarded on errors, but keep its expression defined
+    *expr = (Expression) {0};
+
+    // NOTE(HS): the parser only recurses through here, from the conditions and
+    // blocks of ifs and funcs, so this bounds its C stack
+    if (p->nesting_depth >= p->max_nesting_depth)
+    {
+        parser_error(p, PARSE_ERROR_EXPRESSION_TOO_DEEP, p->cur, TK_ILLEGAL);
+        return;
+    }
+    p->nesting_depth += 1;
+
+    bool more = parser_enter_expression(p);
+    while (more)
+    {
+        Token_Kind kind = cur_token_kind(p);
+        const Parse_Rule *rule = &parse_rules[kind];
+        if (rule->opens != EXPRESSION_FRAME_NONE)
         {
-            expr->kind = AST_IF_EXPRESSION;
-            parse_if_expression(p, expr);
-        } break;
+            if (!parser_enter_expression(p))
+            {
+                break;
+            }
+            Expression_Frame frame = {
+                .kind = rule->opens,
+                .op = kind,
+                .precidence = precidence,
+                .lhs = {0},
+            };
+            da_append(Expression_Frame, &p->scratch_frames, &frame);
+            precidence = rule->opens == EXPRESSION_FRAME_PREFIX ? PREFIX : LOWEST;
+            parser_next_token(p);
+            continue;
+        }
 
-        case TK_FUNC:
+        if (!rule->prefix)
         {
-            expr->kind = AST_FUNCTION_EXPRESSION;
-            parse_function(p, expr);
-        } break;
+            parser_error(p, PARSE_ERROR_EXPECTED_EXPRESSION, p->cur, TK_ILLEGAL);
+            break;
+        }
+        rule->prefix(p, expr);
 
-        default:
+        // NOTE(HS): `;` and every other non operator have a precidence of LOWEST,
+        // so they complete every frame without a separate check
+        more = false;
+        while (!p->panicking)
         {
-            fprintf(stderr, "unhandled token kind for expression: %s\n", token_kind_to_string(p->cur_token.kind));
-            assert(0 && "unhandled expression kind");
-        } break;
-    }
+            const Parse_Rule *infix = &parse_rules[peek_token_kind(p)];
+            if (precidence < infix->precidence)
+            {
+                parser_next_token(p);
+                if (!parser_enter_expression(p))
+                {
+                    break;
+                }
+                Expression_Frame frame = {
+                    .kind = EXPRESSION_FRAME_INFIX,
+                    .op = cur_token_kind(p),
+                    .precidence = precidence,
+                    .lhs = *expr,
+                };
+                da_append(Expression_Frame, &p->scratch_frames, &frame);
+                precidence = infix->precidence;
+                parser_next_token(p);
+                more = true;
+                break;
+            }
 
-    while (!peek_token_is(p, TK_SEMICOLON) && (precidence < peek_precidence(p)))
-    {
-        parser_next_token(p);
-        parse_infix_expression(p, expr);
+            if (p->scratch_frames.len == mark)
+            {
+                break;
+            }
+            p->scratch_frames.len -= 1;
+            const Expression_Frame *frame = &p->scratch_frames.elements[p->scratch_frames.len];
+            parser_complete_frame(p, frame, expr);
+            precidence = (Operator_Precidence) frame->precidence;
+            p->expression_depth -= 1;
+        }
     }
+
+    p->scratch_frames.len = mark;
+    p->expression_depth = depth;
+    p->nesting_depth -= 1;
 }
 
-// TODO(HS): better mem allocs
-// TODO(HS): free ident
+// NOTE(HS): the lexer has already interned the name, which the symbol table owns
 void parse_ident(Parser *p, Expression *ident_expr)
 {
-    size_t slen = p->cur_token.literal.length;
-    char *buffer = malloc(sizeof(char) * (slen + 1));
-    strncpy(buffer, p->cur_token.literal.str, slen);
-    buffer[slen] = '\0';
-    ident_expr->expr.ident_expression.ident = buffer;
+    Symbol symbol = cur_token_value(p).symbol;
+    ident_expr->kind = AST_IDENT_EXPRESSION;
+    ident_expr->expr.ident_expression = (Ident_Expression) {
+        .ident = symbol_to_cstr(symbol),
+        .symbol = symbol,
+    };
 }
 
+// NOTE(HS): the lexer has already decoded the literal's value
 void parse_int(Parser *p, Expression *int_expr)
 {
-    // TODO(HS): handle integers which are too long string wise
-    size_t slen = p->cur_token.literal.length;
-    char *buffer = malloc(sizeof(char) * (slen + 1));
-    assert(buffer && "Failed to allocate scratch buffer");
-    strncpy(buffer, p->cur_token.literal.str, slen);
-    buffer[slen] = '\0';
-
-    // TODO(HS): handle `0` case vs return of 0
-    int val = atoi(buffer);
-    free(buffer);
-
+    int_expr->kind = AST_INT_EXPRESSION;
     int_expr->expr.int_expression = (Int_Expression) {
-        .value = val
+        .value = cur_token_value(p).i
     };
 }
 
 void parse_float(Parser *p, Expression *float_expr)
 {
-    // TODO(HS): handle integers which are too long string wise
-    size_t slen = p->cur_token.literal.length;
-    char *buffer = malloc(sizeof(char) * (slen + 1));
-    assert(buffer && "Failed to allocate scratch buffer");
-    strncpy(buffer, p->cur_token.literal.str, slen);
-    buffer[slen] = '\0';
-
-    // TODO(HS): handle `0.0` case vs return of `0.0`
-    float val = (float) atof(buffer);
-    free(buffer);
-
+    float_expr->kind = AST_FLOAT_EXPRESSION;
     float_expr->expr.float_expression = (Float_Expression) {
-        .value = val
+        .value = cur_token_value(p).f
     };
 }
 
 void parse_boolean(Parser *p, Expression *bool_expr)
 {
+    bool_expr->kind = AST_BOOLEAN_EXPRESSION;
     bool_expr->expr.boolean_expression = (Boolean_Expression) {
-        .value = p->cur_token.kind == TK_TRUE ? true : false
-    };
-}
-
-// TODO(HS): better allocation strategy for expressions
-// TODO(HS): parse prefix op for idents (& call expr?)
-void parse_prefix_expression(Parser *p, Expression *prefix_expr)
-{
-    Token op = p->cur_token;
-
-    switch (op.kind)
-    {
-        case TK_MINUS:
-        {
-            prefix_expr->expr.prefix_expression.op = '-';
-        } break;
-
-        case TK_BANG:
-        {
-            prefix_expr->expr.prefix_expression.op = '!';
-        } break;
-
-        default:
-        {
-            assert(0 && "Invalid prefix operator");
-        } break;
-    }
-
-    parser_next_token(p);
-    Expression rhs;
-    parse_expression(p, &rhs, PREFIX);
-
-    prefix_expr->expr.prefix_expression.rhs = malloc(sizeof(Expression));
-    assert(prefix_expr->expr.prefix_expression.rhs && "Failed to allocate memory for expression");
-    memcpy(prefix_expr->expr.prefix_expression.rhs, &rhs, sizeof(Expression));
-}
-
-void parse_infix_expression(Parser *p, Expression *expr)
-{
-    // NOTE(HS): we create this on the stack later, and later override the passed
-    // in expression with the value of this. Done this way to avoid extra allocations
-    // and potential errors thenceforth.
-    Expression infix_expr = {
-        .kind = AST_INFIX_EXPRESSION,
-        .expr.infix_expression = {
-            .op = p->cur_token.kind,
-        }
+        .value = cur_token_is(p, TK_TRUE) ? true : false
     };
-
-    infix_expr.expr.infix_expression.lhs = malloc(sizeof(Expression));
-    assert(infix_expr.expr.infix_expression.lhs);
-    infix_expr.expr.infix_expression.rhs = malloc(sizeof(Expression));
-    assert(infix_expr.expr.infix_expression.rhs);
-  
-    Operator_Precidence precidence = precidence_of(p->cur_token.kind);
-    parser_next_token(p);
-    Expression rhs;
-    parse_expression(p, &rhs, precidence);
-
-    memcpy(infix_expr.expr.infix_expression.lhs, expr, sizeof(Expression));
-    memcpy(infix_expr.expr.infix_expression.rhs, &rhs, sizeof(Expression));
-    memcpy(expr, &infix_expr, sizeof(Expression));
-}
-
-void parse_grouped_expression(Parser *p, Expression *grouped_expr)
-{
-    parser_next_token(p);
-    
-    Expression expr;
-    parse_expression(p, &expr, LOWEST);
-
-    assert(peek_token_is(p, TK_RPAREN) && "Peeked token is not RParen");
-    parser_next_token(p);
-
-    memcpy(grouped_expr, &expr, sizeof(Expression));
 }
 
 void parse_if_expression(Parser *p, Expression *if_expr)
 {
+    if_expr->kind = AST_IF_EXPRESSION;
     if_expr->expr.if_expression = (If_Expression) {
         .condition = NULL,
         .consequence = NULL,
@@ -477,31 +913,25 @@ void parse_if_expression(Parser *p, Expression *if_expr)
 
     if (!expect_peek(p, TK_LPAREN))
     {
-        // TODO(HS): errors
+        return;
     }
 
     parser_next_token(p);
     Expression condition;
     parse_expression(p, &condition, LOWEST);
-    if (!expect_peek(p, TK_RPAREN))
+    if (p->panicking || !expect_peek(p, TK_RPAREN) || !expect_peek(p, TK_LBRACE))
     {
-        // TODO(HS): errors
+        return;
     }
 
-    if (!expect_peek(p, TK_LBRACE))
+    Block_Statement consequence = parse_block_statement(p);
+    if (p->panicking)
     {
-        // TODO(HS): errors
+        return;
     }
 
-    Block_Statement consequence = parse_block_statement(p);
-
-    if_expr->expr.if_expression.condition = malloc(sizeof(Expression));
-    assert(if_expr->expr.if_expression.condition && "Failed to allocate IF expression condition");
-    memcpy(if_expr->expr.if_expression.condition, &condition, sizeof(Expression));
-
-    if_expr->expr.if_expression.consequence = malloc(sizeof(Block_Statement));
-    assert(if_expr->expr.if_expression.condition && "Failed to allocate IF expression consequence");
-    memcpy(if_expr->expr.if_expression.consequence, &consequence, sizeof(Block_Statement));
+    if_expr->expr.if_expression.condition = parser_new_expression(p, &condition);
+    if_expr->expr.if_expression.consequence = parser_new_block(p, &consequence);
 
     Block_Statement alternative;
     if (peek_token_is(p, TK_ELSE))
@@ -509,130 +939,201 @@ void parse_if_expression(Parser *p, Expression *if_expr)
         parser_next_token(p);
         if (!expect_peek(p, TK_LBRACE))
         {
-            // TODO(HS): errors
+            return;
         }
 
         alternative = parse_block_statement(p);
-
-        if_expr->expr.if_expression.alternative = malloc(sizeof(Block_Statement));
-        assert(if_expr->expr.if_expression.condition && "Failed to allocate IF expression alternative");
-        memcpy(if_expr->expr.if_expression.alternative, &alternative, sizeof(Block_Statement));
+        if_expr->expr.if_expression.alternative = parser_new_block(p, &alternative);
     }
 }
 
 Block_Statement parse_block_statement(Parser *p)
 {
-    Block_Statement block = {
-        .len = 0,
-        .capacity = 16,
-    };
-    block.statements = malloc(sizeof(Statement) * block.capacity);
+    // NOTE(HS): nested blocks push their statements above ours on the scratch
+    // stack, and pop them again before we continue
+    size_t mark = p->scratch_statements.len;
+    size_t open = p->cur;
 
     parser_next_token(p);
     while (!cur_token_is(p, TK_RBRACE) && !cur_token_is(p, TK_EOF))
     {
         Statement stmt;
-        parse_statement(p, &stmt);
-        block_add_statement(&block, &stmt);
-        parser_next_token(p);
+        parse_next_statement(p, &stmt);
+        da_append(Statement, &p->scratch_statements, &stmt);
     }
 
-    return block;
-}
+    size_t len = p->scratch_statements.len - mark;
+    Block_Statement block = {
+        .len = len,
+        .capacity = len,
+        .statements = NULL,
+        .open = (uint32_t) (open - p->statement_start),
+    };
+    if (len > 0)
+    {
+        block.statements = arena_new_array(p->arena, Statement, len);
+        memcpy(block.statements, &p->scratch_statements.elements[mark], sizeof(Statement) * len);
+    }
+    p->scratch_statements.len = mark;
 
-void block_add_statement(Block_Statement *bs, const Statement *stmt)
-{
-    if (bs->len + 1 > bs->capacity)
+    if (cur_token_is(p, TK_EOF))
     {
-        size_t new_capacity = bs->capacity * 2;
-        Statement *new_stmts = realloc(bs->statements, sizeof(Statement) * new_capacity);
-        if (new_stmts != bs->statements)
-        {
-            bs->statements = new_stmts;
-        }
-        bs->capacity = new_capacity;
+        parser_error(p, PARSE_ERROR_EXPECTED_TOKEN, p->cur, TK_RBRACE);
     }
-    memcpy(&bs->statements[bs->len], stmt, sizeof(Statement));
-    bs->len += 1;
+
+    return block;
 }
 
 Parameters parse_function_parameters(Parser *p)
 {
     Parameters params = {
         .len = 0,
-        .capacity = 4,
+        .capacity = 0,
         .idents = NULL
     };
 
-    // if parameters to parse allocate space
     if (peek_token_is(p, TK_RPAREN))
     {
         parser_next_token(p);
-        params.capacity = 0;
         return params;
     }
 
-    parser_next_token(p);
-    params.idents = malloc(sizeof(Ident_Expression) * params.capacity);
-
-    // parse first ident
-    Expression ident_expr;
-    parse_ident(p, &ident_expr);
-    memcpy(params.idents, &ident_expr.expr.ident_expression, sizeof(Ident_Expression));
-    params.len += 1;
+    // NOTE(HS): parameters can't nest, so the scratch stack is always empty here
+    assert(p->scratch_idents.len == 0);
 
-    // parse remaining idents
-    while (peek_token_is(p, TK_COMMA))
+    // comma separated idents
+    for (;;)
     {
-        parser_next_token(p);
-        parser_next_token(p);
-
-        if (params.len + 1 > params.capacity)
+        if (!expect_peek(p, TK_IDENT))
         {
-            size_t new_capacity = params.capacity * 2;
-            Ident_Expression *new_idents = realloc(params.idents, sizeof(Ident_Expression) * new_capacity);
-            if (new_idents != params.idents)
-            {
-                params.idents = new_idents;
-            }
-            params.capacity = new_capacity;
+            p->scratch_idents.len = 0;
+            return params;
         }
 
+        Expression ident_expr;
         parse_ident(p, &ident_expr);
-        memcpy(&params.idents[params.len], &ident_expr.expr.ident_expression, sizeof(Ident_Expression));
-        params.len += 1;
-    }
+        da_append(Ident_Expression, &p->scratch_idents, &ident_expr.expr.ident_expression);
 
-    if (params.len < params.capacity)
-    {
-        Ident_Expression *new_idents = realloc(params.idents, sizeof(Ident_Expression) * params.len);
-        if (new_idents != params.idents)
+        if (!peek_token_is(p, TK_COMMA))
         {
-            params.idents = new_idents;
+            break;
         }
-        params.capacity = params.len;
+        parser_next_token(p);
     }
 
-    // TODO(HS): handle errors
-    if (!expect_peek(p, TK_RPAREN))
-    {}
+    params.len = (uint32_t) p->scratch_idents.len;
+    params.capacity = params.len;
+    params.idents = arena_new_array(p->arena, Ident_Expression, params.len);
+    memcpy(params.idents, p->scratch_idents.elements, sizeof(Ident_Expression) * params.len);
+    p->scratch_idents.len = 0;
 
+    expect_peek(p, TK_RPAREN);
     return params;
 }
 
 void parse_function(Parser *p, Expression *func_expr)
 {
-    // TODO(HS): errors
+    func_expr->kind = AST_FUNCTION_EXPRESSION;
+    func_expr->expr.function_expression = (Function_Expression) {
+        .parameters = { 0, 0, NULL },
+        .body = NULL,
+        .body_open = 0,
+        .body_close = 0,
+    };
+
     if (!expect_peek(p, TK_LPAREN))
-    {}
+    {
+        return;
+    }
 
     func_expr->expr.function_expression.parameters = parse_function_parameters(p);
+    if (p->panicking || !expect_peek(p, TK_LBRACE))
+    {
+        return;
+    }
+    // NOTE(HS): over a stream the indices count from the start of the stream, the
+    // window's tokens are dropped as it moves on
+    size_t dropped = p->stream ? p->stream->dropped : 0;
+    func_expr->expr.function_expression.body_open = (uint32_t) (dropped + p->cur);
+
+    if (p->lazy_function_bodies)
+    {
+        skip_block(p);
+    }
+    else
+    {
+        Block_Statement bs = parse_block_statement(p);
+        func_expr->expr.function_expression.body = parser_new_block(p, &bs);
+    }
+    func_expr->expr.function_expression.body_close = (uint32_t) (dropped + p->cur);
+}
 
-    // TODO(HS): errors
-    if (!expect_peek(p, TK_LBRACE))
-    {}
+void skip_block(Parser *p)
+{
+    Token_Buffer *tokens = p->tokens;
+    size_t depth = 0;
+    for (size_t i = p->cur; i < tokens->len; ++i)
+    {
+        // NOTE(HS): over a stream, the block is lexed as it is matched, keeping the
+        // token after the one matched in the window as `parser_next_token` does
+        if (i + 1 == tokens->len && p->stream && tokens->kinds[i] != TK_EOF)
+        {
+            parser_stream_pull(p->stream, tokens);
+        }
 
+        uint8_t kind = tokens->kinds[i];
+        if (kind == TK_LBRACE)
+        {
+            depth += 1;
+        }
+        else if (kind == TK_RBRACE)
+        {
+            depth -= 1;
+            if (depth == 0)
+            {
+                p->cur = i;
+                return;
+            }
+        }
+    }
+
+    // NOTE(HS): the buffer ends in EOF
+    p->cur = tokens->len - 1;
+    parser_error(p, PARSE_ERROR_EXPECTED_TOKEN, p->cur, TK_RBRACE);
+}
+
+Block_Statement *parser_parse_function_body(Parser *p, Arena *arena, Function_Expression *func)
+{
+    assert(p && arena && func);
+    if (func->body)
+    {
+        return func->body;
+    }
+    size_t dropped = p->stream ? p->stream->dropped : 0;
+    assert(func->body_open >= dropped && "Function body was dropped from the stream");
+    size_t open = func->body_open - dropped;
+    assert(open < p->tokens->len && p->tokens->kinds[open] == TK_LBRACE
+        && "Function is not from a parse over these tokens");
+
+    size_t cur = p->cur;
+    size_t statement_start = p->statement_start;
+    Arena *prev_arena = p->arena;
+    p->cur = open;
+    p->arena = arena;
+    p->panicking = false;
+
+    // NOTE(HS): the function's statement isn't known, so the body is placed
+    // relative to itself
+    p->statement_start = open;
+
+    // NOTE(HS): the braces matched when the body was skipped, so this always
+    // stops on its `}`
     Block_Statement bs = parse_block_statement(p);
-    func_expr->expr.function_expression.body = malloc(sizeof(Block_Statement));
-    memcpy(func_expr->expr.function_expression.body, &bs, sizeof(Block_Statement));
+    assert(p->cur == func->body_close - dropped);
+    func->body = parser_new_block(p, &bs);
+
+    p->cur = cur;
+    p->statement_start = statement_start;
+    p->arena = prev_arena;
+    return func->body;
 }
@@ -0,0 +1,568 @@
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "tstrings.h"
+#include "scan.h"
+#include "tthreads.h"
+
+#if defined(TYGER_CPU_X86_64)
+#include <immintrin.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SCAN_TARGET_AVX2
+#else
+#define SCAN_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif // TYGER_CPU_X86_64
+
+typedef size_t (*Scan_Fn) (const char *, size_t);
+
+typedef struct
+{
+    Scan_Fn whitespace;
+    Scan_Fn ident;
+    Scan_Fn number;
+    Scan_Fn line;
+    Scan_Fn string;
+    Scan_Fn utf8;
+} Scan_Kernels;
+
+///
+/// Scalar kernels, also used for the tail of the vectorised kernels
+///
+
+static size_t scan_whitespace_scalar(const char *str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && is_whitespace(str[i]))
+    {
+        i += 1;
+    }
+    return i;
+}
+
+static size_t scan_ident_scalar(const char *str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && is_ident_char(str[i]))
+    {
+        i += 1;
+    }
+    return i;
+}
+
+static size_t scan_number_scalar(const char *str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && (is_numeric(str[i]) || str[i] == '.'))
+    {
+        i += 1;
+    }
+    return i;
+}
+
+static size_t scan_line_scalar(const char *str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && str[i] != '\n' && str[i] != '\r')
+    {
+        i += 1;
+    }
+    return i;
+}
+
+static size_t scan_string_scalar(const char *str, size_t len)
+{
+    size_t i = 0;
+    while (i < len && str[i] != '\"' && str[i] != '\\')
+    {
+        i += 1;
+    }
+    return i;
+}
+
+/// Length of the well formed UTF-8 sequence (Unicode table 3-7) at the start of
+/// `s`, or 0 if it is ill formed or cut short by the end of the input.
+static inline size_t utf8_sequence_length(const unsigned char *s, size_t len)
+{
+    unsigned char lead = s[0];
+    if (lead < 0x80)
+    {
+        return 1;
+    }
+
+    size_t n;
+    unsigned char lo = 0x80;
+    unsigned char hi = 0xBF;
+    if      (lead >= 0xC2 && lead <= 0xDF) { n = 2; }
+    else if (lead == 0xE0)                 { n = 3; lo = 0xA0; }
+    else if (lead == 0xED)                 { n = 3; hi = 0x9F; }
+    else if (lead >= 0xE1 && lead <= 0xEF) { n = 3; }
+    else if (lead == 0xF0)                 { n = 4; lo = 0x90; }
+    else if (lead == 0xF4)                 { n = 4; hi = 0x8F; }
+    else if (lead >= 0xF1 && lead <= 0xF3) { n = 4; }
+    else                                   { return 0; }
+
+    if (len < n || s[1] < lo || s[1] > hi)
+    {
+        return 0;
+    }
+    for (size_t i = 2; i < n; ++i)
+    {
+        if ((s[i] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+    }
+    return n;
+}
+
+static size_t scan_utf8_scalar(const char *str, size_t len)
+{
+    const unsigned char *s = (const unsigned char *) str;
+    size_t i = 0;
+    while (i < len)
+    {
+        // NOTE(HS): ASCII fast path, 8 bytes at a time
+        if (i + 8 <= len)
+        {
+            uint64_t word;
+            memcpy(&word, &s[i], sizeof(word));
+            if ((word & 0x8080808080808080ull) == 0)
+            {
+                i += 8;
+                continue;
+            }
+        }
+
+        size_t n = utf8_sequence_length(&s[i], len - i);
+        if (n == 0)
+        {
+            return i;
+        }
+        i += n;
+    }
+    return i;
+}
+
+/// Where the scalar validator can resume after the vectorised one has checked
+/// everything before `i`: a sequence may straddle `i`, so back up to its lead
+/// byte. Any continuation byte 3 back from `i` ends a sequence before `i`.
+static inline size_t utf8_resume_point(const char *str, size_t i)
+{
+    size_t back = i >= 3 ? i - 3 : 0;
+    while (back < i && ((unsigned char) str[back] & 0xC0) == 0x80)
+    {
+        back += 1;
+    }
+    return back;
+}
+
+#if defined(TYGER_CPU_X86_64)
+
+static inline uint32_t scan_ctz(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (uint32_t) index;
+#else
+    return (uint32_t) __builtin_ctz(mask);
+#endif
+}
+
+// NOTE(HS): every classifier returns a lane mask of 0xFF for bytes in the class.
+// Range checks use the unsigned trick `(c - lo) <= (hi - lo)`, done as
+// `min(c - lo, hi - lo) == c - lo` since there is no unsigned byte compare.
+
+///
+/// SSE2 kernels
+///
+
+static inline __m128i sse2_class_whitespace(__m128i c)
+{
+    __m128i space = _mm_cmpeq_epi8(c, _mm_set1_epi8(' '));
+    __m128i tab   = _mm_cmpeq_epi8(c, _mm_set1_epi8('\t'));
+    __m128i lf    = _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'));
+    __m128i cr    = _mm_cmpeq_epi8(c, _mm_set1_epi8('\r'));
+    return _mm_or_si128(_mm_or_si128(space, tab), _mm_or_si128(lf, cr));
+}
+
+static inline __m128i sse2_class_ident(__m128i c)
+{
+    // folding to lower case only maps `A-Z` onto `a-z`
+    __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+    __m128i rel   = _mm_sub_epi8(lower, _mm_set1_epi8('a'));
+    __m128i alpha = _mm_cmpeq_epi8(_mm_min_epu8(rel, _mm_set1_epi8('z' - 'a')), rel);
+    __m128i under = _mm_cmpeq_epi8(c, _mm_set1_epi8('_'));
+    // NOTE(HS): bytes of non-ASCII UTF-8 sequences are negative as signed bytes
+    __m128i utf8  = _mm_cmplt_epi8(c, _mm_setzero_si128());
+    return _mm_or_si128(_mm_or_si128(alpha, under), utf8);
+}
+
+static inline __m128i sse2_class_number(__m128i c)
+{
+    __m128i rel    = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    __m128i digit  = _mm_cmpeq_epi8(_mm_min_epu8(rel, _mm_set1_epi8(9)), rel);
+    __m128i period = _mm_cmpeq_epi8(c, _mm_set1_epi8('.'));
+    return _mm_or_si128(digit, period);
+}
+
+static inline __m128i sse2_class_line(__m128i c)
+{
+    __m128i lf = _mm_cmpeq_epi8(c, _mm_set1_epi8('\n'));
+    __m128i cr = _mm_cmpeq_epi8(c, _mm_set1_epi8('\r'));
+    return _mm_xor_si128(_mm_or_si128(lf, cr), _mm_set1_epi8(-1));
+}
+
+static inline __m128i sse2_class_string(__m128i c)
+{
+    __m128i quote = _mm_cmpeq_epi8(c, _mm_set1_epi8('\"'));
+    __m128i slash = _mm_cmpeq_epi8(c, _mm_set1_epi8('\\'));
+    return _mm_xor_si128(_mm_or_si128(quote, slash), _mm_set1_epi8(-1));
+}
+
+#define SCAN_SSE2_KERNEL(NAME, CLASSIFY, SCALAR)                                   \
+    static size_t NAME(const char *str, size_t len)                               \
+    {                                                                             \
+        size_t i = 0;                                                             \
+        for (; i + 16 <= len; i += 16)                                            \
+        {                                                                         \
+            __m128i chunk = _mm_loadu_si128((const __m128i *) &str[i]);           \
+            uint32_t miss = ~(uint32_t) _mm_movemask_epi8(CLASSIFY(chunk)) & 0xFFFF; \
+            if (miss)                                                             \
+            {                                                                     \
+                return i + scan_ctz(miss);                                        \
+            }                                                                     \
+        }                                                                         \
+        return i + SCALAR(&str[i], len - i);                                      \
+    }
+
+SCAN_SSE2_KERNEL(scan_whitespace_sse2, sse2_class_whitespace, scan_whitespace_scalar)
+SCAN_SSE2_KERNEL(scan_ident_sse2,      sse2_class_ident,      scan_ident_scalar)
+SCAN_SSE2_KERNEL(scan_number_sse2,     sse2_class_number,     scan_number_scalar)
+SCAN_SSE2_KERNEL(scan_line_sse2,       sse2_class_line,       scan_line_scalar)
+SCAN_SSE2_KERNEL(scan_string_sse2,     sse2_class_string,     scan_string_scalar)
+
+// NOTE(HS): SSE2 has no byte shuffle for the lookup tables the AVX2 validator
+// uses, so this skips 16 ASCII bytes at a time and checks the rest one sequence
+// at a time
+static size_t scan_utf8_sse2(const char *str, size_t len)
+{
+    const unsigned char *s = (const unsigned char *) str;
+    size_t i = 0;
+    while (i + 16 <= len)
+    {
+        __m128i chunk = _mm_loadu_si128((const __m128i *) &str[i]);
+        uint32_t non_ascii = (uint32_t) _mm_movemask_epi8(chunk);
+        if (non_ascii == 0)
+        {
+            i += 16;
+            continue;
+        }
+
+        i += scan_ctz(non_ascii);
+        size_t n = utf8_sequence_length(&s[i], len - i);
+        if (n == 0)
+        {
+            return i;
+        }
+        i += n;
+    }
+    return i + scan_utf8_scalar(&str[i], len - i);
+}
+
+///
+/// AVX2 kernels
+///
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_class_whitespace(__m256i c)
+{
+    __m256i space = _mm256_cmpeq_epi8(c, _mm256_set1_epi8(' '));
+    __m256i tab   = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'));
+    __m256i lf    = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'));
+    __m256i cr    = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r'));
+    return _mm256_or_si256(_mm256_or_si256(space, tab), _mm256_or_si256(lf, cr));
+}
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_class_ident(__m256i c)
+{
+    __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+    __m256i rel   = _mm256_sub_epi8(lower, _mm256_set1_epi8('a'));
+    __m256i alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(rel, _mm256_set1_epi8('z' - 'a')), rel);
+    __m256i under = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('_'));
+    __m256i utf8  = _mm256_cmpgt_epi8(_mm256_setzero_si256(), c);
+    return _mm256_or_si256(_mm256_or_si256(alpha, under), utf8);
+}
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_class_number(__m256i c)
+{
+    __m256i rel    = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+    __m256i digit  = _mm256_cmpeq_epi8(_mm256_min_epu8(rel, _mm256_set1_epi8(9)), rel);
+    __m256i period = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('.'));
+    return _mm256_or_si256(digit, period);
+}
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_class_line(__m256i c)
+{
+    __m256i lf = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'));
+    __m256i cr = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r'));
+    return _mm256_xor_si256(_mm256_or_si256(lf, cr), _mm256_set1_epi8(-1));
+}
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_class_string(__m256i c)
+{
+    __m256i quote = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\"'));
+    __m256i slash = _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\\'));
+    return _mm256_xor_si256(_mm256_or_si256(quote, slash), _mm256_set1_epi8(-1));
+}
+
+#define SCAN_AVX2_KERNEL(NAME, CLASSIFY, TAIL)                                     \
+    SCAN_TARGET_AVX2 static size_t NAME(const char *str, size_t len)              \
+    {                                                                             \
+        size_t i = 0;                                                             \
+        for (; i + 32 <= len; i += 32)                                            \
+        {                                                                         \
+            __m256i chunk = _mm256_loadu_si256((const __m256i *) &str[i]);        \
+            uint32_t miss = ~(uint32_t) _mm256_movemask_epi8(CLASSIFY(chunk));    \
+            if (miss)                                                             \
+            {                                                                     \
+                return i + scan_ctz(miss);                                        \
+            }                                                                     \
+        }                                                                         \
+        return i + TAIL(&str[i], len - i);                                        \
+    }
+
+SCAN_AVX2_KERNEL(scan_whitespace_avx2, avx2_class_whitespace, scan_whitespace_sse2)
+SCAN_AVX2_KERNEL(scan_ident_avx2,      avx2_class_ident,      scan_ident_sse2)
+SCAN_AVX2_KERNEL(scan_number_avx2,     avx2_class_number,     scan_number_sse2)
+SCAN_AVX2_KERNEL(scan_line_avx2,       avx2_class_line,       scan_line_sse2)
+SCAN_AVX2_KERNEL(scan_string_avx2,     avx2_class_string,     scan_string_sse2)
+
+// NOTE(HS): UTF-8 validation after Keiser & Lemire, "Validating UTF-8 In Less
+// Than One Instruction Per Byte". Each byte is checked together with the 3 before
+// it: three table lookups, on the high and low nibble of the previous byte and
+// the high nibble of this one, flag every error involving a pair of bytes, and
+// the 3rd and 4th bytes of longer sequences are checked separately.
+#define UTF8_TOO_SHORT      (1 << 0)
+#define UTF8_TOO_LONG       (1 << 1)
+#define UTF8_OVERLONG_3     (1 << 2)
+#define UTF8_TOO_LARGE      (1 << 3)
+#define UTF8_SURROGATE      (1 << 4)
+#define UTF8_OVERLONG_2     (1 << 5)
+#define UTF8_TOO_LARGE_1000 (1 << 6)
+#define UTF8_OVERLONG_4     (1 << 6)
+// NOTE(HS): bit 7, spelled as a signed byte for `_mm256_setr_epi8`
+#define UTF8_TWO_CONTS      (-128)
+#define UTF8_CARRY          (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+#define AVX2_TABLE16(...) _mm256_setr_epi8(__VA_ARGS__, __VA_ARGS__)
+
+/// The 32 bytes ending `N` bytes before the end of `input`, carrying over from `prev`.
+#define AVX2_PREV(INPUT, PREV, N) \
+    _mm256_alignr_epi8((INPUT), _mm256_permute2x128_si256((PREV), (INPUT), 0x21), 16 - (N))
+
+SCAN_TARGET_AVX2 static inline __m256i avx2_utf8_errors(__m256i input, __m256i prev_input)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+    const __m256i byte_1_high_table = AVX2_TABLE16(
+        // 0_______ ASCII
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+        // 10______ continuation
+        UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+        // 1100____ two byte lead
+        UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+        // 1101____ two byte lead
+        UTF8_TOO_SHORT,
+        // 1110____ three byte lead
+        UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+        // 1111____ four byte lead
+        UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4
+    );
+
+    const __m256i byte_1_low_table = AVX2_TABLE16(
+        // ____0000
+        UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+        // ____0001
+        UTF8_CARRY | UTF8_OVERLONG_2,
+        // ____001_
+        UTF8_CARRY,
+        UTF8_CARRY,
+        // ____0100
+        UTF8_CARRY | UTF8_TOO_LARGE,
+        // ____0101 to ____1100
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        // ____1101
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+        // ____111_
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+        UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000
+    );
+
+    const __m256i byte_2_high_table = AVX2_TABLE16(
+        // 0_______ ASCII
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+        // 1000____
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+        // 1001____
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+        // 101_____
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+        // 11______ lead
+        UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT
+    );
+
+    __m256i prev1 = AVX2_PREV(input, prev_input, 1);
+    __m256i byte_1_high = _mm256_shuffle_epi8(byte_1_high_table, _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    __m256i byte_1_low  = _mm256_shuffle_epi8(byte_1_low_table, _mm256_and_si256(prev1, nibble));
+    __m256i byte_2_high = _mm256_shuffle_epi8(byte_2_high_table, _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    // NOTE(HS): the 3rd byte of a sequence is 2 after a `111_____` lead, the 4th 3
+    // after a `1111____` lead, both must be continuations. Only those leads have the
+    // top bit set after the saturating subtract.
+    __m256i prev2 = AVX2_PREV(input, prev_input, 2);
+    __m256i prev3 = AVX2_PREV(input, prev_input, 3);
+    __m256i third  = _mm256_subs_epu8(prev2, _mm256_set1_epi8((char) (0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8((char) (0xF0 - 0x80)));
+    __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char) 0x80));
+
+    return _mm256_xor_si256(must_continue, special);
+}
+
+/// Non-zero in any lane of the last 3 that starts a sequence too long to end
+/// within the block.
+SCAN_TARGET_AVX2 static inline __m256i avx2_utf8_incomplete(__m256i input)
+{
+    const __m256i max = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        (char) (0xF0 - 1), (char) (0xE0 - 1), (char) (0xC0 - 1)
+    );
+    return _mm256_subs_epu8(input, max);
+}
+
+SCAN_TARGET_AVX2 static size_t scan_utf8_avx2(const char *str, size_t len)
+{
+    __m256i prev_input = _mm256_setzero_si256();
+    __m256i prev_incomplete = _mm256_setzero_si256();
+
+    size_t i = 0;
+    for (; i + 32 <= len; i += 32)
+    {
+        __m256i input = _mm256_loadu_si256((const __m256i *) &str[i]);
+
+        __m256i errors;
+        if (_mm256_movemask_epi8(input) == 0)
+        {
+            // ASCII, only wrong if the previous block ended mid sequence
+            errors = prev_incomplete;
+            prev_incomplete = _mm256_setzero_si256();
+        }
+        else
+        {
+            errors = avx2_utf8_errors(input, prev_input);
+            prev_incomplete = avx2_utf8_incomplete(input);
+        }
+
+        if (!_mm256_testz_si256(errors, errors))
+        {
+            break;
+        }
+        prev_input = input;
+    }
+
+    // NOTE(HS): the tail, any sequence straddling the last block boundary, and the
+    // exact position of an error are all left to the scalar validator
+    size_t resume = utf8_resume_point(str, i);
+    return resume + scan_utf8_scalar(&str[resume], len - resume);
+}
+
+static const Scan_Kernels scan_kernels[CPU_ISA_COUNT] = {
+    [CPU_ISA_SCALAR] = { scan_whitespace_scalar, scan_ident_scalar, scan_number_scalar, scan_line_scalar, scan_string_scalar, scan_utf8_scalar },
+    [CPU_ISA_SSE2]   = { scan_whitespace_sse2,   scan_ident_sse2,   scan_number_sse2,   scan_line_sse2,   scan_string_sse2,   scan_utf8_sse2   },
+    [CPU_ISA_AVX2]   = { scan_whitespace_avx2,   scan_ident_avx2,   scan_number_avx2,   scan_line_avx2,   scan_string_avx2,   scan_utf8_avx2   },
+};
+
+#else
+
+static const Scan_Kernels scan_kernels[CPU_ISA_COUNT] = {
+    [CPU_ISA_SCALAR] = { scan_whitespace_scalar, scan_ident_scalar, scan_number_scalar, scan_line_scalar, scan_string_scalar, scan_utf8_scalar },
+    [CPU_ISA_SSE2]   = { scan_whitespace_scalar, scan_ident_scalar, scan_number_scalar, scan_line_scalar, scan_string_scalar, scan_utf8_scalar },
+    [CPU_ISA_AVX2]   = { scan_whitespace_scalar, scan_ident_scalar, scan_number_scalar, scan_line_scalar, scan_string_scalar, scan_utf8_scalar },
+};
+
+#endif // TYGER_CPU_X86_64
+
+// NOTE(HS): detected once on first use, the lexer threads all scan from the start
+static Once scan_isa_once = ONCE_INIT;
+static Cpu_Isa scan_isa = CPU_ISA_SCALAR;
+
+static void scan_detect_isa(void)
+{
+    scan_isa = cpu_detect_isa();
+}
+
+static inline const Scan_Kernels *scan_current_kernels(void)
+{
+    thread_once(&scan_isa_once, scan_detect_isa);
+    return &scan_kernels[scan_isa];
+}
+
+void scan_set_isa(Cpu_Isa isa)
+{
+    assert(isa < CPU_ISA_COUNT);
+    // NOTE(HS): detect first, so the detection can't overwrite the choice later
+    thread_once(&scan_isa_once, scan_detect_isa);
+    Cpu_Isa supported = cpu_detect_isa();
+    scan_isa = isa < supported ? isa : supported;
+}
+
+Cpu_Isa scan_get_isa(void)
+{
+    scan_current_kernels();
+    return scan_isa;
+}
+
+size_t scan_whitespace(const char *str, size_t len)
+{
+    return scan_current_kernels()->whitespace(str, len);
+}
+
+size_t scan_ident(const char *str, size_t len)
+{
+    return scan_current_kernels()->ident(str, len);
+}
+
+size_t scan_number(const char *str, size_t len)
+{
+    return scan_current_kernels()->number(str, len);
+}
+
+size_t scan_line(const char *str, size_t len)
+{
+    return scan_current_kernels()->line(str, len);
+}
+
+size_t scan_string(const char *str, size_t len)
+{
+    return scan_current_kernels()->string(str, len);
+}
+
+size_t scan_utf8(const char *str, size_t len)
+{
+    return scan_current_kernels()->utf8(str, len);
+}
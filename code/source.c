@@ -0,0 +1,161 @@
+#if !defined(_WIN32)
+// NOTE(HS): needed for `madvise` under -std=c99
+#define _DEFAULT_SOURCE
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "source.h"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+
+typedef int Source_Read_Result;
+#define source_read_fd(FD, BUF, LEN) _read((FD), (BUF), (unsigned int) (LEN))
+#define source_close_fd(FD) _close(FD)
+#define SOURCE_STDIN_FD 0
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef ssize_t Source_Read_Result;
+#define source_read_fd(FD, BUF, LEN) read((FD), (BUF), (LEN))
+#define source_close_fd(FD) close(FD)
+#define SOURCE_STDIN_FD STDIN_FILENO
+#endif
+
+/// Initial size of the buffer used when the source has to be read rather than mapped
+#define SOURCE_READ_CHUNK (64 * 1024)
+
+/// Fallback for anything that can't be mapped, reads `fd` to the end into a heap
+/// buffer.
+static bool source_read_all(Source *source, int fd)
+{
+    size_t capacity = SOURCE_READ_CHUNK;
+    size_t len = 0;
+    char *buffer = malloc(capacity);
+    assert(buffer && "Failed to allocate source buffer");
+
+    for (;;)
+    {
+        if (len == capacity)
+        {
+            capacity *= 2;
+            char *new_buffer = realloc(buffer, capacity);
+            assert(new_buffer && "Failed to grow source buffer");
+            buffer = new_buffer;
+        }
+
+        Source_Read_Result n = source_read_fd(fd, &buffer[len], capacity - len);
+        if (n < 0)
+        {
+            free(buffer);
+            return false;
+        }
+        if (n == 0)
+        {
+            break;
+        }
+        len += (size_t) n;
+    }
+
+    *source = (Source) {
+        .data = buffer,
+        .len = len,
+        .mapped = false,
+    };
+    return true;
+}
+
+#if !defined(_WIN32)
+/// Maps the whole of the regular file `fd` read-only. Returns false if the file
+/// can't be mapped, e.g. it is not a regular file or is empty.
+static bool source_map(Source *source, int fd)
+{
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0)
+    {
+        return false;
+    }
+
+    size_t len = (size_t) st.st_size;
+    void *data = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    // NOTE(HS): the lexer makes a single forward pass, so let the kernel read
+    // ahead aggressively and drop pages behind us. Only a hint, failure is fine.
+    (void) madvise(data, len, MADV_SEQUENTIAL);
+
+    *source = (Source) {
+        .data = data,
+        .len = len,
+        .mapped = true,
+    };
+    return true;
+}
+#endif
+
+bool source_load(Source *source, const char *path)
+{
+    assert(source);
+    assert(path);
+
+    *source = (Source) {0};
+
+    bool is_stdin = strcmp(path, "-") == 0;
+    int fd = SOURCE_STDIN_FD;
+    if (!is_stdin)
+    {
+#if defined(_WIN32)
+        fd = _open(path, _O_RDONLY | _O_BINARY);
+#else
+        fd = open(path, O_RDONLY);
+#endif
+        if (fd < 0)
+        {
+            return false;
+        }
+    }
+
+    bool loaded = false;
+#if !defined(_WIN32)
+    loaded = source_map(source, fd);
+#endif
+    if (!loaded)
+    {
+        loaded = source_read_all(source, fd);
+    }
+
+    if (!is_stdin)
+    {
+        source_close_fd(fd);
+    }
+    return loaded;
+}
+
+void source_free(Source *source)
+{
+    assert(source);
+
+#if !defined(_WIN32)
+    if (source->mapped)
+    {
+        munmap((void *) source->data, source->len);
+    }
+    else
+#endif
+    {
+        free((void *) source->data);
+    }
+
+    *source = (Source) {0};
+}
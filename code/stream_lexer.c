@@ -0,0 +1,261 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lexer.h"
+#include "lexer_internal.h"
+#include "scan.h"
+#include "stream_lexer.h"
+#include "tstrings.h"
+
+void stream_lexer_init(Stream_Lexer *sl)
+{
+    assert(sl);
+
+    // NOTE(HS): the buffer is allocated by the first feed
+    *sl = (Stream_Lexer) {
+        .buffer = NULL,
+        .capacity = 0,
+        .len = 0,
+        .base = 0,
+        .finished = false,
+        .pending = false,
+        .scanned = 0,
+        .line_break = 0,
+        .line = 1,
+        .line_start = 0,
+        .prev_line_start = 0,
+        .after_cr = false,
+    };
+
+    lexer_init_n(&sl->lexer, "", 0);
+}
+
+void stream_lexer_free(Stream_Lexer *sl)
+{
+    assert(sl);
+    free(sl->buffer);
+    lexer_free(&sl->lexer);
+    *sl = (Stream_Lexer) {0};
+}
+
+/// Counts the lines of the stream up to the byte at `end` in the buffer.
+static void stream_lexer_count_lines(Stream_Lexer *sl, size_t end)
+{
+    const char *buffer = sl->buffer;
+    size_t i = sl->line_break - sl->base;
+    if (sl->after_cr && i < sl->len)
+    {
+        // the byte after the `\r` has arrived
+        sl->after_cr = false;
+        if (buffer[i] == '\n')
+        {
+            i += 1;
+        }
+        sl->line += 1;
+        sl->prev_line_start = sl->line_start;
+        sl->line_start = sl->base + i;
+    }
+
+    // NOTE(HS): as in `line_index_build`, a line ends at a `\n`, or at a `\r` that
+    // isn't the first half of a `\r\n`. The next line break is searched for a
+    // line at a time rather than a token at a time, the search stopping at the end
+    // of the buffer if there is none in it yet.
+    for (;;)
+    {
+        if (i < sl->len && buffer[i] != '\n' && buffer[i] != '\r')
+        {
+            i += scan_line(&buffer[i], sl->len - i);
+        }
+        if (i >= end)
+        {
+            break;
+        }
+
+        if (buffer[i] == '\r')
+        {
+            if (i + 1 >= sl->len)
+            {
+                sl->after_cr = true;
+                i += 1;
+                break;
+            }
+            if (buffer[i + 1] == '\n')
+            {
+                i += 1;
+            }
+        }
+        i += 1;
+        sl->line += 1;
+        sl->prev_line_start = sl->line_start;
+        sl->line_start = sl->base + i;
+    }
+    sl->line_break = sl->base + i;
+}
+
+void stream_lexer_feed(Stream_Lexer *sl, const char *chunk, size_t len)
+{
+    assert(sl);
+    assert(chunk || len == 0);
+    assert(!sl->finished && "Cannot feed a finished stream");
+
+    // NOTE(HS): drop everything before the lexer's position, all of it belongs to
+    // tokens that have already been returned
+    size_t consumed = sl->lexer.pos;
+    stream_lexer_count_lines(sl, consumed);
+    size_t carry = sl->len - consumed;
+    if (carry > 0 && consumed > 0)
+    {
+        memmove(sl->buffer, &sl->buffer[consumed], carry);
+    }
+    sl->base += consumed;
+    sl->len = carry;
+    if (sl->pending)
+    {
+        sl->scanned -= consumed;
+    }
+
+    if (sl->len + len > sl->capacity)
+    {
+        size_t new_capacity = sl->capacity > 0 ? sl->capacity : STREAM_LEXER_DEFAULT_CAPACITY;
+        while (sl->len + len > new_capacity)
+        {
+            new_capacity *= 2;
+        }
+
+        char *new_buffer = realloc(sl->buffer, new_capacity);
+        assert(new_buffer && "Failed to grow stream lexer buffer");
+        sl->buffer = new_buffer;
+        sl->capacity = new_capacity;
+    }
+
+    if (len > 0)
+    {
+        memcpy(&sl->buffer[sl->len], chunk, len);
+        sl->len += len;
+    }
+
+    // NOTE(HS): the strings decoded belong to tokens already returned, so their
+    // space is reused
+    Token_Strings strings = sl->lexer.strings;
+    strings.len = 0;
+    lexer_init_n(&sl->lexer, sl->buffer, sl->len);
+    sl->lexer.strings = strings;
+}
+
+void stream_lexer_finish(Stream_Lexer *sl)
+{
+    assert(sl);
+    sl->finished = true;
+}
+
+/// Continues scanning the string literal whose contents are scanned up to `i`.
+/// Returns the index of its closing quote, or where to continue from once more
+/// input arrives if it isn't in the buffer yet.
+static size_t stream_scan_string(const char *buffer, size_t len, size_t i)
+{
+    for (;;)
+    {
+        i += scan_string(&buffer[i], len - i);
+        if (i >= len || buffer[i] == '\"')
+        {
+            return i;
+        }
+
+        // NOTE(HS): an escape cut off by the end of the buffer is scanned again whole
+        if (i + 1 >= len)
+        {
+            return i;
+        }
+        i += 2;
+    }
+}
+
+/// Scans more of the pending token, as the lexer would, from where the last
+/// attempt got to. Returns whether the lexer would now stop inside the buffer.
+static bool stream_lexer_continue(Stream_Lexer *sl)
+{
+    const char *buffer = sl->buffer;
+    size_t len = sl->len;
+    size_t start = sl->lexer.pos;
+    size_t i = sl->scanned;
+    size_t end = i;
+    if (start < len)
+    {
+        char c = buffer[start];
+        if (is_numeric(c))
+        {
+            i += scan_number(&buffer[i], len - i);
+            end = i;
+        }
+        else if (is_ident_start(c))
+        {
+            i += scan_ident(&buffer[i], len - i);
+            end = i;
+        }
+        else if (c == '\"')
+        {
+            // the lexer stops past the closing quote
+            i = stream_scan_string(buffer, len, i);
+            end = i + 1;
+        }
+    }
+    sl->scanned = i;
+    return end < len;
+}
+
+bool stream_lexer_next(Stream_Lexer *sl, Token *token)
+{
+    assert(sl);
+    assert(token);
+
+    // NOTE(HS): a long token fed a little at a time would be lexed from its start
+    // after every feed, so only lex it again once its end has arrived
+    if (sl->pending && !sl->finished && !stream_lexer_continue(sl))
+    {
+        return false;
+    }
+    sl->pending = false;
+
+    Token t = lexer_next_token(&sl->lexer);
+
+    // NOTE(HS): every token is decided by at most one character past its end, so
+    // a token is only known to be complete if the lexer stopped on a byte that is
+    // actually in the buffer. Otherwise it may continue in the next chunk. The
+    // whitespace before it doesn't depend on what follows, so it is dropped.
+    if (!sl->finished && sl->lexer.pos >= sl->len)
+    {
+        size_t start = t.kind == TK_STRING_LIT ? t.location.pos - 1 : t.location.pos;
+        lexer_seek(&sl->lexer, start);
+        sl->pending = true;
+        sl->scanned = t.kind == TK_STRING_LIT ? start + 1 : start;
+        return false;
+    }
+
+    t.location.pos += sl->base;
+    stream_lexer_count_lines(sl, t.location.pos - sl->base);
+    t.location.line = sl->line;
+    t.location.col = t.location.pos - sl->line_start + 1;
+
+    // NOTE(HS): as in `line_index_lookup`, the end of the stream is at the location
+    // of its final byte, which may have been dropped from the buffer already
+    if (t.kind == TK_EOF)
+    {
+        size_t last = t.location.pos - 1;
+        if (t.location.pos == 0)
+        {
+            t.location.col = 0;
+        }
+        else if (sl->line_start == t.location.pos)
+        {
+            t.location.line = sl->line - 1;
+            t.location.col = last - sl->prev_line_start + 1;
+        }
+        else
+        {
+            t.location.col = last - sl->line_start + 1;
+        }
+    }
+    *token = t;
+    return true;
+}
@@ -0,0 +1,288 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#include "arena.h"
+#include "symbol.h"
+#include "tthreads.h"
+
+/// Initial number of hash slots of a shard, must be a power of 2.
+#define SYMBOL_SHARD_INITIAL_SLOTS 128
+
+/// Number of shards, must be a power of 2. Picked by the top bits of the hash.
+#define SYMBOL_SHARD_COUNT 16
+#define SYMBOL_SHARD_SHIFT 28
+
+/// Entries of the first page, each page after it holds twice the one before, so
+/// `SYMBOL_PAGE_COUNT` pages cover every 32-bit symbol.
+#define SYMBOL_FIRST_PAGE_LEN 1024
+#define SYMBOL_PAGE_COUNT 23
+
+/// Entries of each thread's cache of recently interned names, a power of 2.
+#define SYMBOL_CACHE_LEN 512
+
+typedef struct
+{
+    const char *str;
+    uint32_t length;
+    uint32_t hash;
+} Symbol_Entry;
+
+/// NOTE(HS): the hash is kept alongside the symbol so probing past a different
+/// name doesn't need to touch its entry
+typedef struct
+{
+    uint32_t hash;
+    Symbol symbol;
+} Symbol_Slot;
+
+/// Names whose hash picks the shard. The hash slots are open addressed (linear
+/// probing), empty slots have no symbol.
+typedef struct
+{
+    Mutex lock;
+    Arena names;
+    size_t len;
+    size_t slot_count;
+    Symbol_Slot *slots;
+} Symbol_Shard;
+
+/// Entries are indexed by symbol, in pages that never move once allocated, so a
+/// symbol's name is read without a lock. Symbols are handed out in order across
+/// every shard, `next` being the next one, symbol 0 being `SYMBOL_NONE`.
+typedef struct
+{
+    Symbol_Shard shards[SYMBOL_SHARD_COUNT];
+    Symbol_Entry *volatile pages[SYMBOL_PAGE_COUNT];
+    volatile uint32_t next;
+    /// bumped by `symbol_table_free`, invalidating the threads' caches
+    uint32_t generation;
+} Symbol_Table;
+
+#define SYMBOL_SHARD_INIT { .lock = MUTEX_INIT }
+#define SYMBOL_SHARDS_4 SYMBOL_SHARD_INIT, SYMBOL_SHARD_INIT, SYMBOL_SHARD_INIT, SYMBOL_SHARD_INIT
+
+static Symbol_Table symbol_table = {
+    .shards = { SYMBOL_SHARDS_4, SYMBOL_SHARDS_4, SYMBOL_SHARDS_4, SYMBOL_SHARDS_4 },
+    .next = 1,
+    .generation = 1,
+};
+
+typedef char symbol_shards_initialised[SYMBOL_SHARD_COUNT == 16 ? 1 : -1];
+
+/// A name this thread interned, `str` being its interned copy.
+typedef struct
+{
+    const char *str;
+    uint32_t length;
+    Symbol symbol;
+} Symbol_Cache_Entry;
+
+// NOTE(HS): identifiers repeat a lot, so most lookups are answered here without
+// touching the shared table, let alone its locks
+static THREAD_LOCAL Symbol_Cache_Entry symbol_cache[SYMBOL_CACHE_LEN];
+static THREAD_LOCAL uint32_t symbol_cache_generation;
+
+/// Index of the highest set bit of `n`, which must not be 0.
+static inline uint32_t symbol_log2(uint32_t n)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, n);
+    return (uint32_t) index;
+#else
+    return 31u - (uint32_t) __builtin_clz(n);
+#endif
+}
+
+/// Page of `symbol`, and its index in the page.
+static inline size_t symbol_page(Symbol symbol, size_t *index)
+{
+    // NOTE(HS): page k starts at FIRST * (2^k - 1)
+    size_t page = symbol_log2(symbol / SYMBOL_FIRST_PAGE_LEN + 1);
+    *index = symbol - (size_t) SYMBOL_FIRST_PAGE_LEN * (((size_t) 1 << page) - 1);
+    return page;
+}
+
+static inline const Symbol_Entry *symbol_entry(Symbol symbol)
+{
+    size_t index;
+    size_t page = symbol_page(symbol, &index);
+    return &symbol_table.pages[page][index];
+}
+
+/// Stores the entry of a new symbol, allocating its page if it's the first.
+static void symbol_store_entry(Symbol symbol, const Symbol_Entry *entry)
+{
+    size_t index;
+    size_t page = symbol_page(symbol, &index);
+    Symbol_Entry *entries = atomic_load_ptr((void *volatile *) &symbol_table.pages[page]);
+    if (!entries)
+    {
+        // NOTE(HS): shards race to allocate a page, the loser uses the winner's
+        size_t len = (size_t) SYMBOL_FIRST_PAGE_LEN << page;
+        Symbol_Entry *fresh = malloc(sizeof(Symbol_Entry) * len);
+        assert(fresh && "Failed to allocate symbol table entries");
+        if (atomic_cas_ptr((void *volatile *) &symbol_table.pages[page], NULL, fresh))
+        {
+            entries = fresh;
+        }
+        else
+        {
+            free(fresh);
+            entries = atomic_load_ptr((void *volatile *) &symbol_table.pages[page]);
+        }
+    }
+    entries[index] = *entry;
+}
+
+static void symbol_shard_rehash(Symbol_Shard *shard, size_t slot_count)
+{
+    Symbol_Slot *slots = calloc(slot_count, sizeof(Symbol_Slot));
+    assert(slots && "Failed to allocate symbol table slots");
+
+    size_t mask = slot_count - 1;
+    for (size_t i = 0; i < shard->slot_count; ++i)
+    {
+        Symbol_Slot old = shard->slots[i];
+        if (old.symbol == SYMBOL_NONE)
+        {
+            continue;
+        }
+
+        size_t slot = old.hash & mask;
+        while (slots[slot].symbol != SYMBOL_NONE)
+        {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = old;
+    }
+
+    free(shard->slots);
+    shard->slots = slots;
+    shard->slot_count = slot_count;
+}
+
+/// Looks `name` up in its shard, adding it if it's new.
+static Symbol symbol_shard_intern(Symbol_Shard *shard, String_View name, uint32_t hash, const char **str)
+{
+    mutex_lock(&shard->lock);
+    if (!shard->slots)
+    {
+        symbol_shard_rehash(shard, SYMBOL_SHARD_INITIAL_SLOTS);
+    }
+
+    size_t mask = shard->slot_count - 1;
+    size_t slot = hash & mask;
+    for (; shard->slots[slot].symbol != SYMBOL_NONE; slot = (slot + 1) & mask)
+    {
+        if (shard->slots[slot].hash != hash)
+        {
+            continue;
+        }
+
+        Symbol sym = shard->slots[slot].symbol;
+        const Symbol_Entry *entry = symbol_entry(sym);
+        if (entry->length == name.length && string_bytes_eq(entry->str, name.str, name.length))
+        {
+            *str = entry->str;
+            mutex_unlock(&shard->lock);
+            return sym;
+        }
+    }
+
+    Symbol sym = atomic_add_u32(&symbol_table.next, 1);
+    assert(sym != SYMBOL_NONE && "Symbol table is full");
+    Symbol_Entry entry = {
+        .str = arena_strndup(&shard->names, name.str, name.length),
+        .length = (uint32_t) name.length,
+        .hash = hash,
+    };
+    symbol_store_entry(sym, &entry);
+    shard->slots[slot] = (Symbol_Slot) { hash, sym };
+    shard->len += 1;
+
+    // NOTE(HS): keep the load factor at or under a half
+    if (shard->len * 2 > shard->slot_count)
+    {
+        symbol_shard_rehash(shard, shard->slot_count * 2);
+    }
+
+    *str = entry.str;
+    mutex_unlock(&shard->lock);
+    return sym;
+}
+
+Symbol symbol_intern(String_View name)
+{
+    assert(name.length <= UINT32_MAX);
+    uint32_t hash = string_view_hash(name);
+
+    if (symbol_cache_generation != symbol_table.generation)
+    {
+        memset(symbol_cache, 0, sizeof(symbol_cache));
+        symbol_cache_generation = symbol_table.generation;
+    }
+
+    Symbol_Cache_Entry *cached = &symbol_cache[hash & (SYMBOL_CACHE_LEN - 1)];
+    if (cached->symbol != SYMBOL_NONE && cached->length == name.length
+        && string_bytes_eq(cached->str, name.str, name.length))
+    {
+        return cached->symbol;
+    }
+
+    Symbol_Shard *shard = &symbol_table.shards[hash >> SYMBOL_SHARD_SHIFT];
+    const char *str = NULL;
+    Symbol sym = symbol_shard_intern(shard, name, hash, &str);
+    *cached = (Symbol_Cache_Entry) { str, (uint32_t) name.length, sym };
+    return sym;
+}
+
+const char *symbol_to_cstr(Symbol symbol)
+{
+    return symbol != SYMBOL_NONE ? symbol_entry(symbol)->str : "";
+}
+
+String_View symbol_to_string_view(Symbol symbol)
+{
+    String_View sv = { (char*) "", 0 };
+    if (symbol != SYMBOL_NONE)
+    {
+        const Symbol_Entry *entry = symbol_entry(symbol);
+        sv = (String_View) { (char*) entry->str, entry->length };
+    }
+    return sv;
+}
+
+size_t symbol_count(void)
+{
+    return atomic_load_u32(&symbol_table.next) - 1;
+}
+
+void symbol_table_free(void)
+{
+    for (size_t i = 0; i < SYMBOL_SHARD_COUNT; ++i)
+    {
+        Symbol_Shard *shard = &symbol_table.shards[i];
+        mutex_lock(&shard->lock);
+        arena_free(&shard->names);
+        free(shard->slots);
+        shard->slots = NULL;
+        shard->slot_count = 0;
+        shard->len = 0;
+        mutex_unlock(&shard->lock);
+    }
+
+    for (size_t i = 0; i < SYMBOL_PAGE_COUNT; ++i)
+    {
+        free(symbol_table.pages[i]);
+        symbol_table.pages[i] = NULL;
+    }
+    symbol_table.next = 1;
+    symbol_table.generation += 1;
+}
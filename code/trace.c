@@ -80,6 +80,30 @@ const char *program_print_ast(const Program *prog, AST_Print_Format format)
     return buffer;
 }
 
+const char *statement_print_ast(const Statement *stmt, AST_Print_Format format)
+{
+    size_t buffer_len = 1024;
+    size_t buffer_offset = 0;
+    char *buffer = malloc(sizeof(char) * buffer_len);
+    assert(buffer && "Failed to allocate space for AST string buffer");
+
+    switch (format)
+    {
+        case PRINT_FORMAT_PLAIN:
+        {
+            ast_print_statement_plain(stmt, buffer, &buffer_len, &buffer_offset);
+        } break;
+
+        case PRINT_FORMAT_YAML:
+        {
+            ast_print_statement_yaml(stmt, buffer, &buffer_len, &buffer_offset, 1);
+        } break;
+    }
+
+    buffer[buffer_offset] = '\0';
+    return buffer;
+}
+
 void ast_print_header_plain(
     INOUT char *buffer,
     INOUT size_t *buffer_len,
@@ -125,6 +149,14 @@ void ast_print_statement_plain(
             *buffer_offset += bytes_to_write;
         } break;
 
+        case AST_ILLGEAL_STATEMENT:
+        {
+            bytes_to_write = snprintf(NULL, 0, "(illegal)");
+            ast_print_resize_debug_buffer(buffer, buffer_len, *buffer_offset, bytes_to_write);
+            snprintf(&buffer[*buffer_offset], bytes_to_write + 1, "(illegal)");
+            *buffer_offset += bytes_to_write;
+        } break;
+
         case AST_RETURN_STATEMENT:
         {} break;
 
@@ -476,6 +508,10 @@ void ast_print_statement_yaml(
     { // write statement kind specific info to tree
         switch (stmt->kind)
         {
+            // NOTE(HS): the kind says it all, the statement failed to parse
+            case AST_ILLGEAL_STATEMENT:
+            {} break;
+
             case AST_VAR_STATEMENT:
             {
                 #define IDENT_FMT "%sident: %s\n"
@@ -726,6 +762,15 @@ void ast_print_expression_yaml(
                     }
                 }
 
+                if (!fe->body)
+                {
+                    // NOTE(HS): skipped by a lazy parse
+                    bytes_to_write = snprintf(NULL, 0, "%sbody: ~\n", padding);
+                    ast_print_resize_debug_buffer(buffer, buffer_len, *buffer_offset, bytes_to_write);
+                    snprintf(&buffer[*buffer_offset], bytes_to_write + 1, "%sbody: ~\n", padding);
+                    *buffer_offset += bytes_to_write;
+                }
+                else
                 { // body
                     bytes_to_write = snprintf(NULL, 0, "%sbody:\n", padding);
                     ast_print_resize_debug_buffer(buffer, buffer_len, *buffer_offset, bytes_to_write);
@@ -776,6 +821,10 @@ const char *op_to_string(Token_Kind op)
         case TK_GT:       { res = ">"; } break;
         case TK_EQ:       { res = "=="; } break;
         case TK_NEQ:      { res = "!="; } break;
+        case TK_LTE:      { res = "<="; } break;
+        case TK_GTE:      { res = ">="; } break;
+        case TK_LAND:     { res = "&&"; } break;
+        case TK_LOR:      { res = "||"; } break;
         default:          { res = token_kind_to_string(op); } break;
     }
     return res;
@@ -1,6 +1,17 @@
+#include <stdint.h>
 #include <string.h>
+#include "cpu.h"
 #include "tstrings.h"
 
+#if defined(TYGER_CPU_X86_64)
+#include <emmintrin.h>
+#endif
+
+// NOTE(HS): unaligned loads, memcpy compiles down to a single mov
+static inline uint64_t load_u64(const char *p) { uint64_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint32_t load_u32(const char *p) { uint32_t v; memcpy(&v, p, sizeof(v)); return v; }
+static inline uint16_t load_u16(const char *p) { uint16_t v; memcpy(&v, p, sizeof(v)); return v; }
+
 size_t string_nlen(const char *str, size_t max_len)
 {
     size_t len = 0;
@@ -32,51 +43,125 @@ inline String_View string_view_from_cstr_offset(
     return string_view_from_cstr((char*) &str[offset], length);
 }
 
-bool string_view_eq(String_View s1, String_View s2)
+bool string_bytes_eq(const char *a, const char *b, size_t len)
 {
-    if (s1.length != s2.length)
+    // NOTE(HS): short strings are compared with two overlapping loads from either
+    // end, so there are no byte loops or tail cases
+    if (len < 4)
     {
-        return false;
+        if (len == 0) { return true; }
+        if (len == 1) { return a[0] == b[0]; }
+        return load_u16(a) == load_u16(b) && a[len - 1] == b[len - 1];
+    }
+    if (len <= 8)
+    {
+        return load_u32(a) == load_u32(b) && load_u32(a + len - 4) == load_u32(b + len - 4);
+    }
+    if (len <= 16)
+    {
+        return load_u64(a) == load_u64(b) && load_u64(a + len - 8) == load_u64(b + len - 8);
     }
 
-    for (size_t i = 0; i < s1.length; ++i)
+#if defined(TYGER_CPU_X86_64)
+    size_t i = 0;
+    for (; i + 16 <= len; i += 16)
     {
-        if (s1.str[i] != s2.str[i])
+        __m128i va = _mm_loadu_si128((const __m128i*) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*) (b + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF)
         {
             return false;
         }
     }
+    if (i == len)
+    {
+        return true;
+    }
+    __m128i va = _mm_loadu_si128((const __m128i*) (a + len - 16));
+    __m128i vb = _mm_loadu_si128((const __m128i*) (b + len - 16));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) == 0xFFFF;
+#else
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8)
+    {
+        if (load_u64(a + i) != load_u64(b + i))
+        {
+            return false;
+        }
+    }
+    return i == len || load_u64(a + len - 8) == load_u64(b + len - 8);
+#endif
+}
 
-    return true;
+bool string_view_eq(String_View s1, String_View s2)
+{
+    return s1.length == s2.length && string_bytes_eq(s1.str, s2.str, s1.length);
 }
 
 bool string_view_eq_cstr(String_View sv, const char *s)
 {
-    bool result = false;
+    if (!s)
+    {
+        return false;
+    }
 
-    if (!s || s == NULL || *s == '\0')
+    // NOTE(HS): never reads past the terminator of `s`, so no length up front
+    for (size_t i = 0; i < sv.length; ++i)
     {
-        return result;
+        if (s[i] != sv.str[i] || s[i] == '\0')
+        {
+            return false;
+        }
     }
 
-    size_t s_len = string_nlen(s, 100);
-    if (sv.length != s_len)
+    return s[sv.length] == '\0';
+}
+
+uint32_t string_view_hash(String_View sv)
+{
+    // NOTE(HS): 8 bytes a step, mixed with a multiply and fold. Short strings are
+    // read with overlapping loads like `string_bytes_eq`.
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    const char *p = sv.str;
+    size_t len = sv.length;
+    uint64_t h = (uint64_t) len * k;
+
+    while (len > 8)
     {
-        return result;
+        h = (h ^ load_u64(p)) * k;
+        h ^= h >> 32;
+        p += 8;
+        len -= 8;
     }
 
-    size_t match_count = 0;
-    for (size_t i = 0; i < sv.length; ++i)
+    uint64_t tail = 0;
+    if (len >= 4)
     {
-        if (sv.str[i] != s[i])
-        {
-            break;
-        }
-        match_count += 1;
+        tail = ((uint64_t) load_u32(p) << 32) | load_u32(p + len - 4);
     }
+    else if (len > 0)
+    {
+        tail = ((uint64_t) (unsigned char) p[0] << 16)
+            | ((uint64_t) (unsigned char) p[len / 2] << 8)
+            | (unsigned char) p[len - 1];
+    }
+
+    h = (h ^ tail) * k;
+    h ^= h >> 29;
+    h *= k;
+    return (uint32_t) (h >> 32);
+}
+
+Hashed_String_View string_view_hashed(String_View sv)
+{
+    return (Hashed_String_View) { sv, string_view_hash(sv) };
+}
 
-    result = match_count == sv.length;
-    return result;
+bool hashed_string_view_eq(Hashed_String_View s1, Hashed_String_View s2)
+{
+    return s1.hash == s2.hash
+        && s1.sv.length == s2.sv.length
+        && string_bytes_eq(s1.sv.str, s2.sv.str, s1.sv.length);
 }
 
 inline bool is_whitespace(const char c)
@@ -101,17 +186,17 @@ inline bool is_alphanumeric(const char c)
 
 inline bool is_punctuation(const char c)
 {
-    bool result = false;
-    const char punctuation[] = ";:,.";
-    for (size_t i = 0; i < (sizeof(punctuation) / sizeof(punctuation[0])); ++i)
-    {
-        if (c == punctuation[i])
-        {
-            result = true;
-            break;
-        }
-    }
-    return result;
+    return c == ';' || c == ':' || c == ',' || c == '.';
+}
+
+inline bool is_ident_start(const char c)
+{
+    return is_alpha(c) || (unsigned char) c >= 0x80;
+}
+
+inline bool is_ident_char(const char c)
+{
+    return is_ident_start(c) || c == '_';
 }
 
 inline bool is_end_of_input(const char c)
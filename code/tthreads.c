@@ -0,0 +1,339 @@
+#if !defined(_WIN32)
+// NOTE(HS): needed for `_SC_NPROCESSORS_ONLN` under -std=c99
+#define _DEFAULT_SOURCE
+#include <unistd.h>
+#endif
+
+#include <assert.h>
+
+#include "tthreads.h"
+
+#if defined(_WIN32)
+
+static DWORD WINAPI thread_trampoline(LPVOID arg)
+{
+    Thread *thread = arg;
+    thread->fn(thread->arg);
+    return 0;
+}
+
+bool thread_create(Thread *thread, Thread_Fn fn, void *arg)
+{
+    assert(thread);
+    assert(fn);
+
+    thread->fn = fn;
+    thread->arg = arg;
+    thread->handle = CreateThread(NULL, 0, thread_trampoline, thread, 0, NULL);
+    return thread->handle != NULL;
+}
+
+void thread_join(Thread *thread)
+{
+    assert(thread);
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+void mutex_lock(Mutex *mutex)
+{
+    assert(mutex);
+    AcquireSRWLockExclusive(&mutex->lock);
+}
+
+void mutex_unlock(Mutex *mutex)
+{
+    assert(mutex);
+    ReleaseSRWLockExclusive(&mutex->lock);
+}
+
+void cond_wait(Cond *cond, Mutex *mutex)
+{
+    assert(cond);
+    assert(mutex);
+    BOOL res = SleepConditionVariableSRW(&cond->cond, &mutex->lock, INFINITE, 0);
+    assert(res && "Failed to wait on condition");
+    (void) res;
+}
+
+void cond_signal(Cond *cond)
+{
+    assert(cond);
+    WakeConditionVariable(&cond->cond);
+}
+
+static BOOL CALLBACK once_trampoline(PINIT_ONCE once, PVOID arg, PVOID *context)
+{
+    (void) once;
+    (void) context;
+    const Once_Fn *fn = arg;
+    (*fn)();
+    return TRUE;
+}
+
+void thread_once(Once *once, Once_Fn fn)
+{
+    assert(once);
+    assert(fn);
+    BOOL res = InitOnceExecuteOnce(&once->once, once_trampoline, (PVOID) &fn, NULL);
+    assert(res && "Failed to run once");
+    (void) res;
+}
+
+uint32_t atomic_add_u32(volatile uint32_t *target, uint32_t value)
+{
+    return (uint32_t) InterlockedExchangeAdd((volatile LONG *) target, (LONG) value);
+}
+
+uint32_t atomic_load_u32(volatile uint32_t *target)
+{
+    return (uint32_t) InterlockedCompareExchange((volatile LONG *) target, 0, 0);
+}
+
+void *atomic_load_ptr(void *volatile *target)
+{
+    return InterlockedCompareExchangePointer(target, NULL, NULL);
+}
+
+bool atomic_cas_ptr(void *volatile *target, void *expected, void *desired)
+{
+    return InterlockedCompareExchangePointer(target, desired, expected) == expected;
+}
+
+size_t thread_hardware_count(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (size_t) info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+static void *thread_trampoline(void *arg)
+{
+    Thread *thread = arg;
+    thread->fn(thread->arg);
+    return NULL;
+}
+
+bool thread_create(Thread *thread, Thread_Fn fn, void *arg)
+{
+    assert(thread);
+    assert(fn);
+
+    thread->fn = fn;
+    thread->arg = arg;
+    return pthread_create(&thread->handle, NULL, thread_trampoline, thread) == 0;
+}
+
+void thread_join(Thread *thread)
+{
+    assert(thread);
+    pthread_join(thread->handle, NULL);
+}
+
+void mutex_lock(Mutex *mutex)
+{
+    assert(mutex);
+    int res = pthread_mutex_lock(&mutex->lock);
+    assert(res == 0 && "Failed to lock mutex");
+    (void) res;
+}
+
+void mutex_unlock(Mutex *mutex)
+{
+    assert(mutex);
+    int res = pthread_mutex_unlock(&mutex->lock);
+    assert(res == 0 && "Failed to unlock mutex");
+    (void) res;
+}
+
+void cond_wait(Cond *cond, Mutex *mutex)
+{
+    assert(cond);
+    assert(mutex);
+    int res = pthread_cond_wait(&cond->cond, &mutex->lock);
+    assert(res == 0 && "Failed to wait on condition");
+    (void) res;
+}
+
+void cond_signal(Cond *cond)
+{
+    assert(cond);
+    int res = pthread_cond_signal(&cond->cond);
+    assert(res == 0 && "Failed to signal condition");
+    (void) res;
+}
+
+void thread_once(Once *once, Once_Fn fn)
+{
+    assert(once);
+    assert(fn);
+    int res = pthread_once(&once->once, fn);
+    assert(res == 0 && "Failed to run once");
+    (void) res;
+}
+
+uint32_t atomic_add_u32(volatile uint32_t *target, uint32_t value)
+{
+    return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST);
+}
+
+uint32_t atomic_load_u32(volatile uint32_t *target)
+{
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+void *atomic_load_ptr(void *volatile *target)
+{
+    return __atomic_load_n(target, __ATOMIC_ACQUIRE);
+}
+
+bool atomic_cas_ptr(void *volatile *target, void *expected, void *desired)
+{
+    return __atomic_compare_exchange_n(target, &expected, desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+size_t thread_hardware_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t) count : 1;
+}
+
+#endif
+
+// NOTE(HS): calls with more items than there are workers share them out among
+// the workers there are
+#define THREAD_POOL_MAX_WORKERS 63
+
+/// Workers run the items of the current `thread_run_each` call alongside the
+/// thread that made it, then wait for the next call. Every field after the
+/// workers is guarded by `lock`.
+typedef struct
+{
+    /// held for the whole of a call, so calls take turns
+    Mutex run_lock;
+    Mutex lock;
+    /// signalled when a call starts
+    Cond work_ready;
+    /// signalled when the last item of a call is done
+    Cond work_done;
+    Thread workers[THREAD_POOL_MAX_WORKERS];
+    size_t worker_count;
+
+    /// bumped by every call, so waiting workers can tell a new call from a
+    /// spurious wake up
+    uint32_t generation;
+    Thread_Fn fn;
+    char *items;
+    size_t item_size;
+    size_t count;
+    /// next item to claim
+    size_t next;
+    /// items not done yet, claimed or not
+    size_t remaining;
+} Thread_Pool;
+
+static Thread_Pool thread_pool = {
+    .run_lock = MUTEX_INIT,
+    .lock = MUTEX_INIT,
+    .work_ready = COND_INIT,
+    .work_done = COND_INIT,
+};
+
+static THREAD_LOCAL bool thread_pool_is_worker;
+
+/// Claims and runs items of the current call until none are left. Called with
+/// `pool->lock` held, which is released while each item runs.
+static void thread_pool_run_items(Thread_Pool *pool)
+{
+    while (pool->next < pool->count)
+    {
+        void *item = &pool->items[pool->next * pool->item_size];
+        Thread_Fn fn = pool->fn;
+        pool->next += 1;
+
+        mutex_unlock(&pool->lock);
+        fn(item);
+        mutex_lock(&pool->lock);
+
+        pool->remaining -= 1;
+        if (pool->remaining == 0)
+        {
+            cond_signal(&pool->work_done);
+        }
+    }
+}
+
+static void thread_pool_worker(void *arg)
+{
+    Thread_Pool *pool = arg;
+    thread_pool_is_worker = true;
+
+    mutex_lock(&pool->lock);
+    for (;;)
+    {
+        // NOTE(HS): a worker started by a call joins in on it straight away
+        thread_pool_run_items(pool);
+        uint32_t generation = pool->generation;
+        while (pool->generation == generation)
+        {
+            cond_wait(&pool->work_ready, &pool->lock);
+        }
+    }
+}
+
+void thread_run_each(Thread_Fn fn, void *items, size_t item_size, size_t count)
+{
+    assert(fn);
+    assert(items || count == 0);
+
+    char *item = items;
+    if (count <= 1 || thread_pool_is_worker)
+    {
+        // NOTE(HS): a worker waiting on the pool for its own items would never
+        // get them, it's already taken
+        for (size_t i = 0; i < count; ++i)
+        {
+            fn(&item[i * item_size]);
+        }
+        return;
+    }
+
+    Thread_Pool *pool = &thread_pool;
+    mutex_lock(&pool->run_lock);
+    mutex_lock(&pool->lock);
+
+    size_t wanted = count - 1 < THREAD_POOL_MAX_WORKERS ? count - 1 : THREAD_POOL_MAX_WORKERS;
+    while (pool->worker_count < wanted
+        && thread_create(&pool->workers[pool->worker_count], thread_pool_worker, pool))
+    {
+        pool->worker_count += 1;
+    }
+
+    pool->generation += 1;
+    pool->fn = fn;
+    pool->items = item;
+    pool->item_size = item_size;
+    pool->count = count;
+    pool->next = 0;
+    pool->remaining = count;
+    for (size_t i = 0; i < wanted && i < pool->worker_count; ++i)
+    {
+        cond_signal(&pool->work_ready);
+    }
+
+    thread_pool_run_items(pool);
+    while (pool->remaining > 0)
+    {
+        cond_wait(&pool->work_done, &pool->lock);
+    }
+
+    pool->fn = NULL;
+    pool->items = NULL;
+    pool->count = 0;
+    pool->next = 0;
+
+    mutex_unlock(&pool->lock);
+    mutex_unlock(&pool->run_lock);
+}
@@ -0,0 +1,55 @@
+/**
+ * Bump allocator over a list of blocks. Allocations are never moved or freed
+ * individually, everything is released at once by `arena_free`, so pointers into
+ * an arena stay valid for the arena's lifetime.
+*/
+#ifndef TYGER_ARENA_H_
+#define TYGER_ARENA_H_
+#include <stddef.h>
+
+/// Size of the blocks an arena allocates from, unless an allocation needs more.
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+/// Stands in for C11's `alignof`.
+#define ARENA_ALIGNOF(T) offsetof(struct { char c; T t; }, t)
+
+/// Allocates an (uninitialised) `T`, or an array of `N` of them, from `ARENA`.
+#define arena_new(ARENA, T) ((T*) arena_alloc((ARENA), sizeof(T), ARENA_ALIGNOF(T)))
+#define arena_new_array(ARENA, T, N) ((T*) arena_alloc((ARENA), sizeof(T) * (N), ARENA_ALIGNOF(T)))
+
+typedef struct arena_block_s Arena_Block;
+
+/// An empty arena is zero initialised, blocks are only allocated on first use.
+typedef struct
+{
+    Arena_Block *head;
+    /// total bytes handed out, for statistics
+    size_t used;
+} Arena;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Allocates `size` bytes aligned to `align`, which must be a power of 2.
+void *arena_alloc(Arena *arena, size_t size, size_t align);
+
+/// Copies `len` bytes of `str` into the arena, followed by a NUL terminator.
+char *arena_strndup(Arena *arena, const char *str, size_t len);
+
+/// Releases every allocation at once, keeping the current block for reuse, so an
+/// arena reset between rounds of similar size stops allocating.
+void arena_reset(Arena *arena);
+
+/// Moves every block of `src` into `dst`, leaving `src` empty. Allocations made
+/// from `src` stay valid for the lifetime of `dst`.
+void arena_adopt(Arena *dst, Arena *src);
+
+/// Frees every block of the arena, leaving it empty and ready for reuse.
+void arena_free(Arena *arena);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_ARENA_H_
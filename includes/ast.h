@@ -4,6 +4,7 @@
 #include <stdbool.h>
 
 #include "lexer.h"
+#include "symbol.h"
 
 #define AST_STATEMENT_KIND_LIST \
     X(ILLGEAL_STATEMENT)        \
@@ -38,9 +39,12 @@ typedef enum
     #undef X
 } Expression_Kind;
 
+/// `ident` is the symbol's name, owned by the symbol table. Compare identifiers
+/// by `symbol`.
 typedef struct
 {
     const char *ident;
+    Symbol symbol;
 } Ident_Expression;
 
 typedef struct
@@ -81,17 +85,24 @@ typedef struct
 } If_Expression;
 
 // TODO(HS): conform to dynamic array "interface"
+// NOTE(HS): 32-bit counts leave room for the body's token range in
+// `Function_Expression` without growing `Expression`
 typedef struct
 {
-    size_t len;
-    size_t capacity;
+    uint32_t len;
+    uint32_t capacity;
     Ident_Expression *idents;
 } Parameters;
 
+/// `body` is NULL while the body is unparsed, see `Parser.lazy_function_bodies`.
 typedef struct
 {
     Parameters parameters;
     Block_Statement *body;
+    /// token indices of the body's `{` and `}`, counted from the start of the
+    /// stream for a parser over one
+    uint32_t body_open;
+    uint32_t body_close;
 } Function_Expression;
 
 typedef union
@@ -121,6 +132,7 @@ typedef struct
 typedef struct
 {
     const char *ident;
+    Symbol symbol;
     Expression expression;
 } Var_Statement;
 
@@ -142,17 +154,26 @@ typedef union
     Expression_Statement expression_statement;
 } uStatement;
 
+/// `token_count` is the number of tokens from the statement's first token to the
+/// next statement's, or to the end of its block (the `}`, or EOF at the top level).
+/// Positions are kept relative so that unchanged statements can be reused as they
+/// are when the tokens before them change, see `incremental_parser.h`.
 typedef struct
 {
     Statement_Kind kind;
+    uint32_t token_count;
     uStatement stmt;
 } Statement;
 
+/// `open` is the offset of the block's `{` from the first token of the statement
+/// it is in. It is 0 for the body of a function parsed on its own by
+/// `parser_parse_function_body`.
 struct block_statement_s
 {
     size_t len;
     size_t capacity;
     Statement *statements;
+    uint32_t open;
 };
 
 #if defined(__cplusplus)
@@ -162,8 +183,6 @@ extern "C" {
 const char *ast_statement_kind_to_str(Statement_Kind k);
 const char *ast_expression_kind_to_str(Expression_Kind k);
 
-void ast_free_node(Statement *stmt);
-
 #if defined(__cplusplus)
 }
 #endif
@@ -0,0 +1,74 @@
+/**
+ * On disk cache of parsed programs, so an unchanged script doesn't have to be
+ * lexed and parsed again on every run.
+ *
+ * A cache file is a `Flat_Ast` written out as is, after a fixed header: the node
+ * kinds and payloads and each pool, one after the other. The flat AST refers to
+ * its nodes by index rather than by pointer, so the file is position independent
+ * and is memory mapped and used in place when read back. Symbols are the one
+ * exception, being ids into the process wide symbol table, so the cache has its
+ * own string table of the names used, and refers to them by their index in it
+ * instead. They are interned when the cache is opened, and the few arrays
+ * holding symbols are copied with the ids of this process.
+ *
+ * Each file records the hash and length of the source it was made from, and the
+ * format version. A cache that doesn't match the source, or was written by
+ * another version, is rejected rather than used.
+*/
+#ifndef TYGER_AST_CACHE_H_
+#define TYGER_AST_CACHE_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "flat_ast.h"
+#include "source.h"
+
+/// Bumped on any change to the file layout or the meaning of a flat AST node.
+#define AST_CACHE_VERSION 1
+
+/// Added to a script's path to get the path of its cache, see `ast_cache_path`.
+#define AST_CACHE_EXTENSION ".tyc"
+
+typedef struct
+{
+    /// the mapped cache file
+    Source file;
+    /// the cached program, valid until `ast_cache_close`
+    ///
+    /// @note Most of its arrays point into the mapped file, so the AST must not be
+    /// modified, nor passed to `flat_ast_free`.
+    Flat_Ast ast;
+} Ast_Cache;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Hash of a script's source, the key a cache is checked against.
+uint64_t ast_cache_hash(const char *source, size_t source_len);
+
+/// Path of the cache for the script at `script_path`, next to the script. The
+/// returned string must be freed by the caller.
+char *ast_cache_path(const char *script_path);
+
+/// Writes `ast`, parsed from `source`, to a cache file at `path`. The file is
+/// written under a temporary name and renamed into place, so a cache being
+/// read is never seen half written. Returns false if the file couldn't be
+/// written.
+///
+/// @note A program with syntax errors shouldn't be cached, as its errors aren't.
+bool ast_cache_write(const char *path, const Flat_Ast *ast, const char *source, size_t source_len);
+
+/// Opens the cache file at `path`, checking that it was made from `source` by
+/// this version, and that its nodes are well formed. Returns false if there's
+/// no such file or it can't be used, in which case the source has to be parsed.
+bool ast_cache_open(Ast_Cache *cache, const char *path, const char *source, size_t source_len);
+
+void ast_cache_close(Ast_Cache *cache);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_AST_CACHE_H_
@@ -46,18 +46,18 @@
 /// @param TYPE The type of the elements within the underlying buffer
 /// @param DA Pointer to the dynamic array to append elements to
 /// @param VAL Pointer to the value to append into the dynamic array
-#define da_append(TYPE, DA, VAL)                                      \
-    do {                                                              \
-        if ((DA)->len + 1 > (DA)->capacity) {                         \
-            size_t new_capacity = (DA)->capacity * 2;                 \
-            TYPE *new_buffer = realloc((DA)->elements, new_capacity); \
-            if (new_buffer != (DA)->elements) {                       \
-                (DA)->elements = new_buffer;                          \
-            }                                                         \
-            (DA)->capacity = new_capacity;                            \
-        }                                                             \
-        memcpy(&((DA)->elements[(DA)->len]), VAL, sizeof(TYPE));      \
-        (DA)->len += 1;                                               \
+#define da_append(TYPE, DA, VAL)                                              \
+    do {                                                                      \
+        if ((DA)->len + 1 > (DA)->capacity) {                                 \
+            size_t new_capacity = (DA)->capacity * 2;                         \
+            TYPE *new_buffer = realloc((DA)->elements, sizeof(TYPE) * new_capacity);\
+            if (new_buffer != (DA)->elements) {                               \
+                (DA)->elements = new_buffer;                                  \
+            }                                                                 \
+            (DA)->capacity = new_capacity;                                    \
+        }                                                                     \
+        memcpy(&((DA)->elements[(DA)->len]), VAL, sizeof(TYPE));              \
+        (DA)->len += 1;                                                       \
     } while (0)
 
 // resize dynamic array down to the number of elements actually neeeded
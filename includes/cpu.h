@@ -0,0 +1,37 @@
+/**
+ * Runtime detection of the instruction set extensions available on the host CPU,
+ * used to select between scalar and vectorised implementations of hot loops.
+*/
+#ifndef TYGER_CPU_H_
+#define TYGER_CPU_H_
+
+#if defined(__x86_64__) || defined(_M_X64)
+/// Defined when building for a target where SSE2 is always available and the
+/// SSE2/AVX2 kernels are compiled in.
+#define TYGER_CPU_X86_64 1
+#endif
+
+/// Instruction set levels, ordered such that each level implies all previous ones.
+typedef enum
+{
+    CPU_ISA_SCALAR,
+    CPU_ISA_SSE2,
+    CPU_ISA_AVX2,
+    CPU_ISA_COUNT
+} Cpu_Isa;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Returns the highest instruction set level supported by both the CPU and the OS
+/// (i.e. AVX2 is only reported when the OS saves YMM state on context switch).
+Cpu_Isa cpu_detect_isa(void);
+
+const char *cpu_isa_to_string(Cpu_Isa isa);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_CPU_H_
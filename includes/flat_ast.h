@@ -0,0 +1,190 @@
+/**
+ * Compact, index based, alternative representation of a parsed program.
+ *
+ * Every node is a `Flat_Node` index. Node kinds are stored in one dense byte
+ * array, alongside a 32-bit payload per node. Leaves keep their value in the
+ * payload (an ident's symbol, an int's bits) and need nothing else, other nodes
+ * keep the index of their entry in the typed pool for their kind, where children
+ * are again referred to by index. Nodes are numbered in pre-order, so a linear
+ * pass over `kinds` visits the program in source order.
+ *
+ * A leaf costs 5 bytes, against the `sizeof(Expression)` of the pointer AST.
+*/
+#ifndef TYGER_FLAT_AST_H_
+#define TYGER_FLAT_AST_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lexer.h"
+#include "parser.h"
+#include "symbol.h"
+
+#define FLAT_NODE_KIND_LIST   \
+    X(NONE)                   \
+    X(BLOCK)                  \
+    X(ILLEGAL_STATEMENT)      \
+    X(VAR_STATEMENT)          \
+    X(RETURN_STATEMENT)       \
+    X(EXPRESSION_STATEMENT)   \
+    X(IDENT_EXPRESSION)       \
+    X(INT_EXPRESSION)         \
+    X(FLOAT_EXPRESSION)       \
+    X(BOOLEAN_EXPRESSION)     \
+    X(PREFIX_EXPRESSION)      \
+    X(INFIX_EXPRESSION)       \
+    X(IF_EXPRESSION)          \
+    X(FUNCTION_EXPRESSION)
+
+typedef enum
+{
+    #define X(NAME) FLAT_##NAME,
+    FLAT_NODE_KIND_LIST
+    #undef X
+    FLAT_NODE_KIND_COUNT
+} Flat_Node_Kind;
+
+typedef uint32_t Flat_Node;
+
+/// Node 0 is reserved, so usable as "no node" (e.g. an if without an else).
+#define FLAT_NODE_NONE ((Flat_Node) 0)
+
+typedef struct
+{
+    Symbol symbol;
+    Flat_Node value;
+} Flat_Var;
+
+typedef struct
+{
+    /// '-' or '!'
+    uint32_t op;
+    Flat_Node rhs;
+} Flat_Prefix;
+
+typedef struct
+{
+    /// `Token_Kind` of the operator
+    uint32_t op;
+    Flat_Node lhs;
+    Flat_Node rhs;
+} Flat_Infix;
+
+typedef struct
+{
+    Flat_Node condition;
+    /// both blocks
+    Flat_Node consequence;
+    Flat_Node alternative;
+} Flat_If;
+
+typedef struct
+{
+    /// range of `Flat_Ast.parameters`
+    uint32_t first_parameter;
+    uint32_t parameter_count;
+    /// a block
+    Flat_Node body;
+} Flat_Function;
+
+typedef struct
+{
+    /// range of `Flat_Ast.block_statements`
+    uint32_t first;
+    uint32_t len;
+} Flat_Block;
+
+#define FLAT_POOL(NAME, T) \
+    typedef struct { size_t capacity; size_t len; T *elements; } NAME
+
+/// @note Dynamic arrays, see `containers.h`.
+FLAT_POOL(Flat_Var_Pool,      Flat_Var);
+FLAT_POOL(Flat_Prefix_Pool,   Flat_Prefix);
+FLAT_POOL(Flat_Infix_Pool,    Flat_Infix);
+FLAT_POOL(Flat_If_Pool,       Flat_If);
+FLAT_POOL(Flat_Function_Pool, Flat_Function);
+FLAT_POOL(Flat_Block_Pool,    Flat_Block);
+FLAT_POOL(Flat_Node_Pool,     Flat_Node);
+FLAT_POOL(Flat_Symbol_Pool,   Symbol);
+
+#undef FLAT_POOL
+
+typedef struct
+{
+    /// number of nodes, including the reserved node 0
+    size_t len;
+    size_t capacity;
+    /// `Flat_Node_Kind` of each node
+    uint8_t *kinds;
+    /// the value of a leaf (`Token_Value.bits` for literals and idents, 0 or 1
+    /// for booleans), the child of a return or expression statement, or the
+    /// node's index in the pool for its kind
+    uint32_t *payloads;
+
+    Flat_Var_Pool vars;
+    Flat_Prefix_Pool prefixes;
+    Flat_Infix_Pool infixes;
+    Flat_If_Pool ifs;
+    Flat_Function_Pool functions;
+    Flat_Block_Pool blocks;
+    Flat_Node_Pool block_statements;
+    Flat_Symbol_Pool parameters;
+
+    /// block of the program's top level statements
+    Flat_Node root;
+} Flat_Ast;
+
+/// Called by `flat_ast_walk` for each node, with its depth below the starting
+/// node. Returning false skips the node's children.
+typedef bool (*Flat_Ast_Visit_Fn) (const Flat_Ast *ast, Flat_Node node, size_t depth, void *user);
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+const char *flat_node_kind_to_str(Flat_Node_Kind kind);
+
+/// Builds the flat representation of `prog`, replacing any previous contents of
+/// `ast`. The program may be freed afterwards.
+void flat_ast_from_program(Flat_Ast *ast, const Program *prog);
+void flat_ast_free(Flat_Ast *ast);
+
+/// Rebuilds a pointer based program from `ast`, allocating every node from the
+/// program's arena. The inverse of `flat_ast_from_program`, except that an
+/// illegal statement's token only keeps its position, and a function whose body
+/// was never parsed can no longer be parsed on demand.
+Program flat_ast_to_program(const Flat_Ast *ast);
+
+/// Bytes of memory used by the nodes and pools (not counting spare capacity).
+size_t flat_ast_size_bytes(const Flat_Ast *ast);
+
+/// Visits `node` and its descendants in pre-order, children in source order.
+void flat_ast_walk(const Flat_Ast *ast, Flat_Node node, Flat_Ast_Visit_Fn visit, void *user);
+
+Flat_Node_Kind flat_ast_kind(const Flat_Ast *ast, Flat_Node node);
+
+Symbol flat_ast_ident(const Flat_Ast *ast, Flat_Node node);
+int32_t flat_ast_int(const Flat_Ast *ast, Flat_Node node);
+float flat_ast_float(const Flat_Ast *ast, Flat_Node node);
+bool flat_ast_boolean(const Flat_Ast *ast, Flat_Node node);
+
+/// The expression of a return or expression statement.
+Flat_Node flat_ast_statement_expression(const Flat_Ast *ast, Flat_Node node);
+
+const Flat_Var *flat_ast_var(const Flat_Ast *ast, Flat_Node node);
+const Flat_Prefix *flat_ast_prefix(const Flat_Ast *ast, Flat_Node node);
+const Flat_Infix *flat_ast_infix(const Flat_Ast *ast, Flat_Node node);
+const Flat_If *flat_ast_if(const Flat_Ast *ast, Flat_Node node);
+const Flat_Function *flat_ast_function(const Flat_Ast *ast, Flat_Node node);
+
+/// Statements of a block, `*len` of them.
+const Flat_Node *flat_ast_block_statements(const Flat_Ast *ast, Flat_Node node, size_t *len);
+
+/// Parameters of a function, `*len` of them.
+const Symbol *flat_ast_parameters(const Flat_Ast *ast, Flat_Node node, size_t *len);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_FLAT_AST_H_
@@ -0,0 +1,65 @@
+/**
+ * Reparsing of a program after small edits to its text, for editors and hot
+ * reloading, reusing every statement the edit didn't touch.
+ *
+ * Every statement records the number of tokens it covers, and every block where
+ * its `{` is within its statement (see `Statement.token_count` and
+ * `Block_Statement.open`), relative rather than absolute so the statements after
+ * an edit are still correct once the tokens have shifted. After relexing, the
+ * parser descends from the top level into the innermost block whose inside holds
+ * every changed token, and reparses the statements there from the first one the
+ * change could affect (a statement also depends on the token after it, which
+ * decides where it ends), until a statement ends where one of the old ones
+ * starts past the change. The statements from there on are kept as they are.
+ * Should the new statements run into the end of the block somewhere other than
+ * its old `}`, e.g. because a brace was added or removed, the block's statement
+ * is reparsed one level up instead. The work done is proportional to the changed
+ * statements and the depth and width of the blocks around them, not the program.
+ *
+ * The result is the same program, and errors, as a full parse of the new text.
+ * A program with syntax errors is reparsed in full on the next edit, as errors
+ * and illegal statements refer to absolute positions. The nodes replaced by an
+ * edit stay in the program's arena, so once as many tokens have been reparsed
+ * as the program has, the next edit reparses it in full to reclaim them.
+ *
+ * @note Function bodies are always parsed, and `Function_Expression.body_open`
+ * and `body_close` aren't kept up to date.
+*/
+#ifndef TYGER_INCREMENTAL_PARSER_H_
+#define TYGER_INCREMENTAL_PARSER_H_
+#include <stddef.h>
+
+#include "lexer.h"
+#include "parser.h"
+
+typedef struct
+{
+    /// tokens of the current text
+    Token_Buffer tokens;
+    /// parser over `tokens`, its errors being those of `program`
+    Parser parser;
+    /// program of the current text
+    Program program;
+    /// tokens reparsed since the last full parse
+    size_t reparsed_tokens;
+} Incremental_Parser;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Lexes and parses `input` in full. The text must stay valid until the next
+/// edit, and the parser must not be moved, as it refers to its own tokens.
+void incremental_parser_init(Incremental_Parser *ip, const char *input, size_t input_len);
+
+/// Updates the program for `edit`, `input` being the whole text after it. Returns
+/// the number of tokens parsed to do so.
+size_t incremental_parser_edit(Incremental_Parser *ip, const char *input, size_t input_len, Text_Edit edit);
+
+void incremental_parser_free(Incremental_Parser *ip);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_INCREMENTAL_PARSER_H_
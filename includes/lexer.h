@@ -1,6 +1,8 @@
 #ifndef TYGER_LEXER_H_
 #define TYGER_LEXER_H_
 #include <stddef.h>
+#include <stdint.h>
+#include "symbol.h"
 #include "tstrings.h"
 
 typedef enum
@@ -47,6 +49,9 @@ typedef enum
     TOKEN_KIND_COUNT
 } Token_Kind;
 
+/// A position in the input. The lexer only tracks the byte offset `pos`, `line`
+/// and `col` (both 1-based) are filled in on demand by `lexer_location`,
+/// `token_buffer_location` or `line_index_lookup`, and are 0 otherwise.
 typedef struct
 {
     size_t pos;
@@ -54,22 +59,114 @@ typedef struct
     size_t col;
 } Location;
 
+/// Byte offset of the start of every line of an input, used to turn a byte offset
+/// into a line and column with a binary search.
+///
+/// @note Dynamic array of `size_t`, see `containers.h`.
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    size_t *elements;
+    size_t input_len;
+} Line_Index;
+
+/// Value of a token, decoded by the lexer. `i` is set for `TK_INT_LIT`, `f` for
+/// `TK_FLOAT_LIT` and `symbol` (the interned name) for `TK_IDENT`. A `TK_STRING_LIT`
+/// containing escape sequences (`\n`, `\t`, `\r`, `\0`, `\\` and `\"`) has its
+/// contents decoded into the `Token_Strings` of the lexer or token buffer it came
+/// from, `string` being their offset there, see `token_string_contents`. One
+/// without any leaves `string` as 0, as its contents are the literal itself. For
+/// every other kind of token the value is 0. `bits` is the raw representation,
+/// for storing values compactly.
+typedef union
+{
+    int32_t i;
+    float f;
+    Symbol symbol;
+    uint32_t string;
+    uint32_t bits;
+} Token_Value;
+
+/// Decoded contents of the string literals with escape sequences, see
+/// `Token_Value`. Each is stored as its length, a `uint32_t`, followed by its
+/// bytes, and is found by the offset of its bytes alone. Strings are addressed by
+/// offset, so the store can grow without invalidating the tokens.
+///
+/// @note Dynamic array of `char`, see `containers.h`.
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    char *elements;
+} Token_Strings;
+
 typedef struct
 {
     Token_Kind kind;
     Location location;
     String_View literal;
+    Token_Value value;
 }Token;
 
 typedef struct
 {
     const char *input;
     size_t input_len;
-    Location location;
+    size_t pos;
     size_t read_pos;
     char ch;
+    Line_Index lines;
+    /// decoded contents of the string literals lexed, see `Token_Value`
+    Token_Strings strings;
 } Lexer;
 
+/// Every token of an input, stored as a struct-of-arrays so a pass over the kinds
+/// (e.g. lookahead in the parser) touches as little memory as possible. Token
+/// literals are views into `input`, so the input must outlive the buffer.
+///
+/// @note Only the byte offset of each token is stored, `token_buffer_get` leaves
+/// the line and column of the token's location as 0. Use `token_buffer_location`
+/// when they are needed.
+/// @note The final token is always `TK_EOF`.
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    uint8_t *kinds;
+    uint32_t *offsets;
+    uint32_t *lengths;
+    /// `Token_Value.bits` of each token
+    uint32_t *values;
+    const char *input;
+    size_t input_len;
+    Line_Index lines;
+    /// decoded contents of the string literals, see `Token_Value`. Relexing
+    /// appends the strings it decodes, leaving those of the tokens it replaced.
+    Token_Strings strings;
+    /// bytes of `strings` left by relexing that no token refers to, they are
+    /// dropped once they make up most of it
+    size_t strings_dead;
+} Token_Buffer;
+
+/// An edit to a piece of text: `removed_len` bytes at `offset` replaced by
+/// `inserted_len` new bytes.
+typedef struct
+{
+    size_t offset;
+    size_t removed_len;
+    size_t inserted_len;
+} Text_Edit;
+
+/// The tokens changed by relexing after a `Text_Edit`: `removed` tokens from index
+/// `first` of the old buffer were replaced by `inserted` new ones.
+typedef struct
+{
+    size_t first;
+    size_t removed;
+    size_t inserted;
+} Token_Edit;
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -77,8 +174,59 @@ extern "C" {
 const char *token_kind_to_string(Token_Kind kind);
 
 void lexer_init(Lexer *lexer, const char *input);
+
+/// Initialises the lexer over the first `input_len` bytes of `input`, which need
+/// not be NUL terminated (e.g. a memory mapped file). No byte past `input_len` is
+/// ever read, and a NUL byte within the input lexes as `TK_ILLEGAL`.
+void lexer_init_n(Lexer *lexer, const char *input, size_t input_len);
+void lexer_free(Lexer *lexer);
 Token lexer_next_token(Lexer *lexer);
 
+/// Table driven equivalent of `lexer_next_token`, producing an identical token
+/// stream. Each token is recognised by a single loop over a generated DFA (see
+/// scripts/lexer_dfa_gen.py) rather than a switch on the first character.
+Token lexer_next_token_dfa(Lexer *lexer);
+
+/// Contents of a `TK_STRING_LIT` with its escape sequences decoded. Without any
+/// escapes this is the token's literal, a view into the input, and otherwise a
+/// view into `strings`, those of the lexer or token buffer the token came from.
+///
+/// @note the view is only valid until more is lexed into `strings`.
+String_View token_string_contents(const Token_Strings *strings, Token token);
+
+/// Line and column of the byte at `pos` in the lexer's input. The line index is
+/// built on the first call, so the lexer itself never has to count lines.
+Location lexer_location(Lexer *lexer, size_t pos);
+
+/// Lexes the remainder of the lexer's input into `tokens` in a single pass. Any
+/// previous contents of `tokens` are discarded.
+void lexer_tokenize_all(Lexer *lexer, Token_Buffer *tokens);
+
+/// Returns the token at `index` in the buffer as a `Token`.
+Token token_buffer_get(const Token_Buffer *tokens, size_t index);
+
+/// Line and column of the token at `index`, building the buffer's line index on
+/// the first call.
+Location token_buffer_location(Token_Buffer *tokens, size_t index);
+void token_buffer_free(Token_Buffer *tokens);
+
+/// Updates `tokens`, lexed from the text before `edit`, to be the tokens of `input`,
+/// the whole text after it. Only the tokens from the last one before the edit up to
+/// the point the token stream resynchronises are re-lexed, later tokens just have
+/// their offsets shifted. Returns the number of tokens lexed.
+size_t token_buffer_relex(Token_Buffer *tokens, const char *input, size_t input_len, Text_Edit edit);
+
+/// As `token_buffer_relex`, returning which tokens were replaced.
+Token_Edit token_buffer_relex_edit(Token_Buffer *tokens, const char *input, size_t input_len, Text_Edit edit);
+
+/// Builds the line index for `input`, replacing any previous contents.
+void line_index_build(Line_Index *index, const char *input, size_t input_len);
+
+/// Line and column of the byte at `pos`. Positions at or past the end of the input
+/// are reported at the final byte, the way the lexer reports `TK_EOF`.
+Location line_index_lookup(const Line_Index *index, size_t pos);
+void line_index_free(Line_Index *index);
+
 #if defined(__cplusplus)
 }
 #endif
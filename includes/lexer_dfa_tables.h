@@ -0,0 +1,304 @@
+/**
+ * GENERATED by scripts/lexer_dfa_gen.py - DO NOT EDIT
+ *
+ * Tables for the table driven lexer, `lexer_next_token_dfa`.
+*/
+#ifndef TYGER_LEXER_DFA_TABLES_H_
+#define TYGER_LEXER_DFA_TABLES_H_
+#include <stdint.h>
+#include "lexer.h"
+
+typedef enum
+{
+    LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_UNDERSCORE,
+    LEXER_DFA_CLASS_DIGIT,
+    LEXER_DFA_CLASS_PERIOD,
+    LEXER_DFA_CLASS_QUOTE,
+    LEXER_DFA_CLASS_BACKSLASH,
+    LEXER_DFA_CLASS_EQUALS,
+    LEXER_DFA_CLASS_BANG,
+    LEXER_DFA_CLASS_LT,
+    LEXER_DFA_CLASS_GT,
+    LEXER_DFA_CLASS_PIPE,
+    LEXER_DFA_CLASS_AMP,
+    LEXER_DFA_CLASS_PLUS,
+    LEXER_DFA_CLASS_MINUS,
+    LEXER_DFA_CLASS_ASTERISK,
+    LEXER_DFA_CLASS_SLASH,
+    LEXER_DFA_CLASS_LPAREN,
+    LEXER_DFA_CLASS_RPAREN,
+    LEXER_DFA_CLASS_LBRACE,
+    LEXER_DFA_CLASS_RBRACE,
+    LEXER_DFA_CLASS_LBRACKET,
+    LEXER_DFA_CLASS_RBRACKET,
+    LEXER_DFA_CLASS_COLON,
+    LEXER_DFA_CLASS_SEMICOLON,
+    LEXER_DFA_CLASS_COMMA,
+    LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_COUNT
+} Lexer_Dfa_Class;
+
+typedef enum
+{
+    LEXER_DFA_STOP,
+    LEXER_DFA_START,
+    LEXER_DFA_IDENT,
+    LEXER_DFA_NUMBER,
+    LEXER_DFA_STRING_BODY,
+    LEXER_DFA_STRING_ESCAPE,
+    LEXER_DFA_STRING_END,
+    LEXER_DFA_ILLEGAL,
+    LEXER_DFA_ASSIGN,
+    LEXER_DFA_EQ,
+    LEXER_DFA_BANG,
+    LEXER_DFA_NEQ,
+    LEXER_DFA_LT,
+    LEXER_DFA_LTE,
+    LEXER_DFA_GT,
+    LEXER_DFA_GTE,
+    LEXER_DFA_PIPE,
+    LEXER_DFA_LOR,
+    LEXER_DFA_AMP,
+    LEXER_DFA_LAND,
+    LEXER_DFA_PLUS,
+    LEXER_DFA_MINUS,
+    LEXER_DFA_ASTERISK,
+    LEXER_DFA_SLASH,
+    LEXER_DFA_PERIOD,
+    LEXER_DFA_LPAREN,
+    LEXER_DFA_RPAREN,
+    LEXER_DFA_LBRACE,
+    LEXER_DFA_RBRACE,
+    LEXER_DFA_LBRACKET,
+    LEXER_DFA_RBRACKET,
+    LEXER_DFA_COLON,
+    LEXER_DFA_SEMICOLON,
+    LEXER_DFA_COMMA,
+    LEXER_DFA_STATE_COUNT
+} Lexer_Dfa_State;
+
+/// Character class of every byte
+static const uint8_t lexer_dfa_class[256] = {
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_BANG, LEXER_DFA_CLASS_QUOTE, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_AMP, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_LPAREN, LEXER_DFA_CLASS_RPAREN, LEXER_DFA_CLASS_ASTERISK, LEXER_DFA_CLASS_PLUS,
+    LEXER_DFA_CLASS_COMMA, LEXER_DFA_CLASS_MINUS, LEXER_DFA_CLASS_PERIOD, LEXER_DFA_CLASS_SLASH,
+    LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT,
+    LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT,
+    LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_DIGIT, LEXER_DFA_CLASS_COLON, LEXER_DFA_CLASS_SEMICOLON,
+    LEXER_DFA_CLASS_LT, LEXER_DFA_CLASS_EQUALS, LEXER_DFA_CLASS_GT, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_LBRACKET,
+    LEXER_DFA_CLASS_BACKSLASH, LEXER_DFA_CLASS_RBRACKET, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_UNDERSCORE,
+    LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA,
+    LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_ALPHA, LEXER_DFA_CLASS_LBRACE,
+    LEXER_DFA_CLASS_PIPE, LEXER_DFA_CLASS_RBRACE, LEXER_DFA_CLASS_OTHER, LEXER_DFA_CLASS_OTHER,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+    LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII, LEXER_DFA_CLASS_NON_ASCII,
+};
+
+/// Next state for each state and character class, `LEXER_DFA_STOP` ends the token
+static const uint8_t lexer_dfa_transitions[LEXER_DFA_STATE_COUNT][LEXER_DFA_CLASS_COUNT] = {
+    [LEXER_DFA_START] = {
+        [LEXER_DFA_CLASS_OTHER] = LEXER_DFA_ILLEGAL,
+        [LEXER_DFA_CLASS_ALPHA] = LEXER_DFA_IDENT,
+        [LEXER_DFA_CLASS_UNDERSCORE] = LEXER_DFA_ILLEGAL,
+        [LEXER_DFA_CLASS_DIGIT] = LEXER_DFA_NUMBER,
+        [LEXER_DFA_CLASS_PERIOD] = LEXER_DFA_PERIOD,
+        [LEXER_DFA_CLASS_QUOTE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_BACKSLASH] = LEXER_DFA_ILLEGAL,
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_ASSIGN,
+        [LEXER_DFA_CLASS_BANG] = LEXER_DFA_BANG,
+        [LEXER_DFA_CLASS_LT] = LEXER_DFA_LT,
+        [LEXER_DFA_CLASS_GT] = LEXER_DFA_GT,
+        [LEXER_DFA_CLASS_PIPE] = LEXER_DFA_PIPE,
+        [LEXER_DFA_CLASS_AMP] = LEXER_DFA_AMP,
+        [LEXER_DFA_CLASS_PLUS] = LEXER_DFA_PLUS,
+        [LEXER_DFA_CLASS_MINUS] = LEXER_DFA_MINUS,
+        [LEXER_DFA_CLASS_ASTERISK] = LEXER_DFA_ASTERISK,
+        [LEXER_DFA_CLASS_SLASH] = LEXER_DFA_SLASH,
+        [LEXER_DFA_CLASS_LPAREN] = LEXER_DFA_LPAREN,
+        [LEXER_DFA_CLASS_RPAREN] = LEXER_DFA_RPAREN,
+        [LEXER_DFA_CLASS_LBRACE] = LEXER_DFA_LBRACE,
+        [LEXER_DFA_CLASS_RBRACE] = LEXER_DFA_RBRACE,
+        [LEXER_DFA_CLASS_LBRACKET] = LEXER_DFA_LBRACKET,
+        [LEXER_DFA_CLASS_RBRACKET] = LEXER_DFA_RBRACKET,
+        [LEXER_DFA_CLASS_COLON] = LEXER_DFA_COLON,
+        [LEXER_DFA_CLASS_SEMICOLON] = LEXER_DFA_SEMICOLON,
+        [LEXER_DFA_CLASS_COMMA] = LEXER_DFA_COMMA,
+        [LEXER_DFA_CLASS_NON_ASCII] = LEXER_DFA_IDENT,
+    },
+    [LEXER_DFA_IDENT] = {
+        [LEXER_DFA_CLASS_ALPHA] = LEXER_DFA_IDENT,
+        [LEXER_DFA_CLASS_UNDERSCORE] = LEXER_DFA_IDENT,
+        [LEXER_DFA_CLASS_NON_ASCII] = LEXER_DFA_IDENT,
+    },
+    [LEXER_DFA_NUMBER] = {
+        [LEXER_DFA_CLASS_DIGIT] = LEXER_DFA_NUMBER,
+        [LEXER_DFA_CLASS_PERIOD] = LEXER_DFA_NUMBER,
+    },
+    [LEXER_DFA_STRING_BODY] = {
+        [LEXER_DFA_CLASS_OTHER] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_ALPHA] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_UNDERSCORE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_DIGIT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PERIOD] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_QUOTE] = LEXER_DFA_STRING_END,
+        [LEXER_DFA_CLASS_BACKSLASH] = LEXER_DFA_STRING_ESCAPE,
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_BANG] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_GT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PIPE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_AMP] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PLUS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_MINUS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_ASTERISK] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_SLASH] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LPAREN] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RPAREN] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LBRACE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RBRACE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LBRACKET] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RBRACKET] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_COLON] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_SEMICOLON] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_COMMA] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_NON_ASCII] = LEXER_DFA_STRING_BODY,
+    },
+    [LEXER_DFA_STRING_ESCAPE] = {
+        [LEXER_DFA_CLASS_OTHER] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_ALPHA] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_UNDERSCORE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_DIGIT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PERIOD] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_QUOTE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_BACKSLASH] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_BANG] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_GT] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PIPE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_AMP] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_PLUS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_MINUS] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_ASTERISK] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_SLASH] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LPAREN] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RPAREN] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LBRACE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RBRACE] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_LBRACKET] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_RBRACKET] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_COLON] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_SEMICOLON] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_COMMA] = LEXER_DFA_STRING_BODY,
+        [LEXER_DFA_CLASS_NON_ASCII] = LEXER_DFA_STRING_BODY,
+    },
+    [LEXER_DFA_ASSIGN] = {
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_EQ,
+    },
+    [LEXER_DFA_BANG] = {
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_NEQ,
+    },
+    [LEXER_DFA_LT] = {
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_LTE,
+    },
+    [LEXER_DFA_GT] = {
+        [LEXER_DFA_CLASS_EQUALS] = LEXER_DFA_GTE,
+    },
+    [LEXER_DFA_PIPE] = {
+        [LEXER_DFA_CLASS_PIPE] = LEXER_DFA_LOR,
+    },
+    [LEXER_DFA_AMP] = {
+        [LEXER_DFA_CLASS_AMP] = LEXER_DFA_LAND,
+    },
+};
+
+/// Token kind produced by ending in each state
+static const uint8_t lexer_dfa_accept[LEXER_DFA_STATE_COUNT] = {
+    [LEXER_DFA_IDENT] = TK_IDENT,
+    [LEXER_DFA_NUMBER] = TK_INT_LIT,
+    [LEXER_DFA_STRING_BODY] = TK_STRING_LIT,
+    [LEXER_DFA_STRING_ESCAPE] = TK_STRING_LIT,
+    [LEXER_DFA_STRING_END] = TK_STRING_LIT,
+    [LEXER_DFA_ILLEGAL] = TK_ILLEGAL,
+    [LEXER_DFA_ASSIGN] = TK_ASSIGN,
+    [LEXER_DFA_EQ] = TK_EQ,
+    [LEXER_DFA_BANG] = TK_BANG,
+    [LEXER_DFA_NEQ] = TK_NEQ,
+    [LEXER_DFA_LT] = TK_LT,
+    [LEXER_DFA_LTE] = TK_LTE,
+    [LEXER_DFA_GT] = TK_GT,
+    [LEXER_DFA_GTE] = TK_GTE,
+    [LEXER_DFA_PIPE] = TK_ILLEGAL,
+    [LEXER_DFA_LOR] = TK_LOR,
+    [LEXER_DFA_AMP] = TK_ILLEGAL,
+    [LEXER_DFA_LAND] = TK_LAND,
+    [LEXER_DFA_PLUS] = TK_PLUS,
+    [LEXER_DFA_MINUS] = TK_MINUS,
+    [LEXER_DFA_ASTERISK] = TK_ASTERISK,
+    [LEXER_DFA_SLASH] = TK_SLASH,
+    [LEXER_DFA_PERIOD] = TK_PERIOD,
+    [LEXER_DFA_LPAREN] = TK_LPAREN,
+    [LEXER_DFA_RPAREN] = TK_RPAREN,
+    [LEXER_DFA_LBRACE] = TK_LBRACE,
+    [LEXER_DFA_RBRACE] = TK_RBRACE,
+    [LEXER_DFA_LBRACKET] = TK_LBRACKET,
+    [LEXER_DFA_RBRACKET] = TK_RBRACKET,
+    [LEXER_DFA_COLON] = TK_COLON,
+    [LEXER_DFA_SEMICOLON] = TK_SEMICOLON,
+    [LEXER_DFA_COMMA] = TK_COMMA,
+};
+
+#endif // TYGER_LEXER_DFA_TABLES_H_
@@ -1,17 +1,75 @@
 #ifndef TYGER_LEXER_INTERNAL_H_
 #define TYGER_LEXER_INTERNAL_H_
+#include <stdbool.h>
 #include "tstrings.h"
 #include "lexer.h"
 
+/// Keywords and builtins recognised by the lexer. This is the only place a new
+/// keyword needs adding. The first and last characters are spelled out so the
+/// keyword's slot in the hash table can be computed at compile time.
+#define LEXER_KEYWORD_LIST               \
+    X(TK_TRUE,    "true",    't', 'e')   \
+    X(TK_FALSE,   "false",   'f', 'e')   \
+    X(TK_NIL,     "nil",     'n', 'l')   \
+    X(TK_IF,      "if",      'i', 'f')   \
+    X(TK_ELSE,    "else",    'e', 'e')   \
+    X(TK_FUNC,    "func",    'f', 'c')   \
+    X(TK_VAR,     "var",     'v', 'r')   \
+    X(TK_RETURN,  "return",  'r', 'n')   \
+    X(TK_PRINTLN, "println", 'p', 'n')
+
+/// Number of slots in the keyword hash table, must be a power of 2.
+#define LEXER_KEYWORD_SLOTS 32
+
+/// Perfect hash over the keyword set, keyed on length and first/last character.
+/// NOTE(HS): if a new keyword collides the table initialiser will have a duplicate
+/// designator, which is an error under -Werror (-Woverride-init). Tweak the
+/// multiplier or grow the table until it is collision free.
+#define LEXER_KEYWORD_HASH(LEN, FIRST, LAST)                                 \
+    (((size_t) (LEN) + (unsigned char) (FIRST) + 3u * (unsigned char) (LAST)) \
+        & (LEXER_KEYWORD_SLOTS - 1))
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
 void lexer_read_char(Lexer *lexer);
 char lexer_peek_char(const Lexer *lexer);
 void lexer_skip_whitespace(Lexer *lexer);
 
+/// Moves the lexer forward to the byte at `end` in one step, as though
+/// `lexer_read_char` had been called for every byte in between.
+void lexer_advance_to(Lexer *lexer, size_t end);
+
+/// Moves the lexer to the byte at `pos`, either forwards or backwards.
+void lexer_seek(Lexer *lexer, size_t pos);
+
 void lexer_read_number(Lexer *lexer);
-void lexer_read_string(Lexer *lexer);
+
+/// Reads up to the closing quote of a string literal (or the end of the input),
+/// jumping between quotes and backslashes with `scan_string`. A backslash escapes
+/// the byte after it. Returns true if the literal contains any escapes.
+bool lexer_read_string(Lexer *lexer);
 void lexer_read_ident(Lexer *lexer);
 
-Token_Kind string_view_to_number_kind(String_View sv);
+/// Classifies a run of `[0-9.]` as an int or float literal and decodes its value.
+/// Ints that don't fit in an `int32_t`, floats that overflow, and numbers with
+/// more than one decimal point are `TK_ILLEGAL`. Floats are correctly rounded.
+Token_Kind string_view_to_number(String_View sv, Token_Value *value);
 Token_Kind string_view_to_ident_or_keyword(String_View sv);
 
+/// Decodes the escape sequences of a string literal (excluding its quotes) into
+/// `strings`, returning the offset of the result, see `Token_Value`.
+uint32_t token_strings_push(Token_Strings *strings, String_View literal);
+
+/// Grows the token buffer's arrays to hold at least `capacity` tokens.
+void token_buffer_reserve(Token_Buffer *tokens, size_t capacity);
+
+/// Appends a token lexed from `tokens->input` to the buffer.
+void token_buffer_push(Token_Buffer *tokens, const Token *t);
+
+#if defined(__cplusplus)
+}
+#endif
+
 #endif // TYGER_LEXER_INTERNAL_H_
@@ -0,0 +1,47 @@
+/**
+ * Multi-threaded tokenizer for large inputs, producing exactly the same token
+ * buffer as `lexer_tokenize_all`.
+ *
+ * The input is split into one chunk per thread at newline boundaries. Only a
+ * string literal can span a newline, so the lexer state at the start of a chunk
+ * is just "inside" or "outside" a string. Each thread first works out, for both
+ * possible starting states, which state its chunk ends in (a cheap scan for `"`
+ * and `\`). Chaining those together gives the real starting state of every chunk,
+ * and each thread then lexes its chunk from that state. The chunks' tokens are
+ * checked to line up as they are stitched together; if they ever don't, the
+ * rest of the input is lexed sequentially instead.
+*/
+#ifndef TYGER_PARALLEL_LEXER_H_
+#define TYGER_PARALLEL_LEXER_H_
+#include <stddef.h>
+#include "lexer.h"
+
+/// Inputs smaller than this are lexed on the calling thread by default, as the
+/// cost of starting threads outweighs the gain.
+#define PARALLEL_LEXER_DEFAULT_MIN_SIZE (1024 * 1024)
+
+typedef struct
+{
+    /// number of threads to lex with, 0 for one per hardware thread
+    size_t thread_count;
+    /// inputs (remaining after the lexer's position) smaller than this many bytes
+    /// are lexed sequentially
+    size_t min_input_size;
+} Parallel_Lexer_Config;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+Parallel_Lexer_Config parallel_lexer_default_config(void);
+
+/// Parallel version of `lexer_tokenize_all`, lexes the remainder of the lexer's
+/// input into `tokens`. The lexer is left at the end of the input. `config` may
+/// be NULL to use `parallel_lexer_default_config`.
+void lexer_tokenize_parallel(Lexer *lexer, Token_Buffer *tokens, const Parallel_Lexer_Config *config);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_PARALLEL_LEXER_H_
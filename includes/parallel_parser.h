@@ -0,0 +1,48 @@
+/**
+ * Multi-threaded front end for `parser_parse_program`, producing the same
+ * statements and errors.
+ *
+ * A single pass over the token kinds tracks brace and paren nesting to find the
+ * `;`s that end top level statements, and the tokens are split into one segment
+ * per thread just after those. Each thread parses its segment's statements with
+ * its own parser, into its own arena. The segments are checked to line up as
+ * they are stitched together, i.e. that each one's last statement ended exactly
+ * where the next one starts, as input with syntax errors can throw the split
+ * off; if they ever don't, the rest is parsed sequentially instead. The
+ * segments' arenas are handed over to the program.
+*/
+#ifndef TYGER_PARALLEL_PARSER_H_
+#define TYGER_PARALLEL_PARSER_H_
+#include <stddef.h>
+#include "parser.h"
+
+/// Programs of fewer tokens than this are parsed on the calling thread by default,
+/// as the cost of starting threads outweighs the gain.
+#define PARALLEL_PARSER_DEFAULT_MIN_TOKENS (256 * 1024)
+
+typedef struct
+{
+    /// number of threads to parse with, 0 for one per hardware thread
+    size_t thread_count;
+    /// programs of fewer tokens (remaining after the parser's position) than this
+    /// are parsed sequentially
+    size_t min_token_count;
+} Parallel_Parser_Config;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+Parallel_Parser_Config parallel_parser_default_config(void);
+
+/// Parallel version of `parser_parse_program`, with the same results, honouring
+/// `p->lazy_function_bodies`, `p->max_expression_depth` and
+/// `p->max_nesting_depth`. `config` may be NULL to use
+/// `parallel_parser_default_config`.
+Program parser_parse_program_parallel(Parser *p, const Parallel_Parser_Config *config);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_PARALLEL_PARSER_H_
@@ -1,8 +1,12 @@
 #ifndef TYGER_PARSER_H_
 #define TYGER_PARSER_H_
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdio.h>
+#include "arena.h"
 #include "lexer.h"
 #include "ast.h"
+#include "stream_lexer.h"
 
 #ifndef INOUT
 /// markup for reminiding myself that a (pointer) parameter is both an input param
@@ -12,32 +16,264 @@
 
 typedef struct
 {
-    Lexer lexer;
-    Token cur_token;
-    Token peek_token;
-} Parser;
+    size_t capacity;
+    size_t len;
+    Statement *elements;
+} Statement_Array;
 
 typedef struct
 {
     size_t capacity;
     size_t len;
-    Statement *elements;
-} Statement_Array;
+    Ident_Expression *elements;
+} Ident_Array;
+
+/// Default of `Parser.max_expression_depth`.
+// NOTE(HS): open operators are kept on `scratch_frames`, not the C stack, so this
+// only bounds the memory they take
+#define PARSER_MAX_EXPRESSION_DEPTH 4096
+
+/// Default of `Parser.max_nesting_depth`.
+// NOTE(HS): each level of `if (a) { ... }` nesting takes around 660 bytes of C
+// stack in a release build and 1KB in a dev build (x86-64 GCC). `tyger --check`
+// on ifs nested past this depth runs in a 192KB stack in release and 288KB in
+// dev, within the 512KB of a macOS secondary thread and the 1MB of a Windows one.
+#define PARSER_MAX_NESTING_DEPTH 256
+
+/// What an operator on the expression stack still needs before it completes.
+typedef enum
+{
+    EXPRESSION_FRAME_NONE,
+    /// a prefix operator's operand
+    EXPRESSION_FRAME_PREFIX,
+    /// an infix operator's rhs
+    EXPRESSION_FRAME_INFIX,
+    /// a parenthesised expression and its `)`
+    EXPRESSION_FRAME_GROUP,
+} Expression_Frame_Kind;
+
+/// An operator of an expression being parsed, waiting on its operand.
+typedef struct
+{
+    Expression_Frame_Kind kind;
+    Token_Kind op;
+    /// precidence of the expression the operator is an operand of, restored
+    /// once it completes
+    int precidence;
+    /// the operator's lhs, for `EXPRESSION_FRAME_INFIX`
+    Expression lhs;
+} Expression_Frame;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Expression_Frame *elements;
+} Expression_Frame_Array;
+
+#define PARSE_ERROR_KIND_LIST \
+    X(EXPECTED_TOKEN)         \
+    X(EXPECTED_EXPRESSION)    \
+    X(EXPRESSION_TOO_DEEP)
+
+typedef enum
+{
+    #define X(NAME) PARSE_ERROR_##NAME,
+    PARSE_ERROR_KIND_LIST
+    #undef X
+} Parse_Error_Kind;
+
+typedef struct
+{
+    Parse_Error_Kind kind;
+    /// index of the offending token in the parser's token buffer, or in the stream
+    /// for a parser over one
+    size_t token;
+    /// the token kind that was expected, for `PARSE_ERROR_EXPECTED_TOKEN`
+    Token_Kind expected;
+} Parse_Error;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Parse_Error *elements;
+} Parse_Error_Array;
+
+/// Where an error of a parse over a stream was found, kept as the offending token
+/// may have been dropped by the time the error is reported.
+typedef struct
+{
+    Location location;
+    Token_Kind found;
+} Parse_Error_Site;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Parse_Error_Site *elements;
+} Parse_Error_Site_Array;
+
+typedef struct
+{
+    size_t capacity;
+    size_t len;
+    Location *elements;
+} Location_Array;
+
+/// Reads up to `capacity` bytes of a stream into `buffer`, returning how many were
+/// read, or 0 once the stream has ended.
+typedef size_t (*Parse_Read_Fn) (void *reader, char *buffer, size_t capacity);
+
+/// Bytes read from a stream at a time by a parser over it.
+#define PARSER_STREAM_CHUNK_SIZE 4096
+
+/// Source of the tokens of a parser over a stream, see `parser_init_stream`. The
+/// parser's token buffer is a window onto the stream, its tokens lexed as the
+/// parser reaches them.
+typedef struct
+{
+    Stream_Lexer lexer;
+    Parse_Read_Fn read;
+    void *reader;
+    char chunk[PARSER_STREAM_CHUNK_SIZE];
+    /// literals of the tokens in the window, back to back, which is the input of
+    /// the token buffer
+    char *text;
+    size_t text_len;
+    size_t text_capacity;
+    /// location of each token in the window
+    Location_Array locations;
+    /// tokens of the stream dropped from the front of the window
+    size_t dropped;
+    /// where each of the parser's errors was found
+    Parse_Error_Site_Array error_sites;
+} Parser_Stream;
 
+/// The parser walks a buffer of pre-lexed tokens by index, `cur` being the index of
+/// the current token. Lookahead of any distance is just an index into `tokens`.
+///
+/// Nodes are allocated from `arena`, the arena of the program being parsed. Blocks
+/// and parameter lists are collected on the scratch stacks first, then copied to
+/// the arena once their length is known, so they take no allocations of their own.
+///
+/// Syntax errors don't stop the parse. The first error in a statement is recorded
+/// in `errors` and puts the parser in panic mode, where the statement is abandoned
+/// and the following errors are not reported, until it resynchronises at the next
+/// `;` or `}`. The statement is kept in the program as an `AST_ILLGEAL_STATEMENT`.
+///
+/// Expressions are parsed with an explicit stack of the operators waiting on
+/// their operands, `scratch_frames`, rather than a C call per nesting level, so
+/// long operator chains and deeply parenthesised expressions take no C stack.
+/// Both count towards `expression_depth`. Expressions nested in the conditions
+/// and blocks of `if`s and `func`s still recurse, and count towards the much
+/// smaller `nesting_depth` too. Nesting past either maximum is a syntax error.
+///
+/// With `lazy_function_bodies` set, function bodies are only brace matched over
+/// the tokens and left unparsed, until `parser_parse_function_body`. Errors inside
+/// a skipped body are reported when it is parsed.
+///
+/// A parser over a stream lexes the token after the current one as it steps onto
+/// each, and drops the tokens of each top level statement once it moves on to the
+/// next, so `tokens` only ever holds the statement being parsed.
+typedef struct
+{
+    Token_Buffer *tokens;
+    bool owns_tokens;
+    /// the stream `tokens` is read from, for a parser over one
+    Parser_Stream *stream;
+    size_t cur;
+    /// first token of the innermost statement being parsed, which blocks are
+    /// placed relative to
+    size_t statement_start;
+
+    Arena *arena;
+    Statement_Array scratch_statements;
+    Ident_Array scratch_idents;
+    Expression_Frame_Array scratch_frames;
+
+    Parse_Error_Array errors;
+    bool panicking;
+
+    bool lazy_function_bodies;
+    /// operators and expressions open at once, `PARSER_MAX_EXPRESSION_DEPTH`
+    /// unless changed after init
+    size_t max_expression_depth;
+    size_t expression_depth;
+    /// expressions being parsed at once, each a C call, `PARSER_MAX_NESTING_DEPTH`
+    /// unless changed after init
+    size_t max_nesting_depth;
+    size_t nesting_depth;
+} Parser;
+
+/// Every node of the program lives in `arena`, so freeing a program is a single
+/// release however large it is.
 typedef struct 
 {
     Statement_Array statements;
+    Arena arena;
 } Program;
 
 #if defined(__cplusplus)
 extern "C" {
 #endif
 
+/// Initialises the parser by lexing the remainder of `l`'s input up front. The
+/// lexer passed is not modified.
 void parser_init(Parser *p, Lexer *l);
 
+/// Initialises the parser over an existing token buffer, which must outlive the
+/// parser.
+void parser_init_tokens(Parser *p, Token_Buffer *tokens);
+
+/// Initialises the parser over the stream read by `read`, which is called with
+/// `reader` whenever the parser needs more of it. Its tokens are lexed as the
+/// parser reaches them rather than up front, see `parser_parse_each`.
+void parser_init_stream(Parser *p, Parse_Read_Fn read, void *reader);
+
+void parser_free(Parser *p);
+
+/// Parses every statement of the token buffer. Always returns a program, check
+/// `p->errors` for whether it was valid, they are cleared at the start of a parse.
 Program parser_parse_program(Parser *p);
 void program_free(Program *prog);
-void expression_free(Expression *expr);
+
+/// Parses the next top level statement into `stmt`, allocating its nodes from
+/// `arena`, and adds its errors to `p->errors`. Returns false, leaving `stmt`
+/// untouched, once there are no statements left.
+///
+/// @note over a stream, the tokens of the statements before are dropped first, so
+/// their lazy function bodies can no longer be parsed.
+bool parser_parse_next_statement(Parser *p, Arena *arena, Statement *stmt);
+
+/// Called by `parser_parse_each` for each top level statement, whose nodes are
+/// allocated from `arena` and only valid during the call. Returning false stops
+/// the parse.
+typedef bool (*Parse_Statement_Fn) (Parser *p, const Statement *stmt, Arena *arena, void *user);
+
+/// Parses the program a statement at a time, handing each to `fn`. The nodes of a
+/// statement are released before the next one is parsed, and over a stream (see
+/// `parser_init_stream`) so are its tokens, so memory use is bounded by the largest
+/// statement rather than the program. Over a token buffer, it is still the tokens
+/// of the whole program. Errors are cleared first, as by `parser_parse_program`.
+/// Returns the number of statements parsed.
+size_t parser_parse_each(Parser *p, Parse_Statement_Fn fn, void *user);
+
+/// Parses the body of `func`, a function whose body was skipped by a lazy parse
+/// over the parser's tokens, allocating it from `arena`, usually the program's.
+/// The body is stored in `func` and errors are added to `p->errors`. Returns the
+/// body, which is simply returned again if it was already parsed.
+///
+/// @note over a stream only the bodies of the statement being parsed can be, e.g.
+/// from the `parser_parse_each` callback, as the tokens of those before are gone.
+Block_Statement *parser_parse_function_body(Parser *p, Arena *arena, Function_Expression *func);
+
+const char *parse_error_kind_to_str(Parse_Error_Kind kind);
+
+/// Writes one line per error of the last parse to `out`, in the form
+/// `name:line:col: error: message`.
+void parser_print_errors(Parser *p, FILE *out, const char *name);
 
 #if defined(__cplusplus)
 }
@@ -8,47 +8,89 @@
 typedef enum
 {
     LOWEST      = 0,
-    EQUALS      = 10, // ==
-    LESSGREATER = 20, // > or <
-    SUM         = 30, // +
-    PRODUCT     = 40, // *
-    PREFIX      = 50, // -X or !X
-    CALL        = 60, // myFunction(X)
+    LOGICAL_OR  = 10, // ||
+    LOGICAL_AND = 20, // &&
+    EQUALS      = 30, // ==
+    LESSGREATER = 40, // > or < or >= or <=
+    SUM         = 50, // +
+    PRODUCT     = 60, // *
+    PREFIX      = 70, // -X or !X
+    CALL        = 80, // myFunction(X)
 } Operator_Precidence;
 
+/// Parses an expression starting at the current token into `expr`.
+typedef void (*Prefix_Parse_Fn) (Parser *p, Expression *expr);
+
+/// How a token kind is parsed in an expression. Kinds starting an operand of
+/// their own have a `prefix`, and prefix operators and `(` the frame they
+/// `open` around the expression after them. Kinds with neither can't start an
+/// expression. Binary operators have their precidence, every other kind has
+/// `LOWEST`, so never continues one.
+typedef struct
+{
+    Prefix_Parse_Fn prefix;
+    Expression_Frame_Kind opens;
+    Operator_Precidence precidence;
+} Parse_Rule;
+
 /// Returns the precidence of an operator passed.
 Operator_Precidence precidence_of(Token_Kind k);
 
 Operator_Precidence cur_precidence(const Parser *p);
 Operator_Precidence peek_precidence(const Parser *p);
 
+Token_Kind cur_token_kind(const Parser *p);
+Token_Kind peek_token_kind(const Parser *p);
+String_View cur_token_literal(const Parser *p);
+Token_Value cur_token_value(const Parser *p);
+Token cur_token(const Parser *p);
+
 bool cur_token_is(Parser *p, Token_Kind kind);
 bool peek_token_is(Parser *p, Token_Kind kind);
+/// Steps onto the next token if it is of `kind`, reporting an error otherwise.
 bool expect_peek(Parser *p, Token_Kind kind);
 
 void parser_next_token(Parser *p);
 
-void block_add_statement(Block_Statement *bs, const Statement *stmt);
+/// Records an error at the token at index `token` and enters panic mode, unless
+/// the parser is already panicking.
+void parser_error(Parser *p, Parse_Error_Kind kind, size_t token, Token_Kind expected);
 
-// TODO(HS): remove and replace with error return
-Statement make_illegal(Parser *p);
+/// Skips the rest of the statement starting at token `start` that failed to parse,
+/// stopping on its `;`, or before the `}` closing the enclosing block. Blocks
+/// opened by the statement are skipped whole.
+void parser_synchronize(Parser *p, size_t start);
+
+/// Statement standing in for one that failed to parse, starting at `token`.
+Statement make_illegal(Parser *p, size_t token);
+
+/// Parses top level statements into `statements` until reaching the token at
+/// index `end` or past it, or EOF.
+void parse_statements(Parser *p, Statement_Array *statements, size_t end);
+
+/// Parses the statement at the current token and moves to the token after it,
+/// recording the number of tokens it covers.
+void parse_next_statement(Parser *p, Statement *stmt);
 
 void parse_statement(Parser *p, Statement *stmt);
 void parse_var_statement(Parser *p, Statement *stmt);
 void parse_return_statement(Parser *p, Statement *stmt);
 void parse_expression_statement(Parser *p, Statement *stmt);
 
+/// Parses the expression starting at the current token, up to the first operator
+/// binding no tighter than `precidence`, leaving the current token on its last.
 void parse_expression(Parser *p, Expression *expr, Operator_Precidence precidence);
 
 void parse_ident(Parser *p, Expression *ident_expr);
 void parse_int(Parser *p, Expression *int_expr);
 void parse_float(Parser *p, Expression *float_expr);
 void parse_boolean(Parser *p, Expression *bool_expr);
-void parse_prefix_expression(Parser *p, Expression *prefix_expr);
-void parse_infix_expression(Parser *p, Expression *expr);
-void parse_grouped_expression(Parser *p, Expression *grouped_expr);
 void parse_if_expression(Parser *p, Expression *if_expr);
 Block_Statement parse_block_statement(Parser *p);
+
+/// Steps from the `{` at the current token to its matching `}` without parsing
+/// what is in between.
+void skip_block(Parser *p);
 Parameters parse_function_parameters(Parser *p);
 void parse_function(Parser *p, Expression *func_expr);
 
@@ -0,0 +1,53 @@
+/**
+ * Character-run scanning kernels used by the lexer to skip over whitespace,
+ * identifiers and numbers, and to find line breaks, several bytes at a time. Also
+ * the UTF-8 validator run over scripts before they are lexed.
+ *
+ * Each kernel returns the length of the longest prefix of `str` (never looking
+ * beyond `len` bytes) made up of characters in its class. The implementation
+ * (scalar, SSE2 or AVX2) is picked on first use from `cpu_detect_isa`.
+*/
+#ifndef TYGER_SCAN_H_
+#define TYGER_SCAN_H_
+#include <stddef.h>
+#include "cpu.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Selects the kernel implementation to use, clamped to what the host supports.
+/// Mostly useful for tests and benchmarks comparing implementations, and not to
+/// be called while other threads are scanning.
+void scan_set_isa(Cpu_Isa isa);
+
+/// Returns the kernel implementation currently in use.
+Cpu_Isa scan_get_isa(void);
+
+/// Length of the run of ` `, `\t`, `\n` and `\r` characters at the start of `str`.
+size_t scan_whitespace(const char *str, size_t len);
+
+/// Length of the run of identifier characters (`[a-zA-Z_]` and bytes of non-ASCII
+/// UTF-8 sequences, see `is_ident_char`) at the start of `str`.
+size_t scan_ident(const char *str, size_t len);
+
+/// Length of the run of number characters (`[0-9.]`) at the start of `str`.
+size_t scan_number(const char *str, size_t len);
+
+/// Length of the run of characters other than `\n` and `\r` at the start of `str`.
+size_t scan_line(const char *str, size_t len);
+
+/// Length of the run of characters other than `"` and `\` at the start of `str`,
+/// i.e. the bytes of a string literal that need no special handling.
+size_t scan_string(const char *str, size_t len);
+
+/// Length of the longest prefix of `str` that is well formed UTF-8, so `len` when
+/// the whole input is valid. The position returned is the start of the first ill
+/// formed (or truncated) sequence.
+size_t scan_utf8(const char *str, size_t len);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_SCAN_H_
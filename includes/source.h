@@ -0,0 +1,38 @@
+/**
+ * Loading of script source files. Regular files are memory mapped read-only so
+ * even very large scripts are lexed in place, without a copy or a terminating
+ * NUL. Anything that can't be mapped (pipes, terminals, `-` for stdin) is read
+ * into a heap buffer instead.
+*/
+#ifndef TYGER_SOURCE_H_
+#define TYGER_SOURCE_H_
+#include <stdbool.h>
+#include <stddef.h>
+
+/// The contents of a loaded source file.
+///
+/// @note `data` is NOT NUL terminated, use `lexer_init_n` to lex it.
+typedef struct
+{
+    const char *data;
+    size_t len;
+    /// whether `data` is a mapping of the file rather than a heap buffer
+    bool mapped;
+} Source;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Loads the file at `path`, or stdin when `path` is `-`. Returns false if the
+/// file could not be opened or read, in which case `source` is left empty.
+bool source_load(Source *source, const char *path);
+
+/// Unmaps or frees the contents of `source`.
+void source_free(Source *source);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_SOURCE_H_
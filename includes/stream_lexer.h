@@ -0,0 +1,87 @@
+/**
+ * Streaming mode for the lexer, for input that arrives in chunks (pipes, sockets,
+ * generated files too large to hold in memory).
+ *
+ * The caller feeds chunks in and pulls tokens out. Bytes are kept in a carry
+ * buffer only until the token they belong to has been returned, so memory use is
+ * bounded by the largest token plus the largest chunk, not by the input size.
+ *
+ * @example
+ *  Stream_Lexer sl;
+ *  stream_lexer_init(&sl);
+ *  while ((n = read(fd, chunk, sizeof(chunk))) > 0)
+ *  {
+ *      stream_lexer_feed(&sl, chunk, n);
+ *      while (stream_lexer_next(&sl, &token)) { ... }
+ *  }
+ *  stream_lexer_finish(&sl);
+ *  while (stream_lexer_next(&sl, &token) && token.kind != TK_EOF) { ... }
+ *  stream_lexer_free(&sl);
+*/
+#ifndef TYGER_STREAM_LEXER_H_
+#define TYGER_STREAM_LEXER_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include "lexer.h"
+
+/// Initial size of the carry buffer, grows to fit the largest token + chunk.
+#define STREAM_LEXER_DEFAULT_CAPACITY 4096
+
+typedef struct
+{
+    /// unconsumed input, `buffer[0]` is at offset `base` in the stream
+    char *buffer;
+    size_t capacity;
+    size_t len;
+    size_t base;
+    /// no more input will be fed, the end of the buffer is the end of the stream
+    bool finished;
+    /// the input fed so far ends part way through the token at the lexer's position,
+    /// which has been scanned up to `scanned`, see `stream_lexer_next`
+    bool pending;
+    size_t scanned;
+    /// offset in the stream of the next line break to count, or of the end of the
+    /// buffer if there isn't one in it. `line` is the line before it, starting at
+    /// offset `line_start`, and `prev_line_start` is where the line before that
+    /// starts. A `\r` at the end of the buffer is left `after_cr` until the byte
+    /// after it shows whether it was the first half of a `\r\n`.
+    size_t line_break;
+    size_t line;
+    size_t line_start;
+    size_t prev_line_start;
+    bool after_cr;
+    Lexer lexer;
+} Stream_Lexer;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+void stream_lexer_init(Stream_Lexer *sl);
+void stream_lexer_free(Stream_Lexer *sl);
+
+/// Appends the next `len` bytes of the stream. The chunk is copied, so it may be
+/// reused as soon as this returns.
+///
+/// @note invalidates the literals of all tokens returned so far.
+void stream_lexer_feed(Stream_Lexer *sl, const char *chunk, size_t len);
+
+/// Marks the end of the stream, letting the final token and `TK_EOF` be returned.
+void stream_lexer_finish(Stream_Lexer *sl);
+
+/// Lexes the next token into `token`. Returns false if the input fed so far ends
+/// part way through a token (or the whitespace before one), in which case more
+/// input needs feeding. Once finished, returns `TK_EOF` forever.
+///
+/// @note `token->location.pos` is the offset from the start of the stream, and the
+/// line and column are those `line_index_lookup` gives over the whole stream. The
+/// literal views the carry buffer and is only valid until the next call to
+/// `stream_lexer_feed`, as are the decoded contents of a string with escapes, in
+/// `sl->lexer.strings`.
+bool stream_lexer_next(Stream_Lexer *sl, Token *token);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_STREAM_LEXER_H_
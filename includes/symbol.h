@@ -0,0 +1,47 @@
+/**
+ * Process wide table of interned identifiers. Each distinct name is stored once,
+ * NUL terminated, and given a dense `Symbol` id, so two identifiers are the same
+ * name exactly when their symbols are equal.
+ *
+ * The table can be populated by several lexers on different threads at once. It
+ * is split into shards by hash, each with its own lock, and each thread keeps a
+ * small cache of the names it interned recently, so repeated names take no lock
+ * at all. Looking up a symbol's name takes no lock either. Symbols and their
+ * strings stay valid until `symbol_table_free` is called, which must not run
+ * alongside anything else using the table.
+*/
+#ifndef TYGER_SYMBOL_H_
+#define TYGER_SYMBOL_H_
+#include <stddef.h>
+#include <stdint.h>
+#include "tstrings.h"
+
+typedef uint32_t Symbol;
+
+/// Never returned by `symbol_intern`, so usable as "no symbol".
+#define SYMBOL_NONE ((Symbol) 0)
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Returns the symbol for `name`, adding it to the table the first time it's seen.
+Symbol symbol_intern(String_View name);
+
+/// The interned, NUL terminated, name of a symbol.
+const char *symbol_to_cstr(Symbol symbol);
+
+/// The interned name of a symbol, not including the NUL terminator.
+String_View symbol_to_string_view(Symbol symbol);
+
+/// Number of symbols interned so far.
+size_t symbol_count(void);
+
+/// Frees the table, invalidating every symbol handed out so far.
+void symbol_table_free(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_SYMBOL_H_
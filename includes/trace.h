@@ -22,6 +22,11 @@ extern "C" {
 /// Returns pointer to heap allocated string representing the AST in specified format
 const char *program_print_ast(const Program *prog, AST_Print_Format format);
 
+/// Returns pointer to heap allocated string representing a single top level
+/// statement, as it appears in `program_print_ast`'s output, for printing a
+/// program a statement at a time (see `parser_parse_each`).
+const char *statement_print_ast(const Statement *stmt, AST_Print_Format format);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -2,6 +2,7 @@
 #define TYGER_STRING_H_
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 typedef struct
 {
@@ -9,6 +10,15 @@ typedef struct
     size_t length;
 } String_View;
 
+/// A string view with its `string_view_hash` computed once up front, for views
+/// that are compared many times. Views with different hashes are never equal, so
+/// most mismatches are rejected without reading either string.
+typedef struct
+{
+    String_View sv;
+    uint32_t hash;
+} Hashed_String_View;
+
 #define sv_fmt "%.*s"
 #define sv_args(S) (int) (S).length, (S).str
 
@@ -21,9 +31,18 @@ size_t string_nlen(const char *str, size_t max_len);
 String_View string_view_from_cstr(const char *str, size_t offset);
 String_View string_view_from_cstr_offset(const char *str, size_t offset, size_t length);
 
+/// Compares `len` bytes of `a` and `b` a word (or SIMD lane) at a time.
+bool string_bytes_eq(const char *a, const char *b, size_t len);
+
 bool string_view_eq(String_View s1, String_View s2);
+/// True if `sv` is exactly the NUL terminated string `s`, of any length.
 bool string_view_eq_cstr(String_View sv, const char *s);
 
+/// 32 bit hash of the bytes of the view.
+uint32_t string_view_hash(String_View sv);
+Hashed_String_View string_view_hashed(String_View sv);
+bool hashed_string_view_eq(Hashed_String_View s1, Hashed_String_View s2);
+
 // NOTE(HS): all assume ASCII encoding
 bool is_whitespace(const char c);
 bool is_numeric(const char c);
@@ -32,6 +51,13 @@ bool is_alphanumeric(const char c);
 bool is_punctuation(const char c);
 bool is_end_of_input(const char c);
 
+/// Bytes an identifier may start with: ASCII letters and any byte of a non-ASCII
+/// UTF-8 sequence, so identifiers can use any code point outside ASCII.
+bool is_ident_start(const char c);
+
+/// Bytes an identifier may continue with: those it may start with and `_`.
+bool is_ident_char(const char c);
+
 #if defined(__cplusplus)
 }
 #endif
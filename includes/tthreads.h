@@ -0,0 +1,141 @@
+/**
+ * Minimal portable wrapper over the native threads API (pthreads, or Win32 on
+ * Windows), just enough for splitting work across worker threads and guarding
+ * the little state they share.
+*/
+#ifndef TYGER_THREADS_H_
+#define TYGER_THREADS_H_
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+typedef void (*Thread_Fn) (void *arg);
+
+typedef struct
+{
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    Thread_Fn fn;
+    void *arg;
+} Thread;
+
+/// Mutual exclusion lock. Only statically initialised mutexes are supported, with
+/// `MUTEX_INIT`, which is all the shared (global) state in the library needs.
+typedef struct
+{
+#if defined(_WIN32)
+    SRWLOCK lock;
+#else
+    pthread_mutex_t lock;
+#endif
+} Mutex;
+
+#if defined(_WIN32)
+#define MUTEX_INIT { SRWLOCK_INIT }
+#else
+#define MUTEX_INIT { PTHREAD_MUTEX_INITIALIZER }
+#endif
+
+/// Condition variable, waited on with a `Mutex` held. Statically initialised
+/// with `COND_INIT`, like `Mutex`.
+typedef struct
+{
+#if defined(_WIN32)
+    CONDITION_VARIABLE cond;
+#else
+    pthread_cond_t cond;
+#endif
+} Cond;
+
+#if defined(_WIN32)
+#define COND_INIT { CONDITION_VARIABLE_INIT }
+#else
+#define COND_INIT { PTHREAD_COND_INITIALIZER }
+#endif
+
+/// Flag for running a function exactly once across threads, statically
+/// initialised with `ONCE_INIT`, see `thread_once`.
+typedef struct
+{
+#if defined(_WIN32)
+    INIT_ONCE once;
+#else
+    pthread_once_t once;
+#endif
+} Once;
+
+#if defined(_WIN32)
+#define ONCE_INIT { INIT_ONCE_STATIC_INIT }
+#else
+#define ONCE_INIT { PTHREAD_ONCE_INIT }
+#endif
+
+typedef void (*Once_Fn) (void);
+
+/// Storage class of a variable with a copy per thread.
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/// Starts a thread running `fn(arg)`. The `Thread` must stay at the same address
+/// until it has been joined. Returns false if the thread could not be created.
+bool thread_create(Thread *thread, Thread_Fn fn, void *arg);
+
+/// Waits for the thread to finish.
+void thread_join(Thread *thread);
+
+void mutex_lock(Mutex *mutex);
+void mutex_unlock(Mutex *mutex);
+
+/// Releases `mutex`, which must be held, until `cond` is signalled, then takes
+/// it again. May also return without a signal, so wait in a loop on the condition.
+void cond_wait(Cond *cond, Mutex *mutex);
+void cond_signal(Cond *cond);
+
+/// Runs `fn` the first time it is called for `once`. Every other call, from any
+/// thread, waits for that run to finish, so what `fn` initialised is visible after.
+void thread_once(Once *once, Once_Fn fn);
+
+/// Atomically adds `value` to `*target`, returning its previous value.
+uint32_t atomic_add_u32(volatile uint32_t *target, uint32_t value);
+
+/// Atomically reads `*target`, seeing everything written before it was stored.
+uint32_t atomic_load_u32(volatile uint32_t *target);
+void *atomic_load_ptr(void *volatile *target);
+
+/// Atomically sets `*target` to `desired` if it is `expected`. Returns whether it did.
+bool atomic_cas_ptr(void *volatile *target, void *expected, void *desired);
+
+/// Number of hardware threads available to the process, at least 1.
+size_t thread_hardware_count(void);
+
+/// Runs `fn` over each of the `count` items of `item_size` bytes at `items`, on
+/// the calling thread and up to `count - 1` workers, returning once all are done.
+///
+/// The workers are started on first use and kept for later calls, shared by every
+/// caller, so a call costs a wake up per worker rather than a thread per item.
+/// Calls from different threads take turns, and a call from inside `fn` runs its
+/// items on the calling thread. Items no worker claims (e.g. as no more threads
+/// could be started) are run on the calling thread.
+void thread_run_each(Thread_Fn fn, void *items, size_t item_size, size_t count);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TYGER_THREADS_H_
@@ -0,0 +1,199 @@
+"""Generates the character class and transition tables for the table driven lexer.
+
+usage: python3 scripts/lexer_dfa_gen.py [output file, default stdout]
+
+The DFA recognises exactly one token starting at the current (non-whitespace)
+character, taking the longest match. It stops when the transition for the next
+character is `STOP`, and the token kind is the accepting kind of the final state.
+Keywords are recognised as identifiers and number values are decoded afterwards,
+both by the helpers shared with the switch based lexer.
+"""
+import string
+import sys
+
+#
+# character classes
+#
+CLASSES = [
+    # (class name, characters)
+    ("OTHER",      ""),
+    ("ALPHA",      string.ascii_letters),
+    ("UNDERSCORE", "_"),
+    ("DIGIT",      string.digits),
+    ("PERIOD",     "."),
+    ("QUOTE",      "\""),
+    ("BACKSLASH",  "\\"),
+    ("EQUALS",     "="),
+    ("BANG",       "!"),
+    ("LT",         "<"),
+    ("GT",         ">"),
+    ("PIPE",       "|"),
+    ("AMP",        "&"),
+    ("PLUS",       "+"),
+    ("MINUS",      "-"),
+    ("ASTERISK",   "*"),
+    ("SLASH",      "/"),
+    ("LPAREN",     "("),
+    ("RPAREN",     ")"),
+    ("LBRACE",     "{"),
+    ("RBRACE",     "}"),
+    ("LBRACKET",   "["),
+    ("RBRACKET",   "]"),
+    ("COLON",      ":"),
+    ("SEMICOLON",  ";"),
+    ("COMMA",      ","),
+    # NOTE(HS): every byte of a multi-byte UTF-8 sequence, the input is validated
+    # before lexing so these only ever form whole code points
+    ("NON_ASCII",  "".join(chr(b) for b in range(0x80, 0x100))),
+]
+CLASS_NAMES = [name for name, _ in CLASSES]
+
+#
+# states, (name, accepting token kind)
+#
+# NOTE(HS): `STOP` must be state 0 so a zeroed transition means "stop"
+STATES = [
+    ("STOP",          None),
+    ("START",         None),
+    ("IDENT",         "TK_IDENT"),
+    ("NUMBER",        "TK_INT_LIT"),
+    ("STRING_BODY",   "TK_STRING_LIT"),
+    ("STRING_ESCAPE", "TK_STRING_LIT"),
+    ("STRING_END",    "TK_STRING_LIT"),
+    ("ILLEGAL",       "TK_ILLEGAL"),
+    ("ASSIGN",        "TK_ASSIGN"),
+    ("EQ",            "TK_EQ"),
+    ("BANG",          "TK_BANG"),
+    ("NEQ",           "TK_NEQ"),
+    ("LT",            "TK_LT"),
+    ("LTE",           "TK_LTE"),
+    ("GT",            "TK_GT"),
+    ("GTE",           "TK_GTE"),
+    ("PIPE",          "TK_ILLEGAL"),
+    ("LOR",           "TK_LOR"),
+    ("AMP",           "TK_ILLEGAL"),
+    ("LAND",          "TK_LAND"),
+    ("PLUS",          "TK_PLUS"),
+    ("MINUS",         "TK_MINUS"),
+    ("ASTERISK",      "TK_ASTERISK"),
+    ("SLASH",         "TK_SLASH"),
+    ("PERIOD",        "TK_PERIOD"),
+    ("LPAREN",        "TK_LPAREN"),
+    ("RPAREN",        "TK_RPAREN"),
+    ("LBRACE",        "TK_LBRACE"),
+    ("RBRACE",        "TK_RBRACE"),
+    ("LBRACKET",      "TK_LBRACKET"),
+    ("RBRACKET",      "TK_RBRACKET"),
+    ("COLON",         "TK_COLON"),
+    ("SEMICOLON",     "TK_SEMICOLON"),
+    ("COMMA",         "TK_COMMA"),
+]
+STATE_NAMES = [name for name, _ in STATES]
+
+# transitions[state][class] = state, anything missing is STOP
+transitions = {name: {} for name in STATE_NAMES}
+
+def on(state, classes, target):
+    for c in classes:
+        transitions[state][c] = target
+
+# first character of every token
+on("START", CLASS_NAMES, "ILLEGAL")
+on("START", ["ALPHA", "NON_ASCII"], "IDENT")
+on("START", ["DIGIT"], "NUMBER")
+on("START", ["QUOTE"], "STRING_BODY")
+for single in ["EQUALS", "BANG", "LT", "GT", "PIPE", "AMP", "PLUS", "MINUS",
+               "ASTERISK", "SLASH", "PERIOD", "LPAREN", "RPAREN", "LBRACE",
+               "RBRACE", "LBRACKET", "RBRACKET", "COLON", "SEMICOLON", "COMMA"]:
+    target = {"EQUALS": "ASSIGN"}.get(single, single)
+    on("START", [single], target)
+
+# runs
+on("IDENT", ["ALPHA", "UNDERSCORE", "NON_ASCII"], "IDENT")
+on("NUMBER", ["DIGIT", "PERIOD"], "NUMBER")
+
+# two character operators
+on("ASSIGN", ["EQUALS"], "EQ")
+on("BANG", ["EQUALS"], "NEQ")
+on("LT", ["EQUALS"], "LTE")
+on("GT", ["EQUALS"], "GTE")
+on("PIPE", ["PIPE"], "LOR")
+on("AMP", ["AMP"], "LAND")
+
+# NOTE(HS): strings follow `lexer_read_string`, a backslash escapes whatever
+# character follows it
+on("STRING_BODY", CLASS_NAMES, "STRING_BODY")
+on("STRING_BODY", ["BACKSLASH"], "STRING_ESCAPE")
+on("STRING_BODY", ["QUOTE"], "STRING_END")
+on("STRING_ESCAPE", CLASS_NAMES, "STRING_BODY")
+
+assert len(STATES) < 256 and len(CLASSES) < 256
+
+#
+# print the tables
+#
+if len(sys.argv) > 1:
+    sys.stdout = open(sys.argv[1], "w")
+
+char_class = ["OTHER"] * 256
+for name, chars in CLASSES:
+    for c in chars:
+        char_class[ord(c)] = name
+
+print("/**")
+print(" * GENERATED by scripts/lexer_dfa_gen.py - DO NOT EDIT")
+print(" *")
+print(" * Tables for the table driven lexer, `lexer_next_token_dfa`.")
+print("*/")
+print("#ifndef TYGER_LEXER_DFA_TABLES_H_")
+print("#define TYGER_LEXER_DFA_TABLES_H_")
+print("#include <stdint.h>")
+print("#include \"lexer.h\"")
+print()
+
+print("typedef enum")
+print("{")
+for name in CLASS_NAMES:
+    print(f"    LEXER_DFA_CLASS_{name},")
+print("    LEXER_DFA_CLASS_COUNT")
+print("} Lexer_Dfa_Class;")
+print()
+
+print("typedef enum")
+print("{")
+for name in STATE_NAMES:
+    print(f"    LEXER_DFA_{name},")
+print("    LEXER_DFA_STATE_COUNT")
+print("} Lexer_Dfa_State;")
+print()
+
+print("/// Character class of every byte")
+print("static const uint8_t lexer_dfa_class[256] = {")
+for i in range(0, 256, 4):
+    row = ", ".join(f"LEXER_DFA_CLASS_{char_class[j]}" for j in range(i, i + 4))
+    print(f"    {row},")
+print("};")
+print()
+
+print("/// Next state for each state and character class, `LEXER_DFA_STOP` ends the token")
+print("static const uint8_t lexer_dfa_transitions[LEXER_DFA_STATE_COUNT][LEXER_DFA_CLASS_COUNT] = {")
+for name in STATE_NAMES:
+    row = transitions[name]
+    if not row:
+        continue
+    print(f"    [LEXER_DFA_{name}] = {{")
+    for c in CLASS_NAMES:
+        if c in row:
+            print(f"        [LEXER_DFA_CLASS_{c}] = LEXER_DFA_{row[c]},")
+    print("    },")
+print("};")
+print()
+
+print("/// Token kind produced by ending in each state")
+print("static const uint8_t lexer_dfa_accept[LEXER_DFA_STATE_COUNT] = {")
+for name, kind in STATES:
+    if kind is not None:
+        print(f"    [LEXER_DFA_{name}] = {kind},")
+print("};")
+print()
+print("#endif // TYGER_LEXER_DFA_TABLES_H_")
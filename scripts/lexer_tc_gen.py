@@ -125,6 +125,7 @@ class Token:
     col: int
     kind: TokenKind = TokenKind.Eof
     literal_len: int = 1
+    value: str = "{}"
 
     def __str__(self):
         """Return token formatted in a style where it would be a literal declaration.
@@ -133,13 +134,15 @@ class Token:
         Token{ 
             .kind = <kind>, 
             .location = Location{ .pos=<pos>, .line=<line>, .col=<col>},
-            .literal = String_View{ &prog[<pos>], <len> }
+            .literal = String_View{ &prog[<pos>], <len> },
+            .value = Token_Value{ .i = <int> } | Token_Value{ .f = <float> } | {}
         }
         """
-        return "Token{{ {}, {{ {}, {}, {} }}, {{ (char*) &prog[{}], {} }} }}".format(
+        return "Token{{ {}, {{ {}, {}, {} }}, {{ (char*) &prog[{}], {} }}, {} }}".format(
             self.kind, 
             self.pos, self.line, self.col, 
-            self.pos, self.literal_len
+            self.pos, self.literal_len,
+            self.value
         )
 
     def lit(self, prog: str) -> str:
@@ -249,6 +252,7 @@ class Lexer:
         match self.ch:
             case "\0":
                 t.kind = TokenKind.Eof
+                t.literal_len = 0
             
             case "(" | ")" | "{" | "}" | "[" | "]" | ";" | ":" | "," | ".":
                 t.kind = DELIMITERS[self.ch]
@@ -282,6 +286,11 @@ class Lexer:
                     num_len, kind = self.read_digit()
                     t.kind = kind
                     t.literal_len = num_len
+                    lit = t.lit(self.prog)
+                    if kind == TokenKind.int_lit:
+                        t.value = f"{{ .i = {int(lit)} }}"
+                    elif kind == TokenKind.float_lit:
+                        t.value = f"{{ .f = {lit}f }}"
                     return t
 
                 elif self.ch.isalpha():
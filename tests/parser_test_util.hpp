@@ -13,7 +13,18 @@
 #ifndef PARSER_TEST_UTIL_HPP_
 #define PARSER_TEST_UTIL_HPP_
 #include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include "flat_ast.h"
 #include "parser.h"
+#include "symbol.h"
+
+/// Builds the ident expression the parser should produce for `name`
+inline Ident_Expression make_ident(const char *name)
+{
+    Symbol symbol = symbol_intern(String_View{ (char*) name, strlen(name) });
+    return Ident_Expression{ symbol_to_cstr(symbol), symbol };
+}
 
 /// Tests that 2 expressions match, prints AST if not
 void test_expression(Expression exp, Expression act, const char *prog_str);
@@ -36,6 +47,13 @@ void test_prefix_expression(Expression exp, Expression act, const char *prog_str
 /// Tests that 2 infix_expression match, prints AST if not
 void test_infix_expression(Expression exp, Expression act, const char *prog_str);
 
+/// Tests that 2 flat ASTs match node for node. The flat AST holds no pointers, so
+/// matching ASTs are the same bytes.
+void expect_same_flat_ast(const Flat_Ast& expected, const Flat_Ast& actual, const std::string& trace);
+
+/// Tests that 2 programs match, by comparing their flat ASTs
+void expect_same_program(const Program& expected, const Program& actual, const std::string& trace);
+
 #ifdef PARSER_TEST_UTIL_IMPL
 
 void test_expression(Expression exp, Expression act, const char *prog_str)
@@ -70,6 +88,7 @@ void test_ident_expression(Expression exp, Expression act, const char *prog_str)
     std::string exp_ident{exp.expr.ident_expression.ident};
     std::string act_ident{act.expr.ident_expression.ident};
     EXPECT_EQ(exp_ident, act_ident) << prog_str;
+    EXPECT_EQ(exp.expr.ident_expression.symbol, act.expr.ident_expression.symbol) << prog_str;
 }
 
 void test_int_expression(Expression exp, Expression act, const char *prog_str)
@@ -125,6 +144,48 @@ void test_infix_expression(Expression exp, Expression act, const char *prog_str)
     test_expression(*exp.expr.infix_expression.rhs, *act.expr.infix_expression.rhs, prog_str);
 }
 
+template <typename Pool>
+static void expect_same_flat_pool(const Pool& expected, const Pool& actual, const char *name, const std::string& trace)
+{
+    ASSERT_EQ(expected.len, actual.len) << trace << " " << name;
+    if (expected.len > 0)
+    {
+        EXPECT_EQ(0, memcmp(expected.elements, actual.elements, sizeof(expected.elements[0]) * expected.len))
+            << trace << " " << name;
+    }
+}
+
+void expect_same_flat_ast(const Flat_Ast& expected, const Flat_Ast& actual, const std::string& trace)
+{
+    ASSERT_EQ(expected.len, actual.len) << trace;
+    EXPECT_EQ(expected.root, actual.root) << trace;
+    EXPECT_EQ(0, memcmp(expected.kinds, actual.kinds, expected.len)) << trace;
+    EXPECT_EQ(0, memcmp(expected.payloads, actual.payloads, sizeof(uint32_t) * expected.len)) << trace;
+    expect_same_flat_pool(expected.vars, actual.vars, "vars", trace);
+    expect_same_flat_pool(expected.prefixes, actual.prefixes, "prefixes", trace);
+    expect_same_flat_pool(expected.infixes, actual.infixes, "infixes", trace);
+    expect_same_flat_pool(expected.ifs, actual.ifs, "ifs", trace);
+    expect_same_flat_pool(expected.functions, actual.functions, "functions", trace);
+    expect_same_flat_pool(expected.blocks, actual.blocks, "blocks", trace);
+    expect_same_flat_pool(expected.block_statements, actual.block_statements, "block_statements", trace);
+    expect_same_flat_pool(expected.parameters, actual.parameters, "parameters", trace);
+}
+
+void expect_same_program(const Program& expected, const Program& actual, const std::string& trace)
+{
+    ASSERT_EQ(expected.statements.len, actual.statements.len) << trace;
+
+    Flat_Ast exp_flat{};
+    Flat_Ast act_flat{};
+    flat_ast_from_program(&exp_flat, &expected);
+    flat_ast_from_program(&act_flat, &actual);
+
+    expect_same_flat_ast(exp_flat, act_flat, trace);
+
+    flat_ast_free(&exp_flat);
+    flat_ast_free(&act_flat);
+}
+
 #endif
 
 #endif // PARSER_TEST_UTIL_HPP_
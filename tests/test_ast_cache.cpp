@@ -0,0 +1,240 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "ast_cache.h"
+#include "flat_ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "parser_test_util.hpp"
+#include "trace.h"
+
+static std::string read_file(const char *path)
+{
+    std::string content;
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        return content;
+    }
+    char buffer[4096];
+    size_t n = 0;
+    while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0)
+    {
+        content.append(buffer, n);
+    }
+    fclose(f);
+    return content;
+}
+
+static void write_file(const char *path, const std::string& content)
+{
+    FILE *f = fopen(path, "wb");
+    ASSERT_NE(f, nullptr);
+    fwrite(content.data(), 1, content.size(), f);
+    fclose(f);
+}
+
+static std::string print_program(const Program& program)
+{
+    const char *printed = program_print_ast(&program, PRINT_FORMAT_PLAIN);
+    std::string res(printed);
+    free((void *) printed);
+    return res;
+}
+
+/// Parses and caches `source` at `path`, returning the printed program.
+static std::string write_cache(const char *path, const std::string& source)
+{
+    Lexer l;
+    Parser p;
+    lexer_init_n(&l, source.data(), source.size());
+    parser_init(&p, &l);
+    Program program = parser_parse_program(&p);
+    EXPECT_EQ(0u, p.errors.len) << source;
+
+    Flat_Ast ast{};
+    flat_ast_from_program(&ast, &program);
+    EXPECT_TRUE(ast_cache_write(path, &ast, source.data(), source.size()));
+
+    std::string printed = print_program(program);
+    flat_ast_free(&ast);
+    program_free(&program);
+    parser_free(&p);
+    lexer_free(&l);
+    return printed;
+}
+
+TEST(Ast_Cache_Test_Suite, Round_Trip)
+{
+    const char *path = "test_ast_cache_round_trip.tyc";
+    std::string source =
+        "var add = func(a, b) { return a + b; };\n"
+        "var neg = func() { -1.5 };\n"
+        "if (!flag) { add * 2 } else { false };\n"
+        "add;\n";
+    std::string printed = write_cache(path, source);
+
+    Lexer l;
+    Parser p;
+    lexer_init_n(&l, source.data(), source.size());
+    parser_init(&p, &l);
+    Program program = parser_parse_program(&p);
+    Flat_Ast expected{};
+    flat_ast_from_program(&expected, &program);
+
+    Ast_Cache cache;
+    ASSERT_TRUE(ast_cache_open(&cache, path, source.data(), source.size()));
+
+    expect_same_flat_ast(expected, cache.ast, path);
+
+    // inflating the cache gives back the parsed program
+    Program inflated = flat_ast_to_program(&cache.ast);
+    EXPECT_EQ(printed, print_program(inflated));
+
+    program_free(&inflated);
+    ast_cache_close(&cache);
+    flat_ast_free(&expected);
+    program_free(&program);
+    parser_free(&p);
+    lexer_free(&l);
+    remove(path);
+}
+
+TEST(Ast_Cache_Test_Suite, Empty_Program)
+{
+    const char *path = "test_ast_cache_empty.tyc";
+    write_cache(path, "");
+
+    Ast_Cache cache;
+    ASSERT_TRUE(ast_cache_open(&cache, path, "", 0));
+    Program inflated = flat_ast_to_program(&cache.ast);
+    EXPECT_EQ(0u, inflated.statements.len);
+
+    program_free(&inflated);
+    ast_cache_close(&cache);
+    remove(path);
+}
+
+TEST(Ast_Cache_Test_Suite, Rejects_Changed_Source)
+{
+    const char *path = "test_ast_cache_changed.tyc";
+    std::string source = "var x = 1;";
+    write_cache(path, source);
+
+    Ast_Cache cache;
+    std::string same_length = "var y = 1;";
+    EXPECT_FALSE(ast_cache_open(&cache, path, same_length.data(), same_length.size()));
+    std::string longer = "var x = 10;";
+    EXPECT_FALSE(ast_cache_open(&cache, path, longer.data(), longer.size()));
+
+    ASSERT_TRUE(ast_cache_open(&cache, path, source.data(), source.size()));
+    ast_cache_close(&cache);
+    remove(path);
+
+    EXPECT_FALSE(ast_cache_open(&cache, path, source.data(), source.size()));
+}
+
+TEST(Ast_Cache_Test_Suite, Rejects_Bad_Files)
+{
+    const char *path = "test_ast_cache_bad.tyc";
+    std::string source = "var f = func(a) { if (a) { a } else { -a } }; f;";
+    write_cache(path, source);
+    std::string good = read_file(path);
+    ASSERT_FALSE(good.empty());
+
+    struct Corruption
+    {
+        const char *what;
+        size_t offset;
+    };
+    // NOTE(HS): offsets into the header, then into the payloads right after it
+    Corruption corruptions[] = {
+        { "magic", 0 },
+        { "version", 4 },
+        { "byte order", 8 },
+        { "node count", 32 },
+        { "root", 36 },
+        { "payload", 80 + 4 * 3 },
+    };
+
+    Ast_Cache cache;
+    for (const Corruption& corruption : corruptions)
+    {
+        std::string bad = good;
+        bad[corruption.offset] = (char) (bad[corruption.offset] ^ 0x5A);
+        write_file(path, bad);
+        EXPECT_FALSE(ast_cache_open(&cache, path, source.data(), source.size())) << corruption.what;
+    }
+
+    write_file(path, good.substr(0, good.size() - 1));
+    EXPECT_FALSE(ast_cache_open(&cache, path, source.data(), source.size())) << "truncated";
+
+    write_file(path, good + "x");
+    EXPECT_FALSE(ast_cache_open(&cache, path, source.data(), source.size())) << "trailing bytes";
+
+    write_file(path, good);
+    EXPECT_TRUE(ast_cache_open(&cache, path, source.data(), source.size()));
+    ast_cache_close(&cache);
+    remove(path);
+}
+
+TEST(Ast_Cache_Test_Suite, Rejects_Bad_Operators)
+{
+    const char *path = "test_ast_cache_ops.tyc";
+    std::string source = "var f = func(a) { -a + a }; f;";
+    write_cache(path, source);
+    std::string good = read_file(path);
+    ASSERT_GE(good.size(), 80u);
+
+    // NOTE(HS): the prefixes follow the header, payloads and vars, the infixes
+    // follow the prefixes, each starting with its operator
+    uint32_t node_count = 0, var_count = 0, prefix_count = 0, infix_count = 0;
+    memcpy(&node_count, &good[32], sizeof(uint32_t));
+    memcpy(&var_count, &good[40], sizeof(uint32_t));
+    memcpy(&prefix_count, &good[44], sizeof(uint32_t));
+    memcpy(&infix_count, &good[48], sizeof(uint32_t));
+    ASSERT_EQ(1u, prefix_count);
+    ASSERT_EQ(1u, infix_count);
+    size_t prefix_op = 80 + sizeof(uint32_t) * node_count + sizeof(Flat_Var) * var_count;
+    size_t infix_op = prefix_op + sizeof(Flat_Prefix) * prefix_count;
+
+    struct Corruption
+    {
+        const char *what;
+        size_t offset;
+        uint32_t op;
+    };
+    Corruption corruptions[] = {
+        { "prefix op not a prefix operator", prefix_op, '+' },
+        { "prefix op out of range", prefix_op, 0x5A5A5A5Au },
+        { "infix op not a binary operator", infix_op, TK_BANG },
+        { "infix op past the token kinds", infix_op, TOKEN_KIND_COUNT },
+        { "infix op out of range", infix_op, 0x5A5A5A5Au },
+    };
+
+    Ast_Cache cache;
+    for (const Corruption& corruption : corruptions)
+    {
+        std::string bad = good;
+        memcpy(&bad[corruption.offset], &corruption.op, sizeof(uint32_t));
+        write_file(path, bad);
+        EXPECT_FALSE(ast_cache_open(&cache, path, source.data(), source.size())) << corruption.what;
+    }
+
+    write_file(path, good);
+    ASSERT_TRUE(ast_cache_open(&cache, path, source.data(), source.size()));
+    EXPECT_EQ((uint32_t) '-', cache.ast.prefixes.elements[0].op);
+    EXPECT_EQ((uint32_t) TK_PLUS, cache.ast.infixes.elements[0].op);
+    ast_cache_close(&cache);
+    remove(path);
+}
+
+TEST(Ast_Cache_Test_Suite, Path_Is_Next_To_Script)
+{
+    char *path = ast_cache_path("scripts/hello.ty");
+    EXPECT_STREQ("scripts/hello.ty" AST_CACHE_EXTENSION, path);
+    free(path);
+}
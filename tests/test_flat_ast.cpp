@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "flat_ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "symbol.h"
+
+static Symbol intern(const char *name)
+{
+    return symbol_intern(String_View{ (char*) name, strlen(name) });
+}
+
+static Flat_Ast flatten(const char *input)
+{
+    Lexer l;
+    Parser p;
+    lexer_init(&l, input);
+    parser_init(&p, &l);
+    Program program = parser_parse_program(&p);
+
+    Flat_Ast ast{};
+    flat_ast_from_program(&ast, &program);
+
+    // NOTE(HS): the flat AST doesn't refer back to the program
+    program_free(&program);
+    parser_free(&p);
+    return ast;
+}
+
+TEST(Flat_Ast_Test_Suite, Converts_Every_Node_Kind)
+{
+    Flat_Ast ast = flatten(
+        "var f = func(a, b) { return -a * b; };\n"
+        "if (true) { 1.5 } else { false };\n"
+        "x;\n");
+
+    size_t len = 0;
+    const Flat_Node *top = flat_ast_block_statements(&ast, ast.root, &len);
+    ASSERT_EQ(3u, len);
+
+    // var f = func(a, b) { return -a * b; };
+    ASSERT_EQ(FLAT_VAR_STATEMENT, flat_ast_kind(&ast, top[0]));
+    const Flat_Var *var = flat_ast_var(&ast, top[0]);
+    EXPECT_EQ(intern("f"), var->symbol);
+    ASSERT_EQ(FLAT_FUNCTION_EXPRESSION, flat_ast_kind(&ast, var->value));
+
+    size_t param_count = 0;
+    const Symbol *params = flat_ast_parameters(&ast, var->value, &param_count);
+    ASSERT_EQ(2u, param_count);
+    EXPECT_EQ(intern("a"), params[0]);
+    EXPECT_EQ(intern("b"), params[1]);
+
+    const Flat_Node *body = flat_ast_block_statements(&ast, flat_ast_function(&ast, var->value)->body, &len);
+    ASSERT_EQ(1u, len);
+    ASSERT_EQ(FLAT_RETURN_STATEMENT, flat_ast_kind(&ast, body[0]));
+    Flat_Node product = flat_ast_statement_expression(&ast, body[0]);
+    ASSERT_EQ(FLAT_INFIX_EXPRESSION, flat_ast_kind(&ast, product));
+    const Flat_Infix *infix = flat_ast_infix(&ast, product);
+    EXPECT_EQ((uint32_t) TK_ASTERISK, infix->op);
+    ASSERT_EQ(FLAT_PREFIX_EXPRESSION, flat_ast_kind(&ast, infix->lhs));
+    EXPECT_EQ((uint32_t) '-', flat_ast_prefix(&ast, infix->lhs)->op);
+    EXPECT_EQ(intern("a"), flat_ast_ident(&ast, flat_ast_prefix(&ast, infix->lhs)->rhs));
+    EXPECT_EQ(intern("b"), flat_ast_ident(&ast, infix->rhs));
+
+    // if (true) { 1.5 } else { false };
+    ASSERT_EQ(FLAT_EXPRESSION_STATEMENT, flat_ast_kind(&ast, top[1]));
+    Flat_Node if_node = flat_ast_statement_expression(&ast, top[1]);
+    ASSERT_EQ(FLAT_IF_EXPRESSION, flat_ast_kind(&ast, if_node));
+    const Flat_If *flat_if = flat_ast_if(&ast, if_node);
+    EXPECT_TRUE(flat_ast_boolean(&ast, flat_if->condition));
+
+    const Flat_Node *consequence = flat_ast_block_statements(&ast, flat_if->consequence, &len);
+    ASSERT_EQ(1u, len);
+    EXPECT_FLOAT_EQ(1.5f, flat_ast_float(&ast, flat_ast_statement_expression(&ast, consequence[0])));
+    const Flat_Node *alternative = flat_ast_block_statements(&ast, flat_if->alternative, &len);
+    ASSERT_EQ(1u, len);
+    EXPECT_FALSE(flat_ast_boolean(&ast, flat_ast_statement_expression(&ast, alternative[0])));
+
+    // x;
+    EXPECT_EQ(intern("x"), flat_ast_ident(&ast, flat_ast_statement_expression(&ast, top[2])));
+
+    flat_ast_free(&ast);
+}
+
+TEST(Flat_Ast_Test_Suite, If_Without_Else_Has_No_Alternative)
+{
+    Flat_Ast ast = flatten("if (x) { 1 }");
+
+    size_t len = 0;
+    const Flat_Node *top = flat_ast_block_statements(&ast, ast.root, &len);
+    ASSERT_EQ(1u, len);
+    const Flat_If *flat_if = flat_ast_if(&ast, flat_ast_statement_expression(&ast, top[0]));
+    EXPECT_EQ(FLAT_NODE_NONE, flat_if->alternative);
+    EXPECT_EQ(1, flat_ast_int(&ast, flat_ast_statement_expression(&ast,
+        flat_ast_block_statements(&ast, flat_if->consequence, &len)[0])));
+
+    flat_ast_free(&ast);
+}
+
+struct Visit
+{
+    Flat_Node_Kind kind;
+    size_t depth;
+};
+
+static bool record_visit(const Flat_Ast *ast, Flat_Node node, size_t depth, void *user)
+{
+    auto *visits = (std::vector<Visit>*) user;
+    visits->push_back({ flat_ast_kind(ast, node), depth });
+    return true;
+}
+
+TEST(Flat_Ast_Test_Suite, Walk_Is_Pre_Order_In_Node_Order)
+{
+    Flat_Ast ast = flatten("var y = 1 + 2 * 3; if (y < 4) { y } else { -y; 5 }");
+
+    std::vector<Visit> visits;
+    flat_ast_walk(&ast, ast.root, record_visit, &visits);
+
+    const std::vector<Visit> expected{
+        { FLAT_BLOCK, 0 },
+        { FLAT_VAR_STATEMENT, 1 },
+        { FLAT_INFIX_EXPRESSION, 2 },
+        { FLAT_INT_EXPRESSION, 3 },
+        { FLAT_INFIX_EXPRESSION, 3 },
+        { FLAT_INT_EXPRESSION, 4 },
+        { FLAT_INT_EXPRESSION, 4 },
+        { FLAT_EXPRESSION_STATEMENT, 1 },
+        { FLAT_IF_EXPRESSION, 2 },
+        { FLAT_INFIX_EXPRESSION, 3 },
+        { FLAT_IDENT_EXPRESSION, 4 },
+        { FLAT_INT_EXPRESSION, 4 },
+        { FLAT_BLOCK, 3 },
+        { FLAT_EXPRESSION_STATEMENT, 4 },
+        { FLAT_IDENT_EXPRESSION, 5 },
+        { FLAT_BLOCK, 3 },
+        { FLAT_EXPRESSION_STATEMENT, 4 },
+        { FLAT_PREFIX_EXPRESSION, 5 },
+        { FLAT_IDENT_EXPRESSION, 6 },
+        { FLAT_EXPRESSION_STATEMENT, 4 },
+        { FLAT_INT_EXPRESSION, 5 },
+    };
+
+    ASSERT_EQ(expected.size(), visits.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].kind, visits[i].kind)
+            << i << ": expected " << flat_node_kind_to_str(expected[i].kind)
+            << ", got " << flat_node_kind_to_str(visits[i].kind);
+        EXPECT_EQ(expected[i].depth, visits[i].depth) << i;
+
+        // NOTE(HS): nodes are numbered in pre-order, so the walk visits node i + 1
+        EXPECT_EQ(expected[i].kind, (Flat_Node_Kind) ast.kinds[i + 1]) << i;
+    }
+    EXPECT_EQ(expected.size() + 1, ast.len);
+
+    flat_ast_free(&ast);
+}
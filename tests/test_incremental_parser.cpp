@@ -0,0 +1,333 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "incremental_parser.h"
+#include "lexer.h"
+#include "parser.h"
+#include "parser_test_util.hpp"
+
+static void expect_same_statement_ranges(const Statement *expected, const Statement *actual, size_t len, const std::string& trace);
+
+/// Walks two expressions of the same shape, comparing the positions of their blocks.
+static void expect_same_block_ranges(const Expression *expected, const Expression *actual, const std::string& trace)
+{
+    ASSERT_EQ(expected->kind, actual->kind) << trace;
+    switch (expected->kind)
+    {
+        case AST_PREFIX_EXPRESSION:
+        {
+            expect_same_block_ranges(expected->expr.prefix_expression.rhs, actual->expr.prefix_expression.rhs, trace);
+        } break;
+
+        case AST_INFIX_EXPRESSION:
+        {
+            expect_same_block_ranges(expected->expr.infix_expression.lhs, actual->expr.infix_expression.lhs, trace);
+            expect_same_block_ranges(expected->expr.infix_expression.rhs, actual->expr.infix_expression.rhs, trace);
+        } break;
+
+        case AST_IF_EXPRESSION:
+        {
+            const If_Expression& exp_if = expected->expr.if_expression;
+            const If_Expression& act_if = actual->expr.if_expression;
+            expect_same_block_ranges(exp_if.condition, act_if.condition, trace);
+
+            EXPECT_EQ(exp_if.consequence->open, act_if.consequence->open) << trace;
+            expect_same_statement_ranges(exp_if.consequence->statements, act_if.consequence->statements, exp_if.consequence->len, trace);
+            if (exp_if.alternative)
+            {
+                EXPECT_EQ(exp_if.alternative->open, act_if.alternative->open) << trace;
+                expect_same_statement_ranges(exp_if.alternative->statements, act_if.alternative->statements, exp_if.alternative->len, trace);
+            }
+        } break;
+
+        case AST_FUNCTION_EXPRESSION:
+        {
+            const Block_Statement *exp_body = expected->expr.function_expression.body;
+            const Block_Statement *act_body = actual->expr.function_expression.body;
+            EXPECT_EQ(exp_body->open, act_body->open) << trace;
+            expect_same_statement_ranges(exp_body->statements, act_body->statements, exp_body->len, trace);
+        } break;
+
+        default:
+        {} break;
+    }
+}
+
+static void expect_same_statement_ranges(const Statement *expected, const Statement *actual, size_t len, const std::string& trace)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        EXPECT_EQ(expected[i].token_count, actual[i].token_count) << trace << " statement " << i;
+        switch (expected[i].kind)
+        {
+            case AST_VAR_STATEMENT:
+            {
+                expect_same_block_ranges(&expected[i].stmt.var_statement.expression, &actual[i].stmt.var_statement.expression, trace);
+            } break;
+
+            case AST_RETURN_STATEMENT:
+            {
+                expect_same_block_ranges(&expected[i].stmt.return_statement.expression, &actual[i].stmt.return_statement.expression, trace);
+            } break;
+
+            case AST_EXPRESSION_STATEMENT:
+            {
+                expect_same_block_ranges(&expected[i].stmt.expression_statement.expression, &actual[i].stmt.expression_statement.expression, trace);
+            } break;
+
+            case AST_ILLGEAL_STATEMENT:
+            {} break;
+        }
+    }
+}
+
+/// Checks the incremental parser's program and errors are those of a full parse
+/// of `text`.
+static void expect_matches_full_parse(Incremental_Parser& ip, const std::string& text, const std::string& trace)
+{
+    Lexer l;
+    lexer_init_n(&l, text.data(), text.size());
+    Parser p;
+    parser_init(&p, &l);
+    Program expected = parser_parse_program(&p);
+
+    ASSERT_EQ(expected.statements.len, ip.program.statements.len) << trace;
+    expect_same_program(expected, ip.program, trace);
+    expect_same_statement_ranges(expected.statements.elements, ip.program.statements.elements, expected.statements.len, trace);
+
+    ASSERT_EQ(p.errors.len, ip.parser.errors.len) << trace;
+    for (size_t i = 0; i < p.errors.len; ++i)
+    {
+        EXPECT_EQ(p.errors.elements[i].kind, ip.parser.errors.elements[i].kind) << trace;
+        EXPECT_EQ(p.errors.elements[i].token, ip.parser.errors.elements[i].token) << trace;
+        EXPECT_EQ(p.errors.elements[i].expected, ip.parser.errors.elements[i].expected) << trace;
+    }
+
+    program_free(&expected);
+    parser_free(&p);
+    lexer_free(&l);
+}
+
+/// Applies the edit to `text` and the incremental parser, returning the number
+/// of tokens reparsed.
+static size_t apply_edit(Incremental_Parser& ip, std::string& text, size_t offset, size_t removed, const std::string& inserted)
+{
+    text.replace(offset, removed, inserted);
+    Text_Edit edit{ offset, removed, inserted.size() };
+    return incremental_parser_edit(&ip, text.data(), text.size(), edit);
+}
+
+/// NOTE(HS): identifiers can't have digits, so `i` is spelled in letters
+static std::string letters(int i)
+{
+    std::string name;
+    do
+    {
+        name += (char) ('a' + i % 26);
+        i /= 26;
+    } while (i > 0);
+    return name;
+}
+
+static std::string many_functions(int count)
+{
+    std::string text;
+    for (int i = 0; i < count; ++i)
+    {
+        std::string n = std::to_string(i);
+        text += "var f" + letters(i) + " = func(x) {\n";
+        text += "    var a = x * " + n + ";\n";
+        text += "    if (a > 3) { return a; } else { return -a; };\n";
+        text += "};\n";
+    }
+    return text;
+}
+
+TEST(Incremental_Parser_Test_Suite, Reuses_Statements_Outside_The_Edit)
+{
+    std::string text = many_functions(200);
+    Incremental_Parser ip;
+    incremental_parser_init(&ip, text.data(), text.size());
+
+    const Block_Statement *first_body = ip.program.statements.elements[0].stmt.var_statement.expression.expr.function_expression.body;
+    const Block_Statement *edited_body = ip.program.statements.elements[100].stmt.var_statement.expression.expr.function_expression.body;
+    const Statement *last_statements = ip.program.statements.elements[199].stmt.var_statement.expression.expr.function_expression.body->statements;
+
+    // `x * 100` -> `x * 1000`, within one statement of one function's body
+    size_t offset = text.find("x * 100;") + strlen("x * 100");
+    size_t reparsed = apply_edit(ip, text, offset, 0, "0");
+    EXPECT_LE(reparsed, 10u) << "of " << ip.tokens.len;
+    expect_matches_full_parse(ip, text, "number");
+
+    EXPECT_EQ(first_body, ip.program.statements.elements[0].stmt.var_statement.expression.expr.function_expression.body);
+    EXPECT_EQ(edited_body, ip.program.statements.elements[100].stmt.var_statement.expression.expr.function_expression.body);
+    EXPECT_EQ(last_statements, ip.program.statements.elements[199].stmt.var_statement.expression.expr.function_expression.body->statements);
+
+    // a new statement in the else block, shifting everything after it
+    offset = text.find("{ return -a; }", text.find("var f" + letters(150) + " ")) + 1;
+    reparsed = apply_edit(ip, text, offset, 0, " var b = 2;");
+    EXPECT_LE(reparsed, 20u) << "of " << ip.tokens.len;
+    expect_matches_full_parse(ip, text, "statement");
+
+    // and removing it again
+    reparsed = apply_edit(ip, text, offset, strlen(" var b = 2;"), "");
+    EXPECT_LE(reparsed, 20u) << "of " << ip.tokens.len;
+    expect_matches_full_parse(ip, text, "removed statement");
+
+    incremental_parser_free(&ip);
+}
+
+TEST(Incremental_Parser_Test_Suite, Edits_Match_Full_Parse)
+{
+    struct Test_Case
+    {
+        const char *input;
+        const char *find;
+        size_t removed;
+        const char *inserted;
+    };
+
+    Test_Case test_cases[] = {
+        // statements joined and split by the token after them
+        { "a\nb;\nc;", "b", 0, "+ " },
+        { "a + b;\nc;", "+", 1, ";" },
+        { "var x = 1;\nvar y = 2;", ";", 1, "" },
+        // blocks gaining and losing statements
+        { "if (x) { a; b; } else { c; };", "b;", 2, "" },
+        { "if (x) { a; b; } else { c; };", "c;", 0, "d; " },
+        { "if (x) { } else { c; };", "{ }", 3, "{ a; }" },
+        { "if (x) { } else { c; };", " }", 0, " a;" },
+        { "var f = func() { var g = func(y) { y * 2 }; g };", "2", 1, "3 + 4" },
+        { "var f = func() { var g = func(y) { y * 2 }; g };", "g }", 1, "if (g) { 1 } else { 2 }" },
+        // an edit inside one block shifting the next block of the statement
+        { "if (x) { 1 } else { 2 }; var z = func() { 3 };", "1", 1, "1; 11; 111" },
+        // braces added and removed, so the block ends elsewhere
+        { "var f = func() { a; b; };\nvar g = 1;", "a;", 0, "} " },
+        { "var f = func() { if (a) { b }; c; };\nd;", "}; c", 1, "" },
+        { "var f = func() { a; };\nvar g = 1;", "a;", 0, "{ " },
+        // the start and end of the input
+        { "a;\nb;", "a", 0, "z; " },
+        { "a;\nb;", "b;", 2, "b; c" },
+        { "", "", 0, "var x = 1;" },
+        { "var x = 1;", "var x = 1;", 10, "" },
+        // syntax errors, then reparsing in full from them
+        { "var x = 1;\nvar y = 2;", "y", 1, "" },
+        { "var x = (1 + 2);\ny;", ")", 1, "" },
+    };
+
+    for (const Test_Case& tc : test_cases)
+    {
+        std::string text = tc.input;
+        std::string trace = std::string("`") + tc.input + "` at `" + tc.find + "` -> `" + tc.inserted + "`";
+
+        Incremental_Parser ip;
+        incremental_parser_init(&ip, text.data(), text.size());
+        expect_matches_full_parse(ip, text, trace + " before");
+
+        size_t offset = text.find(tc.find);
+        ASSERT_NE(std::string::npos, offset) << trace;
+        apply_edit(ip, text, offset, tc.removed, tc.inserted);
+        expect_matches_full_parse(ip, text, trace);
+
+        // and back again
+        apply_edit(ip, text, offset, strlen(tc.inserted), std::string(tc.input).substr(offset, tc.removed));
+        expect_matches_full_parse(ip, text, trace + " undone");
+
+        incremental_parser_free(&ip);
+    }
+}
+
+TEST(Incremental_Parser_Test_Suite, Errors_Reparse_In_Full)
+{
+    std::string text = many_functions(10);
+    Incremental_Parser ip;
+    incremental_parser_init(&ip, text.data(), text.size());
+
+    size_t offset = text.find("x * 5;") + strlen("x * ");
+    apply_edit(ip, text, offset, 1, "");
+    EXPECT_GT(ip.parser.errors.len, 0u);
+    expect_matches_full_parse(ip, text, "error");
+
+    // the next edit can't reuse anything around the error
+    size_t reparsed = apply_edit(ip, text, offset, 0, "5");
+    EXPECT_EQ(ip.tokens.len, reparsed);
+    EXPECT_EQ(0u, ip.parser.errors.len);
+    expect_matches_full_parse(ip, text, "fixed");
+
+    incremental_parser_free(&ip);
+}
+
+TEST(Incremental_Parser_Test_Suite, Blocks_Reparse_At_Their_Nesting)
+{
+    // NOTE(HS): `b` is in the block of an if in the condition of the innermost if,
+    // at exactly the nesting limit
+    const size_t wrappers = PARSER_MAX_NESTING_DEPTH - 3;
+    std::string text;
+    for (size_t i = 0; i < wrappers; ++i)
+    {
+        text += i % 2 ? "if (a) { " : "func() { ";
+    }
+    text += "if (if (a) { b }) { c }";
+    for (size_t i = 0; i < wrappers; ++i)
+    {
+        text += " }";
+    }
+    text += ";\nx;";
+
+    Incremental_Parser ip;
+    incremental_parser_init(&ip, text.data(), text.size());
+    EXPECT_EQ(0u, ip.parser.errors.len);
+    expect_matches_full_parse(ip, text, "before");
+
+    // one level deeper is an error, in the reparsed block as in a full parse
+    size_t offset = text.find("b }");
+    size_t reparsed = apply_edit(ip, text, offset, 1, "if (d) { e }");
+    EXPECT_LT(reparsed, ip.tokens.len);
+    EXPECT_EQ(1u, ip.parser.errors.len);
+    expect_matches_full_parse(ip, text, "too deep");
+
+    incremental_parser_free(&ip);
+}
+
+TEST(Incremental_Parser_Test_Suite, Random_Edits)
+{
+    const char *snippets[] = {
+        "x", "1", "2.5", ";", " ", "\n", "+ 2", "* y", "-", "!", "(", ")", "{", "}",
+        "var q = 3;", "return z;", "func(a) { a }", "if (b) { c } else { d }", "true",
+    };
+    const size_t snippet_count = sizeof(snippets) / sizeof(snippets[0]);
+
+    std::string text = many_functions(20);
+    Incremental_Parser ip;
+    incremental_parser_init(&ip, text.data(), text.size());
+
+    // NOTE(HS): fixed seed LCG, so failures reproduce
+    uint64_t state = 0x2545F4914F6CDD1Dull;
+    auto next = [&state](size_t bound) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (size_t) ((state >> 33) % bound);
+    };
+
+    for (int i = 0; i < 400; ++i)
+    {
+        size_t offset = next(text.size() + 1);
+        size_t removed = next(3) == 0 ? next(6) : 0;
+        if (offset + removed > text.size())
+        {
+            removed = text.size() - offset;
+        }
+        std::string inserted = next(4) == 0 ? "" : snippets[next(snippet_count)];
+
+        std::string trace = "edit " + std::to_string(i) + " at " + std::to_string(offset);
+        apply_edit(ip, text, offset, removed, inserted);
+        expect_matches_full_parse(ip, text, trace);
+        if (testing::Test::HasFatalFailure())
+        {
+            break;
+        }
+    }
+
+    incremental_parser_free(&ip);
+}
@@ -1,9 +1,13 @@
 #include <gtest/gtest.h>
+#include <string>
 #include <vector>
 #include <stdio.h>
+#include <string.h>
 
 #include "tstrings.h"
 #include "lexer.h"
+#include "lexer_internal.h"
+#include "scan.h"
 
 const char *prog = \
     "+ - * / ! =\n"
@@ -40,124 +44,146 @@ const char *prog = \
     "println(\"Hello, World!\");\n";
 
 auto expected_tokens = std::vector<Token>{
-    Token{ TK_PLUS, { 0, 1, 1 }, { (char*) &prog[0], 1 } },
-    Token{ TK_MINUS, { 2, 1, 3 }, { (char*) &prog[2], 1 } },
-    Token{ TK_ASTERISK, { 4, 1, 5 }, { (char*) &prog[4], 1 } },
-    Token{ TK_SLASH, { 6, 1, 7 }, { (char*) &prog[6], 1 } },
-    Token{ TK_BANG, { 8, 1, 9 }, { (char*) &prog[8], 1 } },
-    Token{ TK_ASSIGN, { 10, 1, 11 }, { (char*) &prog[10], 1 } },
-    Token{ TK_NEQ, { 12, 2, 1 }, { (char*) &prog[12], 2 } },
-    Token{ TK_EQ, { 15, 2, 4 }, { (char*) &prog[15], 2 } },
-    Token{ TK_LT, { 18, 2, 7 }, { (char*) &prog[18], 1 } },
-    Token{ TK_GT, { 20, 2, 9 }, { (char*) &prog[20], 1 } },
-    Token{ TK_LTE, { 22, 2, 11 }, { (char*) &prog[22], 2 } },
-    Token{ TK_GTE, { 25, 2, 14 }, { (char*) &prog[25], 2 } },
-    Token{ TK_LOR, { 28, 2, 17 }, { (char*) &prog[28], 2 } },
-    Token{ TK_LAND, { 31, 2, 20 }, { (char*) &prog[31], 2 } },
-    Token{ TK_LPAREN, { 34, 3, 1 }, { (char*) &prog[34], 1 } },
-    Token{ TK_RPAREN, { 35, 3, 2 }, { (char*) &prog[35], 1 } },
-    Token{ TK_LBRACKET, { 36, 3, 3 }, { (char*) &prog[36], 1 } },
-    Token{ TK_RBRACKET, { 37, 3, 4 }, { (char*) &prog[37], 1 } },
-    Token{ TK_LBRACE, { 38, 3, 5 }, { (char*) &prog[38], 1 } },
-    Token{ TK_RBRACE, { 39, 3, 6 }, { (char*) &prog[39], 1 } },
-    Token{ TK_COLON, { 41, 4, 1 }, { (char*) &prog[41], 1 } },
-    Token{ TK_SEMICOLON, { 42, 4, 2 }, { (char*) &prog[42], 1 } },
-    Token{ TK_COMMA, { 43, 4, 3 }, { (char*) &prog[43], 1 } },
-    Token{ TK_PERIOD, { 44, 4, 4 }, { (char*) &prog[44], 1 } },
-    Token{ TK_INT_LIT, { 47, 6, 1 }, { (char*) &prog[47], 1 } },
-    Token{ TK_INT_LIT, { 49, 6, 3 }, { (char*) &prog[49], 1 } },
-    Token{ TK_INT_LIT, { 51, 6, 5 }, { (char*) &prog[51], 3 } },
-    Token{ TK_INT_LIT, { 55, 6, 9 }, { (char*) &prog[55], 4 } },
-    Token{ TK_MINUS, { 60, 6, 14 }, { (char*) &prog[60], 1 } },
-    Token{ TK_INT_LIT, { 61, 6, 15 }, { (char*) &prog[61], 2 } },
-    Token{ TK_FLOAT_LIT, { 64, 7, 1 }, { (char*) &prog[64], 3 } },
-    Token{ TK_FLOAT_LIT, { 68, 7, 5 }, { (char*) &prog[68], 6 } },
-    Token{ TK_FLOAT_LIT, { 75, 7, 12 }, { (char*) &prog[75], 7 } },
-    Token{ TK_MINUS, { 83, 7, 20 }, { (char*) &prog[83], 1 } },
-    Token{ TK_FLOAT_LIT, { 84, 7, 21 }, { (char*) &prog[84], 6 } },
-    Token{ TK_STRING_LIT, { 92, 8, 2 }, { (char*) &prog[92], 3 } },
-    Token{ TK_STRING_LIT, { 98, 8, 8 }, { (char*) &prog[98], 3 } },
-    Token{ TK_STRING_LIT, { 104, 8, 14 }, { (char*) &prog[104], 13 } },
-    Token{ TK_STRING_LIT, { 120, 8, 30 }, { (char*) &prog[120], 19 } },
-    Token{ TK_TRUE, { 141, 9, 1 }, { (char*) &prog[141], 4 } },
-    Token{ TK_FALSE, { 146, 9, 6 }, { (char*) &prog[146], 5 } },
-    Token{ TK_NIL, { 152, 10, 1 }, { (char*) &prog[152], 3 } },
-    Token{ TK_IF, { 157, 12, 1 }, { (char*) &prog[157], 2 } },
-    Token{ TK_ELSE, { 160, 12, 4 }, { (char*) &prog[160], 4 } },
-    Token{ TK_VAR, { 165, 12, 9 }, { (char*) &prog[165], 3 } },
-    Token{ TK_FUNC, { 169, 12, 13 }, { (char*) &prog[169], 4 } },
-    Token{ TK_RETURN, { 174, 12, 18 }, { (char*) &prog[174], 6 } },
-    Token{ TK_PRINTLN, { 181, 13, 1 }, { (char*) &prog[181], 7 } },
-    Token{ TK_VAR, { 191, 16, 1 }, { (char*) &prog[191], 3 } },
-    Token{ TK_IDENT, { 195, 16, 5 }, { (char*) &prog[195], 1 } },
-    Token{ TK_ASSIGN, { 197, 16, 7 }, { (char*) &prog[197], 1 } },
-    Token{ TK_INT_LIT, { 199, 16, 9 }, { (char*) &prog[199], 2 } },
-    Token{ TK_SEMICOLON, { 201, 16, 11 }, { (char*) &prog[201], 1 } },
-    Token{ TK_VAR, { 203, 17, 1 }, { (char*) &prog[203], 3 } },
-    Token{ TK_IDENT, { 207, 17, 5 }, { (char*) &prog[207], 2 } },
-    Token{ TK_ASSIGN, { 210, 17, 8 }, { (char*) &prog[210], 1 } },
-    Token{ TK_FLOAT_LIT, { 212, 17, 10 }, { (char*) &prog[212], 4 } },
-    Token{ TK_SEMICOLON, { 216, 17, 14 }, { (char*) &prog[216], 1 } },
-    Token{ TK_VAR, { 218, 18, 1 }, { (char*) &prog[218], 3 } },
-    Token{ TK_IDENT, { 222, 18, 5 }, { (char*) &prog[222], 14 } },
-    Token{ TK_ASSIGN, { 237, 18, 20 }, { (char*) &prog[237], 1 } },
-    Token{ TK_INT_LIT, { 239, 18, 22 }, { (char*) &prog[239], 3 } },
-    Token{ TK_SEMICOLON, { 242, 18, 25 }, { (char*) &prog[242], 1 } },
-    Token{ TK_INT_LIT, { 245, 20, 1 }, { (char*) &prog[245], 1 } },
-    Token{ TK_PLUS, { 247, 20, 3 }, { (char*) &prog[247], 1 } },
-    Token{ TK_INT_LIT, { 249, 20, 5 }, { (char*) &prog[249], 1 } },
-    Token{ TK_MINUS, { 251, 20, 7 }, { (char*) &prog[251], 1 } },
-    Token{ TK_INT_LIT, { 253, 20, 9 }, { (char*) &prog[253], 1 } },
-    Token{ TK_ASTERISK, { 255, 20, 11 }, { (char*) &prog[255], 1 } },
-    Token{ TK_INT_LIT, { 257, 20, 13 }, { (char*) &prog[257], 1 } },
-    Token{ TK_SLASH, { 259, 20, 15 }, { (char*) &prog[259], 1 } },
-    Token{ TK_INT_LIT, { 261, 20, 17 }, { (char*) &prog[261], 1 } },
-    Token{ TK_SEMICOLON, { 262, 20, 18 }, { (char*) &prog[262], 1 } },
-    Token{ TK_IF, { 265, 22, 1 }, { (char*) &prog[265], 2 } },
-    Token{ TK_LPAREN, { 268, 22, 4 }, { (char*) &prog[268], 1 } },
-    Token{ TK_TRUE, { 269, 22, 5 }, { (char*) &prog[269], 4 } },
-    Token{ TK_RPAREN, { 273, 22, 9 }, { (char*) &prog[273], 1 } },
-    Token{ TK_LBRACE, { 275, 22, 11 }, { (char*) &prog[275], 1 } },
-    Token{ TK_IDENT, { 281, 23, 5 }, { (char*) &prog[281], 1 } },
-    Token{ TK_ASSIGN, { 283, 23, 7 }, { (char*) &prog[283], 1 } },
-    Token{ TK_IDENT, { 285, 23, 9 }, { (char*) &prog[285], 1 } },
-    Token{ TK_ASTERISK, { 287, 23, 11 }, { (char*) &prog[287], 1 } },
-    Token{ TK_INT_LIT, { 289, 23, 13 }, { (char*) &prog[289], 1 } },
-    Token{ TK_SEMICOLON, { 290, 23, 14 }, { (char*) &prog[290], 1 } },
-    Token{ TK_RBRACE, { 292, 24, 1 }, { (char*) &prog[292], 1 } },
-    Token{ TK_ELSE, { 294, 24, 3 }, { (char*) &prog[294], 4 } },
-    Token{ TK_LBRACE, { 299, 24, 8 }, { (char*) &prog[299], 1 } },
-    Token{ TK_IDENT, { 305, 25, 5 }, { (char*) &prog[305], 1 } },
-    Token{ TK_ASSIGN, { 307, 25, 7 }, { (char*) &prog[307], 1 } },
-    Token{ TK_IDENT, { 309, 25, 9 }, { (char*) &prog[309], 1 } },
-    Token{ TK_SLASH, { 311, 25, 11 }, { (char*) &prog[311], 1 } },
-    Token{ TK_INT_LIT, { 313, 25, 13 }, { (char*) &prog[313], 1 } },
-    Token{ TK_SEMICOLON, { 314, 25, 14 }, { (char*) &prog[314], 1 } },
-    Token{ TK_RBRACE, { 316, 26, 1 }, { (char*) &prog[316], 1 } },
-    Token{ TK_VAR, { 319, 28, 1 }, { (char*) &prog[319], 3 } },
-    Token{ TK_IDENT, { 323, 28, 5 }, { (char*) &prog[323], 6 } },
-    Token{ TK_ASSIGN, { 330, 28, 12 }, { (char*) &prog[330], 1 } },
-    Token{ TK_FUNC, { 332, 28, 14 }, { (char*) &prog[332], 4 } },
-    Token{ TK_LPAREN, { 336, 28, 18 }, { (char*) &prog[336], 1 } },
-    Token{ TK_IDENT, { 337, 28, 19 }, { (char*) &prog[337], 1 } },
-    Token{ TK_RPAREN, { 338, 28, 20 }, { (char*) &prog[338], 1 } },
-    Token{ TK_LBRACE, { 340, 28, 22 }, { (char*) &prog[340], 1 } },
-    Token{ TK_RETURN, { 346, 29, 5 }, { (char*) &prog[346], 6 } },
-    Token{ TK_IDENT, { 353, 29, 12 }, { (char*) &prog[353], 1 } },
-    Token{ TK_ASTERISK, { 355, 29, 14 }, { (char*) &prog[355], 1 } },
-    Token{ TK_IDENT, { 357, 29, 16 }, { (char*) &prog[357], 1 } },
-    Token{ TK_SEMICOLON, { 358, 29, 17 }, { (char*) &prog[358], 1 } },
-    Token{ TK_RBRACE, { 360, 30, 1 }, { (char*) &prog[360], 1 } },
-    Token{ TK_SEMICOLON, { 361, 30, 2 }, { (char*) &prog[361], 1 } },
-    Token{ TK_PRINTLN, { 364, 32, 1 }, { (char*) &prog[364], 7 } },
-    Token{ TK_LPAREN, { 371, 32, 8 }, { (char*) &prog[371], 1 } },
-    Token{ TK_STRING_LIT, { 373, 32, 10 }, { (char*) &prog[373], 13 } },
-    Token{ TK_RPAREN, { 387, 32, 24 }, { (char*) &prog[387], 1 } },
-    Token{ TK_SEMICOLON, { 388, 32, 25 }, { (char*) &prog[388], 1 } },
-    Token{ TK_EOF, { 390, 32, 26 }, { (char*) &prog[390], 1 } },
+    Token{ TK_PLUS, { 0, 1, 1 }, { (char*) &prog[0], 1 }, {} },
+    Token{ TK_MINUS, { 2, 1, 3 }, { (char*) &prog[2], 1 }, {} },
+    Token{ TK_ASTERISK, { 4, 1, 5 }, { (char*) &prog[4], 1 }, {} },
+    Token{ TK_SLASH, { 6, 1, 7 }, { (char*) &prog[6], 1 }, {} },
+    Token{ TK_BANG, { 8, 1, 9 }, { (char*) &prog[8], 1 }, {} },
+    Token{ TK_ASSIGN, { 10, 1, 11 }, { (char*) &prog[10], 1 }, {} },
+    Token{ TK_NEQ, { 12, 2, 1 }, { (char*) &prog[12], 2 }, {} },
+    Token{ TK_EQ, { 15, 2, 4 }, { (char*) &prog[15], 2 }, {} },
+    Token{ TK_LT, { 18, 2, 7 }, { (char*) &prog[18], 1 }, {} },
+    Token{ TK_GT, { 20, 2, 9 }, { (char*) &prog[20], 1 }, {} },
+    Token{ TK_LTE, { 22, 2, 11 }, { (char*) &prog[22], 2 }, {} },
+    Token{ TK_GTE, { 25, 2, 14 }, { (char*) &prog[25], 2 }, {} },
+    Token{ TK_LOR, { 28, 2, 17 }, { (char*) &prog[28], 2 }, {} },
+    Token{ TK_LAND, { 31, 2, 20 }, { (char*) &prog[31], 2 }, {} },
+    Token{ TK_LPAREN, { 34, 3, 1 }, { (char*) &prog[34], 1 }, {} },
+    Token{ TK_RPAREN, { 35, 3, 2 }, { (char*) &prog[35], 1 }, {} },
+    Token{ TK_LBRACKET, { 36, 3, 3 }, { (char*) &prog[36], 1 }, {} },
+    Token{ TK_RBRACKET, { 37, 3, 4 }, { (char*) &prog[37], 1 }, {} },
+    Token{ TK_LBRACE, { 38, 3, 5 }, { (char*) &prog[38], 1 }, {} },
+    Token{ TK_RBRACE, { 39, 3, 6 }, { (char*) &prog[39], 1 }, {} },
+    Token{ TK_COLON, { 41, 4, 1 }, { (char*) &prog[41], 1 }, {} },
+    Token{ TK_SEMICOLON, { 42, 4, 2 }, { (char*) &prog[42], 1 }, {} },
+    Token{ TK_COMMA, { 43, 4, 3 }, { (char*) &prog[43], 1 }, {} },
+    Token{ TK_PERIOD, { 44, 4, 4 }, { (char*) &prog[44], 1 }, {} },
+    Token{ TK_INT_LIT, { 47, 6, 1 }, { (char*) &prog[47], 1 }, { .i = 0 } },
+    Token{ TK_INT_LIT, { 49, 6, 3 }, { (char*) &prog[49], 1 }, { .i = 1 } },
+    Token{ TK_INT_LIT, { 51, 6, 5 }, { (char*) &prog[51], 3 }, { .i = 100 } },
+    Token{ TK_INT_LIT, { 55, 6, 9 }, { (char*) &prog[55], 4 }, { .i = 1000 } },
+    Token{ TK_MINUS, { 60, 6, 14 }, { (char*) &prog[60], 1 }, {} },
+    Token{ TK_INT_LIT, { 61, 6, 15 }, { (char*) &prog[61], 2 }, { .i = 10 } },
+    Token{ TK_FLOAT_LIT, { 64, 7, 1 }, { (char*) &prog[64], 3 }, { .f = 0.0f } },
+    Token{ TK_FLOAT_LIT, { 68, 7, 5 }, { (char*) &prog[68], 6 }, { .f = 3.1415f } },
+    Token{ TK_FLOAT_LIT, { 75, 7, 12 }, { (char*) &prog[75], 7 }, { .f = 148.012f } },
+    Token{ TK_MINUS, { 83, 7, 20 }, { (char*) &prog[83], 1 }, {} },
+    Token{ TK_FLOAT_LIT, { 84, 7, 21 }, { (char*) &prog[84], 6 }, { .f = 0.8123f } },
+    Token{ TK_STRING_LIT, { 92, 8, 2 }, { (char*) &prog[92], 3 }, {} },
+    Token{ TK_STRING_LIT, { 98, 8, 8 }, { (char*) &prog[98], 3 }, {} },
+    Token{ TK_STRING_LIT, { 104, 8, 14 }, { (char*) &prog[104], 13 }, {} },
+    Token{ TK_STRING_LIT, { 120, 8, 30 }, { (char*) &prog[120], 19 }, {} },
+    Token{ TK_TRUE, { 141, 9, 1 }, { (char*) &prog[141], 4 }, {} },
+    Token{ TK_FALSE, { 146, 9, 6 }, { (char*) &prog[146], 5 }, {} },
+    Token{ TK_NIL, { 152, 10, 1 }, { (char*) &prog[152], 3 }, {} },
+    Token{ TK_IF, { 157, 12, 1 }, { (char*) &prog[157], 2 }, {} },
+    Token{ TK_ELSE, { 160, 12, 4 }, { (char*) &prog[160], 4 }, {} },
+    Token{ TK_VAR, { 165, 12, 9 }, { (char*) &prog[165], 3 }, {} },
+    Token{ TK_FUNC, { 169, 12, 13 }, { (char*) &prog[169], 4 }, {} },
+    Token{ TK_RETURN, { 174, 12, 18 }, { (char*) &prog[174], 6 }, {} },
+    Token{ TK_PRINTLN, { 181, 13, 1 }, { (char*) &prog[181], 7 }, {} },
+    Token{ TK_VAR, { 191, 16, 1 }, { (char*) &prog[191], 3 }, {} },
+    Token{ TK_IDENT, { 195, 16, 5 }, { (char*) &prog[195], 1 }, {} },
+    Token{ TK_ASSIGN, { 197, 16, 7 }, { (char*) &prog[197], 1 }, {} },
+    Token{ TK_INT_LIT, { 199, 16, 9 }, { (char*) &prog[199], 2 }, { .i = 10 } },
+    Token{ TK_SEMICOLON, { 201, 16, 11 }, { (char*) &prog[201], 1 }, {} },
+    Token{ TK_VAR, { 203, 17, 1 }, { (char*) &prog[203], 3 }, {} },
+    Token{ TK_IDENT, { 207, 17, 5 }, { (char*) &prog[207], 2 }, {} },
+    Token{ TK_ASSIGN, { 210, 17, 8 }, { (char*) &prog[210], 1 }, {} },
+    Token{ TK_FLOAT_LIT, { 212, 17, 10 }, { (char*) &prog[212], 4 }, { .f = 3.14f } },
+    Token{ TK_SEMICOLON, { 216, 17, 14 }, { (char*) &prog[216], 1 }, {} },
+    Token{ TK_VAR, { 218, 18, 1 }, { (char*) &prog[218], 3 }, {} },
+    Token{ TK_IDENT, { 222, 18, 5 }, { (char*) &prog[222], 14 }, {} },
+    Token{ TK_ASSIGN, { 237, 18, 20 }, { (char*) &prog[237], 1 }, {} },
+    Token{ TK_INT_LIT, { 239, 18, 22 }, { (char*) &prog[239], 3 }, { .i = 105 } },
+    Token{ TK_SEMICOLON, { 242, 18, 25 }, { (char*) &prog[242], 1 }, {} },
+    Token{ TK_INT_LIT, { 245, 20, 1 }, { (char*) &prog[245], 1 }, { .i = 5 } },
+    Token{ TK_PLUS, { 247, 20, 3 }, { (char*) &prog[247], 1 }, {} },
+    Token{ TK_INT_LIT, { 249, 20, 5 }, { (char*) &prog[249], 1 }, { .i = 4 } },
+    Token{ TK_MINUS, { 251, 20, 7 }, { (char*) &prog[251], 1 }, {} },
+    Token{ TK_INT_LIT, { 253, 20, 9 }, { (char*) &prog[253], 1 }, { .i = 3 } },
+    Token{ TK_ASTERISK, { 255, 20, 11 }, { (char*) &prog[255], 1 }, {} },
+    Token{ TK_INT_LIT, { 257, 20, 13 }, { (char*) &prog[257], 1 }, { .i = 2 } },
+    Token{ TK_SLASH, { 259, 20, 15 }, { (char*) &prog[259], 1 }, {} },
+    Token{ TK_INT_LIT, { 261, 20, 17 }, { (char*) &prog[261], 1 }, { .i = 1 } },
+    Token{ TK_SEMICOLON, { 262, 20, 18 }, { (char*) &prog[262], 1 }, {} },
+    Token{ TK_IF, { 265, 22, 1 }, { (char*) &prog[265], 2 }, {} },
+    Token{ TK_LPAREN, { 268, 22, 4 }, { (char*) &prog[268], 1 }, {} },
+    Token{ TK_TRUE, { 269, 22, 5 }, { (char*) &prog[269], 4 }, {} },
+    Token{ TK_RPAREN, { 273, 22, 9 }, { (char*) &prog[273], 1 }, {} },
+    Token{ TK_LBRACE, { 275, 22, 11 }, { (char*) &prog[275], 1 }, {} },
+    Token{ TK_IDENT, { 281, 23, 5 }, { (char*) &prog[281], 1 }, {} },
+    Token{ TK_ASSIGN, { 283, 23, 7 }, { (char*) &prog[283], 1 }, {} },
+    Token{ TK_IDENT, { 285, 23, 9 }, { (char*) &prog[285], 1 }, {} },
+    Token{ TK_ASTERISK, { 287, 23, 11 }, { (char*) &prog[287], 1 }, {} },
+    Token{ TK_INT_LIT, { 289, 23, 13 }, { (char*) &prog[289], 1 }, { .i = 2 } },
+    Token{ TK_SEMICOLON, { 290, 23, 14 }, { (char*) &prog[290], 1 }, {} },
+    Token{ TK_RBRACE, { 292, 24, 1 }, { (char*) &prog[292], 1 }, {} },
+    Token{ TK_ELSE, { 294, 24, 3 }, { (char*) &prog[294], 4 }, {} },
+    Token{ TK_LBRACE, { 299, 24, 8 }, { (char*) &prog[299], 1 }, {} },
+    Token{ TK_IDENT, { 305, 25, 5 }, { (char*) &prog[305], 1 }, {} },
+    Token{ TK_ASSIGN, { 307, 25, 7 }, { (char*) &prog[307], 1 }, {} },
+    Token{ TK_IDENT, { 309, 25, 9 }, { (char*) &prog[309], 1 }, {} },
+    Token{ TK_SLASH, { 311, 25, 11 }, { (char*) &prog[311], 1 }, {} },
+    Token{ TK_INT_LIT, { 313, 25, 13 }, { (char*) &prog[313], 1 }, { .i = 2 } },
+    Token{ TK_SEMICOLON, { 314, 25, 14 }, { (char*) &prog[314], 1 }, {} },
+    Token{ TK_RBRACE, { 316, 26, 1 }, { (char*) &prog[316], 1 }, {} },
+    Token{ TK_VAR, { 319, 28, 1 }, { (char*) &prog[319], 3 }, {} },
+    Token{ TK_IDENT, { 323, 28, 5 }, { (char*) &prog[323], 6 }, {} },
+    Token{ TK_ASSIGN, { 330, 28, 12 }, { (char*) &prog[330], 1 }, {} },
+    Token{ TK_FUNC, { 332, 28, 14 }, { (char*) &prog[332], 4 }, {} },
+    Token{ TK_LPAREN, { 336, 28, 18 }, { (char*) &prog[336], 1 }, {} },
+    Token{ TK_IDENT, { 337, 28, 19 }, { (char*) &prog[337], 1 }, {} },
+    Token{ TK_RPAREN, { 338, 28, 20 }, { (char*) &prog[338], 1 }, {} },
+    Token{ TK_LBRACE, { 340, 28, 22 }, { (char*) &prog[340], 1 }, {} },
+    Token{ TK_RETURN, { 346, 29, 5 }, { (char*) &prog[346], 6 }, {} },
+    Token{ TK_IDENT, { 353, 29, 12 }, { (char*) &prog[353], 1 }, {} },
+    Token{ TK_ASTERISK, { 355, 29, 14 }, { (char*) &prog[355], 1 }, {} },
+    Token{ TK_IDENT, { 357, 29, 16 }, { (char*) &prog[357], 1 }, {} },
+    Token{ TK_SEMICOLON, { 358, 29, 17 }, { (char*) &prog[358], 1 }, {} },
+    Token{ TK_RBRACE, { 360, 30, 1 }, { (char*) &prog[360], 1 }, {} },
+    Token{ TK_SEMICOLON, { 361, 30, 2 }, { (char*) &prog[361], 1 }, {} },
+    Token{ TK_PRINTLN, { 364, 32, 1 }, { (char*) &prog[364], 7 }, {} },
+    Token{ TK_LPAREN, { 371, 32, 8 }, { (char*) &prog[371], 1 }, {} },
+    Token{ TK_STRING_LIT, { 373, 32, 10 }, { (char*) &prog[373], 13 }, {} },
+    Token{ TK_RPAREN, { 387, 32, 24 }, { (char*) &prog[387], 1 }, {} },
+    Token{ TK_SEMICOLON, { 388, 32, 25 }, { (char*) &prog[388], 1 }, {} },
+    Token{ TK_EOF, { 390, 32, 26 }, { (char*) &prog[390], 0 }, {} },
 };
 
-TEST(LexerTestSuite, test_lexer)
+/// Checks `actual` has the value of `expected`. Identifiers carry their interned
+/// symbol, and strings their decoded contents, in `strings` if they had escapes,
+/// which the expected tokens leave as 0
+static void expect_same_value(const Token& expected, const Token& actual, const Token_Strings *strings)
+{
+    if (expected.kind == TK_STRING_LIT)
+    {
+        // NOTE(HS): the only escapes in the expected strings are `\"`
+        std::string contents(expected.literal.str, expected.literal.length);
+        for (size_t i = contents.find("\\\""); i != std::string::npos; i = contents.find("\\\"", i + 1))
+        {
+            contents.erase(i, 1);
+        }
+        String_View actual_contents = token_string_contents(strings, actual);
+        EXPECT_EQ(contents, std::string(actual_contents.str, actual_contents.length));
+        return;
+    }
+    EXPECT_EQ(expected.kind == TK_IDENT ? symbol_intern(expected.literal) : expected.value.bits, actual.value.bits);
+}
+
+typedef Token (*Next_Token_Fn) (Lexer *);
+
+static void test_lexer_expected_tokens(Next_Token_Fn next_token = lexer_next_token)
 {
     Lexer l;
     lexer_init(&l, prog);
@@ -167,7 +193,7 @@ TEST(LexerTestSuite, test_lexer)
     do
     {
         auto& expected = expected_tokens[expected_index];
-        actual = lexer_next_token(&l);
+        actual = next_token(&l);
 
         // assert correct kind of token lexed
         ASSERT_EQ(expected.kind, actual.kind)
@@ -176,9 +202,10 @@ TEST(LexerTestSuite, test_lexer)
             << std::endl;
 
         // assert read from correct location
+        Location location = lexer_location(&l, actual.location.pos);
         EXPECT_EQ(expected.location.pos,  actual.location.pos);
-        EXPECT_EQ(expected.location.line, actual.location.line);
-        EXPECT_EQ(expected.location.col,  actual.location.col);
+        EXPECT_EQ(expected.location.line, location.line);
+        EXPECT_EQ(expected.location.col,  location.col);
 
         // assert literals are the same
         // TODO(HS): check literals pointed to are equal
@@ -192,8 +219,646 @@ TEST(LexerTestSuite, test_lexer)
             << "Expected Literal \"" << expected_buffer << "\", got \""
             << actual_buffer << "\"";
 
+        // assert literal values were decoded
+        {
+            SCOPED_TRACE(std::string("Expected value of \"") + expected_buffer + "\" to be decoded");
+            expect_same_value(expected, actual, &l.strings);
+        }
+
         expected_index += 1;
     } while (actual.kind != TK_EOF && expected_index < expected_tokens.size());
 
+    lexer_free(&l);
     ASSERT_EQ((expected_index), expected_tokens.size());
 }
+
+TEST(LexerTestSuite, test_lexer)
+{
+    test_lexer_expected_tokens();
+}
+
+TEST(LexerTestSuite, test_lexer_dfa)
+{
+    test_lexer_expected_tokens(lexer_next_token_dfa);
+}
+
+TEST(LexerTestSuite, test_lexer_dfa_matches_switch)
+{
+    // NOTE(HS): random soup of token fragments and every byte value, lexed by both
+    std::vector<std::string> fragments{
+        " ", "\t", "\n", "\r\n", "\r", "a", "Z", "_", "ident", "snake_case", "if", "else",
+        "println", "0", "123", "4.5", "1.2.3", ".", "\"", "\\", "\\\"", "=", "==", "!",
+        "!=", "<", "<=", ">", ">=", "|", "||", "&", "&&", "+", "-", "*", "/", "(", ")",
+        "{", "}", "[", "]", ":", ";", ",", "@", "#", "\x80", "\xff", std::string(1, '\0'),
+    };
+
+    uint32_t rng = 12345;
+    for (int round = 0; round < 500; ++round)
+    {
+        std::string input;
+        for (int i = 0; i < 64; ++i)
+        {
+            rng = rng * 1103515245u + 12345u;
+            input += fragments[(rng >> 16) % fragments.size()];
+        }
+        if (round < 256)
+        {
+            input.push_back((char) round);
+        }
+
+        Lexer a;
+        Lexer b;
+        lexer_init_n(&a, input.data(), input.size());
+        lexer_init_n(&b, input.data(), input.size());
+
+        Token ta;
+        Token tb;
+        do
+        {
+            ta = lexer_next_token(&a);
+            tb = lexer_next_token_dfa(&b);
+
+            ASSERT_EQ(ta.kind, tb.kind)
+                << "at " << ta.location.pos << ": " << token_kind_to_string(ta.kind)
+                << " vs " << token_kind_to_string(tb.kind) << " in round " << round;
+            ASSERT_EQ(ta.location.pos, tb.location.pos) << "round " << round;
+            ASSERT_EQ(ta.literal.str, tb.literal.str) << "round " << round;
+            ASSERT_EQ(ta.literal.length, tb.literal.length) << "round " << round;
+            if (ta.kind == TK_STRING_LIT)
+            {
+                String_View ca = token_string_contents(&a.strings, ta);
+                String_View cb = token_string_contents(&b.strings, tb);
+                ASSERT_EQ(std::string(ca.str, ca.length), std::string(cb.str, cb.length)) << "round " << round;
+            }
+            else
+            {
+                ASSERT_EQ(ta.value.bits, tb.value.bits) << "round " << round;
+            }
+        } while (ta.kind != TK_EOF);
+
+        lexer_free(&a);
+        lexer_free(&b);
+    }
+}
+
+TEST(LexerTestSuite, test_lexer_scan_kernels)
+{
+    Cpu_Isa detected = scan_get_isa();
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        SCOPED_TRACE(cpu_isa_to_string((Cpu_Isa) isa));
+        scan_set_isa((Cpu_Isa) isa);
+        test_lexer_expected_tokens();
+    }
+    scan_set_isa(detected);
+}
+
+TEST(LexerTestSuite, test_lexer_long_runs_and_line_breaks)
+{
+    // NOTE(HS): runs longer than a vector register, and `\r\n` / `\r` line breaks
+    const char *input =
+        "a_very_long_identifier_name_that_spans_more_than_one_avx_register\r\n"
+        "   \t  \r\n\r\n            \t\t\t\t   123456789012345678901234567890123.5\r"
+        "x\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n\n"
+        "                                          y";
+
+    auto expected = std::vector<Token>{
+        Token{ TK_IDENT,     { 0, 1, 1 },     { (char*) &input[0], 65 },  {} },
+        Token{ TK_FLOAT_LIT, { 96, 4, 20 },   { (char*) &input[96], 35 }, { .f = 123456789012345678901234567890123.5f } },
+        Token{ TK_IDENT,     { 132, 5, 1 },   { (char*) &input[132], 1 }, {} },
+        Token{ TK_IDENT,     { 209, 39, 43 }, { (char*) &input[209], 1 }, {} },
+        Token{ TK_EOF,       { 210, 39, 43 }, { (char*) &input[210], 0 }, {} },
+    };
+
+    Cpu_Isa detected = scan_get_isa();
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        SCOPED_TRACE(cpu_isa_to_string((Cpu_Isa) isa));
+        scan_set_isa((Cpu_Isa) isa);
+
+        Lexer l;
+        lexer_init(&l, input);
+        for (auto& exp : expected)
+        {
+            Token act = lexer_next_token(&l);
+            ASSERT_EQ(exp.kind, act.kind)
+                << "Expected token to have kind " << token_kind_to_string(exp.kind)
+                << ", got " << token_kind_to_string(act.kind);
+            Location location = lexer_location(&l, act.location.pos);
+            EXPECT_EQ(exp.location.pos,  act.location.pos);
+            EXPECT_EQ(exp.location.line, location.line);
+            EXPECT_EQ(exp.location.col,  location.col);
+            EXPECT_EQ(exp.literal.length, act.literal.length);
+            expect_same_value(exp, act, &l.strings);
+        }
+        lexer_free(&l);
+    }
+    scan_set_isa(detected);
+}
+
+TEST(LexerTestSuite, test_keyword_lookup)
+{
+    struct Test_Case
+    {
+        const char *input;
+        Token_Kind expected;
+    };
+
+    std::vector<Test_Case> test_cases{
+        #define X(KIND, STR, FIRST, LAST) { STR, KIND },
+        LEXER_KEYWORD_LIST
+        #undef X
+
+        // same length and first/last characters as a keyword
+        { "tame",     TK_IDENT },
+        { "fable",    TK_IDENT },
+        { "ill",      TK_IDENT },
+        { "rotten",   TK_IDENT },
+        { "pumpkin",  TK_IDENT },
+
+        // prefixes, extensions and case changes of keywords
+        { "tru",      TK_IDENT },
+        { "truee",    TK_IDENT },
+        { "True",     TK_IDENT },
+        { "FALSE",    TK_IDENT },
+        { "i",        TK_IDENT },
+        { "printlnx", TK_IDENT },
+        { "x",        TK_IDENT },
+    };
+
+    for (auto& tc : test_cases)
+    {
+        Lexer l;
+        lexer_init(&l, tc.input);
+        Token t = lexer_next_token(&l);
+
+        EXPECT_EQ(tc.expected, t.kind)
+            << "Expected `" << tc.input << "` to lex as " << token_kind_to_string(tc.expected)
+            << ", got " << token_kind_to_string(t.kind);
+        EXPECT_EQ(strlen(tc.input), t.literal.length);
+    }
+}
+
+TEST(LexerTestSuite, test_tokenize_all)
+{
+    Lexer l;
+    lexer_init(&l, prog);
+
+    Token_Buffer tokens{};
+    lexer_tokenize_all(&l, &tokens);
+
+    ASSERT_EQ(expected_tokens.size(), tokens.len);
+    for (size_t i = 0; i < tokens.len; ++i)
+    {
+        auto& expected = expected_tokens[i];
+        Token actual = token_buffer_get(&tokens, i);
+
+        ASSERT_EQ(expected.kind, actual.kind)
+            << "Expected token to have kind " << token_kind_to_string(expected.kind)
+            << ", got " << token_kind_to_string(actual.kind);
+        EXPECT_EQ(expected.location.pos, actual.location.pos);
+        EXPECT_EQ(expected.literal.str, actual.literal.str);
+        EXPECT_EQ(expected.literal.length, actual.literal.length);
+        expect_same_value(expected, actual, &tokens.strings);
+
+        Location location = token_buffer_location(&tokens, i);
+        EXPECT_EQ(expected.location.line, location.line);
+        EXPECT_EQ(expected.location.col, location.col);
+    }
+
+    token_buffer_free(&tokens);
+}
+
+TEST(LexerTestSuite, test_line_index)
+{
+    struct Test_Case
+    {
+        const char *input;
+        size_t pos;
+        size_t line;
+        size_t col;
+    };
+
+    std::vector<Test_Case> test_cases{
+        { "",            0, 1, 0 },
+        { "abc",         0, 1, 1 },
+        { "abc",         2, 1, 3 },
+        { "abc",         3, 1, 3 },
+        { "a\nb",        1, 1, 2 },
+        { "a\nb",        2, 2, 1 },
+        { "a\r\nb",      2, 1, 3 },
+        { "a\r\nb",      3, 2, 1 },
+        { "a\rb",        2, 2, 1 },
+        { "a\r\rb",      3, 3, 1 },
+        { "a\n\r\nb",    4, 3, 1 },
+        { "a\n",         5, 1, 2 },
+        { "\n\n\n  x",   5, 4, 3 },
+    };
+
+    for (auto& tc : test_cases)
+    {
+        Line_Index index{};
+        line_index_build(&index, tc.input, strlen(tc.input));
+        Location location = line_index_lookup(&index, tc.pos);
+
+        EXPECT_EQ(tc.pos,  location.pos);
+        EXPECT_EQ(tc.line, location.line) << "at " << tc.pos << " in `" << tc.input << "`";
+        EXPECT_EQ(tc.col,  location.col)  << "at " << tc.pos << " in `" << tc.input << "`";
+
+        line_index_free(&index);
+    }
+}
+
+TEST(LexerTestSuite, test_lexer_init_n)
+{
+    // NOTE(HS): only the first 10 bytes are the input, the rest must never be seen
+    const char buffer[] = "var x = 5;\"unterminated";
+    Lexer l;
+    lexer_init_n(&l, buffer, 10);
+
+    Token_Buffer tokens{};
+    lexer_tokenize_all(&l, &tokens);
+
+    std::vector<Token_Kind> expected{ TK_VAR, TK_IDENT, TK_ASSIGN, TK_INT_LIT, TK_SEMICOLON, TK_EOF };
+    ASSERT_EQ(expected.size(), tokens.len);
+    for (size_t i = 0; i < tokens.len; ++i)
+    {
+        EXPECT_EQ(expected[i], token_buffer_get(&tokens, i).kind);
+    }
+
+    Token eof = token_buffer_get(&tokens, tokens.len - 1);
+    EXPECT_EQ(10, eof.location.pos);
+    EXPECT_EQ(0, eof.literal.length);
+
+    token_buffer_free(&tokens);
+
+    // a NUL byte within the input is not the end of it
+    const char with_nul[] = { 'a', '\0', 'b' };
+    lexer_init_n(&l, with_nul, sizeof(with_nul));
+    EXPECT_EQ(TK_IDENT,   lexer_next_token(&l).kind);
+    EXPECT_EQ(TK_ILLEGAL, lexer_next_token(&l).kind);
+    EXPECT_EQ(TK_IDENT,   lexer_next_token(&l).kind);
+    EXPECT_EQ(TK_EOF,     lexer_next_token(&l).kind);
+}
+
+TEST(LexerTestSuite, test_number_decoding)
+{
+    struct Test_Case
+    {
+        const char *input;
+        Token_Kind kind;
+        Token_Value value;
+    };
+
+    std::vector<Test_Case> test_cases{
+        { "0",           TK_INT_LIT, { .i = 0 } },
+        { "007",         TK_INT_LIT, { .i = 7 } },
+        { "2147483647",  TK_INT_LIT, { .i = 2147483647 } },
+        { "2147483648",  TK_ILLEGAL, {} },
+        { "99999999999999999999999", TK_ILLEGAL, {} },
+
+        { "0.1",         TK_FLOAT_LIT, { .f = 0.1f } },
+        { "1.",          TK_FLOAT_LIT, { .f = 1.0f } },
+        { "16777216.0",  TK_FLOAT_LIT, { .f = 16777216.0f } },
+        // needs more than 24 bits of mantissa, so must round (to even)
+        { "16777217.0",  TK_FLOAT_LIT, { .f = 16777216.0f } },
+        { "3.14159265358979323846264338327950288", TK_FLOAT_LIT, { .f = 3.14159265358979323846264338327950288f } },
+        { "0.000000000001", TK_FLOAT_LIT, { .f = 0.000000000001f } },
+        { "340282346638528859811704183484516925440.0", TK_FLOAT_LIT, { .f = 340282346638528859811704183484516925440.0f } },
+        { "340282366920938463463374607431768211456.0", TK_ILLEGAL, {} },
+
+        { "1.2.3",       TK_ILLEGAL, {} },
+    };
+
+    for (auto& tc : test_cases)
+    {
+        Lexer l;
+        lexer_init(&l, tc.input);
+        Token t = lexer_next_token(&l);
+
+        EXPECT_EQ(tc.kind, t.kind)
+            << "Expected `" << tc.input << "` to lex as " << token_kind_to_string(tc.kind)
+            << ", got " << token_kind_to_string(t.kind);
+        EXPECT_EQ(strlen(tc.input), t.literal.length);
+        if (tc.kind == TK_INT_LIT)
+        {
+            EXPECT_EQ(tc.value.i, t.value.i) << tc.input;
+        }
+        else if (tc.kind == TK_FLOAT_LIT)
+        {
+            EXPECT_EQ(tc.value.f, t.value.f) << tc.input;
+        }
+        else
+        {
+            EXPECT_EQ(0, t.value.bits) << tc.input;
+        }
+    }
+}
+
+/// Applies the edit to `text`, re-lexes `tokens` for it, and checks the result is
+/// what lexing the edited text from scratch gives.
+static void check_relex(std::string& text, Token_Buffer& tokens, size_t offset, size_t removed, const std::string& inserted)
+{
+    std::string before = text;
+    text.replace(offset, removed, inserted);
+
+    Text_Edit edit{ offset, removed, inserted.size() };
+    token_buffer_relex(&tokens, text.data(), text.size(), edit);
+
+    Lexer l;
+    lexer_init_n(&l, text.data(), text.size());
+    Token_Buffer expected{};
+    lexer_tokenize_all(&l, &expected);
+
+    ASSERT_EQ(expected.len, tokens.len) << "`" << before << "` -> `" << text << "`";
+    for (size_t i = 0; i < expected.len; ++i)
+    {
+        ASSERT_EQ(expected.kinds[i], tokens.kinds[i]) << "`" << before << "` -> `" << text << "` token " << i;
+        ASSERT_EQ(expected.offsets[i], tokens.offsets[i]) << "`" << before << "` -> `" << text << "` token " << i;
+        ASSERT_EQ(expected.lengths[i], tokens.lengths[i]) << "`" << before << "` -> `" << text << "` token " << i;
+        if (expected.kinds[i] == TK_STRING_LIT)
+        {
+            // NOTE(HS): relexed strings are decoded again, at the end of the strings
+            String_View exp_contents = token_string_contents(&expected.strings, token_buffer_get(&expected, i));
+            String_View act_contents = token_string_contents(&tokens.strings, token_buffer_get(&tokens, i));
+            ASSERT_EQ(std::string(exp_contents.str, exp_contents.length), std::string(act_contents.str, act_contents.length))
+                << "`" << before << "` -> `" << text << "` token " << i;
+        }
+        else
+        {
+            ASSERT_EQ(expected.values[i], tokens.values[i]) << "`" << before << "` -> `" << text << "` token " << i;
+        }
+    }
+
+    Location exp_loc = token_buffer_location(&expected, expected.len - 1);
+    Location act_loc = token_buffer_location(&tokens, tokens.len - 1);
+    EXPECT_EQ(exp_loc.line, act_loc.line);
+    EXPECT_EQ(exp_loc.col, act_loc.col);
+
+    token_buffer_free(&expected);
+    lexer_free(&l);
+}
+
+TEST(LexerTestSuite, test_token_buffer_relex)
+{
+    struct Edit_Case
+    {
+        const char *input;
+        size_t offset;
+        size_t removed;
+        const char *inserted;
+    };
+
+    std::vector<Edit_Case> cases{
+        { "var abc = 1;", 7, 0, "d" },        // extend an ident at its end
+        { "var abc = 1;", 4, 0, "x" },        // ... and at its start
+        { "var a b = 1;", 5, 1, "" },         // join two idents
+        { "var ab = 1;", 5, 0, " " },         // split one
+        { "a < b", 3, 0, "=" },               // one char operator becomes two
+        { "a <= b", 3, 1, "" },               // and back
+        { "x = 1.5;", 5, 1, "" },             // float becomes int
+        { "x = \"str\"; y", 4, 1, "" },       // open string runs to the end
+        { "x = str\"; y", 4, 0, "\"" },       // close it again
+        { "x = \"a\\\"b\"; y", 6, 1, "" },    // remove an escape
+        { "x = \"a\\nb\"; y", 8, 0, "\\t" },  // add one
+        { "x = \"a\\nb\"; y", 10, 0, " " },     // relex an escaped string unchanged
+        { "if (x) { return 1; }", 0, 0, "   " },
+        { "if (x) { return 1; }", 20, 0, " else" },
+        { "if (x) { return 1; }", 0, 20, "" },
+        { "", 0, 0, "var x = 10;" },
+        { "var x = 10;", 3, 5, "" },
+        { "var  \n  x", 4, 1, "\r\n" },
+    };
+
+    for (auto& ec : cases)
+    {
+        std::string text = ec.input;
+        Lexer l;
+        lexer_init_n(&l, text.data(), text.size());
+        Token_Buffer tokens{};
+        lexer_tokenize_all(&l, &tokens);
+
+        check_relex(text, tokens, ec.offset, ec.removed, ec.inserted);
+
+        token_buffer_free(&tokens);
+        lexer_free(&l);
+    }
+}
+
+TEST(LexerTestSuite, test_token_buffer_relex_edit)
+{
+    struct Edit_Case
+    {
+        const char *input;
+        size_t offset;
+        size_t removed;
+        const char *inserted;
+        Token_Edit changed;
+    };
+
+    std::vector<Edit_Case> cases{
+        { "var abc = 1;", 7, 0, "d", { 1, 1, 1 } },                // the ident is replaced
+        { "{ x; }", 1, 0, " var b = 2;", { 1, 0, 5 } },            // the `{` before is kept
+        { "{ var b = 2; x; }", 1, 11, "", { 1, 5, 0 } },           // and removed again
+        { "a < b", 3, 0, "=", { 1, 1, 1 } },
+        { "x = \"ab\"; y", 5, 2, "cd", { 2, 1, 1 } },             // same shape, new text
+        { "x = \"a\\nb\"; y", 10, 0, " ", { 3, 0, 0 } },        // decoded again, still the same
+        { "if (x) { return 1; }", 0, 0, "   ", { 0, 0, 0 } },
+    };
+
+    for (auto& ec : cases)
+    {
+        std::string text = ec.input;
+        Lexer l;
+        lexer_init_n(&l, text.data(), text.size());
+        Token_Buffer tokens{};
+        lexer_tokenize_all(&l, &tokens);
+
+        std::string before = text;
+        text.replace(ec.offset, ec.removed, ec.inserted);
+        Text_Edit edit{ ec.offset, ec.removed, strlen(ec.inserted) };
+        Token_Edit changed = token_buffer_relex_edit(&tokens, text.data(), text.size(), edit);
+
+        EXPECT_EQ(ec.changed.first, changed.first) << "`" << before << "` -> `" << text << "`";
+        EXPECT_EQ(ec.changed.removed, changed.removed) << "`" << before << "` -> `" << text << "`";
+        EXPECT_EQ(ec.changed.inserted, changed.inserted) << "`" << before << "` -> `" << text << "`";
+
+        token_buffer_free(&tokens);
+        lexer_free(&l);
+    }
+}
+
+TEST(LexerTestSuite, test_token_buffer_relex_random_edits)
+{
+    const std::vector<std::string> fragments{
+        "a", "b1", "var", " ", "\n", "\"", "\\", "=", "<", "!", "&", "|", "1", ".", "25", ";", "{", "}", "@",
+    };
+
+    std::string text = prog;
+    Lexer l;
+    lexer_init_n(&l, text.data(), text.size());
+    Token_Buffer tokens{};
+    lexer_tokenize_all(&l, &tokens);
+
+    uint32_t rng = 42;
+    auto next = [&rng] (uint32_t bound) {
+        rng = rng * 1103515245u + 12345u;
+        return bound == 0 ? 0u : (rng >> 8) % bound;
+    };
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        size_t offset = next((uint32_t) text.size() + 1);
+        size_t removed = next(4);
+        if (offset + removed > text.size())
+        {
+            removed = text.size() - offset;
+        }
+
+        std::string inserted;
+        for (uint32_t i = next(3); i > 0; --i)
+        {
+            inserted += fragments[next((uint32_t) fragments.size())];
+        }
+
+        // NOTE(HS): the relexed buffer keeps pointing at the edited `text`
+        check_relex(text, tokens, offset, removed, inserted);
+        if (HasFatalFailure())
+        {
+            break;
+        }
+    }
+
+    token_buffer_free(&tokens);
+    lexer_free(&l);
+}
+
+TEST(LexerTestSuite, test_lexer_unicode_identifiers)
+{
+    const std::string input = "var na\xc3\xafve = \"h\xc3\xa9llo w\xc3\xb6rld\"; \xe5\x90\x8d\xe5\x89\x8d_1 + _x \xf0\x9f\x90\xaf";
+
+    struct Expected
+    {
+        Token_Kind kind;
+        std::string literal;
+    };
+    const std::vector<Expected> expected{
+        { TK_VAR,        "var" },
+        { TK_IDENT,      "na\xc3\xafve" },
+        { TK_ASSIGN,     "=" },
+        { TK_STRING_LIT, "h\xc3\xa9llo w\xc3\xb6rld" },
+        { TK_SEMICOLON,  ";" },
+        { TK_IDENT,      "\xe5\x90\x8d\xe5\x89\x8d_" },
+        { TK_INT_LIT,    "1" },
+        { TK_PLUS,       "+" },
+        { TK_ILLEGAL,    "_" },
+        { TK_IDENT,      "x" },
+        { TK_IDENT,      "\xf0\x9f\x90\xaf" },
+        { TK_EOF,        "" },
+    };
+
+    Cpu_Isa detected = scan_get_isa();
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+        for (Next_Token_Fn next_token : { lexer_next_token, lexer_next_token_dfa })
+        {
+            Lexer l;
+            lexer_init_n(&l, input.data(), input.size());
+            for (auto& exp : expected)
+            {
+                Token t = next_token(&l);
+                ASSERT_EQ(exp.kind, t.kind)
+                    << "Expected token to have kind " << token_kind_to_string(exp.kind)
+                    << ", got " << token_kind_to_string(t.kind) << " (" << cpu_isa_to_string((Cpu_Isa) isa) << ")";
+                EXPECT_EQ(exp.literal, std::string(t.literal.str, t.literal.length));
+            }
+            lexer_free(&l);
+        }
+    }
+    scan_set_isa(detected);
+}
+
+TEST(LexerTestSuite, test_lexer_string_escapes)
+{
+    struct Test_Case
+    {
+        std::string input;
+        std::string literal;
+        std::string contents;
+        bool escaped;
+    };
+
+    const std::vector<Test_Case> test_cases{
+        { "\"plain\"",              "plain",              "plain",        false },
+        { "\"\"",                   "",                   "",             false },
+        { "\"say \\\"hi\\\"\"",     "say \\\"hi\\\"",     "say \"hi\"",   true },
+        { "\"a\\nb\\tc\\rd\\0\"",   "a\\nb\\tc\\rd\\0",   std::string("a\nb\tc\rd\0", 8), true },
+        // NOTE(HS): an escaped backslash doesn't escape the closing quote
+        { "\"dir\\\\\" x",          "dir\\\\",            "dir\\",        true },
+        // unknown escapes are kept, and unterminated strings run to the end
+        { "\"\\q\\\"",              "\\q\\\"",             "\\q\"",        true },
+        { "\"open \\",              "open \\",            "open \\",      true },
+        { "\"long " + std::string(300, 'x') + "\\n\"",
+          "long " + std::string(300, 'x') + "\\n",
+          "long " + std::string(300, 'x') + "\n", true },
+    };
+
+    Cpu_Isa detected = scan_get_isa();
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+        for (Next_Token_Fn next_token : { lexer_next_token, lexer_next_token_dfa })
+        {
+            for (auto& tc : test_cases)
+            {
+                Lexer l;
+                lexer_init_n(&l, tc.input.data(), tc.input.size());
+                Token t = next_token(&l);
+
+                ASSERT_EQ(TK_STRING_LIT, t.kind) << tc.input;
+                EXPECT_EQ(tc.literal, std::string(t.literal.str, t.literal.length)) << tc.input;
+
+                String_View contents = token_string_contents(&l.strings, t);
+                EXPECT_EQ(tc.contents, std::string(contents.str, contents.length)) << tc.input;
+                if (tc.escaped)
+                {
+                    EXPECT_NE(0u, t.value.string) << tc.input;
+                }
+                else
+                {
+                    // without escapes the contents are a view into the input
+                    EXPECT_EQ(0u, t.value.string) << tc.input;
+                    EXPECT_EQ(&tc.input[1], contents.str) << tc.input;
+                }
+                lexer_free(&l);
+            }
+        }
+    }
+    scan_set_isa(detected);
+}
+
+TEST(LexerTestSuite, test_token_buffer_relex_drops_dead_strings)
+{
+    std::string text = "var a = \"x\\ny\"; var b = \"p\\tq\";";
+    Lexer l;
+    lexer_init_n(&l, text.data(), text.size());
+    Token_Buffer tokens{};
+    lexer_tokenize_all(&l, &tokens);
+
+    // NOTE(HS): retyping a character of the first string decodes it again each time,
+    // without dropping the dead copies the store would grow by 7 bytes every edit
+    for (int round = 0; round < 2000; ++round)
+    {
+        check_relex(text, tokens, 9, 1, "x");
+        if (HasFatalFailure())
+        {
+            break;
+        }
+    }
+    EXPECT_LT(tokens.strings.len, 8192u);
+    EXPECT_LE(tokens.strings_dead, tokens.strings.len);
+
+    token_buffer_free(&tokens);
+    lexer_free(&l);
+}
@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "lexer.h"
+#include "parallel_lexer.h"
+
+static void expect_same_tokens(const Token_Buffer& expected, const Token_Buffer& actual, const std::string& trace)
+{
+    ASSERT_EQ(expected.len, actual.len) << trace;
+    for (size_t i = 0; i < expected.len; ++i)
+    {
+        ASSERT_EQ(expected.kinds[i], actual.kinds[i]) << trace << " token " << i;
+        ASSERT_EQ(expected.offsets[i], actual.offsets[i]) << trace << " token " << i;
+        ASSERT_EQ(expected.lengths[i], actual.lengths[i]) << trace << " token " << i;
+        ASSERT_EQ(expected.values[i], actual.values[i]) << trace << " token " << i;
+        if (expected.kinds[i] == TK_STRING_LIT)
+        {
+            String_View exp_contents = token_string_contents(&expected.strings, token_buffer_get(&expected, i));
+            String_View act_contents = token_string_contents(&actual.strings, token_buffer_get(&actual, i));
+            ASSERT_EQ(std::string(exp_contents.str, exp_contents.length), std::string(act_contents.str, act_contents.length))
+                << trace << " token " << i;
+        }
+    }
+}
+
+static void check_parallel_matches_sequential(const std::string& input)
+{
+    Lexer l;
+    lexer_init_n(&l, input.data(), input.size());
+    Token_Buffer expected{};
+    lexer_tokenize_all(&l, &expected);
+
+    for (size_t threads = 1; threads <= 9; ++threads)
+    {
+        Parallel_Lexer_Config config{};
+        config.thread_count = threads;
+        config.min_input_size = 0;
+
+        lexer_init_n(&l, input.data(), input.size());
+        Token_Buffer actual{};
+        lexer_tokenize_parallel(&l, &actual, &config);
+
+        expect_same_tokens(expected, actual, std::to_string(threads) + " threads");
+        token_buffer_free(&actual);
+    }
+
+    token_buffer_free(&expected);
+}
+
+TEST(Parallel_Lexer_Test_Suite, Matches_Sequential)
+{
+    std::string input;
+    for (int i = 0; i < 50; ++i)
+    {
+        input += "var x" "abc = func(a, b) { return a * 10 + b / 2.5; };\n";
+        input += "println(\"hello, world\");\n";
+        input += "if (x <= 10 && y != 3) { x = -x; } else { y = !y; };\n";
+    }
+    check_parallel_matches_sequential(input);
+}
+
+TEST(Parallel_Lexer_Test_Suite, Strings_Spanning_Lines)
+{
+    // NOTE(HS): strings containing newlines (and escaped quotes) mean chunks start
+    // part way through a string literal
+    std::string input;
+    for (int i = 0; i < 40; ++i)
+    {
+        input += "var s = \"first line\nsecond \\\"line\\\"\n\nthird\\\\\";\n";
+        input += "var t = 1;\n";
+    }
+    input += "\"one string\n";
+    for (int i = 0; i < 100; ++i)
+    {
+        input += "covering many lines \\\" and chunks\n";
+    }
+    input += "\" ; var u = 2;\n\"unterminated\n\n";
+    check_parallel_matches_sequential(input);
+}
+
+TEST(Parallel_Lexer_Test_Suite, Small_And_Empty_Inputs)
+{
+    check_parallel_matches_sequential("");
+    check_parallel_matches_sequential("x");
+    check_parallel_matches_sequential("\n\n\n\n\n\n\n\n\n\n\n");
+    check_parallel_matches_sequential("a\nb\nc\nd\ne\n");
+    check_parallel_matches_sequential("no newlines at all in this input but it is long enough");
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "lexer.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "parser_test_util.hpp"
+
+static void check_parallel_matches_sequential(const std::string& input, bool lazy)
+{
+    Lexer l;
+    lexer_init_n(&l, input.data(), input.size());
+
+    Parser expected_parser;
+    parser_init(&expected_parser, &l);
+    expected_parser.lazy_function_bodies = lazy;
+    Program expected = parser_parse_program(&expected_parser);
+
+    for (size_t threads = 1; threads <= 9; ++threads)
+    {
+        std::string trace = std::to_string(threads) + " threads" + (lazy ? ", lazy" : "");
+
+        Parallel_Parser_Config config{};
+        config.thread_count = threads;
+        config.min_token_count = 0;
+
+        Parser p;
+        parser_init_tokens(&p, expected_parser.tokens);
+        p.lazy_function_bodies = lazy;
+        Program actual = parser_parse_program_parallel(&p, &config);
+
+        expect_same_program(expected, actual, trace);
+        EXPECT_EQ(expected.arena.used, actual.arena.used) << trace;
+        EXPECT_EQ(expected_parser.cur, p.cur) << trace;
+
+        ASSERT_EQ(expected_parser.errors.len, p.errors.len) << trace;
+        for (size_t i = 0; i < p.errors.len; ++i)
+        {
+            EXPECT_EQ(expected_parser.errors.elements[i].kind, p.errors.elements[i].kind) << trace;
+            EXPECT_EQ(expected_parser.errors.elements[i].token, p.errors.elements[i].token) << trace;
+            EXPECT_EQ(expected_parser.errors.elements[i].expected, p.errors.elements[i].expected) << trace;
+        }
+
+        program_free(&actual);
+        parser_free(&p);
+    }
+
+    program_free(&expected);
+    parser_free(&expected_parser);
+}
+
+TEST(Parallel_Parser_Test_Suite, Matches_Sequential)
+{
+    std::string input;
+    for (int i = 0; i < 200; ++i)
+    {
+        std::string n = std::to_string(i);
+        input += "var a" + n + " = " + n + " * (b + " + n + ") - !c;\n";
+        input += "var f" + n + " = func(x, y) {\n    var z = x < y;\n    if (z) { x } else { y };\n};\n";
+        input += "if (a" + n + " >= " + n + ") { a" + n + " } else { -a" + n + " }\n";
+        input += "f" + n + ";\n";
+    }
+
+    check_parallel_matches_sequential(input, false);
+    check_parallel_matches_sequential(input, true);
+}
+
+TEST(Parallel_Parser_Test_Suite, Statements_Without_Boundaries)
+{
+    std::string input;
+    for (int i = 0; i < 100; ++i)
+    {
+        // NOTE(HS): `return;` parses the next statement as its expression
+        input += "return;\n";
+        input += "x" + std::to_string(i) + "\n";
+        input += "y;\n";
+    }
+
+    check_parallel_matches_sequential(input, false);
+}
+
+TEST(Parallel_Parser_Test_Suite, Syntax_Errors)
+{
+    std::string input;
+    for (int i = 0; i < 100; ++i)
+    {
+        input += "var a = (1 + 2; b);\n";
+        input += "var = 3;\n";
+        input += "} c; ) d;\n";
+        input += "var f = func(x { x; };\n";
+        input += "var g = func() { 1 + ; 2 };\n";
+    }
+
+    check_parallel_matches_sequential(input, false);
+    check_parallel_matches_sequential(input, true);
+
+    // an unterminated block swallows the rest of the input
+    check_parallel_matches_sequential(std::string("var f = func() {\n") + input, false);
+}
+
+TEST(Parallel_Parser_Test_Suite, Misaligned_Segments)
+{
+    // NOTE(HS): the stray `)` puts the split scan a level out, so it may split
+    // inside the body, where the segments won't line up
+    std::string input;
+    for (int i = 0; i < 100; ++i)
+    {
+        input += "var h = func() { ); 1; 2; 3 };\n";
+        input += "var i = " + std::to_string(i) + ";\n";
+    }
+
+    check_parallel_matches_sequential(input, false);
+    check_parallel_matches_sequential(input, true);
+}
+
+TEST(Parallel_Parser_Test_Suite, Small_And_Empty_Inputs)
+{
+    check_parallel_matches_sequential("", false);
+    check_parallel_matches_sequential("x;", false);
+    check_parallel_matches_sequential("a; b; c", false);
+}
@@ -1,4 +1,7 @@
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <vector>
 #include <string>
 #include <stdint.h>
@@ -12,8 +15,6 @@
 #define PARSER_TEST_UTIL_IMPL
 #include "parser_test_util.hpp"
 
-// TODO(HS): add parser error checking
-
 TEST(ParserTestSuite, Parse_Var_Statement)
 {
     struct Test_Case 
@@ -38,7 +39,7 @@ TEST(ParserTestSuite, Parse_Var_Statement)
 
         { "var y = -5;", "y", Expression{ AST_PREFIX_EXPRESSION, { .prefix_expression = { '-', &rhs2 } } } },
 
-        { "var a = b;", "a", Expression{ AST_IDENT_EXPRESSION, { .ident_expression = { "b" } }} },
+        { "var a = b;", "a", Expression{ AST_IDENT_EXPRESSION, { .ident_expression = make_ident("b") }} },
 
         { "var x = 5 + 4 * 3;", "x", Expression{ AST_INFIX_EXPRESSION, { .infix_expression { TK_PLUS, &lhs1, &rhs1 } } } },
     };
@@ -66,11 +67,14 @@ TEST(ParserTestSuite, Parse_Var_Statement)
         std::string expected_ident{tc.expected_ident};
         std::string actual_ident{stmt.stmt.var_statement.ident};
         EXPECT_EQ(expected_ident, actual_ident) << prog_str;
+        EXPECT_EQ(make_ident(tc.expected_ident).symbol, stmt.stmt.var_statement.symbol) << prog_str;
 
         Expression expr = stmt.stmt.var_statement.expression;
         test_expression(tc.expected, expr, prog_str);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -112,6 +116,8 @@ TEST(ParserTestSuite, Parse_Return_Statements)
             << "\n" << prog_str;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -165,6 +171,8 @@ TEST(ParserTestSuite, Parse_Ident_Expression)
             << "\n" << prog_str;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -213,6 +221,8 @@ TEST(ParserTestSuite, Parse_Int_Expression)
         EXPECT_EQ(tc.expected_value, iexpr.value) << prog_str;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -261,6 +271,8 @@ TEST(ParserTestSuite, Parse_Float_Expression)
         EXPECT_FLOAT_EQ(tc.expected_value, fexpr.value) << prog_str;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -297,6 +309,8 @@ TEST(ParserTestSuite, Parse_Boolean_Expression)
         test_expression(tc.expected, act, prog_str);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void*) prog_str);
     }
 }
@@ -348,6 +362,8 @@ TEST(ParserTestSuite, Parse_Prefix_Expression)
         test_expression(tc.expected, expr, prog_str);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -371,6 +387,10 @@ TEST(ParserTestSuite, Parse_Binary_Expression)
         { "5 > 5;",  TK_GT,       Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
         { "5 == 5;", TK_EQ,       Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
         { "5 != 5;", TK_NEQ,      Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
+        { "5 <= 5;", TK_LTE,      Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
+        { "5 >= 5;", TK_GTE,      Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
+        { "5 && 5;", TK_LAND,     Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
+        { "5 || 5;", TK_LOR,      Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } }, Expression{ AST_INT_EXPRESSION, { .int_expression = {5} } } },
     };
 
     for (auto& tc : test_cases)
@@ -415,6 +435,8 @@ TEST(ParserTestSuite, Parse_Binary_Expression)
         test_expression(tc.rhs, *rhs, prog_str);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
@@ -438,6 +460,12 @@ TEST(ParserTestSuite, Parse_Operator_Precidence)
 
         { "5 > 4 == 3 < 4;", "((5 > 4) == (3 < 4))", 1 },
         { "5 > 4 != 3 < 4;", "((5 > 4) != (3 < 4))", 1 },
+        { "5 >= 4 == 3 <= 4;", "((5 >= 4) == (3 <= 4))", 1 },
+
+        { "a || b && c;", "(a || (b && c))", 1 },
+        { "a && b || c && d;", "((a && b) || (c && d))", 1 },
+        { "a == b && c != d || !e;", "(((a == b) && (c != d)) || (!e))", 1 },
+        { "a < b + 1 && b >= c * 2;", "((a < (b + 1)) && (b >= (c * 2)))", 1 },
 
         { "3 + 4 * 5 == 3 * 1 + 4 * 5", "((3 + (4 * 5)) == ((3 * 1) + (4 * 5)))", 1 },
 
@@ -488,6 +516,8 @@ TEST(ParserTestSuite, Parse_Operator_Precidence)
         EXPECT_EQ(act_ast, exp_ast) << "\n" << prog_yml;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
         free((void *) prog_yml);
     }
@@ -497,8 +527,8 @@ TEST(ParserTestSuite, Parse_If_Expressions)
 {
     const char *input = "if (x < y) { 5 }";
 
-    Expression lhs1{ AST_IDENT_EXPRESSION, { .ident_expression = { "x" } } };
-    Expression rhs1{ AST_IDENT_EXPRESSION, { .ident_expression = { "y" } }};
+    Expression lhs1{ AST_IDENT_EXPRESSION, { .ident_expression = make_ident("x") } };
+    Expression rhs1{ AST_IDENT_EXPRESSION, { .ident_expression = make_ident("y") }};
 
     Expression condition1{
         AST_INFIX_EXPRESSION,
@@ -511,6 +541,7 @@ TEST(ParserTestSuite, Parse_If_Expressions)
     Statement consequence1_stmts[] = {
         Statement{
             AST_EXPRESSION_STATEMENT,
+            1,
             { .expression_statement = {
                 Expression{
                     AST_INT_EXPRESSION,
@@ -519,7 +550,7 @@ TEST(ParserTestSuite, Parse_If_Expressions)
             } }
         }
     };
-    Block_Statement consequence1{ 1, 64, consequence1_stmts };
+    Block_Statement consequence1{ 1, 64, consequence1_stmts, 6 };
     Expression exp{
         AST_IF_EXPRESSION,
         { .if_expression = {
@@ -558,6 +589,8 @@ TEST(ParserTestSuite, Parse_If_Expressions)
     EXPECT_TRUE(expr.expr.if_expression.alternative == NULL) << "Expected Consequence to be NUll, instead is not NULL" ;
 
     program_free(&program);
+
+    parser_free(&p);
     free((void *) prog_str);
 }
 
@@ -565,8 +598,8 @@ TEST(ParserTestSuite, Parse_If_Else_Expressions)
 {
     const char *input = "if (x < y) { 5 } else { 3 }";
 
-    Expression lhs1{ AST_IDENT_EXPRESSION, { .ident_expression = { "x" } } };
-    Expression rhs1{ AST_IDENT_EXPRESSION, { .ident_expression = { "y" } }};
+    Expression lhs1{ AST_IDENT_EXPRESSION, { .ident_expression = make_ident("x") } };
+    Expression rhs1{ AST_IDENT_EXPRESSION, { .ident_expression = make_ident("y") }};
 
     Expression condition1{
         AST_INFIX_EXPRESSION,
@@ -579,6 +612,7 @@ TEST(ParserTestSuite, Parse_If_Else_Expressions)
     Statement consequence1_stmts[] = {
         Statement{
             AST_EXPRESSION_STATEMENT,
+            1,
             { .expression_statement = {
                 Expression{
                     AST_INT_EXPRESSION,
@@ -587,10 +621,11 @@ TEST(ParserTestSuite, Parse_If_Else_Expressions)
             } }
         }
     };
-    Block_Statement consequence1{ 1, 64, consequence1_stmts };
+    Block_Statement consequence1{ 1, 64, consequence1_stmts, 6 };
     Statement alternative1_stmts[] = {
         Statement{
             AST_EXPRESSION_STATEMENT,
+            1,
             { .expression_statement = {
                 Expression{
                     AST_INT_EXPRESSION,
@@ -599,7 +634,7 @@ TEST(ParserTestSuite, Parse_If_Else_Expressions)
             } }
         }
     };
-    Block_Statement alternative1{ 1, 64, alternative1_stmts };
+    Block_Statement alternative1{ 1, 64, alternative1_stmts, 10 };
     Expression exp{
         AST_IF_EXPRESSION,
         { .if_expression = {
@@ -638,6 +673,8 @@ TEST(ParserTestSuite, Parse_If_Else_Expressions)
     EXPECT_TRUE(expr.expr.if_expression.alternative != NULL) << "Expected Consequence to be NUll, instead is not NULL" ;
 
     program_free(&program);
+
+    parser_free(&p);
     free((void *) prog_str);
 }
 
@@ -650,21 +687,21 @@ TEST(ParserTestSuite, Parse_Function_Literal)
     };
 
     Parameters func1_args{ 0, 0, NULL };
-    Block_Statement func1_block{ 0, 0, NULL };
+    Block_Statement func1_block{ 0, 0, NULL, 3 };
     Expression func1{
         AST_FUNCTION_EXPRESSION,
-        { .function_expression = { func1_args, &func1_block } }
+        { .function_expression = { func1_args, &func1_block, 3, 4 } }
     };
 
     Ident_Expression idents[] = {
-        Ident_Expression{ "x" },
-        Ident_Expression{ "y" },
+        make_ident("x"),
+        make_ident("y"),
     };
     Parameters func2_args{ 2, 2, idents };
-    Block_Statement func2_block{ 1, 2, NULL };
+    Block_Statement func2_block{ 1, 2, NULL, 6 };
     Expression func2{
         AST_FUNCTION_EXPRESSION,
-        { .function_expression = { func2_args, &func2_block } }
+        { .function_expression = { func2_args, &func2_block, 6, 12 } }
     };
 
     std::vector<Test_Case> test_cases{
@@ -710,8 +747,689 @@ TEST(ParserTestSuite, Parse_Function_Literal)
 
         // test bodies match (not rigorous)
         EXPECT_EQ(exp_fexpr.body->len, act_fexpr.body->len) << prog_str;
+        EXPECT_EQ(exp_fexpr.body_open, act_fexpr.body_open) << prog_str;
+        EXPECT_EQ(exp_fexpr.body_close, act_fexpr.body_close) << prog_str;
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
     }
 }
+
+TEST(ParserTestSuite, Program_Owns_Its_Nodes)
+{
+    const char *input =
+        "var f = func(a, b, c) {\n"
+        "    if (a < b) { return -a; } else { var d = a * b + c; d }\n"
+        "};\n"
+        "if (true) { 1; 2; if (false) { 3 } }\n";
+
+    Lexer l;
+    Parser p;
+    lexer_init(&l, input);
+    parser_init(&p, &l);
+
+    Program program = parser_parse_program(&p);
+
+    ASSERT_EQ(2u, program.statements.len);
+    EXPECT_GT(program.arena.used, 0u);
+
+    // NOTE(HS): nested blocks are copied out of the scratch stack at their exact size
+    EXPECT_EQ(0u, p.scratch_statements.len);
+    EXPECT_EQ(0u, p.scratch_idents.len);
+
+    Function_Expression func = program.statements.elements[0].stmt.var_statement.expression.expr.function_expression;
+    ASSERT_EQ(3u, func.parameters.len);
+    EXPECT_EQ(make_ident("c").symbol, func.parameters.idents[2].symbol);
+    ASSERT_EQ(1u, func.body->len);
+
+    If_Expression inner_if = func.body->statements[0].stmt.expression_statement.expression.expr.if_expression;
+    EXPECT_EQ(1u, inner_if.consequence->len);
+    ASSERT_NE(nullptr, inner_if.alternative);
+    EXPECT_EQ(2u, inner_if.alternative->len);
+    EXPECT_EQ(inner_if.alternative->len, inner_if.alternative->capacity);
+
+    If_Expression outer_if = program.statements.elements[1].stmt.expression_statement.expression.expr.if_expression;
+    ASSERT_EQ(3u, outer_if.consequence->len);
+    EXPECT_EQ(AST_IF_EXPRESSION, outer_if.consequence->statements[2].stmt.expression_statement.expression.kind);
+
+    program_free(&program);
+    EXPECT_EQ(nullptr, program.arena.head);
+    EXPECT_EQ(0u, program.statements.len);
+
+    parser_free(&p);
+}
+
+TEST(ParserTestSuite, Parse_Errors_Recover)
+{
+    struct Test_Case
+    {
+        const char *input;
+        std::vector<Statement_Kind> expected_statements;
+        std::vector<Parse_Error_Kind> expected_errors;
+    };
+
+    std::vector<Test_Case> test_cases{
+        { "var = 5; var y = 2;", { AST_ILLGEAL_STATEMENT, AST_VAR_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        { "var x 5; x;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        { "var x = ; 1;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_EXPRESSION } },
+        { "(1 + 2; 3;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        { "1 + * 2 - 3; 4;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_EXPRESSION } },
+        { "} 1;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_EXPRESSION } },
+        { "func(a, 1) { a }; 2;", { AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        { "if (a) { b", { AST_ILLGEAL_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        // errors inside a block are recovered from inside it
+        { "if (a) { var = 1; b } c;", { AST_EXPRESSION_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_TOKEN } },
+        { "if (a) { var x = } 3;", { AST_EXPRESSION_STATEMENT, AST_EXPRESSION_STATEMENT }, { PARSE_ERROR_EXPECTED_EXPRESSION } },
+        // one error per statement
+        { "var x = (1 +; var y = (2; z;",
+            { AST_ILLGEAL_STATEMENT, AST_ILLGEAL_STATEMENT, AST_EXPRESSION_STATEMENT },
+            { PARSE_ERROR_EXPECTED_EXPRESSION, PARSE_ERROR_EXPECTED_TOKEN } },
+    };
+
+    for (auto& tc : test_cases)
+    {
+        Lexer l;
+        Parser p;
+
+        lexer_init(&l, tc.input);
+        parser_init(&p, &l);
+
+        Program program = parser_parse_program(&p);
+
+        ASSERT_EQ(tc.expected_statements.size(), program.statements.len) << tc.input;
+        for (size_t i = 0; i < program.statements.len; ++i)
+        {
+            EXPECT_EQ(tc.expected_statements[i], program.statements.elements[i].kind)
+                << "Statement " << i << " of " << tc.input
+                << " is " << ast_statement_kind_to_str(program.statements.elements[i].kind);
+        }
+
+        ASSERT_EQ(tc.expected_errors.size(), p.errors.len) << tc.input;
+        for (size_t i = 0; i < p.errors.len; ++i)
+        {
+            EXPECT_EQ(tc.expected_errors[i], p.errors.elements[i].kind)
+                << "Error " << i << " of " << tc.input
+                << " is " << parse_error_kind_to_str(p.errors.elements[i].kind);
+        }
+        EXPECT_FALSE(p.panicking) << tc.input;
+        EXPECT_EQ(0u, p.scratch_statements.len) << tc.input;
+        EXPECT_EQ(0u, p.scratch_idents.len) << tc.input;
+        EXPECT_EQ(0u, p.scratch_frames.len) << tc.input;
+        EXPECT_EQ(0u, p.expression_depth) << tc.input;
+
+        program_free(&program);
+        parser_free(&p);
+    }
+}
+
+TEST(ParserTestSuite, Parse_Errors_Report_Location)
+{
+    const char *input =
+        "var a = 1;\n"
+        "var b = (a + 2;\n"
+        "var = 3;\n";
+
+    Lexer l;
+    Parser p;
+    lexer_init(&l, input);
+    parser_init(&p, &l);
+
+    Program program = parser_parse_program(&p);
+    ASSERT_EQ(2u, p.errors.len);
+    EXPECT_EQ(TK_RPAREN, p.errors.elements[0].expected);
+    EXPECT_EQ(TK_SEMICOLON, p.tokens->kinds[p.errors.elements[0].token]);
+
+    FILE *out = tmpfile();
+    ASSERT_NE(nullptr, out);
+    parser_print_errors(&p, out, "script.ty");
+    rewind(out);
+
+    char line[128];
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), out));
+    EXPECT_STREQ("script.ty:2:15: error: expected RPAREN, found SEMICOLON\n", line);
+    ASSERT_NE(nullptr, fgets(line, sizeof(line), out));
+    EXPECT_STREQ("script.ty:3:5: error: expected IDENT, found ASSIGN\n", line);
+    fclose(out);
+
+    // NOTE(HS): the errors of a previous parse are cleared
+    program_free(&program);
+    p.cur = 0;
+    program = parser_parse_program(&p);
+    EXPECT_EQ(2u, p.errors.len);
+
+    program_free(&program);
+    parser_free(&p);
+}
+
+/// Parses `input`, which must be a single statement, with a depth limit of
+/// `max_depth` and a nesting limit of `max_nesting`, returning the errors.
+static std::vector<Parse_Error_Kind> parse_nested(const std::string& input, size_t max_depth, Program *program, Parser *p,
+    size_t max_nesting = PARSER_MAX_NESTING_DEPTH)
+{
+    Lexer l;
+    lexer_init_n(&l, input.data(), input.size());
+    parser_init(p, &l);
+    lexer_free(&l);
+    p->max_expression_depth = max_depth;
+    p->max_nesting_depth = max_nesting;
+
+    *program = parser_parse_program(p);
+    EXPECT_EQ(0u, p->scratch_frames.len);
+    EXPECT_EQ(0u, p->expression_depth);
+    EXPECT_EQ(0u, p->nesting_depth);
+
+    std::vector<Parse_Error_Kind> errors;
+    for (size_t i = 0; i < p->errors.len; ++i)
+    {
+        errors.push_back(p->errors.elements[i].kind);
+    }
+    return errors;
+}
+
+TEST(ParserTestSuite, Parse_Deeply_Nested_Expressions)
+{
+    const size_t depth = 100000;
+    Program program;
+    Parser p;
+
+    // NOTE(HS): a long left associative chain only ever has one operator open
+    std::string chain = "a";
+    for (size_t i = 0; i < depth; ++i)
+    {
+        chain += i % 2 ? " + b" : " - c";
+    }
+    ASSERT_TRUE(parse_nested(chain + ";", 2, &program, &p).empty());
+    ASSERT_EQ(1u, program.statements.len);
+    const Expression *expr = &program.statements.elements[0].stmt.expression_statement.expression;
+    size_t operators = 0;
+    while (expr->kind == AST_INFIX_EXPRESSION)
+    {
+        EXPECT_EQ(AST_IDENT_EXPRESSION, expr->expr.infix_expression.rhs->kind);
+        expr = expr->expr.infix_expression.lhs;
+        operators += 1;
+    }
+    EXPECT_EQ(depth, operators);
+    EXPECT_STREQ("a", expr->expr.ident_expression.ident);
+    program_free(&program);
+    parser_free(&p);
+
+    // parentheses and prefix operators nest, but take no C stack
+    std::string nested;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        nested += i % 2 ? "-" : "(a + ";
+    }
+    nested += "b";
+    for (size_t i = 0; i < depth / 2; ++i)
+    {
+        nested += ")";
+    }
+    ASSERT_TRUE(parse_nested(nested + ";", 2 * depth, &program, &p).empty());
+    ASSERT_EQ(1u, program.statements.len);
+    expr = &program.statements.elements[0].stmt.expression_statement.expression;
+    for (size_t i = 0; i < depth / 2; ++i)
+    {
+        ASSERT_EQ(AST_INFIX_EXPRESSION, expr->kind);
+        EXPECT_EQ(TK_PLUS, expr->expr.infix_expression.op);
+        expr = expr->expr.infix_expression.rhs;
+        ASSERT_EQ(AST_PREFIX_EXPRESSION, expr->kind);
+        EXPECT_EQ('-', expr->expr.prefix_expression.op);
+        expr = expr->expr.prefix_expression.rhs;
+    }
+    EXPECT_STREQ("b", expr->expr.ident_expression.ident);
+    program_free(&program);
+    parser_free(&p);
+
+    // nesting past the limit is an error, which the parse recovers from
+    std::vector<Parse_Error_Kind> too_deep{ PARSE_ERROR_EXPRESSION_TOO_DEEP };
+    EXPECT_EQ(too_deep, parse_nested(nested + "; x;", PARSER_MAX_EXPRESSION_DEPTH, &program, &p));
+    ASSERT_EQ(2u, program.statements.len);
+    EXPECT_EQ(AST_ILLGEAL_STATEMENT, program.statements.elements[0].kind);
+    EXPECT_EQ(AST_EXPRESSION_STATEMENT, program.statements.elements[1].kind);
+    program_free(&program);
+    parser_free(&p);
+
+    // expressions nested in ifs and funcs recurse, so they stop at the much
+    // smaller nesting limit first. Only the statement too deep in the blocks
+    // is dropped.
+    std::string blocks;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        blocks += i % 2 ? "if (a) { " : "func() { ";
+    }
+    blocks += "b";
+    for (size_t i = 0; i < depth; ++i)
+    {
+        blocks += " }";
+    }
+    EXPECT_EQ(too_deep, parse_nested(blocks + "; x;", 4 * depth, &program, &p));
+    ASSERT_EQ(2u, program.statements.len);
+    const Statement *stmt = &program.statements.elements[0];
+    for (size_t i = 1; i < PARSER_MAX_NESTING_DEPTH; ++i)
+    {
+        ASSERT_EQ(AST_EXPRESSION_STATEMENT, stmt->kind) << i;
+        const Expression *nested_expr = &stmt->stmt.expression_statement.expression;
+        const Block_Statement *block = nested_expr->kind == AST_IF_EXPRESSION
+            ? nested_expr->expr.if_expression.consequence
+            : nested_expr->expr.function_expression.body;
+        ASSERT_EQ(1u, block->len) << i;
+        stmt = &block->statements[0];
+    }
+    EXPECT_EQ(AST_ILLGEAL_STATEMENT, stmt->kind);
+    EXPECT_EQ(AST_EXPRESSION_STATEMENT, program.statements.elements[1].kind);
+    program_free(&program);
+    parser_free(&p);
+
+    std::string conditions;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        conditions += "if (";
+    }
+    conditions += "a";
+    for (size_t i = 0; i < depth; ++i)
+    {
+        conditions += ") { b }";
+    }
+    EXPECT_EQ(too_deep, parse_nested(conditions + "; x;", 4 * depth, &program, &p));
+    ASSERT_EQ(2u, program.statements.len);
+    EXPECT_EQ(AST_ILLGEAL_STATEMENT, program.statements.elements[0].kind);
+    program_free(&program);
+    parser_free(&p);
+
+    // expressions nested in blocks count towards both
+    struct Test_Case
+    {
+        const char *input;
+        size_t max_depth;
+        size_t max_nesting;
+        std::vector<Parse_Error_Kind> expected_errors;
+    };
+    std::vector<Test_Case> test_cases{
+        { "1 + 2 * 3;", 3, 1, {} },
+        { "1 + 2 * 3;", 2, 1, too_deep },
+        { "-(1);", 3, 1, {} },
+        { "-(1);", 2, 1, too_deep },
+        { "if (a) { if (b) { c } };", 3, 3, {} },
+        { "if (a) { if (b) { c } };", 2, 3, too_deep },
+        { "if (a) { if (b) { c } };", 0, 3, too_deep },
+        { "if (a) { if (b) { c } };", 3, 2, too_deep },
+        { "if (if (a) { b }) { c };", 3, 3, {} },
+        { "if (if (a) { b }) { c };", 3, 2, too_deep },
+        { "func() { func() { a } };", 3, 3, {} },
+        { "func() { func() { a } };", 3, 2, too_deep },
+        { "a;", 1, 0, too_deep },
+    };
+    for (auto& tc : test_cases)
+    {
+        EXPECT_EQ(tc.expected_errors, parse_nested(tc.input, tc.max_depth, &program, &p, tc.max_nesting)) << tc.input;
+        program_free(&program);
+        parser_free(&p);
+    }
+}
+
+TEST(ParserTestSuite, Parse_Function_Bodies_Lazily)
+{
+    const char *input =
+        "var f = func(a, b) {\n"
+        "    var g = func(c) { if (c) { c } else { -c } };\n"
+        "    return a + b;\n"
+        "};\n"
+        "var x = func() { 1; 2; 3 };\n"
+        "x;\n";
+
+    Lexer l;
+    lexer_init(&l, input);
+
+    // full parse, for comparison
+    Parser full_parser;
+    parser_init(&full_parser, &l);
+    Program full = parser_parse_program(&full_parser);
+
+    Parser p;
+    parser_init(&p, &l);
+    p.lazy_function_bodies = true;
+    Program program = parser_parse_program(&p);
+
+    ASSERT_EQ(3u, program.statements.len);
+    EXPECT_EQ(0u, p.errors.len);
+    EXPECT_LT(program.arena.used, full.arena.used);
+
+    Function_Expression *f = &program.statements.elements[0].stmt.var_statement.expression.expr.function_expression;
+    EXPECT_EQ(nullptr, f->body);
+    ASSERT_EQ(2u, f->parameters.len);
+    EXPECT_EQ(make_ident("b").symbol, f->parameters.idents[1].symbol);
+    EXPECT_EQ(TK_LBRACE, p.tokens->kinds[f->body_open]);
+    EXPECT_EQ(TK_RBRACE, p.tokens->kinds[f->body_close]);
+    EXPECT_EQ(TK_SEMICOLON, p.tokens->kinds[f->body_close + 1]);
+
+    Function_Expression *full_f = &full.statements.elements[0].stmt.var_statement.expression.expr.function_expression;
+    EXPECT_EQ(full_f->body_open, f->body_open);
+    EXPECT_EQ(full_f->body_close, f->body_close);
+
+    // NOTE(HS): parsing a body on demand leaves the functions inside it lazy
+    Block_Statement *body = parser_parse_function_body(&p, &program.arena, f);
+    ASSERT_NE(nullptr, body);
+    EXPECT_EQ(body, f->body);
+    ASSERT_EQ(2u, body->len);
+    EXPECT_EQ(AST_RETURN_STATEMENT, body->statements[1].kind);
+
+    Function_Expression *g = &body->statements[0].stmt.var_statement.expression.expr.function_expression;
+    EXPECT_EQ(nullptr, g->body);
+    Block_Statement *g_body = parser_parse_function_body(&p, &program.arena, g);
+    ASSERT_EQ(1u, g_body->len);
+    EXPECT_EQ(AST_IF_EXPRESSION, g_body->statements[0].stmt.expression_statement.expression.kind);
+
+    EXPECT_EQ(body, parser_parse_function_body(&p, &program.arena, f));
+
+    Function_Expression *x = &program.statements.elements[1].stmt.var_statement.expression.expr.function_expression;
+    EXPECT_EQ(3u, parser_parse_function_body(&p, &program.arena, x)->len);
+    EXPECT_EQ(0u, p.errors.len);
+
+    program_free(&full);
+    parser_free(&full_parser);
+    program_free(&program);
+    parser_free(&p);
+}
+
+TEST(ParserTestSuite, Parse_Function_Bodies_Lazily_Errors)
+{
+    struct Test_Case
+    {
+        const char *input;
+        size_t errors_before_body;
+        size_t errors_after_body;
+    };
+
+    std::vector<Test_Case> test_cases{
+        // errors inside the body wait until it is parsed
+        { "var f = func() { var = 1; 2 };", 0, 1 },
+        { "var f = func() { 1 + ; { };", 1, 1 },
+    };
+
+    for (auto& tc : test_cases)
+    {
+        Lexer l;
+        Parser p;
+        lexer_init(&l, tc.input);
+        parser_init(&p, &l);
+        p.lazy_function_bodies = true;
+
+        Program program = parser_parse_program(&p);
+        EXPECT_EQ(tc.errors_before_body, p.errors.len) << tc.input;
+
+        ASSERT_EQ(1u, program.statements.len) << tc.input;
+        Statement *stmt = &program.statements.elements[0];
+        if (stmt->kind == AST_VAR_STATEMENT)
+        {
+            Function_Expression *f = &stmt->stmt.var_statement.expression.expr.function_expression;
+            Block_Statement *body = parser_parse_function_body(&p, &program.arena, f);
+            EXPECT_EQ(2u, body->len) << tc.input;
+            EXPECT_EQ(AST_ILLGEAL_STATEMENT, body->statements[0].kind) << tc.input;
+        }
+        else
+        {
+            // unmatched braces are found by the skip
+            EXPECT_EQ(AST_ILLGEAL_STATEMENT, stmt->kind) << tc.input;
+        }
+        EXPECT_EQ(tc.errors_after_body, p.errors.len) << tc.input;
+
+        program_free(&program);
+        parser_free(&p);
+    }
+}
+
+struct Streamed_Statements
+{
+    std::vector<std::string> printed;
+    size_t stop_after;
+    size_t lazy_bodies;
+};
+
+static bool collect_statement(Parser *p, const Statement *stmt, Arena *arena, void *user)
+{
+    Streamed_Statements *streamed = (Streamed_Statements *) user;
+
+    // NOTE(HS): a lazy function body can be parsed into the statement's arena
+    if (stmt->kind == AST_VAR_STATEMENT
+        && stmt->stmt.var_statement.expression.kind == AST_FUNCTION_EXPRESSION)
+    {
+        Function_Expression func = stmt->stmt.var_statement.expression.expr.function_expression;
+        if (!func.body)
+        {
+            const Block_Statement *body = parser_parse_function_body(p, arena, &func);
+            EXPECT_NE(nullptr, body);
+            EXPECT_EQ(0u, body ? body->open : 0u);
+            streamed->lazy_bodies += 1;
+        }
+    }
+
+    const char *str = statement_print_ast(stmt, PRINT_FORMAT_PLAIN);
+    streamed->printed.push_back(str);
+    free((void *) str);
+    return streamed->printed.size() < streamed->stop_after;
+}
+
+TEST(ParserTestSuite, Parse_Statements_One_At_A_Time)
+{
+    const char *input =
+        "var x = 5 + 4 * 3;\n"
+        "var = 1;\n"
+        "var f = func(a) { a * 2 };\n"
+        "!x;\n"
+        "x - (1 + 2)\n";
+
+    Lexer l;
+    lexer_init(&l, input);
+
+    Parser p;
+    parser_init(&p, &l);
+    Program program = parser_parse_program(&p);
+    const char *prog_str = program_print_ast(&program, PRINT_FORMAT_PLAIN);
+    size_t program_errors = p.errors.len;
+
+    std::vector<std::string> expected;
+    std::string line;
+    for (const char *c = prog_str; *c; ++c)
+    {
+        if (*c == '\n')
+        {
+            expected.push_back(line);
+            line.clear();
+        }
+        else
+        {
+            line += *c;
+        }
+    }
+    expected.push_back(line);
+    ASSERT_EQ(5u, expected.size());
+
+    Parser streaming;
+    parser_init(&streaming, &l);
+    streaming.lazy_function_bodies = true;
+
+    Streamed_Statements streamed{ {}, SIZE_MAX, 0 };
+    EXPECT_EQ(5u, parser_parse_each(&streaming, collect_statement, &streamed));
+    EXPECT_EQ(expected, streamed.printed);
+    EXPECT_EQ(1u, streamed.lazy_bodies);
+    EXPECT_EQ(program_errors, streaming.errors.len);
+    EXPECT_EQ(TK_EOF, streaming.tokens->kinds[streaming.cur]);
+    parser_free(&streaming);
+
+    // stopping early
+    parser_init(&streaming, &l);
+    streamed = Streamed_Statements{ {}, 2, 0 };
+    EXPECT_EQ(2u, parser_parse_each(&streaming, collect_statement, &streamed));
+    EXPECT_EQ(2u, streamed.printed.size());
+
+    // and picking up again a statement at a time
+    Arena arena{};
+    Statement stmt;
+    ASSERT_TRUE(parser_parse_next_statement(&streaming, &arena, &stmt));
+    EXPECT_EQ(AST_VAR_STATEMENT, stmt.kind);
+    ASSERT_TRUE(parser_parse_next_statement(&streaming, &arena, &stmt));
+    EXPECT_EQ(AST_EXPRESSION_STATEMENT, stmt.kind);
+    ASSERT_TRUE(parser_parse_next_statement(&streaming, &arena, &stmt));
+    EXPECT_FALSE(parser_parse_next_statement(&streaming, &arena, &stmt));
+    arena_free(&arena);
+    parser_free(&streaming);
+
+    free((void *) prog_str);
+    program_free(&program);
+    parser_free(&p);
+}
+
+/// A string read a few bytes at a time, as from a pipe.
+struct Chunked_Reader
+{
+    std::string input;
+    size_t pos;
+    size_t chunk_size;
+};
+
+static size_t read_chunked(void *reader, char *buffer, size_t capacity)
+{
+    Chunked_Reader *r = (Chunked_Reader *) reader;
+    size_t len = std::min(std::min(r->chunk_size, capacity), r->input.size() - r->pos);
+    memcpy(buffer, &r->input[r->pos], len);
+    r->pos += len;
+    return len;
+}
+
+static std::string printed_errors(Parser *p)
+{
+    FILE *out = tmpfile();
+    EXPECT_NE(nullptr, out);
+    parser_print_errors(p, out, "script.ty");
+    rewind(out);
+
+    std::string printed;
+    char buffer[256];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), out)) > 0)
+    {
+        printed.append(buffer, len);
+    }
+    fclose(out);
+    return printed;
+}
+
+/// What a parse a statement at a time produced, for comparing parses.
+struct Streamed_Parse
+{
+    Streamed_Statements statements;
+    std::vector<std::vector<size_t>> errors;
+    std::string printed_errors;
+};
+
+static Streamed_Parse parse_each_collecting(Parser *p)
+{
+    Streamed_Parse parse{ { {}, SIZE_MAX, 0 }, {}, "" };
+    p->lazy_function_bodies = true;
+    parser_parse_each(p, collect_statement, &parse.statements);
+    for (size_t i = 0; i < p->errors.len; ++i)
+    {
+        const Parse_Error *error = &p->errors.elements[i];
+        parse.errors.push_back({ (size_t) error->kind, error->token, (size_t) error->expected });
+    }
+    parse.printed_errors = printed_errors(p);
+    return parse;
+}
+
+TEST(ParserTestSuite, Parse_Statements_From_A_Stream)
+{
+    const char *inputs[] = {
+        "var x = 5 + 4 * 3;\n"
+        "var = 1;\n"
+        "var f = func(a) { a * 2 };\n"
+        "!x;\n"
+        "x - (1 + 2)\n",
+        "var s = \"a\\nb\"; println(\"c\\td\", s);\r\n"
+        "if (x < 1) { var y = \"\\\\\"; return y } else { return \"\\\"\" };\r\n",
+        "var g = func(a, b) { if (a) { return func() { b } }; a + };\n"
+        "var h = func() { 1 ;\n",
+        "1 + ;\n\n  2 * (3 +\n",
+        "@ # ;",
+        "\"a\\nb\"; \"c\\td\" \"e\\\\f\"; x;",
+        "",
+    };
+
+    for (const char *input : inputs)
+    {
+        Lexer l;
+        lexer_init(&l, input);
+        Parser p;
+        parser_init(&p, &l);
+        Streamed_Parse expected = parse_each_collecting(&p);
+        parser_free(&p);
+
+        parser_init(&p, &l);
+        Program program = parser_parse_program(&p);
+        const char *expected_program = program_print_ast(&program, PRINT_FORMAT_PLAIN);
+        program_free(&program);
+        parser_free(&p);
+        lexer_free(&l);
+
+        for (size_t chunk_size : { 1, 3, 7, 4096 })
+        {
+            SCOPED_TRACE(std::string(input) + " read " + std::to_string(chunk_size) + " bytes at a time");
+
+            Chunked_Reader reader{ input, 0, chunk_size };
+            parser_init_stream(&p, read_chunked, &reader);
+            Streamed_Parse actual = parse_each_collecting(&p);
+            EXPECT_EQ(expected.statements.printed, actual.statements.printed);
+            EXPECT_EQ(expected.statements.lazy_bodies, actual.statements.lazy_bodies);
+            EXPECT_EQ(expected.errors, actual.errors);
+            EXPECT_EQ(expected.printed_errors, actual.printed_errors);
+            parser_free(&p);
+
+            // NOTE(HS): a whole program can be parsed over a stream too, it just
+            // keeps every token
+            reader = Chunked_Reader{ input, 0, chunk_size };
+            parser_init_stream(&p, read_chunked, &reader);
+            program = parser_parse_program(&p);
+            const char *actual_program = program_print_ast(&program, PRINT_FORMAT_PLAIN);
+            EXPECT_STREQ(expected_program, actual_program);
+            free((void *) actual_program);
+            program_free(&program);
+            parser_free(&p);
+        }
+        free((void *) expected_program);
+    }
+}
+
+static bool track_window(Parser *p, const Statement *stmt, Arena *arena, void *user)
+{
+    (void) stmt;
+    (void) arena;
+    size_t *largest = (size_t *) user;
+    *largest = std::max(*largest, p->tokens->len);
+    return true;
+}
+
+TEST(ParserTestSuite, Stream_Only_Keeps_The_Statement_Being_Parsed)
+{
+    std::string input;
+    const size_t statement_count = 10000;
+    for (size_t i = 0; i < statement_count; ++i)
+    {
+        input += i == statement_count / 2 ? "var = 1;\n" : "var f = func(x) { x * 2 };\n";
+    }
+
+    Chunked_Reader reader{ input, 0, 64 };
+    Parser p;
+    parser_init_stream(&p, read_chunked, &reader);
+    size_t largest = 0;
+    EXPECT_EQ(statement_count, parser_parse_each(&p, track_window, &largest));
+
+    // the statement, the one after it has started, and EOF
+    EXPECT_LE(largest, 16u);
+    EXPECT_LE(p.stream->text_capacity, 256u);
+
+    ASSERT_EQ(1u, p.errors.len);
+    EXPECT_EQ(statement_count / 2 * 13 + 1, p.errors.elements[0].token);
+    EXPECT_EQ("script.ty:5001:5: error: expected IDENT, found ASSIGN\n", printed_errors(&p));
+    parser_free(&p);
+}
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "cpu.h"
+#include "scan.h"
+
+typedef size_t (*Scan_Fn) (const char *, size_t);
+
+/// Reference implementation of each kernel, one character class check per byte
+static size_t scan_reference(const char *str, size_t len, bool (*in_class)(char))
+{
+    size_t i = 0;
+    while (i < len && in_class(str[i])) { i += 1; }
+    return i;
+}
+
+static bool in_whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+static bool in_ident(char c) { return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' || (unsigned char) c >= 0x80; }
+static bool in_number(char c) { return ('0' <= c && c <= '9') || c == '.'; }
+static bool in_line(char c) { return c != '\n' && c != '\r'; }
+static bool in_string(char c) { return c != '"' && c != '\\'; }
+
+struct Scan_Case
+{
+    const char *name;
+    Scan_Fn scan;
+    bool (*in_class)(char);
+    std::string run_chars;
+};
+
+static const std::vector<Scan_Case> scan_cases{
+    { "whitespace", scan_whitespace, in_whitespace, " \t\n\r" },
+    { "ident",      scan_ident,      in_ident,      "azAZ_qQ\xc3\xa9" },
+    { "number",     scan_number,     in_number,     "0123456789." },
+    { "line",       scan_line,       in_line,       "a \t;\"0" },
+    { "string",     scan_string,     in_string,     "a \t\n;'0" },
+};
+
+TEST(Scan_Test_Suite, Run_Terminated_By_Every_Byte)
+{
+    Cpu_Isa detected = scan_get_isa();
+
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+
+        for (auto& sc : scan_cases)
+        {
+            // every run length either side of the 16 and 32 byte boundaries, ended
+            // by every possible byte value
+            for (size_t run_len = 0; run_len < 70; ++run_len)
+            {
+                for (int terminator = 0; terminator < 256; ++terminator)
+                {
+                    std::string input;
+                    for (size_t i = 0; i < run_len; ++i)
+                    {
+                        input.push_back(sc.run_chars[i % sc.run_chars.size()]);
+                    }
+                    input.push_back((char) terminator);
+                    input.append(40, sc.run_chars[0]);
+
+                    size_t expected = scan_reference(input.data(), input.size(), sc.in_class);
+                    size_t actual = sc.scan(input.data(), input.size());
+                    ASSERT_EQ(expected, actual)
+                        << sc.name << " (" << cpu_isa_to_string((Cpu_Isa) isa) << ")"
+                        << " run of " << run_len << " ended by byte " << terminator;
+                }
+            }
+        }
+    }
+
+    scan_set_isa(detected);
+}
+
+TEST(Scan_Test_Suite, Never_Reads_Past_Length)
+{
+    Cpu_Isa detected = scan_get_isa();
+
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+
+        for (auto& sc : scan_cases)
+        {
+            // the whole buffer is in the class, so the result must be clamped to `len`
+            std::string input(100, sc.run_chars[0]);
+            for (size_t len = 0; len < input.size(); ++len)
+            {
+                EXPECT_EQ(len, sc.scan(input.data(), len))
+                    << sc.name << " (" << cpu_isa_to_string((Cpu_Isa) isa) << ")";
+            }
+        }
+    }
+
+    scan_set_isa(detected);
+}
+
+/// Reference validator, decoding each code point and checking it against the
+/// definition rather than the byte patterns of Unicode table 3-7
+static size_t utf8_reference(const std::string& s)
+{
+    size_t i = 0;
+    while (i < s.size())
+    {
+        unsigned char lead = (unsigned char) s[i];
+        size_t n = lead < 0x80 ? 1 : lead < 0xC0 ? 0 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : lead < 0xF8 ? 4 : 0;
+        if (n == 0 || i + n > s.size())
+        {
+            return i;
+        }
+
+        uint32_t cp = n == 1 ? lead : lead & (0x7F >> n);
+        for (size_t k = 1; k < n; ++k)
+        {
+            unsigned char c = (unsigned char) s[i + k];
+            if ((c & 0xC0) != 0x80)
+            {
+                return i;
+            }
+            cp = (cp << 6) | (c & 0x3F);
+        }
+
+        static const uint32_t min_for_length[] = { 0, 0, 0x80, 0x800, 0x10000 };
+        if (cp < min_for_length[n] || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+        {
+            return i;
+        }
+        i += n;
+    }
+    return i;
+}
+
+static void check_utf8_all_isas(const std::string& input)
+{
+    Cpu_Isa detected = scan_get_isa();
+    size_t expected = utf8_reference(input);
+    for (int isa = CPU_ISA_SCALAR; isa < CPU_ISA_COUNT; ++isa)
+    {
+        scan_set_isa((Cpu_Isa) isa);
+        ASSERT_EQ(expected, scan_utf8(input.data(), input.size()))
+            << cpu_isa_to_string((Cpu_Isa) isa) << " on " << input.size() << " bytes";
+    }
+    scan_set_isa(detected);
+}
+
+TEST(Scan_Test_Suite, Utf8_Known_Sequences)
+{
+    const std::vector<std::pair<std::string, bool>> cases{
+        { "plain ascii", true },
+        { "na\xc3\xafve", true },                 // 2 byte
+        { "\xe5\x90\x8d\xe5\x89\x8d", true },     // 3 byte
+        { "\xf0\x9f\x90\xaf", true },             // 4 byte
+        { "\xef\xbf\xbf", true },                 // U+FFFF
+        { "\xf4\x8f\xbf\xbf", true },             // U+10FFFF
+        { "\xc0\x80", false },                    // overlong NUL
+        { "\xc1\xbf", false },                    // overlong 2 byte
+        { "\xe0\x9f\xbf", false },                // overlong 3 byte
+        { "\xf0\x8f\xbf\xbf", false },            // overlong 4 byte
+        { "\xed\xa0\x80", false },                // surrogate
+        { "\xf4\x90\x80\x80", false },            // past U+10FFFF
+        { "\xf5\x80\x80\x80", false },            // invalid lead
+        { "\xff", false },
+        { "\x80", false },                         // lone continuation
+        { "\xc3", false },                         // truncated
+        { "\xe5\x90", false },
+        { "\xc3\xa9\xa9", false },                // too long
+    };
+
+    for (auto& tc : cases)
+    {
+        EXPECT_EQ(tc.second, utf8_reference(tc.first) == tc.first.size()) << tc.first;
+
+        // at every offset around the vector block boundaries, preceded and followed
+        // by ASCII or by other multi-byte sequences
+        for (size_t pad = 0; pad < 70; ++pad)
+        {
+            check_utf8_all_isas(std::string(pad, 'a') + tc.first);
+            check_utf8_all_isas(std::string(pad, 'a') + tc.first + std::string(40, 'b'));
+            std::string multi;
+            while (multi.size() < pad) { multi += "\xc3\xa9"; }
+            check_utf8_all_isas(multi + tc.first + "\xe2\x82\xac" + std::string(40, 'c'));
+            if (HasFatalFailure()) { return; }
+        }
+    }
+}
+
+TEST(Scan_Test_Suite, Utf8_Random_Inputs)
+{
+    // NOTE(HS): mostly well formed fragments so errors land anywhere in the input,
+    // not just in the first few bytes
+    const std::vector<std::string> fragments{
+        "a", "bc", " ", "\n", "\xc3\xa9", "\xe2\x82\xac", "\xf0\x9f\x98\x80", "\xed\x9f\xbf",
+        "\xee\x80\x80", "\xf4\x8f\xbf\xbf",
+    };
+    const std::vector<std::string> bad{
+        "\x80", "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xc0\xaf", "\xed\xa0\x80", "\xf8", "\xfe",
+    };
+
+    uint32_t rng = 7;
+    auto next = [&rng] (uint32_t bound) {
+        rng = rng * 1103515245u + 12345u;
+        return (rng >> 8) % bound;
+    };
+
+    for (int round = 0; round < 3000; ++round)
+    {
+        std::string input;
+        size_t target = next(200);
+        while (input.size() < target)
+        {
+            input += next(60) == 0 ? bad[next((uint32_t) bad.size())] : fragments[next((uint32_t) fragments.size())];
+        }
+        check_utf8_all_isas(input);
+        if (HasFatalFailure()) { return; }
+    }
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+
+#include "source.h"
+
+static void write_file(const char *path, const std::string& content)
+{
+    FILE *f = fopen(path, "wb");
+    ASSERT_NE(f, nullptr);
+    fwrite(content.data(), 1, content.size(), f);
+    fclose(f);
+}
+
+TEST(Source_Test_Suite, Load_File)
+{
+    const char *path = "test_source_load.ty";
+    std::string content = "var x = 5;\nprintln(x);\n";
+    write_file(path, content);
+
+    Source source;
+    ASSERT_TRUE(source_load(&source, path));
+    ASSERT_EQ(content.size(), source.len);
+    EXPECT_EQ(content, std::string(source.data, source.len));
+
+    source_free(&source);
+    EXPECT_EQ(nullptr, source.data);
+    EXPECT_EQ(0, source.len);
+
+    remove(path);
+}
+
+TEST(Source_Test_Suite, Load_Empty_File)
+{
+    const char *path = "test_source_empty.ty";
+    write_file(path, "");
+
+    Source source;
+    ASSERT_TRUE(source_load(&source, path));
+    EXPECT_EQ(0, source.len);
+    source_free(&source);
+
+    remove(path);
+}
+
+TEST(Source_Test_Suite, Load_Missing_File)
+{
+    Source source;
+    EXPECT_FALSE(source_load(&source, "this/file/does/not/exist.ty"));
+    EXPECT_EQ(nullptr, source.data);
+    EXPECT_EQ(0, source.len);
+}
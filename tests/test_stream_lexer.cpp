@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "lexer.h"
+#include "stream_lexer.h"
+
+// NOTE(HS): long identifiers/numbers, escaped quotes and two character operators
+// so that every kind of token gets split across a chunk boundary
+static const std::string stream_input =
+    "var a_very_long_identifier_that_will_not_fit_in_one_small_chunk = 12345.678;\r\n"
+    "var s = \"a string with \\\"escaped\\\" quotes and a \\\\ backslash\";\n"
+    "if (a != b && c <= d || e >= f) { return !x == y; } else { println(s); };\n"
+    "   \t\n"
+    "1.2.3 @ | & \"unterminated";
+
+struct Stream_Token
+{
+    Token_Kind kind;
+    size_t pos;
+    size_t line;
+    size_t col;
+    std::string literal;
+    /// decoded, for strings
+    std::string contents;
+};
+
+static Stream_Token stream_token(const Token& t, const Token_Strings *strings)
+{
+    Stream_Token token{ t.kind, t.location.pos, t.location.line, t.location.col, std::string(t.literal.str, t.literal.length), "" };
+    if (t.kind == TK_STRING_LIT)
+    {
+        String_View contents = token_string_contents(strings, t);
+        token.contents = std::string(contents.str, contents.length);
+    }
+    return token;
+}
+
+static std::vector<Stream_Token> lex_whole(const std::string& input)
+{
+    std::vector<Stream_Token> tokens;
+    Lexer l;
+    lexer_init_n(&l, input.data(), input.size());
+
+    Token t;
+    do
+    {
+        t = lexer_next_token(&l);
+        t.location = lexer_location(&l, t.location.pos);
+        tokens.push_back(stream_token(t, &l.strings));
+    } while (t.kind != TK_EOF);
+
+    lexer_free(&l);
+    return tokens;
+}
+
+static std::vector<Stream_Token> lex_stream(const std::string& input, size_t chunk_size)
+{
+    std::vector<Stream_Token> tokens;
+    Stream_Lexer sl;
+    stream_lexer_init(&sl);
+
+    Token t;
+    for (size_t i = 0; i < input.size(); i += chunk_size)
+    {
+        size_t n = std::min(chunk_size, input.size() - i);
+        stream_lexer_feed(&sl, &input[i], n);
+        while (stream_lexer_next(&sl, &t))
+        {
+            tokens.push_back(stream_token(t, &sl.lexer.strings));
+        }
+    }
+
+    stream_lexer_finish(&sl);
+    do
+    {
+        EXPECT_TRUE(stream_lexer_next(&sl, &t));
+        tokens.push_back(stream_token(t, &sl.lexer.strings));
+    } while (t.kind != TK_EOF);
+
+    // EOF is sticky once the stream has finished
+    EXPECT_TRUE(stream_lexer_next(&sl, &t));
+    EXPECT_EQ(TK_EOF, t.kind);
+    EXPECT_EQ(input.size(), t.location.pos);
+
+    stream_lexer_free(&sl);
+    return tokens;
+}
+
+TEST(Stream_Lexer_Test_Suite, Matches_Whole_Input_For_Every_Chunk_Size)
+{
+    auto expected = lex_whole(stream_input);
+
+    for (size_t chunk_size = 1; chunk_size <= stream_input.size(); ++chunk_size)
+    {
+        auto actual = lex_stream(stream_input, chunk_size);
+
+        ASSERT_EQ(expected.size(), actual.size()) << "chunk size " << chunk_size;
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_EQ(expected[i].kind, actual[i].kind)
+                << "token " << i << " with chunk size " << chunk_size
+                << ": expected " << token_kind_to_string(expected[i].kind)
+                << ", got " << token_kind_to_string(actual[i].kind);
+            EXPECT_EQ(expected[i].pos, actual[i].pos) << "token " << i << " with chunk size " << chunk_size;
+            EXPECT_EQ(expected[i].line, actual[i].line) << "token " << i << " with chunk size " << chunk_size;
+            EXPECT_EQ(expected[i].col, actual[i].col) << "token " << i << " with chunk size " << chunk_size;
+            EXPECT_EQ(expected[i].literal, actual[i].literal) << "token " << i << " with chunk size " << chunk_size;
+            EXPECT_EQ(expected[i].contents, actual[i].contents) << "token " << i << " with chunk size " << chunk_size;
+        }
+    }
+}
+
+TEST(Stream_Lexer_Test_Suite, Lines_Match_Whole_Input)
+{
+    // NOTE(HS): `\r\n` split across chunks, lone `\r`s, and streams ending in a
+    // line break, whose end is on the line before
+    const std::string inputs[] = {
+        "a\r\nb\rc\n\nd",
+        "\r\n\r\n  y \r \n z\r\r\n",
+        "x\r",
+        "x\r\n",
+        "x\n",
+        "\"multi\nline\r\nstring\" w",
+        "",
+    };
+
+    for (const std::string& input : inputs)
+    {
+        auto expected = lex_whole(input);
+        for (size_t chunk_size = 1; chunk_size <= input.size() + 1; ++chunk_size)
+        {
+            auto actual = lex_stream(input, chunk_size);
+            ASSERT_EQ(expected.size(), actual.size()) << input;
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                EXPECT_EQ(expected[i].line, actual[i].line) << "token " << i << " of `" << input << "` with chunk size " << chunk_size;
+                EXPECT_EQ(expected[i].col, actual[i].col) << "token " << i << " of `" << input << "` with chunk size " << chunk_size;
+            }
+        }
+    }
+}
+
+TEST(Stream_Lexer_Test_Suite, Long_Tokens_Fed_A_Byte_At_A_Time)
+{
+    // NOTE(HS): lexing each of these again from its start after every byte would
+    // take hundreds of billions of steps
+    const size_t len = 256 * 1024;
+    std::string input = "var " + std::string(len, 'a') + " = " + std::string(len, '7') + ";"
+        + std::string(len, ' ') + "\"" + std::string(len / 2, 'x') + "\\\"" + std::string(len / 2, 'y') + "\" z";
+    auto expected = lex_whole(input);
+    auto actual = lex_stream(input, 1);
+
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(expected[i].kind, actual[i].kind) << "token " << i;
+        EXPECT_EQ(expected[i].pos, actual[i].pos) << "token " << i;
+        EXPECT_EQ(expected[i].literal, actual[i].literal) << "token " << i;
+        EXPECT_EQ(expected[i].contents, actual[i].contents) << "token " << i;
+    }
+}
+
+TEST(Stream_Lexer_Test_Suite, Bounded_Buffer)
+{
+    // NOTE(HS): ~1MiB of short statements fed 256 bytes at a time, the carry buffer
+    // should never need to grow past its initial size
+    std::string statement = "var x = y + 1;\n";
+    Stream_Lexer sl;
+    stream_lexer_init(&sl);
+
+    size_t count = 0;
+    Token t;
+    std::string chunk;
+    while (chunk.size() < 256) { chunk += statement; }
+    chunk.resize(256);
+
+    for (size_t fed = 0; fed < 1024 * 1024; fed += chunk.size())
+    {
+        stream_lexer_feed(&sl, chunk.data(), chunk.size());
+        while (stream_lexer_next(&sl, &t)) { count += 1; }
+    }
+
+    EXPECT_GT(count, 0);
+    EXPECT_EQ(STREAM_LEXER_DEFAULT_CAPACITY, sl.capacity);
+    stream_lexer_free(&sl);
+}
+
+TEST(Stream_Lexer_Test_Suite, Empty_Stream)
+{
+    Stream_Lexer sl;
+    stream_lexer_init(&sl);
+
+    Token t;
+    EXPECT_FALSE(stream_lexer_next(&sl, &t));
+
+    stream_lexer_finish(&sl);
+    ASSERT_TRUE(stream_lexer_next(&sl, &t));
+    EXPECT_EQ(TK_EOF, t.kind);
+    EXPECT_EQ(0, t.location.pos);
+
+    stream_lexer_free(&sl);
+}
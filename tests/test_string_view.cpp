@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <string>
 #include <vector>
 #include <tuple>
 
@@ -181,3 +182,56 @@ TEST(String_View_Test_Suite, Test_String_View_compare_cstr)
     sv = string_view_from_cstr_offset(str, 7, 4); 
     test_eq(sv, "main");
 }
+
+TEST(String_View_Test_Suite, Test_String_View_compare_cstr_long)
+{
+    // NOTE(HS): used to be truncated to the first 100 bytes
+    std::string long_str(300, 'a');
+    String_View sv = string_view_from_cstr(long_str.c_str(), long_str.size());
+    EXPECT_TRUE(string_view_eq_cstr(sv, long_str.c_str()));
+
+    std::string longer = long_str + "b";
+    EXPECT_FALSE(string_view_eq_cstr(sv, longer.c_str()));
+
+    String_View prefix = string_view_from_cstr(long_str.c_str(), 150);
+    EXPECT_FALSE(string_view_eq_cstr(prefix, long_str.c_str()));
+
+    EXPECT_TRUE(string_view_eq_cstr(string_view_from_cstr("", 0), ""));
+    EXPECT_FALSE(string_view_eq_cstr(sv, NULL));
+}
+
+TEST(String_View_Test_Suite, Test_String_View_compare_every_length)
+{
+    // every length either side of the word and SIMD lane sizes, with a difference
+    // at every position, in buffers at different alignments
+    for (size_t len = 0; len < 70; ++len)
+    {
+        std::string a(len + 3, 'x');
+        std::string b(len + 5, 'x');
+        for (size_t i = 0; i < len + 3; ++i) { a[i] = (char) ('a' + i % 26); }
+        for (size_t i = 0; i < len + 5; ++i) { b[i] = (char) ('a' + (i + 24) % 26); }
+
+        String_View sa = string_view_from_cstr_offset(a.c_str(), 1, len);
+        String_View sb = string_view_from_cstr_offset(b.c_str(), 3, len);
+        ASSERT_TRUE(string_view_eq(sa, sb)) << len;
+        ASSERT_TRUE(hashed_string_view_eq(string_view_hashed(sa), string_view_hashed(sb))) << len;
+        ASSERT_EQ(string_view_hash(sa), string_view_hash(sb)) << len;
+
+        for (size_t diff = 0; diff < len; ++diff)
+        {
+            b[3 + diff] ^= 0x20;
+            ASSERT_FALSE(string_view_eq(sa, sb)) << len << " differing at " << diff;
+            ASSERT_FALSE(hashed_string_view_eq(string_view_hashed(sa), string_view_hashed(sb)))
+                << len << " differing at " << diff;
+            ASSERT_NE(string_view_hash(sa), string_view_hash(sb)) << len << " differing at " << diff;
+            b[3 + diff] ^= 0x20;
+        }
+
+        if (len > 0)
+        {
+            String_View shorter = string_view_from_cstr_offset(b.c_str(), 3, len - 1);
+            ASSERT_FALSE(string_view_eq(sa, shorter)) << len;
+            ASSERT_FALSE(hashed_string_view_eq(string_view_hashed(sa), string_view_hashed(shorter))) << len;
+        }
+    }
+}
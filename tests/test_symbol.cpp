@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <string.h>
+
+#include "arena.h"
+#include "lexer.h"
+#include "symbol.h"
+#include "tthreads.h"
+
+static Symbol intern(const std::string& name)
+{
+    return symbol_intern(String_View{ (char*) name.data(), name.size() });
+}
+
+TEST(Symbol_Test_Suite, Same_Name_Same_Symbol)
+{
+    Symbol foo = intern("foo");
+    Symbol bar = intern("bar");
+
+    EXPECT_NE(SYMBOL_NONE, foo);
+    EXPECT_NE(SYMBOL_NONE, bar);
+    EXPECT_NE(foo, bar);
+    EXPECT_EQ(foo, intern("foo"));
+    EXPECT_EQ(bar, intern(std::string("bar")));
+
+    // NOTE(HS): prefixes and differently sized names are distinct
+    EXPECT_NE(foo, intern("fo"));
+    EXPECT_NE(foo, intern("fooo"));
+    EXPECT_NE(foo, intern(""));
+
+    EXPECT_STREQ("foo", symbol_to_cstr(foo));
+    String_View sv = symbol_to_string_view(bar);
+    EXPECT_EQ(3u, sv.length);
+    EXPECT_EQ(0, strncmp("bar", sv.str, sv.length));
+}
+
+TEST(Symbol_Test_Suite, Strings_Are_Stable_As_The_Table_Grows)
+{
+    Symbol first = intern("stable_name");
+    const char *first_str = symbol_to_cstr(first);
+
+    // enough names to rehash and fill several arena blocks
+    std::vector<Symbol> symbols;
+    for (int i = 0; i < 20000; ++i)
+    {
+        symbols.push_back(intern("name_" + std::to_string(i) + std::string(i % 40, 'x')));
+    }
+
+    EXPECT_EQ(first_str, symbol_to_cstr(first));
+    EXPECT_EQ(first, intern("stable_name"));
+    for (int i = 0; i < 20000; ++i)
+    {
+        std::string name = "name_" + std::to_string(i) + std::string(i % 40, 'x');
+        ASSERT_EQ(symbols[i], intern(name));
+        ASSERT_STREQ(name.c_str(), symbol_to_cstr(symbols[i]));
+    }
+}
+
+struct Intern_Job
+{
+    int offset;
+    std::vector<Symbol> symbols;
+};
+
+static void intern_many(void *arg)
+{
+    Intern_Job *job = (Intern_Job*) arg;
+    for (int i = 0; i < 2000; ++i)
+    {
+        // NOTE(HS): each thread starts at a different name so the inserts overlap
+        int n = (i + job->offset) % 2000;
+        job->symbols[n] = intern("shared_" + std::to_string(n));
+    }
+}
+
+TEST(Symbol_Test_Suite, Concurrent_Interning)
+{
+    std::vector<Intern_Job> jobs(4);
+    std::vector<Thread> threads(jobs.size());
+    for (size_t i = 0; i < jobs.size(); ++i)
+    {
+        jobs[i].offset = (int) i * 500;
+        jobs[i].symbols.resize(2000);
+        ASSERT_TRUE(thread_create(&threads[i], intern_many, &jobs[i]));
+    }
+    for (auto& thread : threads)
+    {
+        thread_join(&thread);
+    }
+
+    for (int n = 0; n < 2000; ++n)
+    {
+        for (auto& job : jobs)
+        {
+            ASSERT_EQ(jobs[0].symbols[n], job.symbols[n]);
+        }
+        ASSERT_STREQ(("shared_" + std::to_string(n)).c_str(), symbol_to_cstr(jobs[0].symbols[n]));
+    }
+}
+
+TEST(Symbol_Test_Suite, Lexer_Interns_Identifiers)
+{
+    const char *input = "var abc = abc + abd; if (abc) { abd }";
+    Lexer l;
+    lexer_init(&l, input);
+
+    std::vector<Token> idents;
+    for (Token t = lexer_next_token(&l); t.kind != TK_EOF; t = lexer_next_token(&l))
+    {
+        if (t.kind == TK_IDENT)
+        {
+            idents.push_back(t);
+        }
+        else
+        {
+            EXPECT_EQ(0u, t.value.bits) << token_kind_to_string(t.kind);
+        }
+    }
+    lexer_free(&l);
+
+    ASSERT_EQ(5u, idents.size());
+    EXPECT_EQ(idents[0].value.symbol, idents[1].value.symbol);
+    EXPECT_EQ(idents[0].value.symbol, idents[3].value.symbol);
+    EXPECT_EQ(idents[2].value.symbol, idents[4].value.symbol);
+    EXPECT_NE(idents[0].value.symbol, idents[2].value.symbol);
+    EXPECT_STREQ("abd", symbol_to_cstr(idents[2].value.symbol));
+}
+
+TEST(Arena_Test_Suite, Allocations_Are_Aligned_And_Distinct)
+{
+    Arena arena{};
+
+    std::vector<char*> allocs;
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        size_t align = (size_t) 1 << (i % 5);
+        size_t size = 1 + (i * 37) % 300;
+        char *ptr = (char*) arena_alloc(&arena, size, align);
+        ASSERT_EQ(0u, (uintptr_t) ptr % align);
+        memset(ptr, (int) (i & 0xff), size);
+        allocs.push_back(ptr);
+    }
+
+    // NOTE(HS): later allocations mustn't have overwritten earlier ones
+    for (size_t i = 0; i < allocs.size(); ++i)
+    {
+        size_t size = 1 + (i * 37) % 300;
+        for (size_t j = 0; j < size; ++j)
+        {
+            ASSERT_EQ((char) (i & 0xff), allocs[i][j]);
+        }
+    }
+
+    // bigger than a whole block
+    char *big = (char*) arena_alloc(&arena, ARENA_DEFAULT_BLOCK_SIZE * 2, 16);
+    memset(big, 1, ARENA_DEFAULT_BLOCK_SIZE * 2);
+    char *small = arena_strndup(&arena, "after big", 9);
+    EXPECT_STREQ("after big", small);
+
+    arena_free(&arena);
+    EXPECT_EQ(nullptr, arena.head);
+    EXPECT_EQ(0u, arena.used);
+}
@@ -51,6 +51,8 @@ TEST(TracePlainTestSuite, Test_Trace_Var_Statement)
         EXPECT_EQ(act_ast, exp_ast);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
         free((void *) prog_yml);
     }
@@ -117,6 +119,8 @@ TEST(TracePlainTestSuite, Test_Trace_Expression_Statement)
         EXPECT_EQ(act_ast, exp_ast);
 
         program_free(&program);
+
+        parser_free(&p);
         free((void *) prog_str);
         free((void *) prog_yml);
     }